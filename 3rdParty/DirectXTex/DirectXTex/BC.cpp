@@ -30,6 +30,68 @@ namespace
     const HDRColorA g_Luminance(0.2125f / 0.7154f, 1.0f, 0.0721f / 0.7154f, 1.0f);
     const HDRColorA g_LuminanceInv(0.7154f / 0.2125f, 1.0f, 0.7154f / 0.0721f, 1.0f);
 
+    // Scale of the YCoCg chroma terms relative to luma.  An error in Co counts a third, and
+    // an error in Cg half, as much as the same error in luma.
+    constexpr float g_YCoCgCo = 0.57735027f;
+    constexpr float g_YCoCgCg = 0.70710678f;
+
+    //-------------------------------------------------------------------------------------
+    // Color weighting
+    //-------------------------------------------------------------------------------------
+
+    // The color encoder works on weighted colors, where the squared distance between two
+    // colors is their error under the selected metric.  Every weighting is affine, so the
+    // weighted palette is the interpolation of the weighted endpoints.
+    inline void WeightColor(_Inout_ HDRColorA& Color, uint32_t flags) noexcept
+    {
+        if (flags & BC_FLAGS_YCOCG_METRIC)
+        {
+            // Chroma is offset so that [0, 1] colors have non-negative components
+            const float y = Color.r * 0.25f + Color.g * 0.5f + Color.b * 0.25f;
+            const float co = (Color.r - Color.b) * 0.5f + 0.5f;
+            const float cg = Color.g * 0.5f - (Color.r + Color.b) * 0.25f + 0.5f;
+
+            Color.r = y;
+            Color.g = co * g_YCoCgCo;
+            Color.b = cg * g_YCoCgCg;
+        }
+        else if (!(flags & BC_FLAGS_UNIFORM))
+        {
+            Color.r *= g_Luminance.r;
+            Color.g *= g_Luminance.g;
+            Color.b *= g_Luminance.b;
+        }
+    }
+
+    inline void UnweightColor(_Inout_ HDRColorA& Color, uint32_t flags) noexcept
+    {
+        if (flags & BC_FLAGS_YCOCG_METRIC)
+        {
+            const float y = Color.r;
+            const float co = Color.g * (1.0f / g_YCoCgCo) - 0.5f;
+            const float cg = Color.b * (1.0f / g_YCoCgCg) - 0.5f;
+
+            Color.r = y - cg + co;
+            Color.g = y + cg;
+            Color.b = y - cg - co;
+        }
+        else if (!(flags & BC_FLAGS_UNIFORM))
+        {
+            Color.r *= g_LuminanceInv.r;
+            Color.g *= g_LuminanceInv.g;
+            Color.b *= g_LuminanceInv.b;
+        }
+    }
+
+    // Upper bound of the weighted components of [0, 1] colors, the lower bound is zero
+    inline HDRColorA GetWeightedExtent(uint32_t flags) noexcept
+    {
+        if (flags & BC_FLAGS_YCOCG_METRIC)
+            return HDRColorA(1.0f, g_YCoCgCo, g_YCoCgCg, 1.0f);
+
+        return (flags & BC_FLAGS_UNIFORM) ? HDRColorA(1.f, 1.f, 1.f, 1.f) : g_Luminance;
+    }
+
     //-------------------------------------------------------------------------------------
     // Decode/Encode RGB 5/6/5 colors
     //-------------------------------------------------------------------------------------
@@ -61,6 +123,172 @@ namespace
     }
 
 
+    //-------------------------------------------------------------------------------------
+    // Closed form replacement for the Newton's method refinement in OptimizeRGB.  The
+    // principal axis of the block comes from power iteration on the color covariance,
+    // starting from the bounding box diagonal in X and Y.  The endpoints are the extremes of
+    // the points projected onto that axis, refit by least squares against the steps they
+    // select.
+    void FitPrincipalAxis(
+        _Inout_ HDRColorA *pX,
+        _Inout_ HDRColorA *pY,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *pPoints,
+        uint32_t cSteps,
+        _In_reads_(cSteps) const float *pC,
+        _In_reads_(cSteps) const float *pD) noexcept
+    {
+        // Weighted mean and covariance of the block
+        float fWeight = 0.0f;
+        HDRColorA Mean(0.0f, 0.0f, 0.0f, 0.0f);
+
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+        #ifdef COLOR_WEIGHTS
+            const float w = pPoints[iPoint].a;
+        #else
+            const float w = 1.0f;
+        #endif // COLOR_WEIGHTS
+
+            fWeight += w;
+            Mean.r += pPoints[iPoint].r * w;
+            Mean.g += pPoints[iPoint].g * w;
+            Mean.b += pPoints[iPoint].b * w;
+        }
+
+        if (fWeight < FLT_MIN)
+            return;
+
+        Mean *= 1.0f / fWeight;
+        Mean.a = 0.0f;
+
+        float fCov[3][3] = {};
+
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+        #ifdef COLOR_WEIGHTS
+            const float w = pPoints[iPoint].a;
+        #else
+            const float w = 1.0f;
+        #endif // COLOR_WEIGHTS
+
+            const float fPt[3] = {
+                pPoints[iPoint].r - Mean.r,
+                pPoints[iPoint].g - Mean.g,
+                pPoints[iPoint].b - Mean.b };
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+                for (size_t d = c; d < 3; ++d)
+                {
+                    fCov[c][d] += fPt[c] * fPt[d] * w;
+                }
+            }
+        }
+
+        fCov[1][0] = fCov[0][1];
+        fCov[2][0] = fCov[0][2];
+        fCov[2][1] = fCov[1][2];
+
+        float fAxis[3] = { pY->r - pX->r, pY->g - pX->g, pY->b - pX->b };
+
+        for (size_t iIteration = 0; iIteration < 8; iIteration++)
+        {
+            float fNext[3] = {};
+            float fMax = 0.0f;
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+                fNext[c] = fCov[c][0] * fAxis[0] + fCov[c][1] * fAxis[1] + fCov[c][2] * fAxis[2];
+                fMax = std::max(fMax, fabsf(fNext[c]));
+            }
+
+            if (fMax < FLT_MIN)
+                break;
+
+            const float fInvMax = 1.0f / fMax;
+            fAxis[0] = fNext[0] * fInvMax;
+            fAxis[1] = fNext[1] * fInvMax;
+            fAxis[2] = fNext[2] * fInvMax;
+        }
+
+        const HDRColorA Axis(fAxis[0], fAxis[1], fAxis[2], 0.0f);
+        const float fLen = Axis * Axis;
+
+        if (fLen < FLT_MIN)
+            return;
+
+        // Extremes of the points along the axis
+        const float fInvLen = 1.0f / fLen;
+        float fProj[NUM_PIXELS_PER_BLOCK];
+        float fMin = FLT_MAX;
+        float fMax = -FLT_MAX;
+
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+            fProj[iPoint] = ((pPoints[iPoint].r - Mean.r) * Axis.r +
+                (pPoints[iPoint].g - Mean.g) * Axis.g +
+                (pPoints[iPoint].b - Mean.b) * Axis.b) * fInvLen;
+
+        #ifdef COLOR_WEIGHTS
+            if (pPoints[iPoint].a > 0.0f)
+        #endif // COLOR_WEIGHTS
+            {
+                fMin = std::min(fMin, fProj[iPoint]);
+                fMax = std::max(fMax, fProj[iPoint]);
+            }
+        }
+
+        HDRColorA X = Mean + Axis * fMin;
+        HDRColorA Y = Mean + Axis * fMax;
+
+        // Least-squares endpoints for the steps selected by the extremes
+        const float fRange = fMax - fMin;
+
+        if (fRange >= FLT_MIN)
+        {
+            const auto fScale = static_cast<float>(cSteps - 1) / fRange;
+
+            float fCC = 0.0f, fCD = 0.0f, fDD = 0.0f;
+            HDRColorA CP(0.0f, 0.0f, 0.0f, 0.0f), DP(0.0f, 0.0f, 0.0f, 0.0f);
+
+            for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+            {
+                const float fStep = (fProj[iPoint] - fMin) * fScale + 0.5f;
+                const uint32_t iStep = (fStep <= 0.0f) ? 0u : std::min(cSteps - 1, static_cast<uint32_t>(fStep));
+
+            #ifdef COLOR_WEIGHTS
+                const float fC = pC[iStep] * pPoints[iPoint].a;
+                const float fD = pD[iStep] * pPoints[iPoint].a;
+            #else
+                const float fC = pC[iStep];
+                const float fD = pD[iStep];
+            #endif // COLOR_WEIGHTS
+
+                const HDRColorA Pt(pPoints[iPoint].r, pPoints[iPoint].g, pPoints[iPoint].b, 0.0f);
+
+                fCC += fC * pC[iStep];
+                fCD += fC * pD[iStep];
+                fDD += fD * pD[iStep];
+                CP += Pt * fC;
+                DP += Pt * fD;
+            }
+
+            // Too few distinct steps to pin down both endpoints, keep the extremes
+            const float fDet = fCC * fDD - fCD * fCD;
+
+            if (fDet >= (1.0f / 64.0f) * fCC * fDD && fDet > 0.0f)
+            {
+                const float fInvDet = 1.0f / fDet;
+                X = (CP * fDD - DP * fCD) * fInvDet;
+                Y = (DP * fCC - CP * fCD) * fInvDet;
+            }
+        }
+
+        pX->r = X.r; pX->g = X.g; pX->b = X.b; pX->a = 1.0f;
+        pY->r = Y.r; pY->g = Y.g; pY->b = Y.b; pY->a = 1.0f;
+    }
+
+
     //-------------------------------------------------------------------------------------
     void OptimizeRGB(
         _Out_ HDRColorA *pX,
@@ -79,7 +307,7 @@ namespace
         const float *pD = (3 == cSteps) ? pD3 : pD4;
 
         // Find Min and Max points, as starting point
-        HDRColorA X = (flags & BC_FLAGS_UNIFORM) ? HDRColorA(1.f, 1.f, 1.f, 1.f) : g_Luminance;
+        HDRColorA X = GetWeightedExtent(flags);
         HDRColorA Y = HDRColorA(0.0f, 0.0f, 0.0f, 1.0f);
 
         for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
@@ -202,6 +430,14 @@ namespace
             return;
         }
 
+        if (flags & BC_FLAGS_FORCE_BC7_MODE6)
+        {
+            pX->r = X.r; pX->g = X.g; pX->b = X.b; pX->a = 1.0f;
+            pY->r = Y.r; pY->g = Y.g; pY->b = Y.b; pY->a = 1.0f;
+            FitPrincipalAxis(pX, pY, pPoints, cSteps, pC, pD);
+            return;
+        }
+
         // Use Newton's Method to find local minima of sum-of-squares error.
         const auto fSteps = static_cast<float>(cSteps - 1);
 
@@ -315,12 +551,264 @@ namespace
 
 
     //-------------------------------------------------------------------------------------
-    inline void DecodeBC1(
-        _Out_writes_(NUM_PIXELS_PER_BLOCK) XMVECTOR *pColor,
+    // OptimizeRGB for up to BC_ENCODE_BATCH_SIZE four step blocks at once.  The points are
+    // transposed so each XMVECTOR lane holds a different block, which lets the endpoint
+    // search use every lane instead of one lane per color channel.
+#ifndef COLOR_WEIGHTS
+    void OptimizeRGBBatch(
+        _Out_writes_(count) HDRColorA *pX,
+        _Out_writes_(count) HDRColorA *pY,
+        _In_reads_(count) const HDRColorA* const *pPoints,
+        size_t count,
+        uint32_t flags) noexcept
+    {
+        assert(count > 0 && count <= BC_ENCODE_BATCH_SIZE);
+        static_assert(BC_ENCODE_BATCH_SIZE == 4, "One block per XMVECTOR lane");
+
+        constexpr float fEpsilon = (0.25f / 64.0f) * (0.25f / 64.0f);
+        const XMVECTOR vEpsilon = XMVectorReplicate(fEpsilon);
+        const XMVECTOR vSteps = XMVectorReplicate(3.0f);
+        const XMVECTOR vMinLength = XMVectorReplicate(1.0f / 4096.0f);
+        const XMVECTOR vHalf = g_XMOneHalf;
+
+        // Step weights, the same values as the pC4 and pD4 tables in OptimizeRGB
+        const XMVECTOR vC1 = XMVectorReplicate(2.0f / 3.0f);
+        const XMVECTOR vC2 = XMVectorReplicate(1.0f / 3.0f);
+
+        // Transpose the blocks, unused lanes repeat the first block
+        XMVECTOR R[NUM_PIXELS_PER_BLOCK];
+        XMVECTOR G[NUM_PIXELS_PER_BLOCK];
+        XMVECTOR B[NUM_PIXELS_PER_BLOCK];
+
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+            float r[BC_ENCODE_BATCH_SIZE], g[BC_ENCODE_BATCH_SIZE], b[BC_ENCODE_BATCH_SIZE];
+
+            for (size_t iLane = 0; iLane < BC_ENCODE_BATCH_SIZE; iLane++)
+            {
+                const HDRColorA& pt = pPoints[(iLane < count) ? iLane : 0][iPoint];
+                r[iLane] = pt.r;
+                g[iLane] = pt.g;
+                b[iLane] = pt.b;
+            }
+
+            R[iPoint] = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(r));
+            G[iPoint] = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(g));
+            B[iPoint] = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(b));
+        }
+
+        // Find Min and Max points, as starting point
+        const HDRColorA init = GetWeightedExtent(flags);
+
+        XMVECTOR Xr = XMVectorReplicate(init.r);
+        XMVECTOR Xg = XMVectorReplicate(init.g);
+        XMVECTOR Xb = XMVectorReplicate(init.b);
+        XMVECTOR Yr = XMVectorZero();
+        XMVECTOR Yg = XMVectorZero();
+        XMVECTOR Yb = XMVectorZero();
+
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+            Xr = XMVectorMin(Xr, R[iPoint]);
+            Xg = XMVectorMin(Xg, G[iPoint]);
+            Xb = XMVectorMin(Xb, B[iPoint]);
+            Yr = XMVectorMax(Yr, R[iPoint]);
+            Yg = XMVectorMax(Yg, G[iPoint]);
+            Yb = XMVectorMax(Yb, B[iPoint]);
+        }
+
+        // Diagonal axis
+        const XMVECTOR ABr = XMVectorSubtract(Yr, Xr);
+        const XMVECTOR ABg = XMVectorSubtract(Yg, Xg);
+        const XMVECTOR ABb = XMVectorSubtract(Yb, Xb);
+
+        const XMVECTOR fAB = XMVectorAdd(XMVectorAdd(XMVectorMultiply(ABr, ABr), XMVectorMultiply(ABg, ABg)), XMVectorMultiply(ABb, ABb));
+
+        // Single color blocks.. no need to root-find
+        const XMVECTOR singleColor = XMVectorLess(fAB, XMVectorReplicate(FLT_MIN));
+
+        // Try all four axis directions, to determine which diagonal best fits data
+        const XMVECTOR fABInv = XMVectorDivide(g_XMOne, fAB);
+
+        const XMVECTOR Dr = XMVectorMultiply(ABr, fABInv);
+        const XMVECTOR Dg = XMVectorMultiply(ABg, fABInv);
+        const XMVECTOR Db = XMVectorMultiply(ABb, fABInv);
+
+        const XMVECTOR Mr = XMVectorMultiply(XMVectorAdd(Xr, Yr), vHalf);
+        const XMVECTOR Mg = XMVectorMultiply(XMVectorAdd(Xg, Yg), vHalf);
+        const XMVECTOR Mb = XMVectorMultiply(XMVectorAdd(Xb, Yb), vHalf);
+
+        XMVECTOR fDir[4] = { XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero() };
+
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+            const XMVECTOR Pr = XMVectorMultiply(XMVectorSubtract(R[iPoint], Mr), Dr);
+            const XMVECTOR Pg = XMVectorMultiply(XMVectorSubtract(G[iPoint], Mg), Dg);
+            const XMVECTOR Pb = XMVectorMultiply(XMVectorSubtract(B[iPoint], Mb), Db);
+
+            XMVECTOR f;
+
+            f = XMVectorAdd(XMVectorAdd(Pr, Pg), Pb);
+            fDir[0] = XMVectorAdd(fDir[0], XMVectorMultiply(f, f));
+
+            f = XMVectorSubtract(XMVectorAdd(Pr, Pg), Pb);
+            fDir[1] = XMVectorAdd(fDir[1], XMVectorMultiply(f, f));
+
+            f = XMVectorAdd(XMVectorSubtract(Pr, Pg), Pb);
+            fDir[2] = XMVectorAdd(fDir[2], XMVectorMultiply(f, f));
+
+            f = XMVectorSubtract(XMVectorSubtract(Pr, Pg), Pb);
+            fDir[3] = XMVectorAdd(fDir[3], XMVectorMultiply(f, f));
+        }
+
+        // Ties keep the lowest direction, the same as the single block search
+        XMVECTOR fDirMax = fDir[0];
+        XMVECTOR swapG = XMVectorFalseInt();
+        XMVECTOR swapB = XMVectorFalseInt();
+
+        for (size_t iDir = 1; iDir < 4; iDir++)
+        {
+            const XMVECTOR better = XMVectorGreater(fDir[iDir], fDirMax);
+
+            fDirMax = XMVectorSelect(fDirMax, fDir[iDir], better);
+            swapG = XMVectorSelect(swapG, (iDir & 2) ? XMVectorTrueInt() : XMVectorFalseInt(), better);
+            swapB = XMVectorSelect(swapB, (iDir & 1) ? XMVectorTrueInt() : XMVectorFalseInt(), better);
+        }
+
+        swapG = XMVectorAndCInt(swapG, singleColor);
+        swapB = XMVectorAndCInt(swapB, singleColor);
+
+        XMVECTOR t = Xg;
+        Xg = XMVectorSelect(Xg, Yg, swapG);
+        Yg = XMVectorSelect(Yg, t, swapG);
+
+        t = Xb;
+        Xb = XMVectorSelect(Xb, Yb, swapB);
+        Yb = XMVectorSelect(Yb, t, swapB);
+
+        // Two color blocks.. no need to root-find
+        XMVECTOR active = XMVectorAndCInt(XMVectorTrueInt(), XMVectorOrInt(singleColor, XMVectorLess(fAB, vMinLength)));
+
+        // Use Newton's Method to find local minima of sum-of-squares error,
+        // lanes drop out of the update as soon as their block converges.
+        // Every operation rounds the same way as in OptimizeRGB, so there are no
+        // fused multiply-adds and the step weights come from the same constants.
+        for (size_t iIteration = 0; iIteration < 8; iIteration++)
+        {
+            // Calculate color direction
+            XMVECTOR DirR = XMVectorSubtract(Yr, Xr);
+            XMVECTOR DirG = XMVectorSubtract(Yg, Xg);
+            XMVECTOR DirB = XMVectorSubtract(Yb, Xb);
+
+            const XMVECTOR fLen = XMVectorAdd(XMVectorAdd(XMVectorMultiply(DirR, DirR), XMVectorMultiply(DirG, DirG)), XMVectorMultiply(DirB, DirB));
+
+            active = XMVectorAndCInt(active, XMVectorLess(fLen, vMinLength));
+
+            if (XMVector4EqualInt(active, XMVectorFalseInt()))
+                break;
+
+            const XMVECTOR fScale = XMVectorDivide(vSteps, fLen);
+
+            DirR = XMVectorMultiply(DirR, fScale);
+            DirG = XMVectorMultiply(DirG, fScale);
+            DirB = XMVectorMultiply(DirB, fScale);
+
+            // Evaluate function, and derivatives
+            XMVECTOR d2X = XMVectorZero();
+            XMVECTOR d2Y = XMVectorZero();
+            XMVECTOR dXr = XMVectorZero();
+            XMVECTOR dXg = XMVectorZero();
+            XMVECTOR dXb = XMVectorZero();
+            XMVECTOR dYr = XMVectorZero();
+            XMVECTOR dYg = XMVectorZero();
+            XMVECTOR dYb = XMVectorZero();
+
+            for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+            {
+                XMVECTOR fDot = XMVectorMultiply(XMVectorSubtract(R[iPoint], Xr), DirR);
+                fDot = XMVectorAdd(fDot, XMVectorMultiply(XMVectorSubtract(G[iPoint], Xg), DirG));
+                fDot = XMVectorAdd(fDot, XMVectorMultiply(XMVectorSubtract(B[iPoint], Xb), DirB));
+
+                // Nearest of the four steps, clamped to the endpoints
+                const XMVECTOR iStep = XMVectorClamp(XMVectorTruncate(XMVectorAdd(fDot, vHalf)), XMVectorZero(), vSteps);
+
+                const XMVECTOR step1 = XMVectorEqual(iStep, g_XMOne);
+                const XMVECTOR step2 = XMVectorEqual(iStep, g_XMTwo);
+
+                XMVECTOR fC = XMVectorSelect(XMVectorSelect(XMVectorZero(), vC2, step2), vC1, step1);
+                fC = XMVectorSelect(fC, g_XMOne, XMVectorEqual(iStep, XMVectorZero()));
+
+                XMVECTOR fD = XMVectorSelect(XMVectorSelect(g_XMOne, vC1, step2), vC2, step1);
+                fD = XMVectorSelect(fD, XMVectorZero(), XMVectorEqual(iStep, XMVectorZero()));
+
+                const XMVECTOR Diffr = XMVectorSubtract(XMVectorAdd(XMVectorMultiply(Xr, fC), XMVectorMultiply(Yr, fD)), R[iPoint]);
+                const XMVECTOR Diffg = XMVectorSubtract(XMVectorAdd(XMVectorMultiply(Xg, fC), XMVectorMultiply(Yg, fD)), G[iPoint]);
+                const XMVECTOR Diffb = XMVectorSubtract(XMVectorAdd(XMVectorMultiply(Xb, fC), XMVectorMultiply(Yb, fD)), B[iPoint]);
+
+                const XMVECTOR fC8 = XMVectorScale(fC, 1.0f / 8.0f);
+                const XMVECTOR fD8 = XMVectorScale(fD, 1.0f / 8.0f);
+
+                d2X = XMVectorAdd(d2X, XMVectorMultiply(fC8, fC));
+                dXr = XMVectorAdd(dXr, XMVectorMultiply(fC8, Diffr));
+                dXg = XMVectorAdd(dXg, XMVectorMultiply(fC8, Diffg));
+                dXb = XMVectorAdd(dXb, XMVectorMultiply(fC8, Diffb));
+
+                d2Y = XMVectorAdd(d2Y, XMVectorMultiply(fD8, fD));
+                dYr = XMVectorAdd(dYr, XMVectorMultiply(fD8, Diffr));
+                dYg = XMVectorAdd(dYg, XMVectorMultiply(fD8, Diffg));
+                dYb = XMVectorAdd(dYb, XMVectorMultiply(fD8, Diffb));
+            }
+
+            // Move endpoints
+            const XMVECTOR moveX = XMVectorAndInt(active, XMVectorGreater(d2X, XMVectorZero()));
+            const XMVECTOR moveY = XMVectorAndInt(active, XMVectorGreater(d2Y, XMVectorZero()));
+
+            const XMVECTOR fX = XMVectorDivide(g_XMNegativeOne, d2X);
+            const XMVECTOR fY = XMVectorDivide(g_XMNegativeOne, d2Y);
+
+            Xr = XMVectorSelect(Xr, XMVectorAdd(Xr, XMVectorMultiply(dXr, fX)), moveX);
+            Xg = XMVectorSelect(Xg, XMVectorAdd(Xg, XMVectorMultiply(dXg, fX)), moveX);
+            Xb = XMVectorSelect(Xb, XMVectorAdd(Xb, XMVectorMultiply(dXb, fX)), moveX);
+
+            Yr = XMVectorSelect(Yr, XMVectorAdd(Yr, XMVectorMultiply(dYr, fY)), moveY);
+            Yg = XMVectorSelect(Yg, XMVectorAdd(Yg, XMVectorMultiply(dYg, fY)), moveY);
+            Yb = XMVectorSelect(Yb, XMVectorAdd(Yb, XMVectorMultiply(dYb, fY)), moveY);
+
+            XMVECTOR converged = XMVectorLess(XMVectorMultiply(dXr, dXr), vEpsilon);
+            converged = XMVectorAndInt(converged, XMVectorLess(XMVectorMultiply(dXg, dXg), vEpsilon));
+            converged = XMVectorAndInt(converged, XMVectorLess(XMVectorMultiply(dXb, dXb), vEpsilon));
+            converged = XMVectorAndInt(converged, XMVectorLess(XMVectorMultiply(dYr, dYr), vEpsilon));
+            converged = XMVectorAndInt(converged, XMVectorLess(XMVectorMultiply(dYg, dYg), vEpsilon));
+            converged = XMVectorAndInt(converged, XMVectorLess(XMVectorMultiply(dYb, dYb), vEpsilon));
+
+            active = XMVectorAndCInt(active, converged);
+        }
+
+        float xr[BC_ENCODE_BATCH_SIZE], xg[BC_ENCODE_BATCH_SIZE], xb[BC_ENCODE_BATCH_SIZE];
+        float yr[BC_ENCODE_BATCH_SIZE], yg[BC_ENCODE_BATCH_SIZE], yb[BC_ENCODE_BATCH_SIZE];
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(xr), Xr);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(xg), Xg);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(xb), Xb);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(yr), Yr);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(yg), Yg);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(yb), Yb);
+
+        for (size_t iLane = 0; iLane < count; iLane++)
+        {
+            pX[iLane].r = xr[iLane]; pX[iLane].g = xg[iLane]; pX[iLane].b = xb[iLane]; pX[iLane].a = 1.0f;
+            pY[iLane].r = yr[iLane]; pY[iLane].g = yg[iLane]; pY[iLane].b = yb[iLane]; pY[iLane].a = 1.0f;
+        }
+    }
+#endif // !COLOR_WEIGHTS
+
+
+    //-------------------------------------------------------------------------------------
+    inline void DecodeBC1Palette(
+        _Out_writes_(4) XMVECTOR *pPalette,
         _In_ const D3DX_BC1 *pBC,
         bool isbc1) noexcept
     {
-        assert(pColor && pBC);
+        assert(pPalette && pBC);
         static_assert(sizeof(D3DX_BC1) == 8, "D3DX_BC1 should be 8 bytes");
 
         static XMVECTORF32 s_Scale = { { { 1.f / 31.f, 1.f / 63.f, 1.f / 31.f, 1.f } } };
@@ -337,85 +825,103 @@ namespace
         clr0 = XMVectorSelect(g_XMIdentityR3, clr0, g_XMSelect1110);
         clr1 = XMVectorSelect(g_XMIdentityR3, clr1, g_XMSelect1110);
 
-        XMVECTOR clr2, clr3;
+        pPalette[0] = clr0;
+        pPalette[1] = clr1;
+
         if (isbc1 && (pBC->rgb[0] <= pBC->rgb[1]))
         {
-            clr2 = XMVectorLerp(clr0, clr1, 0.5f);
-            clr3 = XMVectorZero();  // Alpha of 0
+            pPalette[2] = XMVectorLerp(clr0, clr1, 0.5f);
+            pPalette[3] = XMVectorZero();  // Alpha of 0
         }
         else
         {
-            clr2 = XMVectorLerp(clr0, clr1, 1.f / 3.f);
-            clr3 = XMVectorLerp(clr0, clr1, 2.f / 3.f);
+            pPalette[2] = XMVectorLerp(clr0, clr1, 1.f / 3.f);
+            pPalette[3] = XMVectorLerp(clr0, clr1, 2.f / 3.f);
         }
+    }
+
+    inline void DecodeBC1(
+        _Out_writes_(NUM_PIXELS_PER_BLOCK) XMVECTOR *pColor,
+        _In_ const D3DX_BC1 *pBC,
+        bool isbc1) noexcept
+    {
+        assert(pColor && pBC);
+
+        XMVECTOR clr[4];
+        DecodeBC1Palette(clr, pBC, isbc1);
+
+        uint32_t dw = pBC->bitmap;
+
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i, dw >>= 2)
+            pColor[i] = clr[dw & 3];
+    }
+
+    // Same palette as DecodeBC1, quantized to 8 bits once so the texels are plain lookups.
+    // The lookups stay scalar, DirectXMath has no portable gather or variable shuffle to
+    // expand the 2-bit indices, and a table lookup per texel is already cheaper than the
+    // float conversion it replaces.
+    inline void DecodeBC1RGBA8(
+        _Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor,
+        _In_ const D3DX_BC1 *pBC,
+        bool isbc1) noexcept
+    {
+        assert(pColor && pBC);
+
+        XMVECTOR clr[4];
+        DecodeBC1Palette(clr, pBC, isbc1);
+
+        uint32_t palette[4];
+        for (size_t i = 0; i < 4; ++i)
+            XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(&palette[i]), clr[i]);
 
         uint32_t dw = pBC->bitmap;
 
         for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i, dw >>= 2)
+            pColor[i] = palette[dw & 3];
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    inline void DecodeBC3AlphaPalette(
+        _Out_writes_(8) float *pAlpha,
+        _In_ const D3DX_BC3 *pBC) noexcept
+    {
+        assert(pAlpha && pBC);
+
+        pAlpha[0] = static_cast<float>(pBC->alpha[0]) * (1.0f / 255.0f);
+        pAlpha[1] = static_cast<float>(pBC->alpha[1]) * (1.0f / 255.0f);
+
+        if (pBC->alpha[0] > pBC->alpha[1])
         {
-            switch (dw & 3)
-            {
-            case 0: pColor[i] = clr0; break;
-            case 1: pColor[i] = clr1; break;
-            case 2: pColor[i] = clr2; break;
+            for (size_t i = 1; i < 7; ++i)
+                pAlpha[i + 1] = (pAlpha[0] * float(7u - i) + pAlpha[1] * float(i)) * (1.0f / 7.0f);
+        }
+        else
+        {
+            for (size_t i = 1; i < 5; ++i)
+                pAlpha[i + 1] = (pAlpha[0] * float(5u - i) + pAlpha[1] * float(i)) * (1.0f / 5.0f);
 
-            case 3:
-            default: pColor[i] = clr3; break;
-            }
+            pAlpha[6] = 0.0f;
+            pAlpha[7] = 1.0f;
         }
     }
 
 
     //-------------------------------------------------------------------------------------
-    void EncodeBC1(
-        _Out_ D3DX_BC1 *pBC,
+    // Quantize block to R56B5, using Floyd Stienberg error diffusion.  This
+    // increases the chance that colors will map directly to the quantized
+    // axis endpoints.
+    void QuantizeBC1(
+        _Out_writes_(NUM_PIXELS_PER_BLOCK) HDRColorA *Color,
         _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *pColor,
-        bool bColorKey,
-        float threshold,
         uint32_t flags) noexcept
     {
-        assert(pBC && pColor);
-        static_assert(sizeof(D3DX_BC1) == 8, "D3DX_BC1 should be 8 bytes");
+        HDRColorA Error[NUM_PIXELS_PER_BLOCK];
 
-        // Determine if we need to colorkey this block
-        uint32_t uSteps;
+        if (flags & BC_FLAGS_DITHER_RGB)
+            memset(Error, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(HDRColorA));
 
-        if (bColorKey)
-        {
-            size_t uColorKey = 0;
-
-            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-            {
-                if (pColor[i].a < threshold)
-                    uColorKey++;
-            }
-
-            if (NUM_PIXELS_PER_BLOCK == uColorKey)
-            {
-                pBC->rgb[0] = 0x0000;
-                pBC->rgb[1] = 0xffff;
-                pBC->bitmap = 0xffffffff;
-                return;
-            }
-
-            uSteps = (uColorKey > 0) ? 3u : 4u;
-        }
-        else
-        {
-            uSteps = 4u;
-        }
-
-        // Quantize block to R56B5, using Floyd Stienberg error diffusion.  This
-        // increases the chance that colors will map directly to the quantized
-        // axis endpoints.
-        HDRColorA Color[NUM_PIXELS_PER_BLOCK];
-        HDRColorA Error[NUM_PIXELS_PER_BLOCK];
-
-        if (flags & BC_FLAGS_DITHER_RGB)
-            memset(Error, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(HDRColorA));
-
-        size_t i;
-        for (i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
         {
             HDRColorA Clr;
             Clr.r = pColor[i].r;
@@ -481,37 +987,28 @@ namespace
                 }
             }
 
-            if (!(flags & BC_FLAGS_UNIFORM))
-            {
-                Color[i].r *= g_Luminance.r;
-                Color[i].g *= g_Luminance.g;
-                Color[i].b *= g_Luminance.b;
-            }
+            WeightColor(Color[i], flags);
         }
+    }
 
-        // Perform 6D root finding function to find two endpoints of color axis.
-        // Then quantize and sort the endpoints depending on mode.
-        HDRColorA ColorA, ColorB, ColorC, ColorD;
 
-        OptimizeRGB(&ColorA, &ColorB, Color, uSteps, flags);
+    //-------------------------------------------------------------------------------------
+    // Quantize and sort the endpoints found by OptimizeRGB, then pick the index of each pixel
+    void EncodeBC1Endpoints(
+        _Out_ D3DX_BC1 *pBC,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *pColor,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *Color,
+        HDRColorA ColorA,
+        HDRColorA ColorB,
+        uint32_t uSteps,
+        float threshold,
+        uint32_t flags) noexcept
+    {
+        HDRColorA ColorC = ColorA;
+        HDRColorA ColorD = ColorB;
 
-        if (flags & BC_FLAGS_UNIFORM)
-        {
-            ColorC = ColorA;
-            ColorD = ColorB;
-        }
-        else
-        {
-            ColorC.r = ColorA.r * g_LuminanceInv.r;
-            ColorC.g = ColorA.g * g_LuminanceInv.g;
-            ColorC.b = ColorA.b * g_LuminanceInv.b;
-            ColorC.a = ColorA.a;
-
-            ColorD.r = ColorB.r * g_LuminanceInv.r;
-            ColorD.g = ColorB.g * g_LuminanceInv.g;
-            ColorD.b = ColorB.b * g_LuminanceInv.b;
-            ColorD.a = ColorB.a;
-        }
+        UnweightColor(ColorC, flags);
+        UnweightColor(ColorD, flags);
 
         const uint16_t wColorA = Encode565(&ColorC);
         const uint16_t wColorB = Encode565(&ColorD);
@@ -527,21 +1024,11 @@ namespace
         Decode565(&ColorC, wColorA);
         Decode565(&ColorD, wColorB);
 
-        if (flags & BC_FLAGS_UNIFORM)
-        {
-            ColorA = ColorC;
-            ColorB = ColorD;
-        }
-        else
-        {
-            ColorA.r = ColorC.r * g_Luminance.r;
-            ColorA.g = ColorC.g * g_Luminance.g;
-            ColorA.b = ColorC.b * g_Luminance.b;
+        ColorA = ColorC;
+        ColorB = ColorD;
 
-            ColorB.r = ColorD.r * g_Luminance.r;
-            ColorB.g = ColorD.g * g_Luminance.g;
-            ColorB.b = ColorD.b * g_Luminance.b;
-        }
+        WeightColor(ColorA, flags);
+        WeightColor(ColorB, flags);
 
         // Calculate color steps
         HDRColorA Step[4];
@@ -597,10 +1084,11 @@ namespace
 
         // Encode colors
         uint32_t dw = 0;
+        HDRColorA Error[NUM_PIXELS_PER_BLOCK];
         if (flags & BC_FLAGS_DITHER_RGB)
             memset(Error, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(HDRColorA));
 
-        for (i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
         {
             if ((3 == uSteps) && (pColor[i].a < threshold))
             {
@@ -609,20 +1097,13 @@ namespace
             else
             {
                 HDRColorA Clr;
-                if (flags & BC_FLAGS_UNIFORM)
-                {
-                    Clr.r = pColor[i].r;
-                    Clr.g = pColor[i].g;
-                    Clr.b = pColor[i].b;
-                }
-                else
-                {
-                    Clr.r = pColor[i].r * g_Luminance.r;
-                    Clr.g = pColor[i].g * g_Luminance.g;
-                    Clr.b = pColor[i].b * g_Luminance.b;
-                }
+                Clr.r = pColor[i].r;
+                Clr.g = pColor[i].g;
+                Clr.b = pColor[i].b;
                 Clr.a = 1.0f;
 
+                WeightColor(Clr, flags);
+
                 if (flags & BC_FLAGS_DITHER_RGB)
                 {
                     Clr.r += Error[i].r;
@@ -684,6 +1165,103 @@ namespace
         pBC->bitmap = dw;
     }
 
+
+    //-------------------------------------------------------------------------------------
+    void EncodeBC1(
+        _Out_ D3DX_BC1 *pBC,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *pColor,
+        bool bColorKey,
+        float threshold,
+        uint32_t flags) noexcept
+    {
+        assert(pBC && pColor);
+        static_assert(sizeof(D3DX_BC1) == 8, "D3DX_BC1 should be 8 bytes");
+
+        // Determine if we need to colorkey this block
+        uint32_t uSteps;
+
+        if (bColorKey)
+        {
+            size_t uColorKey = 0;
+
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                if (pColor[i].a < threshold)
+                    uColorKey++;
+            }
+
+            if (NUM_PIXELS_PER_BLOCK == uColorKey)
+            {
+                pBC->rgb[0] = 0x0000;
+                pBC->rgb[1] = 0xffff;
+                pBC->bitmap = 0xffffffff;
+                return;
+            }
+
+            uSteps = (uColorKey > 0) ? 3u : 4u;
+        }
+        else
+        {
+            uSteps = 4u;
+        }
+
+        HDRColorA Color[NUM_PIXELS_PER_BLOCK];
+        QuantizeBC1(Color, pColor, flags);
+
+        // Perform 6D root finding function to find two endpoints of color axis.
+        // Then quantize and sort the endpoints depending on mode.
+        HDRColorA ColorA, ColorB;
+
+        OptimizeRGB(&ColorA, &ColorB, Color, uSteps, flags);
+
+        EncodeBC1Endpoints(pBC, pColor, Color, ColorA, ColorB, uSteps, threshold, flags);
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Encodes the color part of up to BC_ENCODE_BATCH_SIZE blocks that use the four color
+    // mode, sharing one OptimizeRGBBatch call between them.
+    void EncodeBC1Batch(
+        _Out_writes_(count) D3DX_BC1* const *pBC,
+        _In_reads_(count) const HDRColorA* const *pColor,
+        size_t count,
+        uint32_t flags) noexcept
+    {
+        assert(count <= BC_ENCODE_BATCH_SIZE);
+
+    #ifndef COLOR_WEIGHTS
+        // Error diffusion is serial within each block and the quick mode has no Newton's method
+        // iterations to share, those blocks take the single block path
+        if (!(flags & (BC_FLAGS_DITHER_RGB | BC_FLAGS_FORCE_BC7_MODE6)) && count > 1)
+        {
+            HDRColorA Color[BC_ENCODE_BATCH_SIZE][NUM_PIXELS_PER_BLOCK];
+            const HDRColorA* pPoints[BC_ENCODE_BATCH_SIZE];
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                QuantizeBC1(Color[i], pColor[i], flags);
+                pPoints[i] = Color[i];
+            }
+
+            HDRColorA ColorA[BC_ENCODE_BATCH_SIZE];
+            HDRColorA ColorB[BC_ENCODE_BATCH_SIZE];
+
+            OptimizeRGBBatch(ColorA, ColorB, pPoints, count, flags);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                EncodeBC1Endpoints(pBC[i], pColor[i], Color[i], ColorA[i], ColorB[i], 4u, 0.f, flags);
+            }
+            return;
+        }
+    #endif // !COLOR_WEIGHTS
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            EncodeBC1(pBC[i], pColor[i], false, 0.f, flags);
+        }
+    }
+
     //-------------------------------------------------------------------------------------
 #ifdef COLOR_WEIGHTS
     void EncodeSolidBC1(_Out_ D3DX_BC1 *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *pColor)
@@ -717,6 +1295,301 @@ namespace
         pBC->bitmap = 0x00000000;
     }
 #endif // COLOR_WEIGHTS
+
+    //-------------------------------------------------------------------------------------
+    void LoadBC1Colors(
+        _Out_writes_(NUM_PIXELS_PER_BLOCK) HDRColorA *Color,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor,
+        uint32_t flags) noexcept
+    {
+        if (flags & BC_FLAGS_DITHER_A)
+        {
+            float fError[NUM_PIXELS_PER_BLOCK] = {};
+
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                HDRColorA clr;
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&clr), pColor[i]);
+
+                const float fAlph = clr.a + fError[i];
+
+                Color[i].r = clr.r;
+                Color[i].g = clr.g;
+                Color[i].b = clr.b;
+                Color[i].a = static_cast<float>(static_cast<int32_t>(clr.a + fError[i] + 0.5f));
+
+                const float fDiff = fAlph - Color[i].a;
+
+                if (3 != (i & 3))
+                {
+                    assert(i < 15);
+                    _Analysis_assume_(i < 15);
+                    fError[i + 1] += fDiff * (7.0f / 16.0f);
+                }
+
+                if (i < 12)
+                {
+                    if (i & 3)
+                        fError[i + 3] += fDiff * (3.0f / 16.0f);
+
+                    fError[i + 4] += fDiff * (5.0f / 16.0f);
+
+                    if (3 != (i & 3))
+                    {
+                        assert(i < 11);
+                        _Analysis_assume_(i < 11);
+                        fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    void EncodeBC2Alpha(
+        _Inout_ D3DX_BC2 *pBC2,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *Color,
+        uint32_t flags) noexcept
+    {
+        // 4-bit alpha part.  Dithered using Floyd Stienberg error diffusion.
+        pBC2->bitmap[0] = 0;
+        pBC2->bitmap[1] = 0;
+
+        float fError[NUM_PIXELS_PER_BLOCK] = {};
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            float fAlph = Color[i].a;
+            if (flags & BC_FLAGS_DITHER_A)
+                fAlph += fError[i];
+
+            const auto u = static_cast<uint32_t>(fAlph * 15.0f + 0.5f);
+
+            pBC2->bitmap[i >> 3] >>= 4;
+            pBC2->bitmap[i >> 3] |= (u << 28);
+
+            if (flags & BC_FLAGS_DITHER_A)
+            {
+                const float fDiff = fAlph - float(u) * (1.0f / 15.0f);
+
+                if (3 != (i & 3))
+                {
+                    assert(i < 15);
+                    _Analysis_assume_(i < 15);
+                    fError[i + 1] += fDiff * (7.0f / 16.0f);
+                }
+
+                if (i < 12)
+                {
+                    if (i & 3)
+                        fError[i + 3] += fDiff * (3.0f / 16.0f);
+
+                    fError[i + 4] += fDiff * (5.0f / 16.0f);
+
+                    if (3 != (i & 3))
+                    {
+                        assert(i < 11);
+                        _Analysis_assume_(i < 11);
+                        fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    }
+                }
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    void EncodeBC3Alpha(
+        _Inout_ D3DX_BC3 *pBC3,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *Color,
+        uint32_t flags) noexcept
+    {
+        // Quantize block to A8, using Floyd Stienberg error diffusion.  This
+        // increases the chance that colors will map directly to the quantized
+        // axis endpoints.
+        float fAlpha[NUM_PIXELS_PER_BLOCK] = {};
+        float fError[NUM_PIXELS_PER_BLOCK] = {};
+
+        float fMinAlpha = Color[0].a;
+        float fMaxAlpha = Color[0].a;
+
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            float fAlph = Color[i].a;
+            if (flags & BC_FLAGS_DITHER_A)
+                fAlph += fError[i];
+
+            fAlpha[i] = static_cast<float>(static_cast<int32_t>(fAlph * 255.0f + 0.5f)) * (1.0f / 255.0f);
+
+            if (fAlpha[i] < fMinAlpha)
+                fMinAlpha = fAlpha[i];
+            else if (fAlpha[i] > fMaxAlpha)
+                fMaxAlpha = fAlpha[i];
+
+            if (flags & BC_FLAGS_DITHER_A)
+            {
+                const float fDiff = fAlph - fAlpha[i];
+
+                if (3 != (i & 3))
+                {
+                    assert(i < 15);
+                    _Analysis_assume_(i < 15);
+                    fError[i + 1] += fDiff * (7.0f / 16.0f);
+                }
+
+                if (i < 12)
+                {
+                    if (i & 3)
+                        fError[i + 3] += fDiff * (3.0f / 16.0f);
+
+                    fError[i + 4] += fDiff * (5.0f / 16.0f);
+
+                    if (3 != (i & 3))
+                    {
+                        assert(i < 11);
+                        _Analysis_assume_(i < 11);
+                        fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    }
+                }
+            }
+        }
+
+        // Alpha part
+        if (1.0f == fMinAlpha)
+        {
+            pBC3->alpha[0] = 0xff;
+            pBC3->alpha[1] = 0xff;
+            memset(pBC3->bitmap, 0x00, 6);
+            return;
+        }
+
+        if (!(flags & BC_FLAGS_DITHER_A))
+        {
+            // Without dithering every texel is matched on its own, so the shared BC4 encoder
+            // can pick the indices with exact integer palette arithmetic.  The BC4/BC5
+            // exhaustive search is left to those formats.
+            EncodeBC4U(reinterpret_cast<uint8_t*>(pBC3), fAlpha, flags & ~BC_FLAGS_BC45_EXHAUSTIVE);
+            return;
+        }
+
+        // Optimize and Quantize Min and Max values
+        const uint32_t uSteps = ((0.0f == fMinAlpha) || (1.0f == fMaxAlpha)) ? 6u : 8u;
+
+        float fAlphaA, fAlphaB;
+        OptimizeAlpha<false>(&fAlphaA, &fAlphaB, fAlpha, uSteps);
+
+        const auto bAlphaA = static_cast<uint8_t>(static_cast<int32_t>(fAlphaA * 255.0f + 0.5f));
+        const auto bAlphaB = static_cast<uint8_t>(static_cast<int32_t>(fAlphaB * 255.0f + 0.5f));
+
+        fAlphaA = static_cast<float>(bAlphaA) * (1.0f / 255.0f);
+        fAlphaB = static_cast<float>(bAlphaB) * (1.0f / 255.0f);
+
+        // Setup block
+        if ((8 == uSteps) && (bAlphaA == bAlphaB))
+        {
+            pBC3->alpha[0] = bAlphaA;
+            pBC3->alpha[1] = bAlphaB;
+            memset(pBC3->bitmap, 0x00, 6);
+            return;
+        }
+
+        static const size_t pSteps6[] = { 0, 2, 3, 4, 5, 1 };
+        static const size_t pSteps8[] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+
+        const size_t *pSteps;
+        float fStep[8] = {};
+
+        if (6 == uSteps)
+        {
+            pBC3->alpha[0] = bAlphaA;
+            pBC3->alpha[1] = bAlphaB;
+
+            fStep[0] = fAlphaA;
+            fStep[1] = fAlphaB;
+
+            for (size_t i = 1; i < 5; ++i)
+                fStep[i + 1] = (fStep[0] * float(5u - i) + fStep[1] * float(i)) * (1.0f / 5.0f);
+
+            fStep[6] = 0.0f;
+            fStep[7] = 1.0f;
+
+            pSteps = pSteps6;
+        }
+        else
+        {
+            pBC3->alpha[0] = bAlphaB;
+            pBC3->alpha[1] = bAlphaA;
+
+            fStep[0] = fAlphaB;
+            fStep[1] = fAlphaA;
+
+            for (size_t i = 1; i < 7; ++i)
+                fStep[i + 1] = (fStep[0] * float(7u - i) + fStep[1] * float(i)) * (1.0f / 7.0f);
+
+            pSteps = pSteps8;
+        }
+
+        // Encode alpha bitmap
+        const auto fSteps = static_cast<float>(uSteps - 1);
+        const float fScale = (fStep[0] != fStep[1]) ? (fSteps / (fStep[1] - fStep[0])) : 0.0f;
+
+        if (flags & BC_FLAGS_DITHER_A)
+            memset(fError, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(float));
+
+        for (size_t iSet = 0; iSet < 2; iSet++)
+        {
+            uint32_t dw = 0;
+
+            const size_t iMin = iSet * 8;
+            const size_t iLim = iMin + 8;
+
+            for (size_t i = iMin; i < iLim; ++i)
+            {
+                float fAlph = Color[i].a;
+                if (flags & BC_FLAGS_DITHER_A)
+                    fAlph += fError[i];
+                const float fDot = (fAlph - fStep[0]) * fScale;
+
+                uint32_t iStep;
+                if (fDot <= 0.0f)
+                    iStep = ((6 == uSteps) && (fAlph <= fStep[0] * 0.5f)) ? 6u : 0u;
+                else if (fDot >= fSteps)
+                    iStep = ((6 == uSteps) && (fAlph >= (fStep[1] + 1.0f) * 0.5f)) ? 7u : 1u;
+                else
+                    iStep = uint32_t(pSteps[uint32_t(fDot + 0.5f)]);
+
+                dw = (iStep << 21) | (dw >> 3);
+
+                if (flags & BC_FLAGS_DITHER_A)
+                {
+                    const float fDiff = (fAlph - fStep[iStep]);
+
+                    if (3 != (i & 3))
+                        fError[i + 1] += fDiff * (7.0f / 16.0f);
+
+                    if (i < 12)
+                    {
+                        if (i & 3)
+                            fError[i + 3] += fDiff * (3.0f / 16.0f);
+
+                        fError[i + 4] += fDiff * (5.0f / 16.0f);
+
+                        if (3 != (i & 3))
+                            fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    }
+                }
+            }
+
+            pBC3->bitmap[0 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[0];
+            pBC3->bitmap[1 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[1];
+            pBC3->bitmap[2 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[2];
+        }
+    }
 }
 
 
@@ -734,64 +1607,69 @@ void DirectX::D3DXDecodeBC1(XMVECTOR *pColor, const uint8_t *pBC) noexcept
     DecodeBC1(pColor, pBC1, true);
 }
 
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC1RGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
+{
+    auto pBC1 = reinterpret_cast<const D3DX_BC1 *>(pBC);
+    DecodeBC1RGBA8(pColor, pBC1, true);
+}
+
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC1(uint8_t *pBC, const XMVECTOR *pColor, float threshold, uint32_t flags) noexcept
 {
     assert(pBC && pColor);
 
     HDRColorA Color[NUM_PIXELS_PER_BLOCK];
+    LoadBC1Colors(Color, pColor, flags);
 
-    if (flags & BC_FLAGS_DITHER_A)
-    {
-        float fError[NUM_PIXELS_PER_BLOCK] = {};
+    auto pBC1 = reinterpret_cast<D3DX_BC1 *>(pBC);
+    EncodeBC1(pBC1, Color, true, threshold, flags);
+}
 
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-        {
-            HDRColorA clr;
-            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&clr), pColor[i]);
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC1Batch(uint8_t *pBC, const XMVECTOR *pColor, size_t count, float threshold, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+    assert(count <= BC_ENCODE_BATCH_SIZE);
 
-            const float fAlph = clr.a + fError[i];
+    HDRColorA Color[BC_ENCODE_BATCH_SIZE][NUM_PIXELS_PER_BLOCK];
+    D3DX_BC1* pBatchBC[BC_ENCODE_BATCH_SIZE];
+    const HDRColorA* pBatchColor[BC_ENCODE_BATCH_SIZE];
+    size_t batchCount = 0;
 
-            Color[i].r = clr.r;
-            Color[i].g = clr.g;
-            Color[i].b = clr.b;
-            Color[i].a = static_cast<float>(static_cast<int32_t>(clr.a + fError[i] + 0.5f));
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto pBC1 = reinterpret_cast<D3DX_BC1 *>(pBC + i * sizeof(D3DX_BC1));
 
-            const float fDiff = fAlph - Color[i].a;
+        LoadBC1Colors(Color[i], pColor + i * NUM_PIXELS_PER_BLOCK, flags);
 
-            if (3 != (i & 3))
+        bool colorKey = false;
+        for (size_t j = 0; j < NUM_PIXELS_PER_BLOCK; ++j)
+        {
+            if (Color[i][j].a < threshold)
             {
-                assert(i < 15);
-                _Analysis_assume_(i < 15);
-                fError[i + 1] += fDiff * (7.0f / 16.0f);
+                colorKey = true;
+                break;
             }
+        }
 
-            if (i < 12)
-            {
-                if (i & 3)
-                    fError[i + 3] += fDiff * (3.0f / 16.0f);
-
-                fError[i + 4] += fDiff * (5.0f / 16.0f);
-
-                if (3 != (i & 3))
-                {
-                    assert(i < 11);
-                    _Analysis_assume_(i < 11);
-                    fError[i + 5] += fDiff * (1.0f / 16.0f);
-                }
-            }
+        // Blocks with transparent pixels use the three color mode, those are encoded on their own
+        if (colorKey)
+        {
+            EncodeBC1(pBC1, Color[i], true, threshold, flags);
         }
-    }
-    else
-    {
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        else
         {
-            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
+            pBatchBC[batchCount] = pBC1;
+            pBatchColor[batchCount] = Color[i];
+            ++batchCount;
         }
     }
 
-    auto pBC1 = reinterpret_cast<D3DX_BC1 *>(pBC);
-    EncodeBC1(pBC1, Color, true, threshold, flags);
+    if (batchCount > 0)
+    {
+        EncodeBC1Batch(pBatchBC, pBatchColor, batchCount, flags);
+    }
 }
 
 
@@ -824,6 +1702,24 @@ void DirectX::D3DXDecodeBC2(XMVECTOR *pColor, const uint8_t *pBC) noexcept
         pColor[i] = XMVectorSetW(pColor[i], static_cast<float>(dw & 0xf) * (1.0f / 15.0f));
 }
 
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC2RGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(D3DX_BC2) == 16, "D3DX_BC2 should be 16 bytes");
+
+    auto pBC2 = reinterpret_cast<const D3DX_BC2 *>(pBC);
+
+    // RGB part
+    DecodeBC1RGBA8(pColor, &pBC2->bc1, false);
+
+    // 4-bit alpha part, n / 15 in 8 bits is exactly n * 17
+    uint64_t qw = uint64_t(pBC2->bitmap[0]) | (uint64_t(pBC2->bitmap[1]) << 32);
+
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i, qw >>= 4)
+        pColor[i] = (pColor[i] & 0x00ffffff) | (uint32_t(qw & 0xf) * 17u) << 24;
+}
+
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC2(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
@@ -838,60 +1734,55 @@ void DirectX::D3DXEncodeBC2(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags
 
     auto pBC2 = reinterpret_cast<D3DX_BC2 *>(pBC);
 
-    // 4-bit alpha part.  Dithered using Floyd Stienberg error diffusion.
-    pBC2->bitmap[0] = 0;
-    pBC2->bitmap[1] = 0;
+    EncodeBC2Alpha(pBC2, Color, flags);
 
-    float fError[NUM_PIXELS_PER_BLOCK] = {};
-    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+    // RGB part
+#ifdef COLOR_WEIGHTS
+    if (!pBC2->bitmap[0] && !pBC2->bitmap[1])
     {
-        float fAlph = Color[i].a;
-        if (flags & BC_FLAGS_DITHER_A)
-            fAlph += fError[i];
-
-        const auto u = static_cast<uint32_t>(fAlph * 15.0f + 0.5f);
+        EncodeSolidBC1(&pBC2->bc1, Color);
+        return;
+    }
+#endif // COLOR_WEIGHTS
 
-        pBC2->bitmap[i >> 3] >>= 4;
-        pBC2->bitmap[i >> 3] |= (u << 28);
+    EncodeBC1(&pBC2->bc1, Color, false, 0.f, flags);
+}
 
-        if (flags & BC_FLAGS_DITHER_A)
-        {
-            const float fDiff = fAlph - float(u) * (1.0f / 15.0f);
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC2Batch(uint8_t *pBC, const XMVECTOR *pColor, size_t count, float threshold, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+    assert(count <= BC_ENCODE_BATCH_SIZE);
 
-            if (3 != (i & 3))
-            {
-                assert(i < 15);
-                _Analysis_assume_(i < 15);
-                fError[i + 1] += fDiff * (7.0f / 16.0f);
-            }
+    UNREFERENCED_PARAMETER(threshold);
 
-            if (i < 12)
-            {
-                if (i & 3)
-                    fError[i + 3] += fDiff * (3.0f / 16.0f);
+#ifdef COLOR_WEIGHTS
+    for (size_t i = 0; i < count; ++i)
+    {
+        D3DXEncodeBC2(pBC + i * sizeof(D3DX_BC2), pColor + i * NUM_PIXELS_PER_BLOCK, flags);
+    }
+#else
+    HDRColorA Color[BC_ENCODE_BATCH_SIZE][NUM_PIXELS_PER_BLOCK];
+    D3DX_BC1* pBatchBC[BC_ENCODE_BATCH_SIZE];
+    const HDRColorA* pBatchColor[BC_ENCODE_BATCH_SIZE];
 
-                fError[i + 4] += fDiff * (5.0f / 16.0f);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto pBC2 = reinterpret_cast<D3DX_BC2 *>(pBC + i * sizeof(D3DX_BC2));
 
-                if (3 != (i & 3))
-                {
-                    assert(i < 11);
-                    _Analysis_assume_(i < 11);
-                    fError[i + 5] += fDiff * (1.0f / 16.0f);
-                }
-            }
+        for (size_t j = 0; j < NUM_PIXELS_PER_BLOCK; ++j)
+        {
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i][j]), pColor[i * NUM_PIXELS_PER_BLOCK + j]);
         }
-    }
 
-    // RGB part
-#ifdef COLOR_WEIGHTS
-    if (!pBC2->bitmap[0] && !pBC2->bitmap[1])
-    {
-        EncodeSolidBC1(pBC2->dxt1, Color);
-        return;
+        EncodeBC2Alpha(pBC2, Color[i], flags);
+
+        pBatchBC[i] = &pBC2->bc1;
+        pBatchColor[i] = Color[i];
     }
-#endif // COLOR_WEIGHTS
 
-    EncodeBC1(&pBC2->bc1, Color, false, 0.f, flags);
+    EncodeBC1Batch(pBatchBC, pBatchColor, count, flags);
+#endif // COLOR_WEIGHTS
 }
 
 
@@ -911,23 +1802,7 @@ void DirectX::D3DXDecodeBC3(XMVECTOR *pColor, const uint8_t *pBC) noexcept
 
     // Adaptive 3-bit alpha part
     float fAlpha[8];
-
-    fAlpha[0] = static_cast<float>(pBC3->alpha[0]) * (1.0f / 255.0f);
-    fAlpha[1] = static_cast<float>(pBC3->alpha[1]) * (1.0f / 255.0f);
-
-    if (pBC3->alpha[0] > pBC3->alpha[1])
-    {
-        for (size_t i = 1; i < 7; ++i)
-            fAlpha[i + 1] = (fAlpha[0] * float(7u - i) + fAlpha[1] * float(i)) * (1.0f / 7.0f);
-    }
-    else
-    {
-        for (size_t i = 1; i < 5; ++i)
-            fAlpha[i + 1] = (fAlpha[0] * float(5u - i) + fAlpha[1] * float(i)) * (1.0f / 5.0f);
-
-        fAlpha[6] = 0.0f;
-        fAlpha[7] = 1.0f;
-    }
+    DecodeBC3AlphaPalette(fAlpha, pBC3);
 
     uint32_t dw = uint32_t(pBC3->bitmap[0]) | uint32_t(pBC3->bitmap[1] << 8) | uint32_t(pBC3->bitmap[2] << 16);
 
@@ -941,201 +1816,94 @@ void DirectX::D3DXDecodeBC3(XMVECTOR *pColor, const uint8_t *pBC) noexcept
 }
 
 _Use_decl_annotations_
-void DirectX::D3DXEncodeBC3(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+void DirectX::D3DXDecodeBC3RGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
 {
-    assert(pBC && pColor);
+    assert(pColor && pBC);
     static_assert(sizeof(D3DX_BC3) == 16, "D3DX_BC3 should be 16 bytes");
 
-    HDRColorA Color[NUM_PIXELS_PER_BLOCK];
-    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-    {
-        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
-    }
-
-    auto pBC3 = reinterpret_cast<D3DX_BC3 *>(pBC);
-
-    // Quantize block to A8, using Floyd Stienberg error diffusion.  This
-    // increases the chance that colors will map directly to the quantized
-    // axis endpoints.
-    float fAlpha[NUM_PIXELS_PER_BLOCK] = {};
-    float fError[NUM_PIXELS_PER_BLOCK] = {};
-
-    float fMinAlpha = Color[0].a;
-    float fMaxAlpha = Color[0].a;
-
-    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-    {
-        float fAlph = Color[i].a;
-        if (flags & BC_FLAGS_DITHER_A)
-            fAlph += fError[i];
-
-        fAlpha[i] = static_cast<float>(static_cast<int32_t>(fAlph * 255.0f + 0.5f)) * (1.0f / 255.0f);
+    auto pBC3 = reinterpret_cast<const D3DX_BC3 *>(pBC);
 
-        if (fAlpha[i] < fMinAlpha)
-            fMinAlpha = fAlpha[i];
-        else if (fAlpha[i] > fMaxAlpha)
-            fMaxAlpha = fAlpha[i];
+    // RGB part
+    DecodeBC1RGBA8(pColor, &pBC3->bc1, false);
 
-        if (flags & BC_FLAGS_DITHER_A)
-        {
-            const float fDiff = fAlph - fAlpha[i];
+    // Adaptive 3-bit alpha part
+    XM_ALIGNED_DATA(16) float fAlpha[8];
+    DecodeBC3AlphaPalette(fAlpha, pBC3);
 
-            if (3 != (i & 3))
-            {
-                assert(i < 15);
-                _Analysis_assume_(i < 15);
-                fError[i + 1] += fDiff * (7.0f / 16.0f);
-            }
+    uint8_t alpha[8];
+    XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(&alpha[0]), XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(&fAlpha[0])));
+    XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(&alpha[4]), XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(&fAlpha[4])));
 
-            if (i < 12)
-            {
-                if (i & 3)
-                    fError[i + 3] += fDiff * (3.0f / 16.0f);
+    uint64_t qw = 0;
+    for (size_t i = 0; i < 6; ++i)
+        qw |= uint64_t(pBC3->bitmap[i]) << (8 * i);
 
-                fError[i + 4] += fDiff * (5.0f / 16.0f);
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i, qw >>= 3)
+        pColor[i] = (pColor[i] & 0x00ffffff) | (uint32_t(alpha[qw & 0x7]) << 24);
+}
 
-                if (3 != (i & 3))
-                {
-                    assert(i < 11);
-                    _Analysis_assume_(i < 11);
-                    fError[i + 5] += fDiff * (1.0f / 16.0f);
-                }
-            }
-        }
-    }
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC3(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+    static_assert(sizeof(D3DX_BC3) == 16, "D3DX_BC3 should be 16 bytes");
 
-#ifdef COLOR_WEIGHTS
-    if (0.0f == fMaxAlpha)
+    HDRColorA Color[NUM_PIXELS_PER_BLOCK];
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
     {
-        EncodeSolidBC1(&pBC3->dxt1, Color);
-        pBC3->alpha[0] = 0x00;
-        pBC3->alpha[1] = 0x00;
-        memset(pBC3->bitmap, 0x00, 6);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
     }
-#endif
 
-    // RGB part
-    EncodeBC1(&pBC3->bc1, Color, false, 0.f, flags);
+    auto pBC3 = reinterpret_cast<D3DX_BC3 *>(pBC);
 
     // Alpha part
-    if (1.0f == fMinAlpha)
-    {
-        pBC3->alpha[0] = 0xff;
-        pBC3->alpha[1] = 0xff;
-        memset(pBC3->bitmap, 0x00, 6);
-        return;
-    }
-
-    // Optimize and Quantize Min and Max values
-    const uint32_t uSteps = ((0.0f == fMinAlpha) || (1.0f == fMaxAlpha)) ? 6u : 8u;
-
-    float fAlphaA, fAlphaB;
-    OptimizeAlpha<false>(&fAlphaA, &fAlphaB, fAlpha, uSteps);
-
-    const auto bAlphaA = static_cast<uint8_t>(static_cast<int32_t>(fAlphaA * 255.0f + 0.5f));
-    const auto bAlphaB = static_cast<uint8_t>(static_cast<int32_t>(fAlphaB * 255.0f + 0.5f));
-
-    fAlphaA = static_cast<float>(bAlphaA) * (1.0f / 255.0f);
-    fAlphaB = static_cast<float>(bAlphaB) * (1.0f / 255.0f);
+    EncodeBC3Alpha(pBC3, Color, flags);
 
-    // Setup block
-    if ((8 == uSteps) && (bAlphaA == bAlphaB))
+    // RGB part
+#ifdef COLOR_WEIGHTS
+    if (!pBC3->alpha[0] && !pBC3->alpha[1])
     {
-        pBC3->alpha[0] = bAlphaA;
-        pBC3->alpha[1] = bAlphaB;
-        memset(pBC3->bitmap, 0x00, 6);
+        EncodeSolidBC1(&pBC3->bc1, Color);
         return;
     }
+#endif // COLOR_WEIGHTS
 
-    static const size_t pSteps6[] = { 0, 2, 3, 4, 5, 1 };
-    static const size_t pSteps8[] = { 0, 2, 3, 4, 5, 6, 7, 1 };
-
-    const size_t *pSteps;
-    float fStep[8] = {};
-
-    if (6 == uSteps)
-    {
-        pBC3->alpha[0] = bAlphaA;
-        pBC3->alpha[1] = bAlphaB;
-
-        fStep[0] = fAlphaA;
-        fStep[1] = fAlphaB;
+    EncodeBC1(&pBC3->bc1, Color, false, 0.f, flags);
+}
 
-        for (size_t i = 1; i < 5; ++i)
-            fStep[i + 1] = (fStep[0] * float(5u - i) + fStep[1] * float(i)) * (1.0f / 5.0f);
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC3Batch(uint8_t *pBC, const XMVECTOR *pColor, size_t count, float threshold, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+    assert(count <= BC_ENCODE_BATCH_SIZE);
 
-        fStep[6] = 0.0f;
-        fStep[7] = 1.0f;
+    UNREFERENCED_PARAMETER(threshold);
 
-        pSteps = pSteps6;
-    }
-    else
+#ifdef COLOR_WEIGHTS
+    for (size_t i = 0; i < count; ++i)
     {
-        pBC3->alpha[0] = bAlphaB;
-        pBC3->alpha[1] = bAlphaA;
-
-        fStep[0] = fAlphaB;
-        fStep[1] = fAlphaA;
-
-        for (size_t i = 1; i < 7; ++i)
-            fStep[i + 1] = (fStep[0] * float(7u - i) + fStep[1] * float(i)) * (1.0f / 7.0f);
-
-        pSteps = pSteps8;
+        D3DXEncodeBC3(pBC + i * sizeof(D3DX_BC3), pColor + i * NUM_PIXELS_PER_BLOCK, flags);
     }
+#else
+    HDRColorA Color[BC_ENCODE_BATCH_SIZE][NUM_PIXELS_PER_BLOCK];
+    D3DX_BC1* pBatchBC[BC_ENCODE_BATCH_SIZE];
+    const HDRColorA* pBatchColor[BC_ENCODE_BATCH_SIZE];
 
-    // Encode alpha bitmap
-    const auto fSteps = static_cast<float>(uSteps - 1);
-    const float fScale = (fStep[0] != fStep[1]) ? (fSteps / (fStep[1] - fStep[0])) : 0.0f;
-
-    if (flags & BC_FLAGS_DITHER_A)
-        memset(fError, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(float));
-
-    for (size_t iSet = 0; iSet < 2; iSet++)
+    for (size_t i = 0; i < count; ++i)
     {
-        uint32_t dw = 0;
+        auto pBC3 = reinterpret_cast<D3DX_BC3 *>(pBC + i * sizeof(D3DX_BC3));
 
-        const size_t iMin = iSet * 8;
-        const size_t iLim = iMin + 8;
-
-        for (size_t i = iMin; i < iLim; ++i)
+        for (size_t j = 0; j < NUM_PIXELS_PER_BLOCK; ++j)
         {
-            float fAlph = Color[i].a;
-            if (flags & BC_FLAGS_DITHER_A)
-                fAlph += fError[i];
-            const float fDot = (fAlph - fStep[0]) * fScale;
-
-            uint32_t iStep;
-            if (fDot <= 0.0f)
-                iStep = ((6 == uSteps) && (fAlph <= fStep[0] * 0.5f)) ? 6u : 0u;
-            else if (fDot >= fSteps)
-                iStep = ((6 == uSteps) && (fAlph >= (fStep[1] + 1.0f) * 0.5f)) ? 7u : 1u;
-            else
-                iStep = uint32_t(pSteps[uint32_t(fDot + 0.5f)]);
-
-            dw = (iStep << 21) | (dw >> 3);
-
-            if (flags & BC_FLAGS_DITHER_A)
-            {
-                const float fDiff = (fAlph - fStep[iStep]);
-
-                if (3 != (i & 3))
-                    fError[i + 1] += fDiff * (7.0f / 16.0f);
-
-                if (i < 12)
-                {
-                    if (i & 3)
-                        fError[i + 3] += fDiff * (3.0f / 16.0f);
-
-                    fError[i + 4] += fDiff * (5.0f / 16.0f);
-
-                    if (3 != (i & 3))
-                        fError[i + 5] += fDiff * (1.0f / 16.0f);
-                }
-            }
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i][j]), pColor[i * NUM_PIXELS_PER_BLOCK + j]);
         }
 
-        pBC3->bitmap[0 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[0];
-        pBC3->bitmap[1 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[1];
-        pBC3->bitmap[2 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[2];
+        EncodeBC3Alpha(pBC3, Color[i], flags);
+
+        pBatchBC[i] = &pBC3->bc1;
+        pBatchColor[i] = Color[i];
     }
+
+    EncodeBC1Batch(pBatchBC, pBatchColor, count, flags);
+#endif // COLOR_WEIGHTS
 }
@@ -42,9 +42,19 @@ namespace DirectX
 
         BC_FLAGS_USE_3SUBSETS = 0x80000,
         // By default, BC7 skips mode 0 & 2; this flag adds those modes back
+        // BC6H/BC7 also start Newton's method from a principal axis fit instead of the bounding box diagonal
 
         BC_FLAGS_FORCE_BC7_MODE6 = 0x100000,
         // BC7 should only use mode 6; skip other modes
+        // BC6H only tries modes 10, 11 and 14
+        // BC1-3, BC6H and BC7 fit the color endpoints in closed form, skipping Newton's method
+
+        BC_FLAGS_BC45_EXHAUSTIVE = 0x200000,
+        // BC4/BC5 search every endpoint pair near the block min/max instead of refining a least-squares fit
+
+        BC_FLAGS_YCOCG_METRIC = 0x400000,
+        // BC1-3 and BC7 measure color error in YCoCg space with chroma weighted below luma
+        // BC7 also scales the color error of each pixel by its alpha
     };
 
     //-------------------------------------------------------------------------------------
@@ -329,11 +339,47 @@ namespace DirectX
     void D3DXDecodeBC6HS(_Out_writes_(NUM_PIXELS_PER_BLOCK) XMVECTOR *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
     void D3DXDecodeBC7(_Out_writes_(NUM_PIXELS_PER_BLOCK) XMVECTOR *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
 
+    typedef void (*BC_DECODE_RGBA8)(uint32_t *pColor, const uint8_t *pBC);
+
+    void D3DXDecodeBC1RGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(8) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC2RGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC3RGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC4URGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(8) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC4SRGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(8) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC5URGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC5SRGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
+        // Palettes are quantized once per block, the result matches the XMVECTOR decoders converted to R8G8B8A8_UNORM
+
+    void D3DXDecodeBC7RGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
+        // Decodes straight to R8G8B8A8 texels with integer math, the result matches D3DXDecodeBC7 converted to 8 bits
+
+    constexpr size_t BC_DECODE_BATCH_SIZE = 4;
+        // Maximum number of horizontally adjacent blocks passed to a BC_DECODE_F16_BATCH function
+
+    typedef void (*BC_DECODE_F16_BATCH)(PackedVector::XMHALF4 *pColor, const uint8_t *pBC, size_t count);
+
+    void D3DXDecodeBC6HUF16(_Out_writes_(NUM_PIXELS_PER_BLOCK) PackedVector::XMHALF4 *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC6HSF16(_Out_writes_(NUM_PIXELS_PER_BLOCK) PackedVector::XMHALF4 *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC6HUF16Batch(_Out_writes_(count * NUM_PIXELS_PER_BLOCK) PackedVector::XMHALF4 *pColor, _In_reads_(count * 16) const uint8_t *pBC, _In_ size_t count) noexcept;
+    void D3DXDecodeBC6HSF16Batch(_Out_writes_(count * NUM_PIXELS_PER_BLOCK) PackedVector::XMHALF4 *pColor, _In_reads_(count * 16) const uint8_t *pBC, _In_ size_t count) noexcept;
+        // Decodes straight to R16G16B16A16_FLOAT texels, the result matches D3DXDecodeBC6HU/S converted to half
+
     void D3DXEncodeBC1(_Out_writes_(8) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ float threshold, _In_ uint32_t flags) noexcept;
         // BC1 requires one additional parameter, so it doesn't match signature of BC_ENCODE above
 
     void D3DXEncodeBC2(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
     void D3DXEncodeBC3(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
+    constexpr size_t BC_ENCODE_BATCH_SIZE = 4;
+        // Maximum number of horizontally adjacent blocks passed to a BC_ENCODE_BATCH function
+
+    typedef void (*BC_ENCODE_BATCH)(uint8_t *pBC, const XMVECTOR *pColor, size_t count, float threshold, uint32_t flags);
+
+    void D3DXEncodeBC1Batch(_Out_writes_(count * 8) uint8_t *pBC, _In_reads_(count * NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ size_t count, _In_ float threshold, _In_ uint32_t flags) noexcept;
+    void D3DXEncodeBC2Batch(_Out_writes_(count * 16) uint8_t *pBC, _In_reads_(count * NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ size_t count, _In_ float threshold, _In_ uint32_t flags) noexcept;
+    void D3DXEncodeBC3Batch(_Out_writes_(count * 16) uint8_t *pBC, _In_reads_(count * NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ size_t count, _In_ float threshold, _In_ uint32_t flags) noexcept;
+        // Encodes count consecutive blocks, the color endpoint search runs on all of them at once
+        // The threshold is only used by BC1
+
     void D3DXEncodeBC4U(_Out_writes_(8) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
     void D3DXEncodeBC4S(_Out_writes_(8) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
     void D3DXEncodeBC5U(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
@@ -342,4 +388,21 @@ namespace DirectX
     void D3DXEncodeBC6HS(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
     void D3DXEncodeBC7(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
 
+    typedef float (*BC_ENCODE_TARGET)(uint8_t *pBC, const XMVECTOR *pColor, float targetError, uint32_t flags);
+
+    float D3DXEncodeBC6HU(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ float targetError, _In_ uint32_t flags) noexcept;
+    float D3DXEncodeBC6HS(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ float targetError, _In_ uint32_t flags) noexcept;
+    float D3DXEncodeBC7(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ float targetError, _In_ uint32_t flags) noexcept;
+        // The mode search stops as soon as a block is within targetError, the mean squared error per channel
+        // with channels normalized to [0,1] (BC6H uses the largest finite half value), 0 searches every mode
+        // Returns the error of the encoded block on the same scale, as measured by the encoder's metric
+
+    void D3DXGetBC6HBlockInfo(_In_reads_(16) const uint8_t *pBC, _Out_ uint8_t& mode, _Out_ uint8_t& partition) noexcept;
+    void D3DXGetBC7BlockInfo(_In_reads_(16) const uint8_t *pBC, _Out_ uint8_t& mode, _Out_ uint8_t& partition, _Out_ uint8_t& rotation) noexcept;
+        // Reads the mode (BC6H 1-14, BC7 0-7, 0xFF if reserved) and partition of an encoded block from its header bits
+
+    void EncodeBC4U(_Out_writes_(8) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const float *pValues, _In_ uint32_t flags) noexcept;
+        // Encodes one channel of UNORM values, also used for the BC3 alpha block which shares the BC4U layout
+        // Index selection compares against the exact integer palette, so 8-bit values are matched exactly
+
 } // namespace
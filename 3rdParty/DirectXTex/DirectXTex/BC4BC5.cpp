@@ -14,6 +14,7 @@
 #include "BC.h"
 
 using namespace DirectX;
+using namespace DirectX::PackedVector;
 
 //------------------------------------------------------------------------------------
 // Constants
@@ -179,13 +180,230 @@ namespace
     }
 
 
+    //------------------------------------------------------------------------------
+    // Endpoint candidate search
+    //------------------------------------------------------------------------------
+
+    // Search radius around each endpoint estimate used by BC_FLAGS_BC45_EXHAUSTIVE
+    constexpr int BC4_SEARCH_RADIUS = 1;
+
+    // Palettes are kept scaled by 35, this turns both the /7 and the /5 interpolation into
+    // whole numbers so that the palette of any pair of endpoint codes is exact
+    constexpr float BC4_PALETTE_SCALE = 35.0f;
+
+    // Builds the scaled palettes of four endpoint pairs, one pair per lane, from integer endpoint codes
+    void XM_CALLCONV BuildPaletteBC4(
+        FXMVECTOR e0,
+        FXMVECTOR e1,
+        float minValue,
+        float maxValue,
+        _Out_writes_(8) XMVECTOR* palette) noexcept
+    {
+        // red_0 > red_1 selects six interpolated values, otherwise four plus the range extremes
+        const XMVECTOR interp6 = XMVectorGreater(e0, e1);
+
+        palette[0] = XMVectorScale(e0, BC4_PALETTE_SCALE);
+        palette[1] = XMVectorScale(e1, BC4_PALETTE_SCALE);
+
+        for (size_t i = 1; i < 7; ++i)
+        {
+            const XMVECTOR p8 = XMVectorScale(XMVectorAdd(XMVectorScale(e0, float(7u - i)), XMVectorScale(e1, float(i))), BC4_PALETTE_SCALE / 7.0f);
+
+            XMVECTOR p6;
+            if (i < 5)
+                p6 = XMVectorScale(XMVectorAdd(XMVectorScale(e0, float(5u - i)), XMVectorScale(e1, float(i))), BC4_PALETTE_SCALE / 5.0f);
+            else
+                p6 = XMVectorReplicate(((i == 5) ? minValue : maxValue) * BC4_PALETTE_SCALE);
+
+            palette[i + 1] = XMVectorSelect(p6, p8, interp6);
+        }
+    }
+
+    // Evaluates up to four endpoint pairs at a time, one pair per lane, and keeps the
+    // pair with the lowest squared error.  Ties keep the pair that was added first.
+    class BC4EndpointSearch
+    {
+    public:
+        BC4EndpointSearch(
+            _In_reads_(BLOCK_SIZE) const float theTexels[],
+            float minValue,
+            float maxValue) noexcept :
+            m_texels{},
+            m_minValue(minValue),
+            m_maxValue(maxValue),
+            m_pending0{},
+            m_pending1{},
+            m_pendingCount(0),
+            m_best0(0),
+            m_best1(0),
+            m_bestError(FLT_MAX)
+        {
+            // Work in the integer domain of the endpoint codes
+            const float scale = std::max(fabsf(minValue), maxValue);
+
+            for (size_t i = 0; i < BLOCK_SIZE; ++i)
+            {
+                const float t = isnan(theTexels[i]) ? 0.f : theTexels[i] * scale;
+                m_texels[i] = std::min(maxValue, std::max(minValue, t));
+            }
+        }
+
+        BC4EndpointSearch(const BC4EndpointSearch&) = delete;
+        BC4EndpointSearch& operator=(const BC4EndpointSearch&) = delete;
+
+        float GetTexel(size_t index) const noexcept { return m_texels[index]; }
+
+        void Add(int endpoint0, int endpoint1) noexcept
+        {
+            m_pending0[m_pendingCount] = static_cast<float>(Clamp(endpoint0));
+            m_pending1[m_pendingCount] = static_cast<float>(Clamp(endpoint1));
+
+            if (++m_pendingCount == 4)
+                Evaluate();
+        }
+
+        void Finish(_Out_ int& endpoint0, _Out_ int& endpoint1) noexcept
+        {
+            if (m_pendingCount > 0)
+                Evaluate();
+
+            endpoint0 = m_best0;
+            endpoint1 = m_best1;
+        }
+
+        int Clamp(int value) const noexcept
+        {
+            return std::min(static_cast<int>(m_maxValue), std::max(static_cast<int>(m_minValue), value));
+        }
+
+    private:
+        void Evaluate() noexcept
+        {
+            // Unused lanes repeat the first pair
+            for (size_t i = m_pendingCount; i < 4; ++i)
+            {
+                m_pending0[i] = m_pending0[0];
+                m_pending1[i] = m_pending1[0];
+            }
+
+            XMVECTOR palette[8];
+            BuildPaletteBC4(
+                XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(m_pending0)),
+                XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(m_pending1)),
+                m_minValue,
+                m_maxValue,
+                palette);
+
+            XMVECTOR error = XMVectorZero();
+
+            for (size_t i = 0; i < BLOCK_SIZE; ++i)
+            {
+                const XMVECTOR t = XMVectorReplicate(m_texels[i] * BC4_PALETTE_SCALE);
+
+                XMVECTOR delta = XMVectorAbs(XMVectorSubtract(palette[0], t));
+                for (size_t j = 1; j < 8; ++j)
+                {
+                    delta = XMVectorMin(delta, XMVectorAbs(XMVectorSubtract(palette[j], t)));
+                }
+
+                error = XMVectorMultiplyAdd(delta, delta, error);
+            }
+
+            float errors[4];
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(errors), error);
+
+            for (size_t i = 0; i < m_pendingCount; ++i)
+            {
+                if (errors[i] < m_bestError)
+                {
+                    m_bestError = errors[i];
+                    m_best0 = static_cast<int>(m_pending0[i]);
+                    m_best1 = static_cast<int>(m_pending1[i]);
+                }
+            }
+
+            m_pendingCount = 0;
+        }
+
+        float m_texels[BLOCK_SIZE];
+        float m_minValue;
+        float m_maxValue;
+        float m_pending0[4];
+        float m_pending1[4];
+        size_t m_pendingCount;
+        int m_best0;
+        int m_best1;
+        float m_bestError;
+    };
+
+    // Tries every endpoint pair within BC4_SEARCH_RADIUS codes of (q0, q1)
+    void AddNeighbourCandidates(BC4EndpointSearch& search, int q0, int q1) noexcept
+    {
+        for (int d0 = -BC4_SEARCH_RADIUS; d0 <= BC4_SEARCH_RADIUS; ++d0)
+        {
+            for (int d1 = -BC4_SEARCH_RADIUS; d1 <= BC4_SEARCH_RADIUS; ++d1)
+            {
+                search.Add(q0 + d0, q1 + d1);
+            }
+        }
+    }
+
+    // Quantizing the optimized endpoints can move them away from the optimum, so the
+    // neighbouring code of each endpoint is tried as well.  The exhaustive search tries
+    // every code within BC4_SEARCH_RADIUS of the optimized endpoints.
+    void AddRoundingCandidates(
+        BC4EndpointSearch& search,
+        float f0,
+        int q0,
+        float f1,
+        int q1,
+        bool bExhaustive) noexcept
+    {
+        if (bExhaustive)
+        {
+            AddNeighbourCandidates(search, q0, q1);
+            return;
+        }
+
+        const int alt0 = search.Clamp((f0 >= float(q0)) ? q0 + 1 : q0 - 1);
+        const int alt1 = search.Clamp((f1 >= float(q1)) ? q1 + 1 : q1 - 1);
+
+        search.Add(q0, q1);
+        search.Add(alt0, q1);
+        search.Add(q0, alt1);
+        search.Add(alt0, alt1);
+    }
+
+    // Tries the pairs near the block min/max in both codecs, these keep the exact
+    // extremes that the least-squares fit tends to pull inwards.
+    void AddMinMaxCandidates(BC4EndpointSearch& search) noexcept
+    {
+        float fBlockMin = search.GetTexel(0);
+        float fBlockMax = search.GetTexel(0);
+        for (size_t i = 1; i < BLOCK_SIZE; ++i)
+        {
+            fBlockMin = std::min(fBlockMin, search.GetTexel(i));
+            fBlockMax = std::max(fBlockMax, search.GetTexel(i));
+        }
+
+        const int lo = static_cast<int>(floorf(fBlockMin + 0.5f));
+        const int hi = static_cast<int>(floorf(fBlockMax + 0.5f));
+
+        AddNeighbourCandidates(search, hi, lo);
+
+        if (lo != hi)
+            AddNeighbourCandidates(search, lo, hi);
+    }
+
+
     //------------------------------------------------------------------------------
     void FindEndPointsBC4U(
         _In_reads_(BLOCK_SIZE) const float theTexelsU[],
         _Out_ uint8_t &endpointU_0,
-        _Out_ uint8_t &endpointU_1) noexcept
+        _Out_ uint8_t &endpointU_1,
+        uint32_t flags) noexcept
     {
-        // The boundary of codec for signed/unsigned format
+        //  The boundary of codec for signed/unsigned format
         constexpr float MIN_NORM = 0.f;
         constexpr float MAX_NORM = 1.f;
 
@@ -208,37 +426,51 @@ namespace
         //  the exact code of the boundary values.
         const bool bUsing4BlockCodec = (MIN_NORM == fBlockMin || MAX_NORM == fBlockMax);
 
+        // The exhaustive search tries both codecs around the optimized endpoints and the block min/max
+        const bool bExhaustive = (flags & BC_FLAGS_BC45_EXHAUSTIVE) != 0;
+
+        BC4EndpointSearch search(theTexelsU, 0.f, 255.f);
+
         // Using Optimize
         float fStart, fEnd;
 
-        if (!bUsing4BlockCodec)
+        if (!bUsing4BlockCodec || bExhaustive)
         {
             // 6 interpolated color values
             OptimizeAlpha<false>(&fStart, &fEnd, theTexelsU, 8);
 
             auto iStart = static_cast<uint8_t>(fStart * 255.0f);
             auto iEnd = static_cast<uint8_t>(fEnd * 255.0f);
-
-            endpointU_0 = iEnd;
-            endpointU_1 = iStart;
+            AddRoundingCandidates(search, fEnd * 255.0f, iEnd, fStart * 255.0f, iStart, bExhaustive);
         }
-        else
+
+        if (bUsing4BlockCodec || bExhaustive)
         {
             // 4 interpolated color values
             OptimizeAlpha<false>(&fStart, &fEnd, theTexelsU, 6);
 
             auto iStart = static_cast<uint8_t>(fStart * 255.0f);
             auto iEnd = static_cast<uint8_t>(fEnd * 255.0f);
+            AddRoundingCandidates(search, fStart * 255.0f, iStart, fEnd * 255.0f, iEnd, bExhaustive);
+        }
 
-            endpointU_1 = iEnd;
-            endpointU_0 = iStart;
+        if (bExhaustive)
+        {
+            AddMinMaxCandidates(search);
         }
+
+        int iEndpoint0, iEndpoint1;
+        search.Finish(iEndpoint0, iEndpoint1);
+
+        endpointU_0 = static_cast<uint8_t>(iEndpoint0);
+        endpointU_1 = static_cast<uint8_t>(iEndpoint1);
     }
 
     void FindEndPointsBC4S(
         _In_reads_(BLOCK_SIZE) const float theTexelsU[],
         _Out_ int8_t &endpointU_0,
-        _Out_ int8_t &endpointU_1) noexcept
+        _Out_ int8_t &endpointU_1,
+        uint32_t flags) noexcept
     {
         //  The boundary of codec for signed/unsigned format
         constexpr float MIN_NORM = -1.f;
@@ -263,10 +495,15 @@ namespace
         //  the exact code of the boundary values.
         const bool bUsing4BlockCodec = (MIN_NORM == fBlockMin || MAX_NORM == fBlockMax);
 
+        // The exhaustive search tries both codecs around the optimized endpoints and the block min/max
+        const bool bExhaustive = (flags & BC_FLAGS_BC45_EXHAUSTIVE) != 0;
+
+        BC4EndpointSearch search(theTexelsU, -127.f, 127.f);
+
         // Using Optimize
         float fStart, fEnd;
 
-        if (!bUsing4BlockCodec)
+        if (!bUsing4BlockCodec || bExhaustive)
         {
             // 6 interpolated color values
             OptimizeAlpha<true>(&fStart, &fEnd, theTexelsU, 8);
@@ -274,11 +511,10 @@ namespace
             int8_t iStart, iEnd;
             FloatToSNorm(fStart, &iStart);
             FloatToSNorm(fEnd, &iEnd);
-
-            endpointU_0 = iEnd;
-            endpointU_1 = iStart;
+            AddRoundingCandidates(search, fEnd * 127.0f, iEnd, fStart * 127.0f, iStart, bExhaustive);
         }
-        else
+
+        if (bUsing4BlockCodec || bExhaustive)
         {
             // 4 interpolated color values
             OptimizeAlpha<true>(&fStart, &fEnd, theTexelsU, 6);
@@ -286,95 +522,148 @@ namespace
             int8_t iStart, iEnd;
             FloatToSNorm(fStart, &iStart);
             FloatToSNorm(fEnd, &iEnd);
+            AddRoundingCandidates(search, fStart * 127.0f, iStart, fEnd * 127.0f, iEnd, bExhaustive);
+        }
 
-            endpointU_1 = iEnd;
-            endpointU_0 = iStart;
+        if (bExhaustive)
+        {
+            AddMinMaxCandidates(search);
         }
+
+        int iEndpoint0, iEndpoint1;
+        search.Finish(iEndpoint0, iEndpoint1);
+
+        endpointU_0 = static_cast<int8_t>(iEndpoint0);
+        endpointU_1 = static_cast<int8_t>(iEndpoint1);
     }
 
 
     //------------------------------------------------------------------------------
-    inline void FindEndPointsBC5U(
-        _In_reads_(BLOCK_SIZE) const float theTexelsU[],
-        _In_reads_(BLOCK_SIZE) const float theTexelsV[],
-        _Out_ uint8_t &endpointU_0,
-        _Out_ uint8_t &endpointU_1,
-        _Out_ uint8_t &endpointV_0,
-        _Out_ uint8_t &endpointV_1) noexcept
+    // Picks the nearest palette entry for four texels at a time.  The texels are compared
+    // against the scaled integer palette, so 8-bit input selects exactly the entry that
+    // decodes closest to it.
+    template<class BC4>
+    void FindClosest(
+        _Inout_ BC4* pBC,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const float theTexelsU[],
+        float minValue,
+        float maxValue) noexcept
     {
-        //Encoding the U and V channel by BC4 codec separately.
-        FindEndPointsBC4U(theTexelsU, endpointU_0, endpointU_1);
-        FindEndPointsBC4U(theTexelsV, endpointV_0, endpointV_1);
-    }
+        const float scale = std::max(fabsf(minValue), maxValue);
 
-    inline void FindEndPointsBC5S(
-        _In_reads_(BLOCK_SIZE) const float theTexelsU[],
-        _In_reads_(BLOCK_SIZE) const float theTexelsV[],
-        _Out_ int8_t &endpointU_0,
-        _Out_ int8_t &endpointU_1,
-        _Out_ int8_t &endpointV_0,
-        _Out_ int8_t &endpointV_1) noexcept
-    {
-        //Encoding the U and V channel by BC4 codec separately.
-        FindEndPointsBC4S(theTexelsU, endpointU_0, endpointU_1);
-        FindEndPointsBC4S(theTexelsV, endpointV_0, endpointV_1);
-    }
+        XMVECTOR palette[8];
+        BuildPaletteBC4(
+            XMVectorReplicate(std::max(minValue, float(pBC->red_0))),
+            XMVectorReplicate(std::max(minValue, float(pBC->red_1))),
+            minValue,
+            maxValue,
+            palette);
 
+        const XMVECTOR vMin = XMVectorReplicate(minValue);
+        const XMVECTOR vMax = XMVectorReplicate(maxValue);
 
-    //------------------------------------------------------------------------------
-    void FindClosestUNORM(
-        _Inout_ BC4_UNORM* pBC,
-        _In_reads_(NUM_PIXELS_PER_BLOCK) const float theTexelsU[]) noexcept
-    {
-        float rGradient[8];
-        for (size_t i = 0; i < 8; ++i)
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; i += 4)
         {
-            rGradient[i] = pBC->DecodeFromIndex(i);
-        }
+            XMVECTOR texels = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&theTexelsU[i]));
+            texels = XMVectorSelect(texels, XMVectorZero(), XMVectorIsNaN(texels));
+            texels = XMVectorClamp(XMVectorScale(texels, scale), vMin, vMax);
+            texels = XMVectorScale(texels, BC4_PALETTE_SCALE);
 
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-        {
-            size_t uBestIndex = 0;
-            float fBestDelta = 100000;
-            for (size_t uIndex = 0; uIndex < 8; uIndex++)
+            XMVECTOR bestDelta = XMVectorAbs(XMVectorSubtract(palette[0], texels));
+            XMVECTOR bestIndex = XMVectorZero();
+
+            for (size_t uIndex = 1; uIndex < 8; uIndex++)
             {
-                const float fCurrentDelta = fabsf(rGradient[uIndex] - theTexelsU[i]);
-                if (fCurrentDelta < fBestDelta)
-                {
-                    uBestIndex = uIndex;
-                    fBestDelta = fCurrentDelta;
-                }
+                const XMVECTOR delta = XMVectorAbs(XMVectorSubtract(palette[uIndex], texels));
+                const XMVECTOR closer = XMVectorLess(delta, bestDelta);
+
+                bestDelta = XMVectorSelect(bestDelta, delta, closer);
+                bestIndex = XMVectorSelect(bestIndex, XMVectorReplicate(float(uIndex)), closer);
             }
-            pBC->SetIndex(i, uBestIndex);
-        }
-    }
 
-    void FindClosestSNORM(
-        _Inout_ BC4_SNORM* pBC,
-        _In_reads_(NUM_PIXELS_PER_BLOCK) const float theTexelsU[]) noexcept
-    {
-        float rGradient[8];
-        for (size_t i = 0; i < 8; ++i)
-        {
-            rGradient[i] = pBC->DecodeFromIndex(i);
-        }
+            float indices[4];
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(indices), bestIndex);
 
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-        {
-            size_t uBestIndex = 0;
-            float fBestDelta = 100000;
-            for (size_t uIndex = 0; uIndex < 8; uIndex++)
+            for (size_t j = 0; j < 4; ++j)
             {
-                const float fCurrentDelta = fabsf(rGradient[uIndex] - theTexelsU[i]);
-                if (fCurrentDelta < fBestDelta)
-                {
-                    uBestIndex = uIndex;
-                    fBestDelta = fCurrentDelta;
-                }
+                pBC->SetIndex(i + j, static_cast<size_t>(indices[j]));
             }
-            pBC->SetIndex(i, uBestIndex);
         }
     }
+
+    //------------------------------------------------------------------------------
+    void EncodeBC4S(
+        _Out_writes_(8) uint8_t *pBC,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const float theTexelsU[],
+        uint32_t flags) noexcept
+    {
+        memset(pBC, 0, sizeof(BC4_SNORM));
+        auto pBC4 = reinterpret_cast<BC4_SNORM*>(pBC);
+
+        FindEndPointsBC4S(theTexelsU, pBC4->red_0, pBC4->red_1, flags);
+        FindClosest(pBC4, theTexelsU, -127.f, 127.f);
+    }
+
+    //------------------------------------------------------------------------------
+    // 8-bit palettes for the RGBA8 decoders, rounded exactly like a R8G8B8A8_UNORM
+    // store of the float decoder output (SNORM is first remapped to [0,1])
+    void DecodeRGBA8Palette(
+        _Out_writes_(8) uint8_t *pPalette,
+        _In_ const BC4_UNORM *pBC) noexcept
+    {
+        const XMVECTOR v0 = XMVectorSet(pBC->DecodeFromIndex(0), pBC->DecodeFromIndex(1), pBC->DecodeFromIndex(2), pBC->DecodeFromIndex(3));
+        const XMVECTOR v1 = XMVectorSet(pBC->DecodeFromIndex(4), pBC->DecodeFromIndex(5), pBC->DecodeFromIndex(6), pBC->DecodeFromIndex(7));
+
+        XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(&pPalette[0]), v0);
+        XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(&pPalette[4]), v1);
+    }
+
+    void DecodeRGBA8Palette(
+        _Out_writes_(8) uint8_t *pPalette,
+        _In_ const BC4_SNORM *pBC) noexcept
+    {
+        XMVECTOR v0 = XMVectorSet(pBC->DecodeFromIndex(0), pBC->DecodeFromIndex(1), pBC->DecodeFromIndex(2), pBC->DecodeFromIndex(3));
+        XMVECTOR v1 = XMVectorSet(pBC->DecodeFromIndex(4), pBC->DecodeFromIndex(5), pBC->DecodeFromIndex(6), pBC->DecodeFromIndex(7));
+
+        v0 = XMVectorMultiplyAdd(v0, g_XMOneHalf, g_XMOneHalf);
+        v1 = XMVectorMultiplyAdd(v1, g_XMOneHalf, g_XMOneHalf);
+
+        XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(&pPalette[0]), v0);
+        XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(&pPalette[4]), v1);
+    }
+
+    // Expands a BC4 channel into one byte lane of the R8G8B8A8 texels
+    template <class BC4>
+    void DecodeRGBA8Channel(
+        _Inout_updates_all_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor,
+        _In_ const BC4 *pBC,
+        uint32_t multiplier) noexcept
+    {
+        uint8_t palette[8];
+        DecodeRGBA8Palette(palette, pBC);
+
+        uint64_t qw = pBC->data >> 16;
+
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i, qw >>= 3)
+            pColor[i] |= uint32_t(palette[qw & 0x7]) * multiplier;
+    }
+}
+
+
+//=====================================================================================
+// Shared with the BC3 alpha block, which uses the BC4U layout
+//=====================================================================================
+_Use_decl_annotations_
+void DirectX::EncodeBC4U(uint8_t *pBC, const float *pValues, uint32_t flags) noexcept
+{
+    assert(pBC && pValues);
+    static_assert(sizeof(BC4_UNORM) == 8, "BC4_UNORM should be 8 bytes");
+
+    memset(pBC, 0, sizeof(BC4_UNORM));
+    auto pBC4 = reinterpret_cast<BC4_UNORM*>(pBC);
+
+    FindEndPointsBC4U(pValues, pBC4->red_0, pBC4->red_1, flags);
+    FindClosest(pBC4, pValues, 0.f, 255.f);
 }
 
 
@@ -416,15 +705,36 @@ void DirectX::D3DXDecodeBC4S(XMVECTOR *pColor, const uint8_t *pBC) noexcept
 }
 
 _Use_decl_annotations_
-void DirectX::D3DXEncodeBC4U(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+void DirectX::D3DXDecodeBC4URGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(BC4_UNORM) == 8, "BC4_UNORM should be 8 bytes");
+
+    // Red is replicated to green and blue, as when converting R to RGB
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        pColor[i] = 0xff000000;
+
+    DecodeRGBA8Channel(pColor, reinterpret_cast<const BC4_UNORM*>(pBC), 0x010101);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC4SRGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
 {
-    UNREFERENCED_PARAMETER(flags);
+    assert(pColor && pBC);
+    static_assert(sizeof(BC4_SNORM) == 8, "BC4_SNORM should be 8 bytes");
+
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        pColor[i] = 0xff000000;
 
+    DecodeRGBA8Channel(pColor, reinterpret_cast<const BC4_SNORM*>(pBC), 0x010101);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC4U(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
     assert(pBC && pColor);
     static_assert(sizeof(BC4_UNORM) == 8, "BC4_UNORM should be 8 bytes");
 
-    memset(pBC, 0, sizeof(BC4_UNORM));
-    auto pBC4 = reinterpret_cast<BC4_UNORM*>(pBC);
     float theTexelsU[NUM_PIXELS_PER_BLOCK];
 
     for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
@@ -432,20 +742,15 @@ void DirectX::D3DXEncodeBC4U(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flag
         theTexelsU[i] = XMVectorGetX(pColor[i]);
     }
 
-    FindEndPointsBC4U(theTexelsU, pBC4->red_0, pBC4->red_1);
-    FindClosestUNORM(pBC4, theTexelsU);
+    EncodeBC4U(pBC, theTexelsU, flags);
 }
 
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC4S(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
-    UNREFERENCED_PARAMETER(flags);
-
     assert(pBC && pColor);
     static_assert(sizeof(BC4_SNORM) == 8, "BC4_SNORM should be 8 bytes");
 
-    memset(pBC, 0, sizeof(BC4_UNORM));
-    auto pBC4 = reinterpret_cast<BC4_SNORM*>(pBC);
     float theTexelsU[NUM_PIXELS_PER_BLOCK];
 
     for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
@@ -453,8 +758,7 @@ void DirectX::D3DXEncodeBC4S(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flag
         theTexelsU[i] = XMVectorGetX(pColor[i]);
     }
 
-    FindEndPointsBC4S(theTexelsU, pBC4->red_0, pBC4->red_1);
-    FindClosestSNORM(pBC4, theTexelsU);
+    EncodeBC4S(pBC, theTexelsU, flags);
 }
 
 
@@ -494,16 +798,38 @@ void DirectX::D3DXDecodeBC5S(XMVECTOR *pColor, const uint8_t *pBC) noexcept
 }
 
 _Use_decl_annotations_
-void DirectX::D3DXEncodeBC5U(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+void DirectX::D3DXDecodeBC5URGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
 {
-    UNREFERENCED_PARAMETER(flags);
+    assert(pColor && pBC);
+    static_assert(sizeof(BC4_UNORM) == 8, "BC4_UNORM should be 8 bytes");
 
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        pColor[i] = 0xff000000;
+
+    DecodeRGBA8Channel(pColor, reinterpret_cast<const BC4_UNORM*>(pBC), 0x01);
+    DecodeRGBA8Channel(pColor, reinterpret_cast<const BC4_UNORM*>(pBC + sizeof(BC4_UNORM)), 0x0100);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC5SRGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(BC4_SNORM) == 8, "BC4_SNORM should be 8 bytes");
+
+    // Blue is 0 remapped to 0.5, which rounds to 128
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        pColor[i] = 0xff800000;
+
+    DecodeRGBA8Channel(pColor, reinterpret_cast<const BC4_SNORM*>(pBC), 0x01);
+    DecodeRGBA8Channel(pColor, reinterpret_cast<const BC4_SNORM*>(pBC + sizeof(BC4_SNORM)), 0x0100);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC5U(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
     assert(pBC && pColor);
     static_assert(sizeof(BC4_UNORM) == 8, "BC4_UNORM should be 8 bytes");
 
-    memset(pBC, 0, sizeof(BC4_UNORM) * 2);
-    auto pBCR = reinterpret_cast<BC4_UNORM*>(pBC);
-    auto pBCG = reinterpret_cast<BC4_UNORM*>(pBC + sizeof(BC4_UNORM));
     float theTexelsU[NUM_PIXELS_PER_BLOCK];
     float theTexelsV[NUM_PIXELS_PER_BLOCK];
 
@@ -515,29 +841,17 @@ void DirectX::D3DXEncodeBC5U(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flag
         theTexelsV[i] = clr.y;
     }
 
-    FindEndPointsBC5U(
-        theTexelsU,
-        theTexelsV,
-        pBCR->red_0,
-        pBCR->red_1,
-        pBCG->red_0,
-        pBCG->red_1);
-
-    FindClosestUNORM(pBCR, theTexelsU);
-    FindClosestUNORM(pBCG, theTexelsV);
+    //Encoding the U and V channel by BC4 codec separately.
+    EncodeBC4U(pBC, theTexelsU, flags);
+    EncodeBC4U(pBC + sizeof(BC4_UNORM), theTexelsV, flags);
 }
 
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC5S(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
-    UNREFERENCED_PARAMETER(flags);
-
     assert(pBC && pColor);
     static_assert(sizeof(BC4_SNORM) == 8, "BC4_SNORM should be 8 bytes");
 
-    memset(pBC, 0, sizeof(BC4_UNORM) * 2);
-    auto pBCR = reinterpret_cast<BC4_SNORM*>(pBC);
-    auto pBCG = reinterpret_cast<BC4_SNORM*>(pBC + sizeof(BC4_SNORM));
     float theTexelsU[NUM_PIXELS_PER_BLOCK];
     float theTexelsV[NUM_PIXELS_PER_BLOCK];
 
@@ -549,14 +863,7 @@ void DirectX::D3DXEncodeBC5S(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flag
         theTexelsV[i] = clr.y;
     }
 
-    FindEndPointsBC5S(
-        theTexelsU,
-        theTexelsV,
-        pBCR->red_0,
-        pBCR->red_1,
-        pBCG->red_0,
-        pBCG->red_1);
-
-    FindClosestSNORM(pBCR, theTexelsU);
-    FindClosestSNORM(pBCG, theTexelsV);
+    //Encoding the U and V channel by BC4 codec separately.
+    EncodeBC4S(pBC, theTexelsU, flags);
+    EncodeBC4S(pBC + sizeof(BC4_SNORM), theTexelsV, flags);
 }
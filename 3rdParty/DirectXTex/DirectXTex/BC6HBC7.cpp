@@ -37,6 +37,7 @@ namespace
     constexpr uint16_t F16S_MASK = 0x8000;   // f16 sign mask
     constexpr uint16_t F16EM_MASK = 0x7fff;   // f16 exp & mantissa mask
     constexpr uint16_t F16MAX = 0x7bff;   // MAXFLT bit pattern for XMHALF
+    constexpr uint16_t F16ONE = 0x3c00;   // 1.0 bit pattern for XMHALF
 
     constexpr size_t BC6H_NUM_CHANNELS = 3;
     constexpr size_t BC6H_MAX_SHAPES = 32;
@@ -55,7 +56,7 @@ namespace
     constexpr float pD4[] = { 0.0f / 3.0f, 1.0f / 3.0f, 2.0f / 3.0f, 3.0f / 3.0f };
 
     // Partition, Shape, Pixel (index into 4x4 block)
-    const uint8_t g_aPartitionTable[3][64][16] =
+    constexpr uint8_t g_aPartitionTable[3][64][16] =
     {
         {   // 1 Region case has no subsets (all 0)
             { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
@@ -327,6 +328,90 @@ namespace
     const int g_aWeights2[] = { 0, 21, 43, 64 };
     const int g_aWeights3[] = { 0, 9, 18, 27, 37, 46, 55, 64 };
     const int g_aWeights4[] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Subset masks, texel lists and counts of every shape, derived from g_aPartitionTable
+    struct PartitionSubsets
+    {
+        uint16_t uMask[BC7_MAX_REGIONS];                            // Bit i is set when texel i is in the subset
+        uint8_t uCount[BC7_MAX_REGIONS];
+        uint8_t aIndex[BC7_MAX_REGIONS][NUM_PIXELS_PER_BLOCK];     // Texels of the subset in block order
+    };
+
+    struct PartitionSubsetTable
+    {
+        PartitionSubsets aShapes[3][64];
+    };
+
+    constexpr PartitionSubsetTable BuildPartitionSubsets() noexcept
+    {
+        PartitionSubsetTable table = {};
+
+        for (size_t uPartitions = 0; uPartitions < 3; ++uPartitions)
+        {
+            for (size_t uShape = 0; uShape < 64; ++uShape)
+            {
+                PartitionSubsets& subsets = table.aShapes[uPartitions][uShape];
+
+                for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+                {
+                    const size_t p = g_aPartitionTable[uPartitions][uShape][i];
+                    subsets.uMask[p] = static_cast<uint16_t>(subsets.uMask[p] | (1u << i));
+                    subsets.aIndex[p][subsets.uCount[p]] = static_cast<uint8_t>(i);
+                    subsets.uCount[p]++;
+                }
+            }
+        }
+
+        return table;
+    }
+
+    constexpr PartitionSubsetTable g_PartitionSubsets = BuildPartitionSubsets();
+
+    // Lane masks for each combination of four texels
+    const XMVECTORU32 g_aLaneMasks[16] =
+    {
+        { { { 0, 0, 0, 0 } } },
+        { { { 0xFFFFFFFF, 0, 0, 0 } } },
+        { { { 0, 0xFFFFFFFF, 0, 0 } } },
+        { { { 0xFFFFFFFF, 0xFFFFFFFF, 0, 0 } } },
+        { { { 0, 0, 0xFFFFFFFF, 0 } } },
+        { { { 0xFFFFFFFF, 0, 0xFFFFFFFF, 0 } } },
+        { { { 0, 0xFFFFFFFF, 0xFFFFFFFF, 0 } } },
+        { { { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0 } } },
+        { { { 0, 0, 0, 0xFFFFFFFF } } },
+        { { { 0xFFFFFFFF, 0, 0, 0xFFFFFFFF } } },
+        { { { 0, 0xFFFFFFFF, 0, 0xFFFFFFFF } } },
+        { { { 0xFFFFFFFF, 0xFFFFFFFF, 0, 0xFFFFFFFF } } },
+        { { { 0, 0, 0xFFFFFFFF, 0xFFFFFFFF } } },
+        { { { 0xFFFFFFFF, 0, 0xFFFFFFFF, 0xFFFFFFFF } } },
+        { { { 0, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF } } },
+        { { { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF } } },
+    };
+
+    // YCoCg error metric for BC7 palettes.  The metric terms 4Y, 2Co, 4Cg and A are integer
+    // combinations of the channel differences, so they are exact in float lanes, and the
+    // error is their weighted sum of squares.  Rotated modes move a color channel into the
+    // alpha slot, so each rotation has its own terms per block channel.
+    struct LDRErrorMetric
+    {
+        XMVECTORF32 vTerms[4];  // Metric terms of a unit difference in each block channel
+        size_t uAlphaChannel;   // Block channel holding the source alpha
+    };
+
+    // 3 Y^2 + Co^2 + 1.5 Cg^2 + A^2, luma counts as much as under the uniform metric
+    const XMVECTORF32 g_YCoCgMetricWeights = { { { 6.0f / 32.0f, 8.0f / 32.0f, 3.0f / 32.0f, 1.0f } } };
+
+    const LDRErrorMetric g_aYCoCgMetric[4] =
+    {
+        // No rotation
+        { { { { { 1.f, 1.f, -1.f, 0.f } } }, { { { 2.f, 0.f, 2.f, 0.f } } }, { { { 1.f, -1.f, -1.f, 0.f } } }, { { { 0.f, 0.f, 0.f, 1.f } } } }, 3 },
+        // Red and alpha swapped
+        { { { { { 0.f, 0.f, 0.f, 1.f } } }, { { { 2.f, 0.f, 2.f, 0.f } } }, { { { 1.f, -1.f, -1.f, 0.f } } }, { { { 1.f, 1.f, -1.f, 0.f } } } }, 0 },
+        // Green and alpha swapped
+        { { { { { 1.f, 1.f, -1.f, 0.f } } }, { { { 0.f, 0.f, 0.f, 1.f } } }, { { { 1.f, -1.f, -1.f, 0.f } } }, { { { 2.f, 0.f, 2.f, 0.f } } } }, 1 },
+        // Blue and alpha swapped
+        { { { { { 1.f, 1.f, -1.f, 0.f } } }, { { { 2.f, 0.f, 2.f, 0.f } } }, { { { 0.f, 0.f, 0.f, 1.f } } }, { { { 1.f, -1.f, -1.f, 0.f } } } }, 2 },
+    };
 }
 
 namespace DirectX
@@ -584,6 +669,162 @@ namespace
         INTColor B;
     };
 
+    // Moments of one subset of a block
+    struct SubsetMoments
+    {
+        float fCount;
+        HDRColorA Mean;
+        HDRColorA Min;
+        HDRColorA Max;
+        float fCovariance[4][4];    // Sums over the subset, not divided by the count
+    };
+
+    // The texels of a block and their pairwise products in structure-of-arrays form, four
+    // texels per vector.  The moments of any subset then reduce to masked sums over the
+    // block, so every shape reuses the same per-texel data.
+    class BlockMoments
+    {
+    public:
+        explicit BlockMoments(_In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* pPoints) noexcept
+        {
+            // Center the texels on the block mean, this keeps the products of HDR values small
+            HDRColorA sum(0.0f, 0.0f, 0.0f, 0.0f);
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                sum += pPoints[i];
+            }
+
+            m_offset = sum * (1.0f / float(NUM_PIXELS_PER_BLOCK));
+
+            for (size_t q = 0; q < c_NumQuads; ++q)
+            {
+                const HDRColorA* pQuad = &pPoints[q * 4];
+                m_value[0][q] = XMVectorSet(pQuad[0].r, pQuad[1].r, pQuad[2].r, pQuad[3].r);
+                m_value[1][q] = XMVectorSet(pQuad[0].g, pQuad[1].g, pQuad[2].g, pQuad[3].g);
+                m_value[2][q] = XMVectorSet(pQuad[0].b, pQuad[1].b, pQuad[2].b, pQuad[3].b);
+                m_value[3][q] = XMVectorSet(pQuad[0].a, pQuad[1].a, pQuad[2].a, pQuad[3].a);
+
+                m_value[0][q] = XMVectorSubtract(m_value[0][q], XMVectorReplicate(m_offset.r));
+                m_value[1][q] = XMVectorSubtract(m_value[1][q], XMVectorReplicate(m_offset.g));
+                m_value[2][q] = XMVectorSubtract(m_value[2][q], XMVectorReplicate(m_offset.b));
+                m_value[3][q] = XMVectorSubtract(m_value[3][q], XMVectorReplicate(m_offset.a));
+
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    for (size_t d = c; d < 4; ++d)
+                    {
+                        m_product[ProductIndex(c, d)][q] = XMVectorMultiply(m_value[c][q], m_value[d][q]);
+                    }
+                }
+            }
+        }
+
+        void GetSubset(uint16_t uMask, size_t uCount, _Out_ SubsetMoments& subset) const noexcept
+        {
+            assert(uCount > 0);
+
+            XMVECTOR laneMask[c_NumQuads];
+            for (size_t q = 0; q < c_NumQuads; ++q)
+            {
+                laneMask[q] = g_aLaneMasks[(uMask >> (q * 4)) & 0xF];
+            }
+
+            const XMVECTOR vFltMax = XMVectorReplicate(FLT_MAX);
+            const XMVECTOR vNegFltMax = XMVectorReplicate(-FLT_MAX);
+
+            float fSum[4], fMin[4], fMax[4];
+            for (size_t c = 0; c < 4; ++c)
+            {
+                XMVECTOR vSum = XMVectorZero();
+                XMVECTOR vMin = vFltMax;
+                XMVECTOR vMax = vNegFltMax;
+
+                for (size_t q = 0; q < c_NumQuads; ++q)
+                {
+                    vSum = XMVectorAdd(vSum, XMVectorSelect(XMVectorZero(), m_value[c][q], laneMask[q]));
+                    vMin = XMVectorMin(vMin, XMVectorSelect(vFltMax, m_value[c][q], laneMask[q]));
+                    vMax = XMVectorMax(vMax, XMVectorSelect(vNegFltMax, m_value[c][q], laneMask[q]));
+                }
+
+                float lanes[4];
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes), vSum);
+                fSum[c] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes), vMin);
+                fMin[c] = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes), vMax);
+                fMax[c] = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+            }
+
+            const float fCount = float(uCount);
+            const float fInvCount = 1.0f / fCount;
+
+            for (size_t c = 0; c < 4; ++c)
+            {
+                for (size_t d = c; d < 4; ++d)
+                {
+                    XMVECTOR vSum = XMVectorZero();
+                    for (size_t q = 0; q < c_NumQuads; ++q)
+                    {
+                        vSum = XMVectorAdd(vSum, XMVectorSelect(XMVectorZero(), m_product[ProductIndex(c, d)][q], laneMask[q]));
+                    }
+
+                    float lanes[4];
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(lanes), vSum);
+                    const float fProduct = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+
+                    subset.fCovariance[c][d] = subset.fCovariance[d][c] = fProduct - fSum[c] * fSum[d] * fInvCount;
+                }
+            }
+
+            subset.fCount = fCount;
+            subset.Mean = HDRColorA(fSum[0] * fInvCount, fSum[1] * fInvCount, fSum[2] * fInvCount, fSum[3] * fInvCount) + m_offset;
+            subset.Min = HDRColorA(fMin[0], fMin[1], fMin[2], fMin[3]) + m_offset;
+            subset.Max = HDRColorA(fMax[0], fMax[1], fMax[2], fMax[3]) + m_offset;
+        }
+
+    private:
+        static constexpr size_t c_NumQuads = NUM_PIXELS_PER_BLOCK / 4;
+        static constexpr size_t c_NumProducts = 10;
+
+        static constexpr size_t ProductIndex(size_t c, size_t d) noexcept
+        {
+            // rr, rg, rb, ra, gg, gb, ga, bb, ba, aa
+            return c * 4 - (c * (c + 1)) / 2 + d;
+        }
+
+        HDRColorA m_offset;
+        XMVECTOR m_value[4][c_NumQuads];
+        XMVECTOR m_product[c_NumProducts][c_NumQuads];
+    };
+
+    // How OptimizeRGB and OptimizeRGBA fit the endpoints of a subset
+    enum class EndPointFit
+    {
+        Principal,          // Extent of the subset along its principal axis
+        Newton,             // Newton's method starting from the best bounding box diagonal
+        PrincipalNewton,    // Newton's method starting from the refit principal axis endpoints
+    };
+
+    inline EndPointFit GetEndPointFit(uint32_t flags) noexcept
+    {
+        if (flags & BC_FLAGS_FORCE_BC7_MODE6)
+            return EndPointFit::Principal;
+
+        if (flags & BC_FLAGS_USE_3SUBSETS)
+            return EndPointFit::PrincipalNewton;
+
+        return EndPointFit::Newton;
+    }
+
+    // BC6H palette stored as structure-of-arrays, four palette entries per vector
+    struct BC6HPalette
+    {
+        XMVECTOR r[BC6H_MAX_INDICES / 4];
+        XMVECTOR g[BC6H_MAX_INDICES / 4];
+        XMVECTOR b[BC6H_MAX_INDICES / 4];
+        size_t uVectors;
+    };
+
     template< size_t SizeInBytes >
     class CBits
     {
@@ -667,9 +908,31 @@ namespace
     {
     public:
         void Decode(_In_ bool bSigned, _Out_writes_(NUM_PIXELS_PER_BLOCK) HDRColorA* pOut) const noexcept;
-        void Encode(_In_ bool bSigned, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pIn) noexcept;
+        void DecodeF16(_In_ bool bSigned, _Out_writes_(NUM_PIXELS_PER_BLOCK) XMHALF4* pOut) const noexcept;
+        static void DecodeF16Batch(_In_ bool bSigned, _In_reads_(count) const D3DX_BC6H* pBC, _In_ size_t count,
+            _Out_writes_(count * NUM_PIXELS_PER_BLOCK) XMHALF4* pOut) noexcept;
+        void GetBlockInfo(_Out_ uint8_t& mode, _Out_ uint8_t& partition) const noexcept;
+        float Encode(_In_ bool bSigned, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pIn, _In_ float targetError, _In_ uint32_t flags) noexcept;
 
     private:
+        // Unquantized endpoints of each region and the region and weight of each texel
+        struct DecodedTexels
+        {
+            INTColor aEndPts[BC6H_MAX_REGIONS][2];
+            uint8_t aRegion[NUM_PIXELS_PER_BLOCK];
+            uint8_t aWeight[NUM_PIXELS_PER_BLOCK];
+        };
+
+        enum EBlockStatus : uint8_t
+        {
+            BLOCK_VALID,
+            BLOCK_INVALID,
+            BLOCK_RESERVED,
+        };
+
+        EBlockStatus ReadTexels(_In_ bool bSigned, _Out_ DecodedTexels& texels) const noexcept;
+        static void InterpolateF16(_In_ bool bSigned, _In_ const DecodedTexels& texels, _Out_writes_(NUM_PIXELS_PER_BLOCK) XMHALF4* pOut) noexcept;
+
     #pragma warning(push)
     #pragma warning(disable : 4480)
         enum EField : uint8_t
@@ -718,9 +981,11 @@ namespace
             const HDRColorA* const aHDRPixels;
             INTEndPntPair aUnqEndPts[BC6H_MAX_SHAPES][BC6H_MAX_REGIONS];
             INTColor aIPixels[NUM_PIXELS_PER_BLOCK];
+            const BlockMoments moments;
+            const EndPointFit fit;
 
-            EncodeParams(const HDRColorA* const aOriginal, bool bSignedFormat) noexcept :
-                fBestErr(FLT_MAX), bSigned(bSignedFormat), uMode(0), uShape(0), aHDRPixels(aOriginal), aUnqEndPts{}, aIPixels{}
+            EncodeParams(const HDRColorA* const aOriginal, bool bSignedFormat, EndPointFit endPointFit) noexcept :
+                fBestErr(FLT_MAX), bSigned(bSignedFormat), uMode(0), uShape(0), aHDRPixels(aOriginal), aUnqEndPts{}, aIPixels{}, moments(aOriginal), fit(endPointFit)
             {
                 for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
                 {
@@ -732,12 +997,11 @@ namespace
 
         static int Quantize(_In_ int iValue, _In_ int prec, _In_ bool bSigned) noexcept;
         static int Unquantize(_In_ int comp, _In_ uint8_t uBitsPerComp, _In_ bool bSigned) noexcept;
-        static int FinishUnquantize(_In_ int comp, _In_ bool bSigned) noexcept;
 
         static bool EndPointsFit(_In_ const EncodeParams* pEP, _In_reads_(BC6H_MAX_REGIONS) const INTEndPntPair aEndPts[]) noexcept;
 
         void GeneratePaletteQuantized(_In_ const EncodeParams* pEP, _In_ const INTEndPntPair& endPts,
-            _Out_writes_(BC6H_MAX_INDICES) INTColor aPalette[]) const noexcept;
+            _Out_ BC6HPalette& palette) const noexcept;
         float MapColorsQuantized(_In_ const EncodeParams* pEP, _In_reads_(np) const INTColor aColors[], _In_ size_t np, _In_ const INTEndPntPair &endPts) const noexcept;
         float PerturbOne(_In_ const EncodeParams* pEP, _In_reads_(np) const INTColor aColors[], _In_ size_t np, _In_ uint8_t ch,
             _In_ const INTEndPntPair& oldEndPts, _Out_ INTEndPntPair& newEndPts, _In_ float fOldErr, _In_ int do_b) const noexcept;
@@ -756,8 +1020,8 @@ namespace
             _In_reads_(NUM_PIXELS_PER_BLOCK) const size_t aIndices[]) noexcept;
         void Refine(_Inout_ EncodeParams* pEP) noexcept;
 
-        static void GeneratePaletteUnquantized(_In_ const EncodeParams* pEP, _In_ size_t uRegion, _Out_writes_(BC6H_MAX_INDICES) INTColor aPalette[]) noexcept;
-        float MapColors(_In_ const EncodeParams* pEP, _In_ size_t uRegion, _In_ size_t np, _In_reads_(np) const size_t* auIndex) const noexcept;
+        static void GeneratePaletteUnquantized(_In_ const EncodeParams* pEP, _In_ size_t uRegion, _Out_ BC6HPalette& palette) noexcept;
+        float MapColors(_In_ const EncodeParams* pEP, _In_ size_t uRegion, _In_ size_t np, _In_reads_(np) const uint8_t* auIndex) const noexcept;
         float RoughMSE(_Inout_ EncodeParams* pEP) const noexcept;
 
     private:
@@ -767,6 +1031,8 @@ namespace
         static const ModeDescriptor ms_aDesc[c_NumModes][82];
         static const ModeInfo ms_aInfo[c_NumModes];
         static const int ms_aModeToInfo[c_NumModeInfo];
+        static const bool ms_aQuickModes[c_NumModes];
+        static const uint8_t ms_aTargetModeOrder[c_NumModes];
     };
 
     // BC67 compression (16b bits per texel)
@@ -774,7 +1040,8 @@ namespace
     {
     public:
         void Decode(_Out_writes_(NUM_PIXELS_PER_BLOCK) HDRColorA* pOut) const noexcept;
-        void Encode(uint32_t flags, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pIn) noexcept;
+        void GetBlockInfo(_Out_ uint8_t& mode, _Out_ uint8_t& partition, _Out_ uint8_t& rotation) const noexcept;
+        float Encode(uint32_t flags, _In_ float targetError, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pIn) noexcept;
 
     private:
         struct ModeInfo
@@ -798,8 +1065,12 @@ namespace
             LDREndPntPair aEndPts[BC7_MAX_SHAPES][BC7_MAX_REGIONS];
             LDRColorA aLDRPixels[NUM_PIXELS_PER_BLOCK];
             const HDRColorA* const aHDRPixels;
+            const BlockMoments moments;
+            const EndPointFit fit;
+            const LDRErrorMetric* pMetric;
 
-            EncodeParams(const HDRColorA* const aOriginal) noexcept : uMode(0), aEndPts{}, aLDRPixels{}, aHDRPixels(aOriginal) {}
+            EncodeParams(const HDRColorA* const aOriginal, EndPointFit endPointFit) noexcept :
+                uMode(0), aEndPts{}, aLDRPixels{}, aHDRPixels(aOriginal), moments(aOriginal), fit(endPointFit), pMetric(nullptr) {}
         };
     #pragma warning(pop)
 
@@ -872,6 +1143,7 @@ namespace
         static constexpr uint8_t c_NumModes = 8;
 
         static const ModeInfo ms_aInfo[c_NumModes];
+        static const uint8_t ms_aTargetModeOrder[c_NumModes];
     };
 }
 
@@ -1102,6 +1374,33 @@ const int D3DX_BC6H::ms_aModeToInfo[D3DX_BC6H::c_NumModeInfo] =
     -1, // Resreved - 0x1f
 };
 
+// Modes tried with BC_FLAGS_FORCE_BC7_MODE6, the untransformed two region mode covers most
+// blocks with an edge and the one region modes cover smooth blocks
+const bool D3DX_BC6H::ms_aQuickModes[D3DX_BC6H::c_NumModes] =
+{
+    false, // Mode 1
+    false, // Mode 2
+    false, // Mode 3
+    false, // Mode 4
+    false, // Mode 5
+    false, // Mode 6
+    false, // Mode 7
+    false, // Mode 8
+    false, // Mode 9
+    true,  // Mode 10
+    true,  // Mode 11
+    false, // Mode 12
+    false, // Mode 13
+    true,  // Mode 14
+};
+
+// Search order used with a target error, the one region modes are cheapest and satisfy most
+// smooth blocks so the search can stop before the 32 shape two region modes are tried
+const uint8_t D3DX_BC6H::ms_aTargetModeOrder[D3DX_BC6H::c_NumModes] =
+{
+    10, 11, 12, 13, 9, 0, 1, 2, 3, 4, 5, 6, 7, 8
+};
+
 // BC7 compression: uPartitions, uPartitionBits, uPBits, uRotationBits, uIndexModeBits, uIndexPrec, uIndexPrec2, RGBAPrec, RGBAPrecWithP
 const D3DX_BC7::ModeInfo D3DX_BC7::ms_aInfo[D3DX_BC7::c_NumModes] =
 {
@@ -1123,6 +1422,12 @@ const D3DX_BC7::ModeInfo D3DX_BC7::ms_aInfo[D3DX_BC7::c_NumModes] =
         // Mode 7: Color+Alpha, 2 Subsets, RGBAP 55551 (unique P-bit), 2-bit indices, 64 partitions
 };
 
+// Search order used with a target error, the modes that win most often come first
+const uint8_t D3DX_BC7::ms_aTargetModeOrder[D3DX_BC7::c_NumModes] =
+{
+    6, 5, 4, 1, 3, 7, 0, 2
+};
+
 
 namespace
 {
@@ -1164,12 +1469,117 @@ namespace
         }
     }
 
-    inline float Norm(_In_ const INTColor& a, _In_ const INTColor& b) noexcept
+    //-------------------------------------------------------------------------------------
+    // BC6H palette helpers
+    //-------------------------------------------------------------------------------------
+    const XMVECTORF32 g_aWeightVectors3[] =
+    {
+        { { { 0.f, 9.f, 18.f, 27.f } } },
+        { { { 37.f, 46.f, 55.f, 64.f } } },
+    };
+
+    const XMVECTORF32 g_aWeightVectors4[] =
+    {
+        { { { 0.f, 4.f, 9.f, 13.f } } },
+        { { { 17.f, 21.f, 26.f, 30.f } } },
+        { { { 34.f, 38.f, 43.f, 47.f } } },
+        { { { 51.f, 55.f, 60.f, 64.f } } },
+    };
+
+    const XMVECTORF32 g_PaletteLaneIndices = { { { 0.f, 1.f, 2.f, 3.f } } };
+
+    // Interpolates one channel for four palette entries.  Every intermediate value is an
+    // integer below 2^24, so the float math matches the decoder's integer math exactly.
+    inline XMVECTOR XM_CALLCONV InterpolateBC6H(
+        int a,
+        int b,
+        FXMVECTOR weightA,
+        FXMVECTOR weightB,
+        bool bFinishUnquantize,
+        float fFinishScale) noexcept
+    {
+        XMVECTOR v = XMVectorMultiplyAdd(XMVectorReplicate(float(a)), weightA, XMVectorMultiply(XMVectorReplicate(float(b)), weightB));
+        v = XMVectorFloor(XMVectorScale(XMVectorAdd(v, XMVectorReplicate(float(BC67_WEIGHT_ROUND))), 1.0f / float(BC67_WEIGHT_MAX)));
+
+        if (bFinishUnquantize)
+        {
+            // Scaling the magnitude by 31/32 (signed) or 31/64 (unsigned) and truncating matches
+            // the integer multiply and shift of the format's finishing step
+            v = XMVectorTruncate(XMVectorScale(v, fFinishScale));
+        }
+
+        return v;
+    }
+
+    void BuildPaletteBC6H(
+        _In_ const INTEndPntPair& endPts,
+        _In_range_(3, 4) uint8_t uIndexPrec,
+        bool bFinishUnquantize,
+        bool bSigned,
+        _Out_ BC6HPalette& palette) noexcept
+    {
+        assert(uIndexPrec == 3 || uIndexPrec == 4);
+
+        const XMVECTORF32* aWeights = (uIndexPrec == 3) ? g_aWeightVectors3 : g_aWeightVectors4;
+        const float fFinishScale = bSigned ? (31.0f / 32.0f) : (31.0f / 64.0f);
+        const XMVECTOR vWeightMax = XMVectorReplicate(float(BC67_WEIGHT_MAX));
+
+        palette.uVectors = (size_t(1) << uIndexPrec) >> 2;
+
+        for (size_t i = 0; i < palette.uVectors; ++i)
+        {
+            const XMVECTOR weightB = aWeights[i];
+            const XMVECTOR weightA = XMVectorSubtract(vWeightMax, weightB);
+
+            palette.r[i] = InterpolateBC6H(endPts.A.r, endPts.B.r, weightA, weightB, bFinishUnquantize, fFinishScale);
+            palette.g[i] = InterpolateBC6H(endPts.A.g, endPts.B.g, weightA, weightB, bFinishUnquantize, fFinishScale);
+            palette.b[i] = InterpolateBC6H(endPts.A.b, endPts.B.b, weightA, weightB, bFinishUnquantize, fFinishScale);
+        }
+    }
+
+    // Returns the squared distance to the nearest palette entry, comparing four entries at
+    // a time.  Ties pick the lowest index.
+    float FindNearestBC6H(
+        _In_ const BC6HPalette& palette,
+        _In_ const INTColor& color,
+        _Out_opt_ size_t* pIndex) noexcept
     {
-        const float dr = float(a.r) - float(b.r);
-        const float dg = float(a.g) - float(b.g);
-        const float db = float(a.b) - float(b.b);
-        return dr * dr + dg * dg + db * db;
+        const XMVECTOR r = XMVectorReplicate(float(color.r));
+        const XMVECTOR g = XMVectorReplicate(float(color.g));
+        const XMVECTOR b = XMVectorReplicate(float(color.b));
+
+        XMVECTOR vBestErr = XMVectorReplicate(FLT_MAX);
+        XMVECTOR vBestIndex = XMVectorZero();
+        XMVECTOR vIndex = g_PaletteLaneIndices;
+
+        for (size_t i = 0; i < palette.uVectors; ++i)
+        {
+            const XMVECTOR dr = XMVectorSubtract(r, palette.r[i]);
+            const XMVECTOR dg = XMVectorSubtract(g, palette.g[i]);
+            const XMVECTOR db = XMVectorSubtract(b, palette.b[i]);
+            const XMVECTOR vErr = XMVectorMultiplyAdd(db, db, XMVectorMultiplyAdd(dg, dg, XMVectorMultiply(dr, dr)));
+
+            const XMVECTOR closer = XMVectorLess(vErr, vBestErr);
+            vBestErr = XMVectorSelect(vBestErr, vErr, closer);
+            vBestIndex = XMVectorSelect(vBestIndex, vIndex, closer);
+            vIndex = XMVectorAdd(vIndex, g_XMFour);
+        }
+
+        float aErr[4], aIndex[4];
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(aErr), vBestErr);
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(aIndex), vBestIndex);
+
+        size_t uBest = 0;
+        for (size_t i = 1; i < 4; ++i)
+        {
+            if (aErr[i] < aErr[uBest] || (aErr[i] == aErr[uBest] && aIndex[i] < aIndex[uBest]))
+                uBest = i;
+        }
+
+        if (pIndex)
+            *pIndex = static_cast<size_t>(aIndex[uBest]);
+
+        return aErr[uBest];
     }
 
     // return # of bits needed to store n. handle signed or unsigned cases properly
@@ -1195,31 +1605,200 @@ namespace
 
 
     //-------------------------------------------------------------------------------------
-    void OptimizeRGB(
+    // Returns which diagonal of the bounding box the subset spreads along the most.  The
+    // spread along a diagonal is a quadratic form of the subset covariance, so the texels
+    // themselves are not revisited.  Bit n of the result flips channel uChannels - 1 - n.
+    size_t FindBestDiagonal(
+        _In_ const SubsetMoments& moments,
+        _In_ const HDRColorA& Mid,
+        _In_ const HDRColorA& Dir,
+        _In_range_(3, 4) size_t uChannels) noexcept
+    {
+        const float fDir[4] = { Dir.r, Dir.g, Dir.b, Dir.a };
+        const float fOffset[4] = { moments.Mean.r - Mid.r, moments.Mean.g - Mid.g, moments.Mean.b - Mid.b, moments.Mean.a - Mid.a };
+
+        // Second moments about the bounding box center, scaled by the axis
+        float fSpread[4][4];
+        for (size_t c = 0; c < uChannels; ++c)
+        {
+            for (size_t d = 0; d < uChannels; ++d)
+            {
+                fSpread[c][d] = (moments.fCovariance[c][d] + moments.fCount * fOffset[c] * fOffset[d]) * fDir[c] * fDir[d];
+            }
+        }
+
+        const size_t uNumDirs = size_t(1) << (uChannels - 1);
+        float fDirMax = -FLT_MAX;
+        size_t iDirMax = 0;
+
+        for (size_t iDir = 0; iDir < uNumDirs; iDir++)
+        {
+            float fSign[4];
+            for (size_t c = 0; c < uChannels; ++c)
+            {
+                fSign[c] = (c > 0 && ((iDir >> (uChannels - 1 - c)) & 1)) ? -1.0f : 1.0f;
+            }
+
+            float f = 0.0f;
+            for (size_t c = 0; c < uChannels; ++c)
+            {
+                for (size_t d = 0; d < uChannels; ++d)
+                {
+                    f += fSign[c] * fSign[d] * fSpread[c][d];
+                }
+            }
+
+            if (f > fDirMax)
+            {
+                fDirMax = f;
+                iDirMax = iDir;
+            }
+        }
+
+        return iDirMax;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Fits the endpoints to the principal axis of the subset.  The axis is found by power
+    // iteration on the subset covariance, starting from the bounding box diagonal in X and Y,
+    // and the endpoints are the extremes of the texels projected onto it.  With bRefit both
+    // endpoints are then solved for in closed form, by least squares against the indices
+    // the principal axis endpoints select.
+    void FitPrincipalAxis(
         _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pPoints,
-        _Out_ HDRColorA* pX,
-        _Out_ HDRColorA* pY,
+        _Inout_ HDRColorA& X,
+        _Inout_ HDRColorA& Y,
         _In_range_(3, 4) uint32_t cSteps,
         size_t cPixels,
-        _In_reads_(cPixels) const size_t* pIndex) noexcept
+        _In_reads_(cPixels) const uint8_t* pIndex,
+        _In_ const SubsetMoments& moments,
+        _In_range_(3, 4) size_t uChannels,
+        bool bRefit) noexcept
     {
+        constexpr size_t c_NumPowerIterations = 8;
+
+        float fAxis[4] = { Y.r - X.r, Y.g - X.g, Y.b - X.b, (uChannels == 4) ? Y.a - X.a : 0.0f };
+
+        for (size_t iIteration = 0; iIteration < c_NumPowerIterations; iIteration++)
+        {
+            float fNext[4] = {};
+            float fMax = 0.0f;
+
+            for (size_t c = 0; c < uChannels; ++c)
+            {
+                for (size_t d = 0; d < uChannels; ++d)
+                {
+                    fNext[c] += moments.fCovariance[c][d] * fAxis[d];
+                }
+
+                fMax = std::max(fMax, fabsf(fNext[c]));
+            }
+
+            // The texels do not spread along the axis, keep the previous estimate
+            if (fMax < FLT_MIN)
+                break;
+
+            const float fInvMax = 1.0f / fMax;
+            for (size_t c = 0; c < uChannels; ++c)
+            {
+                fAxis[c] = fNext[c] * fInvMax;
+            }
+        }
+
+        const HDRColorA Axis(fAxis[0], fAxis[1], fAxis[2], fAxis[3]);
+        const float fLen = Axis * Axis;
+
+        if (fLen < FLT_MIN)
+            return;
+
+        HDRColorA Mean = moments.Mean;
+        if (uChannels == 3)
+        {
+            Mean.a = 0.0f;
+        }
+
+        // Project the texels onto the axis
+        const float fInvLen = 1.0f / fLen;
+        float fProj[NUM_PIXELS_PER_BLOCK];
+        float fMin = FLT_MAX;
+        float fMax = -FLT_MAX;
+
+        for (size_t iPoint = 0; iPoint < cPixels; ++iPoint)
+        {
+            HDRColorA Pt = pPoints[pIndex[iPoint]] - Mean;
+            if (uChannels == 3)
+            {
+                Pt.a = 0.0f;
+            }
+
+            fProj[iPoint] = (Pt * Axis) * fInvLen;
+            fMin = std::min(fMin, fProj[iPoint]);
+            fMax = std::max(fMax, fProj[iPoint]);
+        }
+
+        X = Mean + Axis * fMin;
+        Y = Mean + Axis * fMax;
+
+        const float fRange = fMax - fMin;
+        if (!bRefit || fRange < FLT_MIN)
+            return;
+
+        // Least-squares endpoints for the indices the principal axis endpoints select
         const float *pC = (3 == cSteps) ? pC3 : pC4;
         const float *pD = (3 == cSteps) ? pD3 : pD4;
+        const auto fSteps = static_cast<float>(cSteps - 1);
+        const float fScale = fSteps / fRange;
 
-        // Find Min and Max points, as starting point
-        HDRColorA X(FLT_MAX, FLT_MAX, FLT_MAX, 0.0f);
-        HDRColorA Y(-FLT_MAX, -FLT_MAX, -FLT_MAX, 0.0f);
+        float fCC = 0.0f, fCD = 0.0f, fDD = 0.0f;
+        HDRColorA CP(0.0f, 0.0f, 0.0f, 0.0f), DP(0.0f, 0.0f, 0.0f, 0.0f);
 
-        for (size_t iPoint = 0; iPoint < cPixels; iPoint++)
+        for (size_t iPoint = 0; iPoint < cPixels; ++iPoint)
         {
-            if (pPoints[pIndex[iPoint]].r < X.r) X.r = pPoints[pIndex[iPoint]].r;
-            if (pPoints[pIndex[iPoint]].g < X.g) X.g = pPoints[pIndex[iPoint]].g;
-            if (pPoints[pIndex[iPoint]].b < X.b) X.b = pPoints[pIndex[iPoint]].b;
-            if (pPoints[pIndex[iPoint]].r > Y.r) Y.r = pPoints[pIndex[iPoint]].r;
-            if (pPoints[pIndex[iPoint]].g > Y.g) Y.g = pPoints[pIndex[iPoint]].g;
-            if (pPoints[pIndex[iPoint]].b > Y.b) Y.b = pPoints[pIndex[iPoint]].b;
+            const auto iStep = std::min(cSteps - 1, static_cast<uint32_t>((fProj[iPoint] - fMin) * fScale + 0.5f));
+
+            HDRColorA Pt = pPoints[pIndex[iPoint]];
+            if (uChannels == 3)
+            {
+                Pt.a = 0.0f;
+            }
+
+            fCC += pC[iStep] * pC[iStep];
+            fCD += pC[iStep] * pD[iStep];
+            fDD += pD[iStep] * pD[iStep];
+            CP += Pt * pC[iStep];
+            DP += Pt * pD[iStep];
         }
 
+        // Too few distinct indices to pin down both endpoints, keep the extremes
+        const float fDet = fCC * fDD - fCD * fCD;
+        if (fDet < (1.0f / 64.0f) * fCC * fDD)
+            return;
+
+        const float fInvDet = 1.0f / fDet;
+        X = (CP * fDD - DP * fCD) * fInvDet;
+        Y = (DP * fCC - CP * fCD) * fInvDet;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    void OptimizeRGB(
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pPoints,
+        _Out_ HDRColorA* pX,
+        _Out_ HDRColorA* pY,
+        _In_range_(3, 4) uint32_t cSteps,
+        size_t cPixels,
+        _In_reads_(cPixels) const uint8_t* pIndex,
+        _In_ const SubsetMoments& moments,
+        EndPointFit fit) noexcept
+    {
+        const float *pC = (3 == cSteps) ? pC3 : pC4;
+        const float *pD = (3 == cSteps) ? pD3 : pD4;
+
+        // Min and Max points, as starting point
+        HDRColorA X(moments.Min.r, moments.Min.g, moments.Min.b, 0.0f);
+        HDRColorA Y(moments.Max.r, moments.Max.g, moments.Max.b, 0.0f);
+
         // Diagonal axis
         HDRColorA AB;
         AB.r = Y.r - X.r;
@@ -1249,34 +1828,7 @@ namespace
         Mid.g = (X.g + Y.g) * 0.5f;
         Mid.b = (X.b + Y.b) * 0.5f;
 
-        float fDir[4];
-        fDir[0] = fDir[1] = fDir[2] = fDir[3] = 0.0f;
-
-        for (size_t iPoint = 0; iPoint < cPixels; iPoint++)
-        {
-            HDRColorA Pt;
-            Pt.r = (pPoints[pIndex[iPoint]].r - Mid.r) * Dir.r;
-            Pt.g = (pPoints[pIndex[iPoint]].g - Mid.g) * Dir.g;
-            Pt.b = (pPoints[pIndex[iPoint]].b - Mid.b) * Dir.b;
-
-            float f;
-            f = Pt.r + Pt.g + Pt.b; fDir[0] += f * f;
-            f = Pt.r + Pt.g - Pt.b; fDir[1] += f * f;
-            f = Pt.r - Pt.g + Pt.b; fDir[2] += f * f;
-            f = Pt.r - Pt.g - Pt.b; fDir[3] += f * f;
-        }
-
-        float fDirMax = fDir[0];
-        size_t  iDirMax = 0;
-
-        for (size_t iDir = 1; iDir < 4; iDir++)
-        {
-            if (fDir[iDir] > fDirMax)
-            {
-                fDirMax = fDir[iDir];
-                iDirMax = iDir;
-            }
-        }
+        const size_t iDirMax = FindBestDiagonal(moments, Mid, Dir, 3);
 
         if (iDirMax & 2) std::swap(X.g, Y.g);
         if (iDirMax & 1) std::swap(X.b, Y.b);
@@ -1289,6 +1841,18 @@ namespace
             return;
         }
 
+        if (fit != EndPointFit::Newton)
+        {
+            FitPrincipalAxis(pPoints, X, Y, cSteps, cPixels, pIndex, moments, 3, fit == EndPointFit::PrincipalNewton);
+
+            if (fit == EndPointFit::Principal)
+            {
+                pX->r = X.r; pX->g = X.g; pX->b = X.b;
+                pY->r = Y.r; pY->g = Y.g; pY->b = Y.b;
+                return;
+            }
+        }
+
         // Use Newton's Method to find local minima of sum-of-squares error.
         const auto fSteps = static_cast<float>(cSteps - 1);
 
@@ -1395,26 +1959,24 @@ namespace
         _Out_ HDRColorA* pY,
         _In_range_(3, 4) uint32_t cSteps,
         size_t cPixels,
-        _In_reads_(cPixels) const size_t* pIndex) noexcept
+        _In_reads_(cPixels) const uint8_t* pIndex,
+        _In_ const SubsetMoments& moments,
+        EndPointFit fit) noexcept
     {
         const float *pC = (3 == cSteps) ? pC3 : pC4;
         const float *pD = (3 == cSteps) ? pD3 : pD4;
 
-        // Find Min and Max points, as starting point
-        HDRColorA X(1.0f, 1.0f, 1.0f, 1.0f);
-        HDRColorA Y(0.0f, 0.0f, 0.0f, 0.0f);
-
-        for (size_t iPoint = 0; iPoint < cPixels; iPoint++)
-        {
-            if (pPoints[pIndex[iPoint]].r < X.r) X.r = pPoints[pIndex[iPoint]].r;
-            if (pPoints[pIndex[iPoint]].g < X.g) X.g = pPoints[pIndex[iPoint]].g;
-            if (pPoints[pIndex[iPoint]].b < X.b) X.b = pPoints[pIndex[iPoint]].b;
-            if (pPoints[pIndex[iPoint]].a < X.a) X.a = pPoints[pIndex[iPoint]].a;
-            if (pPoints[pIndex[iPoint]].r > Y.r) Y.r = pPoints[pIndex[iPoint]].r;
-            if (pPoints[pIndex[iPoint]].g > Y.g) Y.g = pPoints[pIndex[iPoint]].g;
-            if (pPoints[pIndex[iPoint]].b > Y.b) Y.b = pPoints[pIndex[iPoint]].b;
-            if (pPoints[pIndex[iPoint]].a > Y.a) Y.a = pPoints[pIndex[iPoint]].a;
-        }
+        // Min and Max points within [0, 1], as starting point
+        HDRColorA X(
+            std::min(moments.Min.r, 1.0f),
+            std::min(moments.Min.g, 1.0f),
+            std::min(moments.Min.b, 1.0f),
+            std::min(moments.Min.a, 1.0f));
+        HDRColorA Y(
+            std::max(moments.Max.r, 0.0f),
+            std::max(moments.Max.g, 0.0f),
+            std::max(moments.Max.b, 0.0f),
+            std::max(moments.Max.a, 0.0f));
 
         // Diagonal axis
         const HDRColorA AB = Y - X;
@@ -1433,52 +1995,32 @@ namespace
         HDRColorA Dir = AB * fABInv;
         const HDRColorA Mid = (X + Y) * 0.5f;
 
-        float fDir[8];
-        fDir[0] = fDir[1] = fDir[2] = fDir[3] = fDir[4] = fDir[5] = fDir[6] = fDir[7] = 0.0f;
+        const size_t iDirMax = FindBestDiagonal(moments, Mid, Dir, 4);
 
-        for (size_t iPoint = 0; iPoint < cPixels; iPoint++)
-        {
-            HDRColorA Pt;
-            Pt.r = (pPoints[pIndex[iPoint]].r - Mid.r) * Dir.r;
-            Pt.g = (pPoints[pIndex[iPoint]].g - Mid.g) * Dir.g;
-            Pt.b = (pPoints[pIndex[iPoint]].b - Mid.b) * Dir.b;
-            Pt.a = (pPoints[pIndex[iPoint]].a - Mid.a) * Dir.a;
+        if (iDirMax & 4) std::swap(X.g, Y.g);
+        if (iDirMax & 2) std::swap(X.b, Y.b);
+        if (iDirMax & 1) std::swap(X.a, Y.a);
 
-            float f;
-            f = Pt.r + Pt.g + Pt.b + Pt.a; fDir[0] += f * f;
-            f = Pt.r + Pt.g + Pt.b - Pt.a; fDir[1] += f * f;
-            f = Pt.r + Pt.g - Pt.b + Pt.a; fDir[2] += f * f;
-            f = Pt.r + Pt.g - Pt.b - Pt.a; fDir[3] += f * f;
-            f = Pt.r - Pt.g + Pt.b + Pt.a; fDir[4] += f * f;
-            f = Pt.r - Pt.g + Pt.b - Pt.a; fDir[5] += f * f;
-            f = Pt.r - Pt.g - Pt.b + Pt.a; fDir[6] += f * f;
-            f = Pt.r - Pt.g - Pt.b - Pt.a; fDir[7] += f * f;
+        // Two color block.. no need to root-find
+        if (fAB < 1.0f / 4096.0f)
+        {
+            *pX = X;
+            *pY = Y;
+            return;
         }
 
-        float fDirMax = fDir[0];
-        size_t  iDirMax = 0;
-
-        for (size_t iDir = 1; iDir < 8; iDir++)
+        if (fit != EndPointFit::Newton)
         {
-            if (fDir[iDir] > fDirMax)
+            FitPrincipalAxis(pPoints, X, Y, cSteps, cPixels, pIndex, moments, 4, fit == EndPointFit::PrincipalNewton);
+
+            if (fit == EndPointFit::Principal)
             {
-                fDirMax = fDir[iDir];
-                iDirMax = iDir;
+                *pX = X;
+                *pY = Y;
+                return;
             }
         }
 
-        if (iDirMax & 4) std::swap(X.g, Y.g);
-        if (iDirMax & 2) std::swap(X.b, Y.b);
-        if (iDirMax & 1) std::swap(X.a, Y.a);
-
-        // Two color block.. no need to root-find
-        if (fAB < 1.0f / 4096.0f)
-        {
-            *pX = X;
-            *pY = Y;
-            return;
-        }
-
         // Use Newton's Method to find local minima of sum-of-squares error.
         const auto fSteps = static_cast<float>(cSteps - 1u);
 
@@ -1555,15 +2097,120 @@ namespace
     }
 
 
+    //-------------------------------------------------------------------------------------
+    // ComputeError under an LDRErrorMetric.  The color terms are scaled by the source alpha
+    // of the pixel, color errors in transparent pixels matter less.
+    float ComputeMetricError(
+        _In_ const LDRColorA& pixel,
+        _In_reads_(1 << uIndexPrec) const LDRColorA aPalette[],
+        uint8_t uIndexPrec,
+        uint8_t uIndexPrec2,
+        _In_ const LDRErrorMetric& metric,
+        _Out_opt_ size_t* pBestIndex,
+        _Out_opt_ size_t* pBestIndex2) noexcept
+    {
+        const size_t uNumIndices = size_t(1) << uIndexPrec;
+        const size_t uNumIndices2 = size_t(1) << uIndexPrec2;
+        float fTotalErr = 0;
+        float fBestErr = FLT_MAX;
+
+        if (pBestIndex)
+            *pBestIndex = 0;
+        if (pBestIndex2)
+            *pBestIndex2 = 0;
+
+        const float fAlphaScale = float(pixel[metric.uAlphaChannel] + 1u) * (1.0f / 256.0f);
+        const XMVECTOR vWeight = XMVectorMultiply(g_YCoCgMetricWeights, XMVectorSet(fAlphaScale, fAlphaScale, fAlphaScale, 1.0f));
+
+        const XMVECTOR vpixel = XMLoadUByte4(reinterpret_cast<const XMUBYTE4*>(&pixel));
+
+        if (uIndexPrec2 == 0)
+        {
+            for (size_t i = 0; i < uNumIndices && fBestErr > 0; i++)
+            {
+                XMVECTOR tpixel = XMLoadUByte4(reinterpret_cast<const XMUBYTE4*>(&aPalette[i]));
+                tpixel = XMVectorSubtract(vpixel, tpixel);
+
+                XMVECTOR vTerms = XMVectorMultiply(XMVectorSplatX(tpixel), metric.vTerms[0]);
+                vTerms = XMVectorMultiplyAdd(XMVectorSplatY(tpixel), metric.vTerms[1], vTerms);
+                vTerms = XMVectorMultiplyAdd(XMVectorSplatZ(tpixel), metric.vTerms[2], vTerms);
+                vTerms = XMVectorMultiplyAdd(XMVectorSplatW(tpixel), metric.vTerms[3], vTerms);
+
+                const float fErr = XMVectorGetX(XMVector4Dot(XMVectorMultiply(vTerms, vTerms), vWeight));
+                if (fErr > fBestErr)	// error increased, so we're done searching
+                    break;
+                if (fErr < fBestErr)
+                {
+                    fBestErr = fErr;
+                    if (pBestIndex)
+                        *pBestIndex = i;
+                }
+            }
+            fTotalErr += fBestErr;
+        }
+        else
+        {
+            for (size_t i = 0; i < uNumIndices && fBestErr > 0; i++)
+            {
+                XMVECTOR tpixel = XMLoadUByte4(reinterpret_cast<const XMUBYTE4*>(&aPalette[i]));
+                tpixel = XMVectorSubtract(vpixel, tpixel);
+
+                XMVECTOR vTerms = XMVectorMultiply(XMVectorSplatX(tpixel), metric.vTerms[0]);
+                vTerms = XMVectorMultiplyAdd(XMVectorSplatY(tpixel), metric.vTerms[1], vTerms);
+                vTerms = XMVectorMultiplyAdd(XMVectorSplatZ(tpixel), metric.vTerms[2], vTerms);
+
+                const float fErr = XMVectorGetX(XMVector4Dot(XMVectorMultiply(vTerms, vTerms), vWeight));
+                if (fErr > fBestErr)	// error increased, so we're done searching
+                    break;
+                if (fErr < fBestErr)
+                {
+                    fBestErr = fErr;
+                    if (pBestIndex)
+                        *pBestIndex = i;
+                }
+            }
+            fTotalErr += fBestErr;
+
+            // The channel in the alpha slot contributes to the metric terms independently
+            const XMVECTOR vAlphaTerms = metric.vTerms[3];
+            const float fAlphaWeight = XMVectorGetX(XMVector4Dot(XMVectorMultiply(vAlphaTerms, vAlphaTerms), vWeight));
+
+            fBestErr = FLT_MAX;
+            for (size_t i = 0; i < uNumIndices2 && fBestErr > 0; i++)
+            {
+                const float ea = float(pixel.a) - float(aPalette[i].a);
+                const float fErr = ea * ea * fAlphaWeight;
+                if (fErr > fBestErr)	// error increased, so we're done searching
+                    break;
+                if (fErr < fBestErr)
+                {
+                    fBestErr = fErr;
+                    if (pBestIndex2)
+                        *pBestIndex2 = i;
+                }
+            }
+            fTotalErr += fBestErr;
+        }
+
+        return fTotalErr;
+    }
+
+
     //-------------------------------------------------------------------------------------
     float ComputeError(
         _Inout_ const LDRColorA& pixel,
         _In_reads_(1 << uIndexPrec) const LDRColorA aPalette[],
         uint8_t uIndexPrec,
         uint8_t uIndexPrec2,
+        _In_opt_ const LDRErrorMetric* pMetric,
         _Out_opt_ size_t* pBestIndex = nullptr,
         _Out_opt_ size_t* pBestIndex2 = nullptr) noexcept
     {
+        if (pMetric)
+        {
+            return ComputeMetricError(pixel, aPalette, uIndexPrec, uIndexPrec2, *pMetric, pBestIndex, pBestIndex2);
+        }
+
         const size_t uNumIndices = size_t(1) << uIndexPrec;
         const size_t uNumIndices2 = size_t(1) << uIndexPrec2;
         float fTotalErr = 0;
@@ -1648,6 +2295,20 @@ namespace
         #endif
         }
     }
+
+    void FillWithErrorColors(_Out_writes_(NUM_PIXELS_PER_BLOCK) XMHALF4* pOut) noexcept
+    {
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+        #ifdef _DEBUG
+            // Use Magenta in debug as a highly-visible error color
+            pOut[i] = XMHALF4(F16ONE, HALF(0), F16ONE, F16ONE);
+        #else
+            // In production use, default to black
+            pOut[i] = XMHALF4(HALF(0), HALF(0), HALF(0), F16ONE);
+        #endif
+        }
+    }
 }
 
 
@@ -1655,10 +2316,8 @@ namespace
 // BC6H Compression
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-void D3DX_BC6H::Decode(bool bSigned, HDRColorA* pOut) const noexcept
+D3DX_BC6H::EBlockStatus D3DX_BC6H::ReadTexels(bool bSigned, DecodedTexels& texels) const noexcept
 {
-    assert(pOut);
-
     size_t uStartBit = 0;
     uint8_t uMode = GetBits(uStartBit, 2u);
     if (uMode != 0x00 && uMode != 0x01)
@@ -1669,159 +2328,327 @@ void D3DX_BC6H::Decode(bool bSigned, HDRColorA* pOut) const noexcept
     assert(uMode < c_NumModeInfo);
     _Analysis_assume_(uMode < c_NumModeInfo);
 
-    if (ms_aModeToInfo[uMode] >= 0)
+    if (ms_aModeToInfo[uMode] < 0)
     {
-        assert(static_cast<unsigned int>(ms_aModeToInfo[uMode]) < c_NumModes);
-        _Analysis_assume_(ms_aModeToInfo[uMode] < c_NumModes);
-        const ModeDescriptor* desc = ms_aDesc[ms_aModeToInfo[uMode]];
-        const ModeInfo& info = ms_aInfo[ms_aModeToInfo[uMode]];
+    #if defined(_WIN32) && defined(_DEBUG)
+        const char* warnstr = "BC6H: Invalid mode encountered during decoding\n";
+        switch (uMode)
+        {
+        case 0x13:  warnstr = "BC6H: Reserved mode 10011 encountered during decoding\n"; break;
+        case 0x17:  warnstr = "BC6H: Reserved mode 10111 encountered during decoding\n"; break;
+        case 0x1B:  warnstr = "BC6H: Reserved mode 11011 encountered during decoding\n"; break;
+        case 0x1F:  warnstr = "BC6H: Reserved mode 11111 encountered during decoding\n"; break;
+        default: break;
+        }
+        OutputDebugStringA(warnstr);
+    #endif
+        return BLOCK_RESERVED;
+    }
+
+    assert(static_cast<unsigned int>(ms_aModeToInfo[uMode]) < c_NumModes);
+    _Analysis_assume_(ms_aModeToInfo[uMode] < c_NumModes);
+    const ModeDescriptor* desc = ms_aDesc[ms_aModeToInfo[uMode]];
+    const ModeInfo& info = ms_aInfo[ms_aModeToInfo[uMode]];
 
-        INTEndPntPair aEndPts[BC6H_MAX_REGIONS] = {};
-        uint32_t uShape = 0;
+    INTEndPntPair aEndPts[BC6H_MAX_REGIONS] = {};
+    uint32_t uShape = 0;
 
-        // Read header
-        const size_t uHeaderBits = info.uPartitions > 0 ? 82u : 65u;
-        while (uStartBit < uHeaderBits)
+    // Read header
+    const size_t uHeaderBits = info.uPartitions > 0 ? 82u : 65u;
+    while (uStartBit < uHeaderBits)
+    {
+        const size_t uCurBit = uStartBit;
+        if (GetBit(uStartBit))
         {
-            const size_t uCurBit = uStartBit;
-            if (GetBit(uStartBit))
+            switch (desc[uCurBit].m_eField)
             {
-                switch (desc[uCurBit].m_eField)
+            case D:  uShape |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case RW: aEndPts[0].A.r |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case RX: aEndPts[0].B.r |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case RY: aEndPts[1].A.r |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case RZ: aEndPts[1].B.r |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case GW: aEndPts[0].A.g |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case GX: aEndPts[0].B.g |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case GY: aEndPts[1].A.g |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case GZ: aEndPts[1].B.g |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case BW: aEndPts[0].A.b |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case BX: aEndPts[0].B.b |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case BY: aEndPts[1].A.b |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            case BZ: aEndPts[1].B.b |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
+            default:
                 {
-                case D:  uShape |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case RW: aEndPts[0].A.r |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case RX: aEndPts[0].B.r |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case RY: aEndPts[1].A.r |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case RZ: aEndPts[1].B.r |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case GW: aEndPts[0].A.g |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case GX: aEndPts[0].B.g |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case GY: aEndPts[1].A.g |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case GZ: aEndPts[1].B.g |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case BW: aEndPts[0].A.b |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case BX: aEndPts[0].B.b |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case BY: aEndPts[1].A.b |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                case BZ: aEndPts[1].B.b |= 1 << uint32_t(desc[uCurBit].m_uBit); break;
-                default:
-                    {
-                    #if defined(_WIN32) && defined(_DEBUG)
-                        OutputDebugStringA("BC6H: Invalid header bits encountered during decoding\n");
-                    #endif
-                        FillWithErrorColors(pOut);
-                        return;
-                    }
+                #if defined(_WIN32) && defined(_DEBUG)
+                    OutputDebugStringA("BC6H: Invalid header bits encountered during decoding\n");
+                #endif
+                    return BLOCK_INVALID;
                 }
             }
         }
+    }
 
-        assert(uShape < 64);
-        _Analysis_assume_(uShape < 64);
+    assert(uShape < 64);
+    _Analysis_assume_(uShape < 64);
 
-        // Sign extend necessary end points
-        if (bSigned)
-        {
-            aEndPts[0].A.SignExtend(info.RGBAPrec[0][0]);
-        }
-        if (bSigned || info.bTransformed)
+    // Sign extend necessary end points
+    if (bSigned)
+    {
+        aEndPts[0].A.SignExtend(info.RGBAPrec[0][0]);
+    }
+    if (bSigned || info.bTransformed)
+    {
+        assert(info.uPartitions < BC6H_MAX_REGIONS);
+        _Analysis_assume_(info.uPartitions < BC6H_MAX_REGIONS);
+        for (size_t p = 0; p <= info.uPartitions; ++p)
         {
-            assert(info.uPartitions < BC6H_MAX_REGIONS);
-            _Analysis_assume_(info.uPartitions < BC6H_MAX_REGIONS);
-            for (size_t p = 0; p <= info.uPartitions; ++p)
+            if (p != 0)
             {
-                if (p != 0)
-                {
-                    aEndPts[p].A.SignExtend(info.RGBAPrec[p][0]);
-                }
-                aEndPts[p].B.SignExtend(info.RGBAPrec[p][1]);
+                aEndPts[p].A.SignExtend(info.RGBAPrec[p][0]);
             }
+            aEndPts[p].B.SignExtend(info.RGBAPrec[p][1]);
         }
+    }
+
+    // Inverse transform the end points
+    if (info.bTransformed)
+    {
+        TransformInverse(aEndPts, info.RGBAPrec[0][0], bSigned);
+    }
+
+    // Unquantize endpoints
+    const LDRColorA& prec = info.RGBAPrec[0][0];
+    for (size_t p = 0; p < BC6H_MAX_REGIONS; ++p)
+    {
+        texels.aEndPts[p][0] = INTColor(
+            Unquantize(aEndPts[p].A.r, prec.r, bSigned),
+            Unquantize(aEndPts[p].A.g, prec.g, bSigned),
+            Unquantize(aEndPts[p].A.b, prec.b, bSigned));
+        texels.aEndPts[p][1] = INTColor(
+            Unquantize(aEndPts[p].B.r, prec.r, bSigned),
+            Unquantize(aEndPts[p].B.g, prec.g, bSigned),
+            Unquantize(aEndPts[p].B.b, prec.b, bSigned));
+    }
 
-        // Inverse transform the end points
-        if (info.bTransformed)
+    // Read indices
+    const int* aWeights = info.uPartitions > 0 ? g_aWeights3 : g_aWeights4;
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+    {
+        const size_t uNumBits = IsFixUpOffset(info.uPartitions, uShape, i) ? info.uIndexPrec - 1u : info.uIndexPrec;
+        if (uStartBit + uNumBits > 128)
         {
-            TransformInverse(aEndPts, info.RGBAPrec[0][0], bSigned);
+        #if defined(_WIN32) && defined(_DEBUG)
+            OutputDebugStringA("BC6H: Invalid block encountered during decoding\n");
+        #endif
+            return BLOCK_INVALID;
         }
+        const uint8_t uIndex = GetBits(uStartBit, uNumBits);
 
-        // Read indices
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        if (uIndex >= ((info.uPartitions > 0) ? 8 : 16))
         {
-            const size_t uNumBits = IsFixUpOffset(info.uPartitions, uShape, i) ? info.uIndexPrec - 1u : info.uIndexPrec;
-            if (uStartBit + uNumBits > 128)
-            {
-            #if defined(_WIN32) && defined(_DEBUG)
-                OutputDebugStringA("BC6H: Invalid block encountered during decoding\n");
-            #endif
-                FillWithErrorColors(pOut);
-                return;
-            }
-            const uint8_t uIndex = GetBits(uStartBit, uNumBits);
+        #if defined(_WIN32) && defined(_DEBUG)
+            OutputDebugStringA("BC6H: Invalid index encountered during decoding\n");
+        #endif
+            return BLOCK_INVALID;
+        }
 
-            if (uIndex >= ((info.uPartitions > 0) ? 8 : 16))
-            {
-            #if defined(_WIN32) && defined(_DEBUG)
-                OutputDebugStringA("BC6H: Invalid index encountered during decoding\n");
-            #endif
-                FillWithErrorColors(pOut);
-                return;
-            }
+        const size_t uRegion = g_aPartitionTable[info.uPartitions][uShape][i];
+        assert(uRegion < BC6H_MAX_REGIONS);
+        _Analysis_assume_(uRegion < BC6H_MAX_REGIONS);
 
-            const size_t uRegion = g_aPartitionTable[info.uPartitions][uShape][i];
-            assert(uRegion < BC6H_MAX_REGIONS);
-            _Analysis_assume_(uRegion < BC6H_MAX_REGIONS);
+        texels.aRegion[i] = static_cast<uint8_t>(uRegion);
+        texels.aWeight[i] = static_cast<uint8_t>(aWeights[uIndex]);
+    }
 
-            // Unquantize endpoints and interpolate
-            const int r1 = Unquantize(aEndPts[uRegion].A.r, info.RGBAPrec[0][0].r, bSigned);
-            const int g1 = Unquantize(aEndPts[uRegion].A.g, info.RGBAPrec[0][0].g, bSigned);
-            const int b1 = Unquantize(aEndPts[uRegion].A.b, info.RGBAPrec[0][0].b, bSigned);
-            const int r2 = Unquantize(aEndPts[uRegion].B.r, info.RGBAPrec[0][0].r, bSigned);
-            const int g2 = Unquantize(aEndPts[uRegion].B.g, info.RGBAPrec[0][0].g, bSigned);
-            const int b2 = Unquantize(aEndPts[uRegion].B.b, info.RGBAPrec[0][0].b, bSigned);
-            const int* aWeights = info.uPartitions > 0 ? g_aWeights3 : g_aWeights4;
-            INTColor fc;
-            fc.r = FinishUnquantize((r1 * (BC67_WEIGHT_MAX - aWeights[uIndex]) + r2 * aWeights[uIndex] + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT, bSigned);
-            fc.g = FinishUnquantize((g1 * (BC67_WEIGHT_MAX - aWeights[uIndex]) + g2 * aWeights[uIndex] + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT, bSigned);
-            fc.b = FinishUnquantize((b1 * (BC67_WEIGHT_MAX - aWeights[uIndex]) + b2 * aWeights[uIndex] + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT, bSigned);
+    return BLOCK_VALID;
+}
 
-            HALF rgb[3];
-            fc.ToF16(rgb, bSigned);
 
-            pOut[i].r = XMConvertHalfToFloat(rgb[0]);
-            pOut[i].g = XMConvertHalfToFloat(rgb[1]);
-            pOut[i].b = XMConvertHalfToFloat(rgb[2]);
-            pOut[i].a = 1.0f;
-        }
+//-------------------------------------------------------------------------------------
+// Interpolates, finishes the unquantize and forms the half bit patterns with
+// float vector math. Every intermediate is an integer below 2^24, so the result
+// matches the integer math of the format exactly: the magnitude is scaled by 31/32
+// (signed) or 31/64 (unsigned) and truncated before it becomes the half bit pattern.
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void D3DX_BC6H::InterpolateF16(bool bSigned, const DecodedTexels& texels, XMHALF4* pOut) noexcept
+{
+    static const XMVECTORF32 s_WeightMax = { { { float(BC67_WEIGHT_MAX), float(BC67_WEIGHT_MAX), float(BC67_WEIGHT_MAX), float(BC67_WEIGHT_MAX) } } };
+    static const XMVECTORF32 s_WeightRound = { { { float(BC67_WEIGHT_ROUND), float(BC67_WEIGHT_ROUND), float(BC67_WEIGHT_ROUND), float(BC67_WEIGHT_ROUND) } } };
+    static const XMVECTORF32 s_SignBit = { { { float(F16S_MASK), float(F16S_MASK), float(F16S_MASK), float(F16S_MASK) } } };
+    static const XMVECTORF32 s_One = { { { 0.f, 0.f, 0.f, float(F16ONE) } } };
+
+    constexpr float fWeightScale = 1.f / float(1 << BC67_WEIGHT_SHIFT);
+
+    XMVECTOR vEndPts[BC6H_MAX_REGIONS][2];
+    for (size_t p = 0; p < BC6H_MAX_REGIONS; ++p)
+    {
+        vEndPts[p][0] = XMLoadSInt4(reinterpret_cast<const XMINT4*>(&texels.aEndPts[p][0]));
+        vEndPts[p][1] = XMLoadSInt4(reinterpret_cast<const XMINT4*>(&texels.aEndPts[p][1]));
     }
-    else
+
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
     {
-    #if defined(_WIN32) && defined(_DEBUG)
-        const char* warnstr = "BC6H: Invalid mode encountered during decoding\n";
-        switch (uMode)
+        const size_t uRegion = texels.aRegion[i];
+        const XMVECTOR w = XMVectorReplicate(float(texels.aWeight[i]));
+
+        // (a * (64 - w) + b * w + 32) >> 6
+        XMVECTOR v = XMVectorMultiplyAdd(vEndPts[uRegion][0], XMVectorSubtract(s_WeightMax, w), s_WeightRound);
+        v = XMVectorMultiplyAdd(vEndPts[uRegion][1], w, v);
+        v = XMVectorFloor(XMVectorScale(v, fWeightScale));
+
+        if (bSigned)
         {
-        case 0x13:  warnstr = "BC6H: Reserved mode 10011 encountered during decoding\n"; break;
-        case 0x17:  warnstr = "BC6H: Reserved mode 10111 encountered during decoding\n"; break;
-        case 0x1B:  warnstr = "BC6H: Reserved mode 11011 encountered during decoding\n"; break;
-        case 0x1F:  warnstr = "BC6H: Reserved mode 11111 encountered during decoding\n"; break;
-        default: break;
+            // Scale the magnitude by 31/32 and move the sign to bit 15
+            const XMVECTOR mag = XMVectorFloor(XMVectorScale(XMVectorAbs(v), 31.f / 32.f));
+            const XMVECTOR neg = XMVectorAndInt(XMVectorLess(v, g_XMZero), XMVectorGreater(mag, g_XMZero));
+            v = XMVectorSelect(mag, XMVectorAdd(mag, s_SignBit), neg);
         }
-        OutputDebugStringA(warnstr);
-    #endif
+        else
+        {
+            // Scale the magnitude by 31/64
+            v = XMVectorFloor(XMVectorScale(v, 31.f / 64.f));
+        }
+
+        v = XMVectorSelect(s_One, v, g_XMSelect1110);
+        XMStoreUShort4(reinterpret_cast<XMUSHORT4*>(&pOut[i]), v);
+    }
+}
+
+
+_Use_decl_annotations_
+void D3DX_BC6H::DecodeF16(bool bSigned, XMHALF4* pOut) const noexcept
+{
+    assert(pOut);
+
+    DecodedTexels texels;
+    switch (ReadTexels(bSigned, texels))
+    {
+    case BLOCK_VALID:
+        InterpolateF16(bSigned, texels, pOut);
+        break;
+
+    case BLOCK_INVALID:
+        FillWithErrorColors(pOut);
+        break;
+
+    default:
         // Per the BC6H format spec, we must return opaque black
         for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
         {
-            pOut[i] = HDRColorA(0.0f, 0.0f, 0.0f, 1.0f);
+            pOut[i] = XMHALF4(HALF(0), HALF(0), HALF(0), F16ONE);
+        }
+        break;
+    }
+}
+
+
+_Use_decl_annotations_
+void D3DX_BC6H::DecodeF16Batch(bool bSigned, const D3DX_BC6H* pBC, size_t count, XMHALF4* pOut) noexcept
+{
+    assert(pBC && pOut);
+    assert(count <= BC_DECODE_BATCH_SIZE);
+
+    // Read every header first, so the interpolation runs back to back with no bit parsing in between
+    DecodedTexels texels[BC_DECODE_BATCH_SIZE];
+    EBlockStatus status[BC_DECODE_BATCH_SIZE];
+    for (size_t j = 0; j < count; ++j)
+    {
+        status[j] = pBC[j].ReadTexels(bSigned, texels[j]);
+    }
+
+    for (size_t j = 0; j < count; ++j)
+    {
+        XMHALF4* pBlockOut = pOut + j * NUM_PIXELS_PER_BLOCK;
+        switch (status[j])
+        {
+        case BLOCK_VALID:
+            InterpolateF16(bSigned, texels[j], pBlockOut);
+            break;
+
+        case BLOCK_INVALID:
+            FillWithErrorColors(pBlockOut);
+            break;
+
+        default:
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                pBlockOut[i] = XMHALF4(HALF(0), HALF(0), HALF(0), F16ONE);
+            }
+            break;
+        }
+    }
+}
+
+
+_Use_decl_annotations_
+void D3DX_BC6H::Decode(bool bSigned, HDRColorA* pOut) const noexcept
+{
+    assert(pOut);
+
+    XMHALF4 aF16[NUM_PIXELS_PER_BLOCK];
+    DecodeF16(bSigned, aF16);
+
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+    {
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&pOut[i]), XMLoadHalf4(&aF16[i]));
+    }
+}
+
+
+_Use_decl_annotations_
+void D3DX_BC6H::GetBlockInfo(uint8_t& mode, uint8_t& partition) const noexcept
+{
+    mode = 0xFF;
+    partition = 0;
+
+    size_t uStartBit = 0;
+    uint8_t uMode = GetBits(uStartBit, 2u);
+    if (uMode != 0x00 && uMode != 0x01)
+    {
+        uMode = static_cast<uint8_t>((unsigned(GetBits(uStartBit, 3)) << 2) | uMode);
+    }
+
+    if (ms_aModeToInfo[uMode] < 0)
+        return;
+
+    // Modes are numbered 1 to 14 as in the format specification
+    mode = static_cast<uint8_t>(ms_aModeToInfo[uMode] + 1);
+
+    const ModeDescriptor* desc = ms_aDesc[ms_aModeToInfo[uMode]];
+    if (ms_aInfo[ms_aModeToInfo[uMode]].uPartitions > 0)
+    {
+        while (uStartBit < 82)
+        {
+            const size_t uCurBit = uStartBit;
+            if (GetBit(uStartBit) && desc[uCurBit].m_eField == D)
+            {
+                partition = static_cast<uint8_t>(partition | (1u << desc[uCurBit].m_uBit));
+            }
         }
     }
 }
 
 
 _Use_decl_annotations_
-void D3DX_BC6H::Encode(bool bSigned, const HDRColorA* const pIn) noexcept
+float D3DX_BC6H::Encode(bool bSigned, const HDRColorA* const pIn, float targetError, uint32_t flags) noexcept
 {
     assert(pIn);
 
-    EncodeParams EP(pIn, bSigned);
+    EncodeParams EP(pIn, bSigned, GetEndPointFit(flags));
+
+    // The target is a per channel MSE relative to the largest finite half, the block error sums 3 channels of 16 pixels
+    const float fErrScale = float(F16MAX) * float(F16MAX) * float(3 * NUM_PIXELS_PER_BLOCK);
+    const float fTargetErr = std::max(0.0f, targetError) * fErrScale;
+
+    for (size_t m = 0; m < c_NumModes && EP.fBestErr > fTargetErr; ++m)
+    {
+        EP.uMode = (fTargetErr > 0) ? ms_aTargetModeOrder[m] : static_cast<uint8_t>(m);
+
+        if ((flags & BC_FLAGS_FORCE_BC7_MODE6) && !ms_aQuickModes[EP.uMode])
+        {
+            // Skip the modes that rarely win
+            continue;
+        }
 
-    for (EP.uMode = 0; EP.uMode < c_NumModes && EP.fBestErr > 0; ++EP.uMode)
-    {
         const uint8_t uShapes = ms_aInfo[EP.uMode].uPartitions ? 32u : 1u;
         // Number of rough cases to look at. reasonable values of this are 1, uShapes/4, and uShapes
         // uShapes/4 gets nearly all the cases; you can increase that a bit (say by 3 or 4) if you really want to squeeze the last bit out
@@ -1850,12 +2677,14 @@ void D3DX_BC6H::Encode(bool bSigned, const HDRColorA* const pIn) noexcept
             }
         }
 
-        for (size_t i = 0; i < uItems && EP.fBestErr > 0; i++)
+        for (size_t i = 0; i < uItems && EP.fBestErr > fTargetErr; i++)
         {
             EP.uShape = auShape[i];
             Refine(&EP);
         }
     }
+
+    return EP.fBestErr / fErrScale;
 }
 
 
@@ -1926,20 +2755,6 @@ int D3DX_BC6H::Unquantize(int comp, uint8_t uBitsPerComp, bool bSigned) noexcept
 }
 
 
-_Use_decl_annotations_
-int D3DX_BC6H::FinishUnquantize(int comp, bool bSigned) noexcept
-{
-    if (bSigned)
-    {
-        return (comp < 0) ? -(((-comp) * 31) >> 5) : (comp * 31) >> 5;  // scale the magnitude by 31/32
-    }
-    else
-    {
-        return (comp * 31) >> 6;                                        // scale the magnitude by 31/64
-    }
-}
-
-
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
 bool D3DX_BC6H::EndPointsFit(const EncodeParams* pEP, const INTEndPntPair aEndPts[]) noexcept
@@ -1987,16 +2802,12 @@ bool D3DX_BC6H::EndPointsFit(const EncodeParams* pEP, const INTEndPntPair aEndPt
 
 
 _Use_decl_annotations_
-void D3DX_BC6H::GeneratePaletteQuantized(const EncodeParams* pEP, const INTEndPntPair& endPts, INTColor aPalette[]) const noexcept
+void D3DX_BC6H::GeneratePaletteQuantized(const EncodeParams* pEP, const INTEndPntPair& endPts, BC6HPalette& palette) const noexcept
 {
     assert(pEP);
     assert(pEP->uMode < c_NumModes);
     _Analysis_assume_(pEP->uMode < c_NumModes);
 
-    const size_t uIndexPrec = ms_aInfo[pEP->uMode].uIndexPrec;
-    const size_t uNumIndices = size_t(1) << uIndexPrec;
-    assert(uNumIndices > 0);
-    _Analysis_assume_(uNumIndices > 0);
     const LDRColorA& Prec = ms_aInfo[pEP->uMode].RGBAPrec[0][0];
 
     // scale endpoints
@@ -2009,33 +2820,7 @@ void D3DX_BC6H::GeneratePaletteQuantized(const EncodeParams* pEP, const INTEndPn
     unqEndPts.B.b = Unquantize(endPts.B.b, Prec.b, pEP->bSigned);
 
     // interpolate
-    const int* aWeights = nullptr;
-    switch (uIndexPrec)
-    {
-    case 3: aWeights = g_aWeights3; assert(uNumIndices <= 8); _Analysis_assume_(uNumIndices <= 8); break;
-    case 4: aWeights = g_aWeights4; assert(uNumIndices <= 16); _Analysis_assume_(uNumIndices <= 16); break;
-    default:
-        assert(false);
-        for (size_t i = 0; i < uNumIndices; ++i)
-        {
-        #pragma prefast(suppress:22102 22103, "writing blocks in two halves confuses tool")
-            aPalette[i] = INTColor(0, 0, 0);
-        }
-        return;
-    }
-
-    for (size_t i = 0; i < uNumIndices; ++i)
-    {
-        aPalette[i].r = FinishUnquantize(
-            (unqEndPts.A.r * (BC67_WEIGHT_MAX - aWeights[i]) + unqEndPts.B.r * aWeights[i] + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT,
-            pEP->bSigned);
-        aPalette[i].g = FinishUnquantize(
-            (unqEndPts.A.g * (BC67_WEIGHT_MAX - aWeights[i]) + unqEndPts.B.g * aWeights[i] + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT,
-            pEP->bSigned);
-        aPalette[i].b = FinishUnquantize(
-            (unqEndPts.A.b * (BC67_WEIGHT_MAX - aWeights[i]) + unqEndPts.B.b * aWeights[i] + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT,
-            pEP->bSigned);
-    }
+    BuildPaletteBC6H(unqEndPts, ms_aInfo[pEP->uMode].uIndexPrec, true, pEP->bSigned, palette);
 }
 
 
@@ -2044,34 +2829,14 @@ _Use_decl_annotations_
 float D3DX_BC6H::MapColorsQuantized(const EncodeParams* pEP, const INTColor aColors[], size_t np, const INTEndPntPair &endPts) const noexcept
 {
     assert(pEP);
-    assert(pEP->uMode < c_NumModes);
-    _Analysis_assume_(pEP->uMode < c_NumModes);
 
-    const uint8_t uIndexPrec = ms_aInfo[pEP->uMode].uIndexPrec;
-    const auto uNumIndices = static_cast<const uint8_t>(1u << uIndexPrec);
-    INTColor aPalette[BC6H_MAX_INDICES];
-    GeneratePaletteQuantized(pEP, endPts, aPalette);
+    BC6HPalette palette;
+    GeneratePaletteQuantized(pEP, endPts, palette);
 
     float fTotErr = 0;
     for (size_t i = 0; i < np; ++i)
     {
-        const XMVECTOR vcolors = XMLoadSInt4(reinterpret_cast<const XMINT4*>(&aColors[i]));
-
-        // Compute ErrorMetricRGB
-        XMVECTOR tpal = XMLoadSInt4(reinterpret_cast<const XMINT4*>(&aPalette[0]));
-        tpal = XMVectorSubtract(vcolors, tpal);
-        float fBestErr = XMVectorGetX(XMVector3Dot(tpal, tpal));
-
-        for (int j = 1; j < uNumIndices && fBestErr > 0; ++j)
-        {
-            // Compute ErrorMetricRGB
-            tpal = XMLoadSInt4(reinterpret_cast<const XMINT4*>(&aPalette[j]));
-            tpal = XMVectorSubtract(vcolors, tpal);
-            const float fErr = XMVectorGetX(XMVector3Dot(tpal, tpal));
-            if (fErr > fBestErr) break;     // error increased, so we're done searching
-            if (fErr < fBestErr) fBestErr = fErr;
-        }
-        fTotErr += fBestErr;
+        fTotErr += FindNearestBC6H(palette, aColors[i], nullptr);
     }
     return fTotErr;
 }
@@ -2204,18 +2969,16 @@ void D3DX_BC6H::OptimizeEndPoints(const EncodeParams* pEP, const float aOrgErr[]
     const uint8_t uPartitions = ms_aInfo[pEP->uMode].uPartitions;
     assert(uPartitions < BC6H_MAX_REGIONS);
     _Analysis_assume_(uPartitions < BC6H_MAX_REGIONS);
+    const PartitionSubsets& subsets = g_PartitionSubsets.aShapes[uPartitions][pEP->uShape];
     INTColor aPixels[NUM_PIXELS_PER_BLOCK];
 
     for (size_t p = 0; p <= uPartitions; ++p)
     {
         // collect the pixels in the region
-        size_t np = 0;
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        const size_t np = subsets.uCount[p];
+        for (size_t i = 0; i < np; ++i)
         {
-            if (g_aPartitionTable[p][pEP->uShape][i] == p)
-            {
-                aPixels[np++] = pEP->aIPixels[i];
-            }
+            aPixels[i] = pEP->aIPixels[subsets.aIndex[p][i]];
         }
 
         OptimizeOne(pEP, aPixels, np, aOrgErr[p], aOrgEndPts[p], aOptEndPts[p]);
@@ -2264,13 +3027,12 @@ void D3DX_BC6H::AssignIndices(const EncodeParams* pEP, const INTEndPntPair aEndP
     _Analysis_assume_(pEP->uMode < c_NumModes);
 
     const uint8_t uPartitions = ms_aInfo[pEP->uMode].uPartitions;
-    const auto uNumIndices = static_cast<const uint8_t>(1u << ms_aInfo[pEP->uMode].uIndexPrec);
 
     assert(uPartitions < BC6H_MAX_REGIONS && pEP->uShape < BC6H_MAX_SHAPES);
     _Analysis_assume_(uPartitions < BC6H_MAX_REGIONS && pEP->uShape < BC6H_MAX_SHAPES);
 
     // build list of possibles
-    INTColor aPalette[BC6H_MAX_REGIONS][BC6H_MAX_INDICES];
+    BC6HPalette aPalette[BC6H_MAX_REGIONS];
 
     for (size_t p = 0; p <= uPartitions; ++p)
     {
@@ -2283,20 +3045,7 @@ void D3DX_BC6H::AssignIndices(const EncodeParams* pEP, const INTEndPntPair aEndP
         const uint8_t uRegion = g_aPartitionTable[uPartitions][pEP->uShape][i];
         assert(uRegion < BC6H_MAX_REGIONS);
         _Analysis_assume_(uRegion < BC6H_MAX_REGIONS);
-        float fBestErr = Norm(pEP->aIPixels[i], aPalette[uRegion][0]);
-        aIndices[i] = 0;
-
-        for (uint8_t j = 1; j < uNumIndices && fBestErr > 0; ++j)
-        {
-            const float fErr = Norm(pEP->aIPixels[i], aPalette[uRegion][j]);
-            if (fErr > fBestErr) break;	// error increased, so we're done searching
-            if (fErr < fBestErr)
-            {
-                fBestErr = fErr;
-                aIndices[i] = j;
-            }
-        }
-        aTotErr[uRegion] += fBestErr;
+        aTotErr[uRegion] += FindNearestBC6H(aPalette[uRegion], pEP->aIPixels[i], &aIndices[i]);
     }
 }
 
@@ -2427,7 +3176,7 @@ void D3DX_BC6H::Refine(EncodeParams* pEP) noexcept
 
 
 _Use_decl_annotations_
-void D3DX_BC6H::GeneratePaletteUnquantized(const EncodeParams* pEP, size_t uRegion, INTColor aPalette[]) noexcept
+void D3DX_BC6H::GeneratePaletteUnquantized(const EncodeParams* pEP, size_t uRegion, BC6HPalette& palette) noexcept
 {
     assert(pEP);
     assert(uRegion < BC6H_MAX_REGIONS && pEP->uShape < BC6H_MAX_SHAPES);
@@ -2435,59 +3184,22 @@ void D3DX_BC6H::GeneratePaletteUnquantized(const EncodeParams* pEP, size_t uRegi
     assert(pEP->uMode < c_NumModes);
     _Analysis_assume_(pEP->uMode < c_NumModes);
 
-    const INTEndPntPair& endPts = pEP->aUnqEndPts[pEP->uShape][uRegion];
-    const uint8_t uIndexPrec = ms_aInfo[pEP->uMode].uIndexPrec;
-    const auto uNumIndices = static_cast<const uint8_t>(1u << uIndexPrec);
-    assert(uNumIndices > 0);
-    _Analysis_assume_(uNumIndices > 0);
-
-    const int* aWeights = nullptr;
-    switch (uIndexPrec)
-    {
-    case 3: aWeights = g_aWeights3; assert(uNumIndices <= 8); _Analysis_assume_(uNumIndices <= 8); break;
-    case 4: aWeights = g_aWeights4; assert(uNumIndices <= 16); _Analysis_assume_(uNumIndices <= 16); break;
-    default:
-        assert(false);
-        for (size_t i = 0; i < uNumIndices; ++i)
-        {
-        #pragma prefast(suppress:22102 22103, "writing blocks in two halves confuses tool")
-            aPalette[i] = INTColor(0, 0, 0);
-        }
-        return;
-    }
-
-    for (size_t i = 0; i < uNumIndices; ++i)
-    {
-        aPalette[i].r = (endPts.A.r * (BC67_WEIGHT_MAX - aWeights[i]) + endPts.B.r * aWeights[i] + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT;
-        aPalette[i].g = (endPts.A.g * (BC67_WEIGHT_MAX - aWeights[i]) + endPts.B.g * aWeights[i] + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT;
-        aPalette[i].b = (endPts.A.b * (BC67_WEIGHT_MAX - aWeights[i]) + endPts.B.b * aWeights[i] + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT;
-    }
+    BuildPaletteBC6H(pEP->aUnqEndPts[pEP->uShape][uRegion], ms_aInfo[pEP->uMode].uIndexPrec, false, pEP->bSigned, palette);
 }
 
 
 _Use_decl_annotations_
-float D3DX_BC6H::MapColors(const EncodeParams* pEP, size_t uRegion, size_t np, const size_t* auIndex) const noexcept
+float D3DX_BC6H::MapColors(const EncodeParams* pEP, size_t uRegion, size_t np, const uint8_t* auIndex) const noexcept
 {
     assert(pEP);
-    assert(pEP->uMode < c_NumModes);
-    _Analysis_assume_(pEP->uMode < c_NumModes);
 
-    const uint8_t uIndexPrec = ms_aInfo[pEP->uMode].uIndexPrec;
-    const auto uNumIndices = static_cast<const uint8_t>(1u << uIndexPrec);
-    INTColor aPalette[BC6H_MAX_INDICES];
-    GeneratePaletteUnquantized(pEP, uRegion, aPalette);
+    BC6HPalette palette;
+    GeneratePaletteUnquantized(pEP, uRegion, palette);
 
     float fTotalErr = 0.0f;
     for (size_t i = 0; i < np; ++i)
     {
-        float fBestErr = Norm(pEP->aIPixels[auIndex[i]], aPalette[0]);
-        for (uint8_t j = 1; j < uNumIndices && fBestErr > 0.0f; ++j)
-        {
-            const float fErr = Norm(pEP->aIPixels[auIndex[i]], aPalette[j]);
-            if (fErr > fBestErr) break;      // error increased, so we're done searching
-            if (fErr < fBestErr) fBestErr = fErr;
-        }
-        fTotalErr += fBestErr;
+        fTotalErr += FindNearestBC6H(palette, pEP->aIPixels[auIndex[i]], nullptr);
     }
 
     return fTotalErr;
@@ -2508,19 +3220,13 @@ float D3DX_BC6H::RoughMSE(EncodeParams* pEP) const noexcept
     assert(uPartitions < BC6H_MAX_REGIONS);
     _Analysis_assume_(uPartitions < BC6H_MAX_REGIONS);
 
-    size_t auPixIdx[NUM_PIXELS_PER_BLOCK];
+    const PartitionSubsets& subsets = g_PartitionSubsets.aShapes[uPartitions][pEP->uShape];
 
     float fError = 0.0f;
     for (size_t p = 0; p <= uPartitions; ++p)
     {
-        size_t np = 0;
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-        {
-            if (g_aPartitionTable[uPartitions][pEP->uShape][i] == p)
-            {
-                auPixIdx[np++] = i;
-            }
-        }
+        const size_t np = subsets.uCount[p];
+        const uint8_t* auPixIdx = subsets.aIndex[p];
 
         // handle simple cases
         assert(np > 0);
@@ -2537,8 +3243,11 @@ float D3DX_BC6H::RoughMSE(EncodeParams* pEP) const noexcept
             continue;
         }
 
+        SubsetMoments moments;
+        pEP->moments.GetSubset(subsets.uMask[p], np, moments);
+
         HDRColorA epA, epB;
-        OptimizeRGB(pEP->aHDRPixels, &epA, &epB, 4, np, auPixIdx);
+        OptimizeRGB(pEP->aHDRPixels, &epA, &epB, 4, np, auPixIdx, moments, pEP->fit);
         aEndPts[p].A.Set(epA, pEP->bSigned);
         aEndPts[p].B.Set(epB, pEP->bSigned);
         if (pEP->bSigned)
@@ -2780,12 +3489,32 @@ void D3DX_BC7::Decode(HDRColorA* pOut) const noexcept
 }
 
 _Use_decl_annotations_
-void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
+void D3DX_BC7::GetBlockInfo(uint8_t& mode, uint8_t& partition, uint8_t& rotation) const noexcept
+{
+    mode = 0xFF;
+    partition = 0;
+    rotation = 0;
+
+    size_t uFirst = 0;
+    while (uFirst < 128 && !GetBit(uFirst)) {}
+    const uint8_t uMode = uint8_t(uFirst - 1);
+
+    if (uMode < 8)
+    {
+        size_t uStartBit = size_t(uMode) + 1;
+        mode = uMode;
+        partition = GetBits(uStartBit, ms_aInfo[uMode].uPartitionBits);
+        rotation = GetBits(uStartBit, ms_aInfo[uMode].uRotationBits);
+    }
+}
+
+_Use_decl_annotations_
+float D3DX_BC7::Encode(uint32_t flags, float targetError, const HDRColorA* const pIn) noexcept
 {
     assert(pIn);
 
     D3DX_BC7 final = *this;
-    EncodeParams EP(pIn);
+    EncodeParams EP(pIn, GetEndPointFit(flags));
     float fMSEBest = FLT_MAX;
     uint32_t alphaMask = 0xFF;
 
@@ -2800,15 +3529,21 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
 
     const bool bHasAlpha = (alphaMask != 0xFF);
 
-    for (EP.uMode = 0; EP.uMode < 8 && fMSEBest > 0; ++EP.uMode)
+    // The target is a per channel MSE on [0,1], the block error sums 4 channels of 16 pixels on [0,255]
+    const float fErrScale = 255.0f * 255.0f * float(4 * NUM_PIXELS_PER_BLOCK);
+    const float fTargetErr = std::max(0.0f, targetError) * fErrScale;
+
+    for (size_t m = 0; m < c_NumModes && fMSEBest > fTargetErr; ++m)
     {
+        EP.uMode = (fTargetErr > 0) ? ms_aTargetModeOrder[m] : static_cast<uint8_t>(m);
+
         if (!(flags & BC_FLAGS_USE_3SUBSETS) && (EP.uMode == 0 || EP.uMode == 2))
         {
             // 3 subset modes tend to be used rarely and add significant compression time
             continue;
         }
 
-        if ((flags & TEX_COMPRESS_BC7_QUICK) && (EP.uMode != 6))
+        if ((flags & BC_FLAGS_FORCE_BC7_MODE6) && (EP.uMode != 6))
         {
             // Use only mode 6
             continue;
@@ -2832,8 +3567,10 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
         float afRoughMSE[BC7_MAX_SHAPES];
         size_t auShape[BC7_MAX_SHAPES];
 
-        for (size_t r = 0; r < uNumRots && fMSEBest > 0; ++r)
+        for (size_t r = 0; r < uNumRots && fMSEBest > fTargetErr; ++r)
         {
+            EP.pMetric = (flags & BC_FLAGS_YCOCG_METRIC) ? &g_aYCoCgMetric[r] : nullptr;
+
             switch (r)
             {
             case 1: for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; i++) std::swap(EP.aLDRPixels[i].r, EP.aLDRPixels[i].a); break;
@@ -2842,7 +3579,7 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
             default: break;
             }
 
-            for (size_t im = 0; im < uNumIdxMode && fMSEBest > 0; ++im)
+            for (size_t im = 0; im < uNumIdxMode && fMSEBest > fTargetErr; ++im)
             {
                 // pick the best uItems shapes and refine these.
                 for (size_t s = 0; s < uShapes; s++)
@@ -2864,7 +3601,7 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
                     }
                 }
 
-                for (size_t i = 0; i < uItems && fMSEBest > 0; i++)
+                for (size_t i = 0; i < uItems && fMSEBest > fTargetErr; i++)
                 {
                     const float fMSE = Refine(&EP, auShape[i], r, im);
                     if (fMSE < fMSEBest)
@@ -2886,6 +3623,8 @@ void D3DX_BC7::Encode(uint32_t flags, const HDRColorA* const pIn) noexcept
     }
 
     *this = final;
+
+    return fMSEBest / fErrScale;
 }
 
 
@@ -3121,15 +3860,15 @@ void D3DX_BC7::OptimizeEndPoints(const EncodeParams* pEP, size_t uShape, size_t
     assert(uPartitions < BC7_MAX_REGIONS && uShape < BC7_MAX_SHAPES);
     _Analysis_assume_(uPartitions < BC7_MAX_REGIONS && uShape < BC7_MAX_SHAPES);
 
+    const PartitionSubsets& subsets = g_PartitionSubsets.aShapes[uPartitions][uShape];
     LDRColorA aPixels[NUM_PIXELS_PER_BLOCK];
 
     for (size_t p = 0; p <= uPartitions; ++p)
     {
         // collect the pixels in the region
-        size_t np = 0;
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-            if (g_aPartitionTable[uPartitions][uShape][i] == p)
-                aPixels[np++] = pEP->aLDRPixels[i];
+        const size_t np = subsets.uCount[p];
+        for (size_t i = 0; i < np; ++i)
+            aPixels[i] = pEP->aLDRPixels[subsets.aIndex[p][i]];
 
         OptimizeOne(pEP, aPixels, np, uIndexMode, afOrgErr[p], aOrgEndPts[p], aOptEndPts[p]);
     }
@@ -3173,7 +3912,7 @@ void D3DX_BC7::AssignIndices(const EncodeParams* pEP, size_t uShape, size_t uInd
         uint8_t uRegion = g_aPartitionTable[uPartitions][uShape][i];
         assert(uRegion < BC7_MAX_REGIONS);
         _Analysis_assume_(uRegion < BC7_MAX_REGIONS);
-        afTotErr[uRegion] += ComputeError(pEP->aLDRPixels[i], aPalette[uRegion], uIndexPrec, uIndexPrec2, &(aIndices[i]), &(aIndices2[i]));
+        afTotErr[uRegion] += ComputeError(pEP->aLDRPixels[i], aPalette[uRegion], uIndexPrec, uIndexPrec2, pEP->pMetric, &(aIndices[i]), &(aIndices2[i]));
     }
 
     // swap endpoints as needed to ensure that the indices at index_positions have a 0 high-order bit
@@ -3477,7 +4216,7 @@ float D3DX_BC7::MapColors(const EncodeParams* pEP, const LDRColorA aColors[], si
     GeneratePaletteQuantized(pEP, uIndexMode, endPts, aPalette);
     for (size_t i = 0; i < np; ++i)
     {
-        fTotalErr += ComputeError(aColors[i], aPalette, uIndexPrec, uIndexPrec2);
+        fTotalErr += ComputeError(aColors[i], aPalette, uIndexPrec, uIndexPrec2, pEP->pMetric);
         if (fTotalErr > fMinErr)   // check for early exit
         {
             fTotalErr = FLT_MAX;
@@ -3507,19 +4246,13 @@ float D3DX_BC7::RoughMSE(EncodeParams* pEP, size_t uShape, size_t uIndexMode) no
     const uint8_t uIndexPrec2 = uIndexMode ? ms_aInfo[pEP->uMode].uIndexPrec : ms_aInfo[pEP->uMode].uIndexPrec2;
     const auto uNumIndices = static_cast<const uint8_t>(1u << uIndexPrec);
     const auto uNumIndices2 = static_cast<const uint8_t>(1u << uIndexPrec2);
-    size_t auPixIdx[NUM_PIXELS_PER_BLOCK];
+    const PartitionSubsets& subsets = g_PartitionSubsets.aShapes[uPartitions][uShape];
     LDRColorA aPalette[BC7_MAX_REGIONS][BC7_MAX_INDICES];
 
     for (size_t p = 0; p <= uPartitions; p++)
     {
-        size_t np = 0;
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; i++)
-        {
-            if (g_aPartitionTable[uPartitions][uShape][i] == p)
-            {
-                auPixIdx[np++] = i;
-            }
-        }
+        const size_t np = subsets.uCount[p];
+        const uint8_t* auPixIdx = subsets.aIndex[p];
 
         // handle simple cases
         assert(np > 0);
@@ -3536,10 +4269,13 @@ float D3DX_BC7::RoughMSE(EncodeParams* pEP, size_t uShape, size_t uIndexMode) no
             continue;
         }
 
+        SubsetMoments moments;
+        pEP->moments.GetSubset(subsets.uMask[p], np, moments);
+
         if (uIndexPrec2 == 0)
         {
             HDRColorA epA, epB;
-            OptimizeRGBA(pEP->aHDRPixels, &epA, &epB, 4, np, auPixIdx);
+            OptimizeRGBA(pEP->aHDRPixels, &epA, &epB, 4, np, auPixIdx, moments, pEP->fit);
             epA.Clamp(0.0f, 1.0f);
             epB.Clamp(0.0f, 1.0f);
             epA *= 255.0f;
@@ -3550,14 +4286,14 @@ float D3DX_BC7::RoughMSE(EncodeParams* pEP, size_t uShape, size_t uIndexMode) no
         else
         {
             uint8_t uMinAlpha = 255, uMaxAlpha = 0;
-            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            for (size_t i = 0; i < np; ++i)
             {
                 uMinAlpha = std::min<uint8_t>(uMinAlpha, pEP->aLDRPixels[auPixIdx[i]].a);
                 uMaxAlpha = std::max<uint8_t>(uMaxAlpha, pEP->aLDRPixels[auPixIdx[i]].a);
             }
 
             HDRColorA epA, epB;
-            OptimizeRGB(pEP->aHDRPixels, &epA, &epB, 4, np, auPixIdx);
+            OptimizeRGB(pEP->aHDRPixels, &epA, &epB, 4, np, auPixIdx, moments, pEP->fit);
             epA.Clamp(0.0f, 1.0f);
             epB.Clamp(0.0f, 1.0f);
             epA *= 255.0f;
@@ -3590,7 +4326,7 @@ float D3DX_BC7::RoughMSE(EncodeParams* pEP, size_t uShape, size_t uIndexMode) no
     for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; i++)
     {
         const uint8_t uRegion = g_aPartitionTable[uPartitions][uShape][i];
-        fTotalErr += ComputeError(pEP->aLDRPixels[i], aPalette[uRegion], uIndexPrec, uIndexPrec2);
+        fTotalErr += ComputeError(pEP->aLDRPixels[i], aPalette[uRegion], uIndexPrec, uIndexPrec2, pEP->pMetric);
     }
 
     return fTotalErr;
@@ -3620,22 +4356,338 @@ void DirectX::D3DXDecodeBC6HS(XMVECTOR *pColor, const uint8_t *pBC) noexcept
     reinterpret_cast<const D3DX_BC6H*>(pBC)->Decode(true, reinterpret_cast<HDRColorA*>(pColor));
 }
 
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC6HUF16(XMHALF4 *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
+    reinterpret_cast<const D3DX_BC6H*>(pBC)->DecodeF16(false, pColor);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC6HSF16(XMHALF4 *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
+    reinterpret_cast<const D3DX_BC6H*>(pBC)->DecodeF16(true, pColor);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC6HUF16Batch(XMHALF4 *pColor, const uint8_t *pBC, size_t count) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
+    D3DX_BC6H::DecodeF16Batch(false, reinterpret_cast<const D3DX_BC6H*>(pBC), count, pColor);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC6HSF16Batch(XMHALF4 *pColor, const uint8_t *pBC, size_t count) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
+    D3DX_BC6H::DecodeF16Batch(true, reinterpret_cast<const D3DX_BC6H*>(pBC), count, pColor);
+}
+
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC6HU(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
-    UNREFERENCED_PARAMETER(flags);
+    D3DXEncodeBC6HU(pBC, pColor, 0.0f, flags);
+}
+
+_Use_decl_annotations_
+float DirectX::D3DXEncodeBC6HU(uint8_t *pBC, const XMVECTOR *pColor, float targetError, uint32_t flags) noexcept
+{
     assert(pBC && pColor);
     static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
-    reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(false, reinterpret_cast<const HDRColorA*>(pColor));
+    return reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(false, reinterpret_cast<const HDRColorA*>(pColor), targetError, flags);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXGetBC6HBlockInfo(const uint8_t *pBC, uint8_t& mode, uint8_t& partition) noexcept
+{
+    assert(pBC);
+    static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
+    reinterpret_cast<const D3DX_BC6H*>(pBC)->GetBlockInfo(mode, partition);
 }
 
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC6HS(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
-    UNREFERENCED_PARAMETER(flags);
+    D3DXEncodeBC6HS(pBC, pColor, 0.0f, flags);
+}
+
+_Use_decl_annotations_
+float DirectX::D3DXEncodeBC6HS(uint8_t *pBC, const XMVECTOR *pColor, float targetError, uint32_t flags) noexcept
+{
     assert(pBC && pColor);
     static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
-    reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(true, reinterpret_cast<const HDRColorA*>(pColor));
+    return reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(true, reinterpret_cast<const HDRColorA*>(pColor), targetError, flags);
+}
+
+
+//-------------------------------------------------------------------------------------
+// BC7 integer decoding
+//-------------------------------------------------------------------------------------
+namespace
+{
+    // Reads consecutive fields from a BC7 block held as two little-endian 64-bit words
+    class BC7BitReader
+    {
+    public:
+        explicit BC7BitReader(_In_reads_(16) const uint8_t* pBC) noexcept : m_uStart(0)
+        {
+            memcpy(&m_uLo, pBC, sizeof(uint64_t));
+            memcpy(&m_uHi, pBC + sizeof(uint64_t), sizeof(uint64_t));
+        }
+
+        uint32_t Read(_In_ size_t uNumBits) noexcept
+        {
+            if (uNumBits == 0) return 0;
+            assert(uNumBits <= 8 && m_uStart + uNumBits <= 128);
+            _Analysis_assume_(uNumBits <= 8 && m_uStart + uNumBits <= 128);
+
+            uint64_t v;
+            if (m_uStart >= 64)
+                v = m_uHi >> (m_uStart - 64);
+            else if (m_uStart == 0)
+                v = m_uLo;
+            else
+                v = (m_uLo >> m_uStart) | (m_uHi << (64 - m_uStart));
+
+            m_uStart += uNumBits;
+            return static_cast<uint32_t>(v & ((uint64_t(1) << uNumBits) - 1));
+        }
+
+    private:
+        uint64_t m_uLo;
+        uint64_t m_uHi;
+        size_t m_uStart;
+    };
+
+    struct BC7ModeLayout
+    {
+        uint8_t uSubsets;
+        uint8_t uPartitionBits;
+        uint8_t uRotationBits;
+        uint8_t uIndexModeBits;
+        uint8_t uColorBits;
+        uint8_t uAlphaBits;
+        uint8_t uEndPointPBits;
+        uint8_t uSharedPBits;
+        uint8_t uIndexPrec;
+        uint8_t uIndexPrec2;
+    };
+
+    // Field widths of each mode, matching D3DX_BC7::ms_aInfo
+    constexpr BC7ModeLayout g_aBC7Layout[8] =
+    {
+        { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+        { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+        { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+        { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+        { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+        { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+        { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+        { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+    };
+
+    inline uint32_t ExpandBC7EndPoint(uint32_t v, size_t uPrec) noexcept
+    {
+        v <<= (8u - uPrec);
+        return v | (v >> uPrec);
+    }
+
+    inline const int* GetBC7Weights(size_t uIndexPrec) noexcept
+    {
+        return (uIndexPrec == 2) ? g_aWeights2 : (uIndexPrec == 3) ? g_aWeights3 : g_aWeights4;
+    }
+
+    // Decodes a block of the given mode to 16 RGBA8 texels, the field widths are compile time
+    // constants so the loops below unroll for each mode
+    template<size_t Mode>
+    void DecodeBC7ModeRGBA8(BC7BitReader& bits, _Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t* pColor) noexcept
+    {
+        constexpr BC7ModeLayout layout = g_aBC7Layout[Mode];
+        constexpr size_t uSubsets = layout.uSubsets;
+        constexpr size_t uNumEndPts = uSubsets * 2;
+        constexpr size_t uPBit = (layout.uEndPointPBits || layout.uSharedPBits) ? 1u : 0u;
+
+        const size_t uShape = bits.Read(layout.uPartitionBits);
+        const size_t uRotation = bits.Read(layout.uRotationBits);
+        const size_t uIndexMode = bits.Read(layout.uIndexModeBits);
+
+        uint32_t aEndPts[uNumEndPts][4];
+        for (size_t ch = 0; ch < 3; ++ch)
+        {
+            for (size_t i = 0; i < uNumEndPts; ++i)
+            {
+                aEndPts[i][ch] = bits.Read(layout.uColorBits);
+            }
+        }
+
+        for (size_t i = 0; i < uNumEndPts; ++i)
+        {
+            aEndPts[i][3] = bits.Read(layout.uAlphaBits);
+        }
+
+        if (uPBit)
+        {
+            uint32_t aPBits[uNumEndPts];
+            if (layout.uEndPointPBits)
+            {
+                for (size_t i = 0; i < uNumEndPts; ++i)
+                {
+                    aPBits[i] = bits.Read(1);
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < uNumEndPts; i += 2)
+                {
+                    aPBits[i] = aPBits[i + 1] = bits.Read(1);
+                }
+            }
+
+            for (size_t i = 0; i < uNumEndPts; ++i)
+            {
+                for (size_t ch = 0; ch < 4; ++ch)
+                {
+                    aEndPts[i][ch] = (aEndPts[i][ch] << 1) | aPBits[i];
+                }
+            }
+        }
+
+        for (size_t i = 0; i < uNumEndPts; ++i)
+        {
+            for (size_t ch = 0; ch < 3; ++ch)
+            {
+                aEndPts[i][ch] = ExpandBC7EndPoint(aEndPts[i][ch], layout.uColorBits + uPBit);
+            }
+
+            aEndPts[i][3] = layout.uAlphaBits ? ExpandBC7EndPoint(aEndPts[i][3], layout.uAlphaBits + uPBit) : 255u;
+        }
+
+        // Indices, the anchor index of each subset has its top bit implied
+        const uint8_t* pPartition = g_aPartitionTable[uSubsets - 1][uShape];
+        const size_t uAnchor1 = (uSubsets > 1) ? g_aFixUp[uSubsets - 1][uShape][1] : 0;
+        const size_t uAnchor2 = (uSubsets > 2) ? g_aFixUp[uSubsets - 1][uShape][2] : 0;
+
+        uint8_t aIndices[NUM_PIXELS_PER_BLOCK];
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const bool bAnchor = (i == 0) || (uSubsets > 1 && i == uAnchor1) || (uSubsets > 2 && i == uAnchor2);
+            aIndices[i] = static_cast<uint8_t>(bits.Read(bAnchor ? layout.uIndexPrec - 1u : layout.uIndexPrec));
+        }
+
+        uint8_t aIndices2[NUM_PIXELS_PER_BLOCK] = {};
+        if (layout.uIndexPrec2)
+        {
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                aIndices2[i] = static_cast<uint8_t>(bits.Read(i ? layout.uIndexPrec2 : layout.uIndexPrec2 - 1u));
+            }
+        }
+
+        // The index mode bit swaps which index set drives color and alpha
+        const uint8_t* pColorIndices = (layout.uIndexPrec2 && uIndexMode) ? aIndices2 : aIndices;
+        const uint8_t* pAlphaIndices = layout.uIndexPrec2 ? (uIndexMode ? aIndices : aIndices2) : aIndices;
+        const size_t uColorPrec = (layout.uIndexPrec2 && uIndexMode) ? layout.uIndexPrec2 : layout.uIndexPrec;
+        const size_t uAlphaPrec = layout.uIndexPrec2 ? (uIndexMode ? layout.uIndexPrec : layout.uIndexPrec2) : layout.uIndexPrec;
+
+        // Palettes of packed RGBA8 values, color and alpha are or'ed together per texel
+        uint32_t aColorPalette[uSubsets][16];
+        uint32_t aAlphaPalette[uSubsets][16];
+        const int* aColorWeights = GetBC7Weights(uColorPrec);
+        const int* aAlphaWeights = GetBC7Weights(uAlphaPrec);
+        const size_t uRotByte = uRotation ? (uRotation - 1) * 8 : 24;
+
+        for (size_t s = 0; s < uSubsets; ++s)
+        {
+            const uint32_t* e0 = aEndPts[s * 2];
+            const uint32_t* e1 = aEndPts[s * 2 + 1];
+
+            for (size_t w = 0; w < (size_t(1) << uColorPrec); ++w)
+            {
+                const uint32_t w1 = uint32_t(aColorWeights[w]);
+                const uint32_t w0 = uint32_t(BC67_WEIGHT_MAX) - w1;
+                uint32_t c[4];
+                for (size_t ch = 0; ch < 3; ++ch)
+                {
+                    c[ch] = (e0[ch] * w0 + e1[ch] * w1 + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT;
+                }
+                c[3] = 0;
+                if (uRotation)
+                {
+                    // The rotated color channel moves to alpha
+                    std::swap(c[uRotation - 1], c[3]);
+                }
+                aColorPalette[s][w] = c[0] | (c[1] << 8) | (c[2] << 16) | (c[3] << 24);
+            }
+
+            for (size_t w = 0; w < (size_t(1) << uAlphaPrec); ++w)
+            {
+                const uint32_t w1 = uint32_t(aAlphaWeights[w]);
+                const uint32_t w0 = uint32_t(BC67_WEIGHT_MAX) - w1;
+                const uint32_t a = (e0[3] * w0 + e1[3] * w1 + BC67_WEIGHT_ROUND) >> BC67_WEIGHT_SHIFT;
+                aAlphaPalette[s][w] = a << uRotByte;
+            }
+        }
+
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const size_t s = (uSubsets > 1) ? pPartition[i] : 0;
+            pColor[i] = aColorPalette[s][pColorIndices[i]] | aAlphaPalette[s][pAlphaIndices[i]];
+        }
+    }
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC7RGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+
+    BC7BitReader bits(pBC);
+
+    // Modes 6 and 1 are the most common in encoded files, so they are tested first
+    const uint32_t uModeBits = pBC[0];
+    if ((uModeBits & 0x7F) == 0x40)
+    {
+        bits.Read(7);
+        DecodeBC7ModeRGBA8<6>(bits, pColor);
+        return;
+    }
+
+    if ((uModeBits & 0x03) == 0x02)
+    {
+        bits.Read(2);
+        DecodeBC7ModeRGBA8<1>(bits, pColor);
+        return;
+    }
+
+    size_t uMode = 0;
+    while (uMode < 8 && !(uModeBits & (1u << uMode)))
+    {
+        ++uMode;
+    }
+
+    if (uMode >= 8)
+    {
+        // Reserved mode, matches D3DX_BC7::Decode
+        memset(pColor, 0, sizeof(uint32_t) * NUM_PIXELS_PER_BLOCK);
+        return;
+    }
+
+    bits.Read(uMode + 1);
+
+    switch (uMode)
+    {
+    case 0: DecodeBC7ModeRGBA8<0>(bits, pColor); break;
+    case 2: DecodeBC7ModeRGBA8<2>(bits, pColor); break;
+    case 3: DecodeBC7ModeRGBA8<3>(bits, pColor); break;
+    case 4: DecodeBC7ModeRGBA8<4>(bits, pColor); break;
+    case 5: DecodeBC7ModeRGBA8<5>(bits, pColor); break;
+    default: DecodeBC7ModeRGBA8<7>(bits, pColor); break;
+    }
 }
 
 
@@ -3652,8 +4704,22 @@ void DirectX::D3DXDecodeBC7(XMVECTOR *pColor, const uint8_t *pBC) noexcept
 
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC7(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
+    D3DXEncodeBC7(pBC, pColor, 0.0f, flags);
+}
+
+_Use_decl_annotations_
+float DirectX::D3DXEncodeBC7(uint8_t *pBC, const XMVECTOR *pColor, float targetError, uint32_t flags) noexcept
 {
     assert(pBC && pColor);
     static_assert(sizeof(D3DX_BC7) == 16, "D3DX_BC7 should be 16 bytes");
-    reinterpret_cast<D3DX_BC7*>(pBC)->Encode(flags, reinterpret_cast<const HDRColorA*>(pColor));
+    return reinterpret_cast<D3DX_BC7*>(pBC)->Encode(flags, targetError, reinterpret_cast<const HDRColorA*>(pColor));
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXGetBC7BlockInfo(const uint8_t *pBC, uint8_t& mode, uint8_t& partition, uint8_t& rotation) noexcept
+{
+    assert(pBC);
+    static_assert(sizeof(D3DX_BC7) == 16, "D3DX_BC7 should be 16 bytes");
+    reinterpret_cast<const D3DX_BC7*>(pBC)->GetBlockInfo(mode, partition, rotation);
 }
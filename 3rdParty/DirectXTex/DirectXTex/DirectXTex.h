@@ -429,16 +429,74 @@ namespace DirectX
         uint8_t*    pixels;
     };
 
+    //---------------------------------------------------------------------------------
+    // Optional allocator for ScratchImage pixel memory, used to recycle buffers between
+    // images. The allocator must outlive every ScratchImage that uses it.
+    class IScratchImageAllocator
+    {
+    public:
+        virtual void* __cdecl Allocate(_In_ size_t size, _In_ size_t alignment) noexcept = 0;
+        virtual void __cdecl Free(_In_opt_ void* ptr, _In_ size_t size) noexcept = 0;
+
+        virtual bool __cdecl IsZeroInitialized(_In_ size_t /*size*/) const noexcept { return false; }
+            // Return true if Allocate returns zero-filled memory for this size, which lets
+            // ScratchImage skip clearing it
+
+    protected:
+        ~IScratchImageAllocator() = default;
+    };
+
+    enum TEX_ALLOC_FLAGS : uint32_t
+    {
+        TEX_ALLOC_DEFAULT = 0,
+
+        TEX_ALLOC_TRANSPARENT_HUGE_PAGES = 0x1,
+        // Ask the kernel to back the allocation with transparent huge pages (madvise, Linux only)
+
+        TEX_ALLOC_LARGE_PAGES = 0x2,
+        // Use explicit 2 MB pages (MAP_HUGETLB or MEM_LARGE_PAGES), falls back to normal pages if none are available
+
+        TEX_ALLOC_FIRST_TOUCH = 0x4,
+        // Leave the pages untouched until the image is written, so that on NUMA systems each page is
+        // placed on the node of the thread that first writes it (e.g. the CompressBC_Parallel worker).
+        // Without it the pages are populated when allocated, after the huge page advice (Linux only)
+    };
+
+    //---------------------------------------------------------------------------------
+    // Allocates large images directly from the OS with the requested page policy,
+    // smaller images use the default heap
+    class DIRECTX_TEX_API PageAllocator final : public IScratchImageAllocator
+    {
+    public:
+        explicit PageAllocator(_In_ TEX_ALLOC_FLAGS flags, _In_ size_t minSize = 2 * 1024 * 1024) noexcept
+            : m_flags(flags), m_minSize(minSize) {}
+
+        void* __cdecl Allocate(_In_ size_t size, _In_ size_t alignment) noexcept override;
+        void __cdecl Free(_In_opt_ void* ptr, _In_ size_t size) noexcept override;
+        bool __cdecl IsZeroInitialized(_In_ size_t size) const noexcept override;
+
+    private:
+        TEX_ALLOC_FLAGS m_flags;
+        size_t          m_minSize;
+    };
+
+    DIRECTX_TEX_API void __cdecl ReleaseScanlineCaches() noexcept;
+        // Frees the scanline buffers that the calling thread and the OpenMP worker threads keep for reuse
+
     class DIRECTX_TEX_API ScratchImage
     {
     public:
         ScratchImage() noexcept
-            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr) {}
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr), m_allocator(nullptr), m_memoryAllocator(nullptr) {}
+        explicit ScratchImage(_In_opt_ IScratchImageAllocator* allocator) noexcept
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr), m_allocator(allocator), m_memoryAllocator(nullptr) {}
         ScratchImage(ScratchImage&& moveFrom) noexcept
-            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr) { *this = std::move(moveFrom); }
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr), m_allocator(nullptr), m_memoryAllocator(nullptr) { *this = std::move(moveFrom); }
         ~ScratchImage() { Release(); }
 
         ScratchImage& __cdecl operator= (ScratchImage&& moveFrom) noexcept;
+            // Keeps this image's allocator for later allocations if it has one; the moved pixel memory
+            // is still freed by the allocator that created it
 
         ScratchImage(const ScratchImage&) = delete;
         ScratchImage& operator=(const ScratchImage&) = delete;
@@ -470,12 +528,18 @@ namespace DirectX
 
         bool __cdecl IsAlphaAllOpaque() const noexcept;
 
+        IScratchImageAllocator* __cdecl GetAllocator() const noexcept { return m_allocator; }
+        void __cdecl SetAllocator(_In_opt_ IScratchImageAllocator* allocator) noexcept;
+            // Releases the current image before switching allocators
+
     private:
         size_t      m_nimages;
         size_t      m_size;
         TexMetadata m_metadata;
         Image*      m_image;
         uint8_t*    m_memory;
+        IScratchImageAllocator* m_allocator;
+        IScratchImageAllocator* m_memoryAllocator;
     };
 
     //---------------------------------------------------------------------------------
@@ -516,6 +580,9 @@ namespace DirectX
     //---------------------------------------------------------------------------------
 
     // User-defined I/O callbacks for loading and saving images
+    // LoadFromDDSIOCallbacks may call Read on a worker thread while it decodes the previous chunk.
+    // The callbacks are never called concurrently, and all calls have returned before the load
+    // function does. A failed callback HRESULT is returned unchanged by the load function.
     struct ImageIOCallbacks
     {
         HRESULT(__stdcall *Read)(void* buffer, const DWORD count);
@@ -587,6 +654,13 @@ namespace DirectX
         _Out_opt_ TexMetadata* metadata,
         _Out_opt_ DDSMetaData* ddPixelFormat,
         _Out_ ScratchImage& image);
+    HRESULT __cdecl LoadPreviewFromDDSIOCallbacks(
+        _In_ const ImageIOCallbacks* pIOCallbacks, _In_ DDS_FLAGS flags,
+        _In_ size_t minWidth, _In_ size_t minHeight,
+        _Out_opt_ TexMetadata* metadata,
+        _Out_opt_ DDSMetaData* ddPixelFormat,
+        _Out_ ScratchImage& image);
+        // Reads only the smallest stored mip level of the first item that is at least minWidth by minHeight
 
     DIRECTX_TEX_API HRESULT __cdecl LoadFromDDSMemoryEx(
         _In_reads_bytes_(size) const uint8_t* pSource, _In_ size_t size,
@@ -812,6 +886,17 @@ namespace DirectX
     constexpr float TEX_THRESHOLD_DEFAULT = 0.5f;
         // Default value for alpha threshold used when converting to 1-bit alpha
 
+    struct AlphaStatistics
+    {
+        float minAlpha;
+        float maxAlpha;
+        bool  allOpaque;        // Every alpha value passes the threshold used by ScratchImage::IsAlphaAllOpaque
+        bool  allTransparent;   // Every alpha value is zero
+        bool  oneBit;           // Every alpha value is either zero or fully opaque
+    };
+        // Alpha values of an image as they were passed to the encoder or converter, which
+        // can be used to pick the TEX_ALPHA_MODE of the result without scanning it again.
+
     struct ConvertOptions
     {
         TEX_FILTER_FLAGS filter;
@@ -828,12 +913,20 @@ namespace DirectX
     DIRECTX_TEX_API HRESULT __cdecl ConvertEx(
         _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ const ConvertOptions& options,
         _Out_ ScratchImage& image,
-        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr);
+        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr,
+        _Out_opt_ AlphaStatistics* alphaStats = nullptr);
     DIRECTX_TEX_API HRESULT __cdecl ConvertEx(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ DXGI_FORMAT format, _In_ const ConvertOptions& options, _Out_ ScratchImage& result,
-        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr);
+        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr,
+        _Out_writes_opt_(nimages) AlphaStatistics* alphaStats = nullptr);
         // Convert the image to a new format
+        // If alphaStats is not null it receives the alpha statistics of each image
+
+    DIRECTX_TEX_API HRESULT __cdecl ConvertInPlace(
+        _Inout_ ScratchImage& image, _In_ DXGI_FORMAT format, _In_ TEX_FILTER_FLAGS filter, _In_ float threshold) noexcept;
+        // Convert the image to a new format with the same bits per pixel, reusing the existing pixel memory
+        // The image is released if the conversion fails
 
     DIRECTX_TEX_API HRESULT __cdecl ConvertToSinglePlane(_In_ const Image& srcImage, _Out_ ScratchImage& image) noexcept;
     DIRECTX_TEX_API HRESULT __cdecl ConvertToSinglePlane(
@@ -905,9 +998,17 @@ namespace DirectX
 
         TEX_COMPRESS_BC7_USE_3SUBSETS = 0x80000,
         // Enables exhaustive search for BC7 compress for mode 0 and 2; by default skips trying these modes
+        // Also refines the BC6H/BC7 rough endpoints with Newton's method
 
         TEX_COMPRESS_BC7_QUICK = 0x100000,
-        // Minimal modes (usually mode 6) for BC7 compression
+        // Minimal modes (usually mode 6) for BC7 compression, and modes 10, 11 and 14 for BC6H compression
+        // Also fits BC1-3 color endpoints in closed form rather than by Newton's method
+
+        TEX_COMPRESS_BC45_EXHAUSTIVE = 0x200000,
+        // Exhaustive endpoint search near the block min/max for BC4/BC5 compression; by default refines a least-squares fit
+
+        TEX_COMPRESS_YCOCG_METRIC = 0x400000,
+        // Alpha-aware YCoCg error metric for BC1-3 and BC7 compression, weights chroma below luma
 
         TEX_COMPRESS_SRGB_IN = 0x1000000,
         TEX_COMPRESS_SRGB_OUT = 0x2000000,
@@ -927,6 +1028,12 @@ namespace DirectX
         TEX_COMPRESS_FLAGS flags;
         float              threshold;
         float              alphaWeight;
+        float              targetError;
+            // BC6H/BC7 stop searching modes once a block's mean squared error per channel (on a [0,1] scale)
+            // is at or below targetError, 0 searches every mode
+        float              refineFraction;
+            // BC6H/BC7 encode the image with TEX_COMPRESS_BC7_QUICK first and then re-encode this fraction
+            // of the blocks with the largest errors using the search selected by flags, 0 uses a single pass
     };
 
     DIRECTX_TEX_API HRESULT __cdecl Compress(
@@ -940,11 +1047,18 @@ namespace DirectX
     DIRECTX_TEX_API HRESULT __cdecl CompressEx(
         _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ const CompressOptions& options,
         _Out_ ScratchImage& cImage,
-        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr);
+        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr,
+        _Out_opt_ AlphaStatistics* alphaStats = nullptr,
+        _Out_opt_ ScratchImage* blockErrorMap = nullptr);
     DIRECTX_TEX_API HRESULT __cdecl CompressEx(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ DXGI_FORMAT format, _In_ const CompressOptions& options, _Out_ ScratchImage& cImages,
-        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr);
+        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr,
+        _Out_writes_opt_(nimages) AlphaStatistics* alphaStats = nullptr,
+        _Out_writes_opt_(nimages) ScratchImage* blockErrorMaps = nullptr);
+        // If alphaStats is not null it receives the alpha statistics of each image
+        // If blockErrorMaps is not null each BC6H/BC7 image gets a R32G32B32A32_FLOAT map with one texel per block:
+        //   the mean squared error per channel (the targetError scale), the mode, the partition, and the BC7 rotation
 
 #if defined(__d3d11_h__) || defined(__d3d11_x_h__)
     DIRECTX_TEX_API HRESULT __cdecl Compress(
@@ -958,11 +1072,13 @@ namespace DirectX
     DIRECTX_TEX_API HRESULT __cdecl CompressEx(
         _In_ ID3D11Device* pDevice, _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ const CompressOptions& options,
         _Out_ ScratchImage& image,
-        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr);
+        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr,
+        _Out_opt_ AlphaStatistics* alphaStats = nullptr);
     DIRECTX_TEX_API HRESULT __cdecl CompressEx(
         _In_ ID3D11Device* pDevice, _In_ const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ DXGI_FORMAT format, _In_ const CompressOptions& options, _Out_ ScratchImage& cImages,
-        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr);
+        _In_ std::function<bool __cdecl(size_t, size_t)> statusCallBack = nullptr,
+        _Out_writes_opt_(nimages) AlphaStatistics* alphaStats = nullptr);
 #endif
 
     DIRECTX_TEX_API HRESULT __cdecl Decompress(_In_ const Image& cImage, _In_ DXGI_FORMAT format, _Out_ ScratchImage& image) noexcept;
@@ -1022,6 +1138,17 @@ namespace DirectX
         _In_ const Image& srcImage, _In_ const Rect& srcRect, _In_ const Image& dstImage,
         _In_ TEX_FILTER_FLAGS filter, _In_ size_t xOffset, _In_ size_t yOffset) noexcept;
 
+    DIRECTX_TEX_API HRESULT __cdecl DecompressRegion(
+        _In_ const Image& cImage, _In_ const Rect& rect, _In_ DXGI_FORMAT format, _Out_ ScratchImage& image) noexcept;
+        // Decompresses only the blocks of a BC image covering rect, the result is rect.w by rect.h
+
+    HRESULT __cdecl LoadRegionFromDDSIOCallbacks(
+        _In_ const ImageIOCallbacks* pIOCallbacks, _In_ DDS_FLAGS flags,
+        _In_ const Rect& rect, _In_ DXGI_FORMAT format,
+        _Out_opt_ TexMetadata* metadata,
+        _Out_ ScratchImage& image);
+        // Reads only the rows of blocks covering rect in the top-level image of a BC file and decompresses them
+
     enum CMSE_FLAGS : uint32_t
     {
         CMSE_DEFAULT = 0,
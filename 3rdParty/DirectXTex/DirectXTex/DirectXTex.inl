@@ -25,6 +25,7 @@ DEFINE_ENUM_FLAG_OPERATORS(TEX_COMPRESS_FLAGS)
 DEFINE_ENUM_FLAG_OPERATORS(CNMAP_FLAGS)
 DEFINE_ENUM_FLAG_OPERATORS(CMSE_FLAGS)
 DEFINE_ENUM_FLAG_OPERATORS(CREATETEX_FLAGS)
+DEFINE_ENUM_FLAG_OPERATORS(TEX_ALLOC_FLAGS)
 
 // WIC_FILTER modes match TEX_FILTER modes
 constexpr WIC_FLAGS operator|(WIC_FLAGS a, TEX_FILTER_FLAGS b) { return static_cast<WIC_FLAGS>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b & TEX_FILTER_MODE_MASK)); }
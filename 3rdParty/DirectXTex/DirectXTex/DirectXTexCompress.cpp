@@ -31,7 +31,9 @@ namespace
         static_assert(static_cast<int>(TEX_COMPRESS_UNIFORM) == static_cast<int>(BC_FLAGS_UNIFORM), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
         static_assert(static_cast<int>(TEX_COMPRESS_BC7_USE_3SUBSETS) == static_cast<int>(BC_FLAGS_USE_3SUBSETS), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
         static_assert(static_cast<int>(TEX_COMPRESS_BC7_QUICK) == static_cast<int>(BC_FLAGS_FORCE_BC7_MODE6), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
-        return (compress & (BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A | BC_FLAGS_UNIFORM | BC_FLAGS_USE_3SUBSETS | BC_FLAGS_FORCE_BC7_MODE6));
+        static_assert(static_cast<int>(TEX_COMPRESS_BC45_EXHAUSTIVE) == static_cast<int>(BC_FLAGS_BC45_EXHAUSTIVE), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        static_assert(static_cast<int>(TEX_COMPRESS_YCOCG_METRIC) == static_cast<int>(BC_FLAGS_YCOCG_METRIC), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        return (compress & (BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A | BC_FLAGS_UNIFORM | BC_FLAGS_USE_3SUBSETS | BC_FLAGS_FORCE_BC7_MODE6 | BC_FLAGS_BC45_EXHAUSTIVE | BC_FLAGS_YCOCG_METRIC));
     }
 
     constexpr TEX_FILTER_FLAGS GetSRGBFlags(_In_ TEX_COMPRESS_FLAGS compress) noexcept
@@ -68,6 +70,35 @@ namespace
     }
 
 
+    inline BC_ENCODE_BATCH GetBatchEncoder(_In_ DXGI_FORMAT format) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:    return D3DXEncodeBC1Batch;
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:    return D3DXEncodeBC2Batch;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:    return D3DXEncodeBC3Batch;
+        default:                            return nullptr;
+        }
+    }
+
+
+    // Encoders that take a target error and report the error of each block
+    inline BC_ENCODE_TARGET GetTargetErrorEncoder(_In_ DXGI_FORMAT format) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC6H_UF16:         return D3DXEncodeBC6HU;
+        case DXGI_FORMAT_BC6H_SF16:         return D3DXEncodeBC6HS;
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:    return D3DXEncodeBC7;
+        default:                            return nullptr;
+        }
+    }
+
+
     //-------------------------------------------------------------------------------------
     HRESULT CompressBC(
         const Image& image,
@@ -75,7 +106,10 @@ namespace
         uint32_t bcflags,
         TEX_FILTER_FLAGS srgb,
         float threshold,
-        const std::function<bool __cdecl(size_t, size_t)>& statusCallback) noexcept
+        float targetError,
+        const std::function<bool __cdecl(size_t, size_t)>& statusCallback,
+        AlphaStatistics* alphaStats,
+        float* blockErrors) noexcept
     {
         if (!image.pixels || !result.pixels)
             return E_POINTER;
@@ -106,10 +140,20 @@ namespace
         if (!DetermineEncoderSettings(result.format, pfEncode, blocksize, cflags))
             return HRESULT_E_NOT_SUPPORTED;
 
+        const BC_ENCODE_TARGET pfEncodeTarget = (targetError > 0 || blockErrors) ? GetTargetErrorEncoder(result.format) : nullptr;
+        if (blockErrors && !pfEncodeTarget)
+            return HRESULT_E_NOT_SUPPORTED;
+
+        if (alphaStats)
+        {
+            ResetAlphaStatistics(*alphaStats);
+        }
+
         XM_ALIGNED_DATA(16) XMVECTOR temp[16];
         const uint8_t *pSrc = image.pixels;
         const uint8_t *pEnd = image.pixels + image.slicePitch;
         const size_t rowPitch = image.rowPitch;
+        size_t nblock = 0;
         for (size_t h = 0; h < image.height; h += 4)
         {
             if (statusCallback)
@@ -188,13 +232,28 @@ namespace
 
                 ConvertScanline(temp, 16, result.format, format, cflags | srgb);
 
-                if (pfEncode)
+                if (alphaStats)
+                {
+                    if (pfEncode)
+                        UpdateAlphaStatistics(*alphaStats, temp, 16, ALPHA_OPAQUE_THRESHOLD_BC);
+                    else
+                        UpdateAlphaStatistics(*alphaStats, temp, 16, ALPHA_OPAQUE_THRESHOLD_BC, threshold);
+                }
+
+                if (pfEncodeTarget)
+                {
+                    const float err = pfEncodeTarget(dptr, temp, targetError, bcflags);
+                    if (blockErrors)
+                        blockErrors[nblock] = err;
+                }
+                else if (pfEncode)
                     pfEncode(dptr, temp, bcflags);
                 else
                     D3DXEncodeBC1(dptr, temp, threshold, bcflags);
 
                 sptr += sbpp * 4;
                 dptr += blocksize;
+                ++nblock;
             }
 
             pSrc += rowPitch * 4;
@@ -206,6 +265,86 @@ namespace
 
 
     //-------------------------------------------------------------------------------------
+    // Loads the 4x4 block at (x, y), replicating pixels for partial blocks
+    bool LoadBlock(
+        _Out_writes_(NUM_PIXELS_PER_BLOCK) XMVECTOR* pBlock,
+        const Image& image,
+        size_t x,
+        size_t y,
+        size_t sbpp,
+        _In_ const uint8_t* pEnd) noexcept
+    {
+        assert(x < image.width);
+        assert(y < image.height);
+
+        const size_t rowPitch = image.rowPitch;
+        const uint8_t *pSrc = image.pixels + (y*rowPitch) + (x*sbpp);
+
+        const size_t ph = std::min<size_t>(4, image.height - y);
+        const size_t pw = std::min<size_t>(4, image.width - x);
+        assert(pw > 0 && ph > 0);
+
+        const ptrdiff_t bytesLeft = pEnd - pSrc;
+        assert(bytesLeft > 0);
+        size_t bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft));
+
+        bool result = true;
+
+        if (!LoadScanline(&pBlock[0], pw, pSrc, bytesToRead, image.format))
+            result = false;
+
+        if (ph > 1)
+        {
+            bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch);
+            if (!LoadScanline(&pBlock[4], pw, pSrc + rowPitch, bytesToRead, image.format))
+                result = false;
+
+            if (ph > 2)
+            {
+                bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 2);
+                if (!LoadScanline(&pBlock[8], pw, pSrc + rowPitch * 2, bytesToRead, image.format))
+                    result = false;
+
+                if (ph > 3)
+                {
+                    bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 3);
+                    if (!LoadScanline(&pBlock[12], pw, pSrc + rowPitch * 3, bytesToRead, image.format))
+                        result = false;
+                }
+            }
+        }
+
+        if (pw != 4 || ph != 4)
+        {
+            // Replicate pixels for partial block
+            static const size_t uSrc[] = { 0, 0, 0, 1 };
+
+            if (pw < 4)
+            {
+                for (size_t t = 0; t < ph && t < 4; ++t)
+                {
+                    for (size_t s = pw; s < 4; ++s)
+                    {
+                        pBlock[(t << 2) | s] = pBlock[(t << 2) | uSrc[s]];
+                    }
+                }
+            }
+
+            if (ph < 4)
+            {
+                for (size_t t = ph; t < 4; ++t)
+                {
+                    for (size_t s = 0; s < 4; ++s)
+                    {
+                        pBlock[(t << 2) | s] = pBlock[(uSrc[t] << 2) | s];
+                    }
+                }
+            }
+        }
+
+        return result;
+    }
+
 #ifdef _OPENMP
     HRESULT CompressBC_Parallel(
         const Image& image,
@@ -213,7 +352,10 @@ namespace
         uint32_t bcflags,
         TEX_FILTER_FLAGS srgb,
         float threshold,
-        const std::function<bool __cdecl(size_t, size_t)>& statusCallback) noexcept
+        float targetError,
+        const std::function<bool __cdecl(size_t, size_t)>& statusCallback,
+        AlphaStatistics* alphaStats,
+        float* blockErrors) noexcept
     {
         if (!image.pixels || !result.pixels)
             return E_POINTER;
@@ -244,18 +386,45 @@ namespace
         if (!DetermineEncoderSettings(result.format, pfEncode, blocksize, cflags))
             return HRESULT_E_NOT_SUPPORTED;
 
-        // Refactored version of loop to support parallel independance
-        const size_t nBlocks = std::max<size_t>(1, (image.width + 3) / 4) * std::max<size_t>(1, (image.height + 3) / 4);
+        // Refactored version of loop to support parallel independance, the BC1-3 encoders
+        // process a batch of horizontally adjacent blocks in each iteration
+        const BC_ENCODE_BATCH pfEncodeBatch = GetBatchEncoder(result.format);
+        const BC_ENCODE_TARGET pfEncodeTarget = (targetError > 0 || blockErrors) ? GetTargetErrorEncoder(result.format) : nullptr;
+        if (blockErrors && !pfEncodeTarget)
+            return HRESULT_E_NOT_SUPPORTED;
+
+        const size_t batchSize = pfEncodeBatch ? BC_ENCODE_BATCH_SIZE : 1;
+
+        const size_t nbWidth = std::max<size_t>(1, (image.width + 3) / 4);
+        const size_t nbHeight = std::max<size_t>(1, (image.height + 3) / 4);
+        const size_t nBatchesPerRow = (nbWidth + batchSize - 1) / batchSize;
+        const size_t nBatches = nBatchesPerRow * nbHeight;
 
         bool fail = false;
 
         size_t progress = 0;
         bool abort = false;
 
-        const size_t progressTotal = std::max<size_t>(1, (image.height + 3) / 4);
+        const size_t progressTotal = nbHeight;
+
+        // Each thread gathers its own alpha statistics, they are merged after the loop
+        std::unique_ptr<AlphaStatistics[]> threadAlphaStats;
+        if (alphaStats)
+        {
+            const size_t threadCount = static_cast<size_t>(omp_get_max_threads());
+
+            threadAlphaStats.reset(new (std::nothrow) AlphaStatistics[threadCount]);
+            if (!threadAlphaStats)
+                return E_OUTOFMEMORY;
+
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                ResetAlphaStatistics(threadAlphaStats[i]);
+            }
+        }
 
 #pragma omp parallel for shared(progress)
-        for (int nb = 0; nb < static_cast<int>(nBlocks); ++nb)
+        for (int nbatch = 0; nbatch < static_cast<int>(nBatches); ++nbatch)
         {
 #pragma omp flush (abort)
             if (abort)
@@ -265,112 +434,348 @@ namespace
                 continue;
             }
 
-            const int nbWidth = std::max<int>(1, int((image.width + 3) / 4));
+            const size_t by = size_t(nbatch) / nBatchesPerRow;
+            const size_t bx = (size_t(nbatch) - (by * nBatchesPerRow)) * batchSize;
+            const size_t count = std::min<size_t>(batchSize, nbWidth - bx);
 
-            int y = nb / nbWidth;
-            const int x = (nb - (y*nbWidth)) * 4;
-            y *= 4;
+            XM_ALIGNED_DATA(16) XMVECTOR temp[BC_ENCODE_BATCH_SIZE * NUM_PIXELS_PER_BLOCK];
 
-            assert((x >= 0) && (x < int(image.width)));
-            assert((y >= 0) && (y < int(image.height)));
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!LoadBlock(&temp[i * NUM_PIXELS_PER_BLOCK], image, (bx + i) * 4, by * 4, sbpp, pEnd))
+                    fail = true;
+            }
 
-            const size_t rowPitch = image.rowPitch;
-            const uint8_t *pSrc = image.pixels + (size_t(y)*rowPitch) + (size_t(x)*sbpp);
+            const size_t npixels = count * NUM_PIXELS_PER_BLOCK;
 
-            uint8_t *pDest = result.pixels + (size_t(nb)*blocksize);
+            ConvertScanline(temp, npixels, result.format, format, cflags | srgb);
 
-            const size_t ph = std::min<size_t>(4, image.height - size_t(y));
-            const size_t pw = std::min<size_t>(4, image.width - size_t(x));
-            assert(pw > 0 && ph > 0);
+            if (threadAlphaStats)
+            {
+                AlphaStatistics& stats = threadAlphaStats[static_cast<size_t>(omp_get_thread_num())];
 
-            const ptrdiff_t bytesLeft = pEnd - pSrc;
-            assert(bytesLeft > 0);
-            size_t bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft));
+                if (pfEncode)
+                    UpdateAlphaStatistics(stats, temp, npixels, ALPHA_OPAQUE_THRESHOLD_BC);
+                else
+                    UpdateAlphaStatistics(stats, temp, npixels, ALPHA_OPAQUE_THRESHOLD_BC, threshold);
+            }
 
-            XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-            if (!LoadScanline(&temp[0], pw, pSrc, bytesToRead, format))
-                fail = true;
+            uint8_t *pDest = result.pixels + ((by * nbWidth + bx) * blocksize);
 
-            if (ph > 1)
+            if (pfEncodeBatch)
+                pfEncodeBatch(pDest, temp, count, threshold, bcflags);
+            else if (pfEncodeTarget)
             {
-                bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch);
-                if (!LoadScanline(&temp[4], pw, pSrc + rowPitch, bytesToRead, format))
-                    fail = true;
-
-                if (ph > 2)
-                {
-                    bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 2);
-                    if (!LoadScanline(&temp[8], pw, pSrc + rowPitch * 2, bytesToRead, format))
-                        fail = true;
-
-                    if (ph > 3)
-                    {
-                        bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 3);
-                        if (!LoadScanline(&temp[12], pw, pSrc + rowPitch * 3, bytesToRead, format))
-                            fail = true;
-                    }
-                }
+                const float err = pfEncodeTarget(pDest, temp, targetError, bcflags);
+                if (blockErrors)
+                    blockErrors[by * nbWidth + bx] = err;
             }
+            else
+                pfEncode(pDest, temp, bcflags);
 
-            if (pw != 4 || ph != 4)
+            // Report progress when a new row is reached.
+            if (bx == 0 && statusCallback)
             {
-                // Replicate pixels for partial block
-                static const size_t uSrc[] = { 0, 0, 0, 1 };
+#pragma omp atomic
+                ++progress;
 
-                if (pw < 4)
+                if (!statusCallback(progress, progressTotal))
                 {
-                    for (size_t t = 0; t < ph && t < 4; ++t)
-                    {
-                        for (size_t s = pw; s < 4; ++s)
-                        {
-                            temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
-                        }
-                    }
+                    abort = true;
+#pragma omp flush (abort)
                 }
+            }
+        }
 
-                if (ph < 4)
-                {
-                    for (size_t t = ph; t < 4; ++t)
-                    {
-                        for (size_t s = 0; s < 4; ++s)
-                        {
-                            temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
-                        }
-                    }
-                }
+        if (abort)
+        {
+            return E_ABORT;
+        }
+
+        if (threadAlphaStats)
+        {
+            ResetAlphaStatistics(*alphaStats);
+
+            const size_t threadCount = static_cast<size_t>(omp_get_max_threads());
+            for (size_t i = 0; i < threadCount; ++i)
+            {
+                MergeAlphaStatistics(*alphaStats, threadAlphaStats[i]);
             }
+        }
 
-            ConvertScanline(temp, 16, result.format, format, cflags | srgb);
+        return (fail) ? E_FAIL : S_OK;
+    }
+#endif // _OPENMP
 
-            if (pfEncode)
-                pfEncode(pDest, temp, bcflags);
-            else
-                D3DXEncodeBC1(pDest, temp, threshold, bcflags);
+
+    //-------------------------------------------------------------------------------------
+    // Re-encodes the blocks with the largest errors using the full mode search, blockErrors
+    // holds the error of each block from the first pass and is updated with the new errors.
+    // Progress is reported once per block row that has blocks to refine, as the second half
+    // of the range after the first pass.
+    HRESULT RefineBC(
+        const Image& image,
+        const Image& result,
+        uint32_t bcflags,
+        TEX_FILTER_FLAGS srgb,
+        float targetError,
+        float refineFraction,
+        bool parallel,
+        const std::function<bool __cdecl(size_t, size_t)>& statusCallback,
+        float* blockErrors) noexcept
+    {
+        if (!image.pixels || !result.pixels || !blockErrors)
+            return E_POINTER;
+
+        const DXGI_FORMAT format = image.format;
+        size_t sbpp = BitsPerPixel(format);
+        if (sbpp < 8)
+            return E_FAIL;
+
+        // Round to bytes
+        sbpp = (sbpp + 7) / 8;
+
+        const uint8_t *pEnd = image.pixels + image.slicePitch;
+
+        BC_ENCODE pfEncode;
+        size_t blocksize;
+        TEX_FILTER_FLAGS cflags;
+        if (!DetermineEncoderSettings(result.format, pfEncode, blocksize, cflags))
+            return HRESULT_E_NOT_SUPPORTED;
+
+        const BC_ENCODE_TARGET pfEncodeTarget = GetTargetErrorEncoder(result.format);
+        if (!pfEncodeTarget)
+            return HRESULT_E_NOT_SUPPORTED;
+
+        const size_t nbWidth = std::max<size_t>(1, (image.width + 3) / 4);
+        const size_t nbHeight = std::max<size_t>(1, (image.height + 3) / 4);
+        const size_t nBlocks = nbWidth * nbHeight;
+
+        const size_t nRefine = std::min<size_t>(nBlocks, static_cast<size_t>(double(refineFraction) * double(nBlocks) + 0.5));
+        if (!nRefine)
+            return S_OK;
+
+        std::unique_ptr<size_t[]> order(new (std::nothrow) size_t[nBlocks]);
+        if (!order)
+            return E_OUTOFMEMORY;
+
+        for (size_t i = 0; i < nBlocks; ++i)
+        {
+            order[i] = i;
+        }
+
+        std::nth_element(order.get(), order.get() + nRefine - 1, order.get() + nBlocks,
+            [blockErrors](size_t a, size_t b) noexcept { return blockErrors[a] > blockErrors[b]; });
+
+        // Visit the selected blocks in memory order
+        std::sort(order.get(), order.get() + nRefine);
+
+        size_t nRows = 0;
+        for (size_t n = 0; n < nRefine; ++n)
+        {
+            if (!n || (order[n] / nbWidth) != (order[n - 1] / nbWidth))
+                ++nRows;
+        }
+
+        bool fail = false;
+
+        size_t progress = 0;
+        bool abort = false;
+
+    #ifdef _OPENMP
+        #pragma omp parallel for if (parallel) shared(progress)
+    #else
+        UNREFERENCED_PARAMETER(parallel);
+    #endif
+        for (int n = 0; n < static_cast<int>(nRefine); ++n)
+        {
+        #ifdef _OPENMP
+        #pragma omp flush (abort)
+        #endif
+            if (abort)
+            {
+                // OpenMP 2.0 does not support cancellation of a 'parallel for' loop.
+                continue;
+            }
+
+            const size_t nblock = order[size_t(n)];
+            const size_t by = nblock / nbWidth;
+            const size_t bx = nblock - (by * nbWidth);
 
             // Report progress when a new row is reached.
-            if (x == 0 && statusCallback)
+            if (statusCallback && (!n || (order[size_t(n) - 1] / nbWidth) != by))
             {
-#pragma omp atomic
-                progress += 4;
+            #ifdef _OPENMP
+            #pragma omp atomic
+            #endif
+                ++progress;
 
-                if (!statusCallback(progress, progressTotal))
+                if (!statusCallback(nRows + progress, nRows * 2))
                 {
                     abort = true;
-#pragma omp flush (abort)
+                #ifdef _OPENMP
+                #pragma omp flush (abort)
+                #endif
+                    continue;
                 }
             }
+
+            if (blockErrors[nblock] <= targetError)
+            {
+                // The first pass already met the target
+                continue;
+            }
+
+            XM_ALIGNED_DATA(16) XMVECTOR temp[NUM_PIXELS_PER_BLOCK];
+            if (!LoadBlock(temp, image, bx * 4, by * 4, sbpp, pEnd))
+            {
+                fail = true;
+                continue;
+            }
+
+            ConvertScanline(temp, NUM_PIXELS_PER_BLOCK, result.format, format, cflags | srgb);
+
+            uint8_t block[16];
+            const float err = pfEncodeTarget(block, temp, targetError, bcflags);
+            if (err < blockErrors[nblock])
+            {
+                memcpy(result.pixels + (by * result.rowPitch) + (bx * blocksize), block, blocksize);
+                blockErrors[nblock] = err;
+            }
         }
 
         if (abort)
-        {
             return E_ABORT;
+
+        return (fail) ? E_FAIL : S_OK;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Builds the block error map of a BC6H/BC7 image from the errors reported by the encoder
+    // and the mode and partition stored in each block
+    HRESULT CreateBlockErrorMap(
+        const Image& result,
+        const float* blockErrors,
+        ScratchImage& errorMap) noexcept
+    {
+        const size_t nbWidth = std::max<size_t>(1, (result.width + 3) / 4);
+        const size_t nbHeight = std::max<size_t>(1, (result.height + 3) / 4);
+
+        HRESULT hr = errorMap.Initialize2D(DXGI_FORMAT_R32G32B32A32_FLOAT, nbWidth, nbHeight, 1, 1);
+        if (FAILED(hr))
+            return hr;
+
+        const Image* img = errorMap.GetImage(0, 0, 0);
+        if (!img)
+        {
+            errorMap.Release();
+            return E_POINTER;
+        }
+
+        const bool bc6h = (result.format == DXGI_FORMAT_BC6H_UF16 || result.format == DXGI_FORMAT_BC6H_SF16);
+
+        for (size_t by = 0; by < nbHeight; ++by)
+        {
+            const uint8_t* pBlock = result.pixels + by * result.rowPitch;
+            auto pDest = reinterpret_cast<XMFLOAT4*>(img->pixels + by * img->rowPitch);
+
+            for (size_t bx = 0; bx < nbWidth; ++bx, pBlock += 16)
+            {
+                uint8_t mode, partition, rotation = 0;
+                if (bc6h)
+                    D3DXGetBC6HBlockInfo(pBlock, mode, partition);
+                else
+                    D3DXGetBC7BlockInfo(pBlock, mode, partition, rotation);
+
+                pDest[bx] = XMFLOAT4(blockErrors[by * nbWidth + bx], float(mode), float(partition), float(rotation));
+            }
+        }
+
+        return S_OK;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Compresses one image, with a refineFraction the BC6H/BC7 formats use a quick first
+    // pass and then re-encode the worst blocks with the search selected by the flags
+    HRESULT CompressImage(
+        const Image& image,
+        const Image& result,
+        const CompressOptions& options,
+        const std::function<bool __cdecl(size_t, size_t)>& statusCallback,
+        AlphaStatistics* alphaStats,
+        ScratchImage* blockErrorMap) noexcept
+    {
+        const uint32_t bcflags = GetBCFlags(options.flags);
+        const TEX_FILTER_FLAGS srgb = GetSRGBFlags(options.flags);
+        const bool parallel = (options.flags & TEX_COMPRESS_PARALLEL) != 0;
+
+    #ifndef _OPENMP
+        if (parallel)
+            return E_NOTIMPL;
+    #endif
+
+        const bool twoPass = (options.refineFraction > 0) && GetTargetErrorEncoder(result.format);
+
+        if (blockErrorMap)
+        {
+            blockErrorMap->Release();
+
+            if (!GetTargetErrorEncoder(result.format))
+                return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        std::unique_ptr<float[]> blockErrors;
+        if (twoPass || blockErrorMap)
+        {
+            const size_t nBlocks = std::max<size_t>(1, (image.width + 3) / 4) * std::max<size_t>(1, (image.height + 3) / 4);
+            blockErrors.reset(new (std::nothrow) float[nBlocks]);
+            if (!blockErrors)
+                return E_OUTOFMEMORY;
+        }
+
+        const uint32_t firstPassFlags = twoPass ? (bcflags | BC_FLAGS_FORCE_BC7_MODE6) : bcflags;
+
+        // The first pass reports the first half of the progress when the blocks are refined
+        std::function<bool __cdecl(size_t, size_t)> firstPassCallback;
+        if (twoPass && statusCallback)
+        {
+            firstPassCallback = [&statusCallback](size_t done, size_t total) -> bool
+            {
+                return statusCallback(done, total * 2);
+            };
+        }
+
+        const auto& passCallback = firstPassCallback ? firstPassCallback : statusCallback;
+
+        HRESULT hr;
+    #ifdef _OPENMP
+        if (parallel)
+        {
+            hr = CompressBC_Parallel(image, result, firstPassFlags, srgb, options.threshold, options.targetError,
+                passCallback, alphaStats, blockErrors.get());
         }
         else
+    #endif
         {
-            return (fail) ? E_FAIL : S_OK;
+            hr = CompressBC(image, result, firstPassFlags, srgb, options.threshold, options.targetError,
+                passCallback, alphaStats, blockErrors.get());
         }
+
+        if (SUCCEEDED(hr) && twoPass)
+        {
+            hr = RefineBC(image, result, bcflags & ~static_cast<uint32_t>(BC_FLAGS_FORCE_BC7_MODE6), srgb,
+                options.targetError, options.refineFraction, parallel, statusCallback, blockErrors.get());
+        }
+
+        if (SUCCEEDED(hr) && blockErrorMap)
+        {
+            hr = CreateBlockErrorMap(result, blockErrors.get(), *blockErrorMap);
+        }
+
+        return hr;
     }
-#endif // _OPENMP
 
 
     //-------------------------------------------------------------------------------------
@@ -421,6 +826,45 @@ namespace
     }
 
 
+    //-------------------------------------------------------------------------------------
+    // Decoders that write R8G8B8A8 texels directly, used when the output needs no conversion
+    inline BC_DECODE_RGBA8 GetRGBA8Decoder(_In_ DXGI_FORMAT cformat, _In_ DXGI_FORMAT format) noexcept
+    {
+        switch (cformat)
+        {
+        case DXGI_FORMAT_BC1_UNORM:         return (format == DXGI_FORMAT_R8G8B8A8_UNORM) ? D3DXDecodeBC1RGBA8 : nullptr;
+        case DXGI_FORMAT_BC1_UNORM_SRGB:    return (format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) ? D3DXDecodeBC1RGBA8 : nullptr;
+        case DXGI_FORMAT_BC2_UNORM:         return (format == DXGI_FORMAT_R8G8B8A8_UNORM) ? D3DXDecodeBC2RGBA8 : nullptr;
+        case DXGI_FORMAT_BC2_UNORM_SRGB:    return (format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) ? D3DXDecodeBC2RGBA8 : nullptr;
+        case DXGI_FORMAT_BC3_UNORM:         return (format == DXGI_FORMAT_R8G8B8A8_UNORM) ? D3DXDecodeBC3RGBA8 : nullptr;
+        case DXGI_FORMAT_BC3_UNORM_SRGB:    return (format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) ? D3DXDecodeBC3RGBA8 : nullptr;
+        case DXGI_FORMAT_BC4_UNORM:         return (format == DXGI_FORMAT_R8G8B8A8_UNORM) ? D3DXDecodeBC4URGBA8 : nullptr;
+        case DXGI_FORMAT_BC4_SNORM:         return (format == DXGI_FORMAT_R8G8B8A8_UNORM) ? D3DXDecodeBC4SRGBA8 : nullptr;
+        case DXGI_FORMAT_BC5_UNORM:         return (format == DXGI_FORMAT_R8G8B8A8_UNORM) ? D3DXDecodeBC5URGBA8 : nullptr;
+        case DXGI_FORMAT_BC5_SNORM:         return (format == DXGI_FORMAT_R8G8B8A8_UNORM) ? D3DXDecodeBC5SRGBA8 : nullptr;
+        case DXGI_FORMAT_BC7_UNORM:         return (format == DXGI_FORMAT_R8G8B8A8_UNORM) ? D3DXDecodeBC7RGBA8 : nullptr;
+        case DXGI_FORMAT_BC7_UNORM_SRGB:    return (format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) ? D3DXDecodeBC7RGBA8 : nullptr;
+        default:                            return nullptr;
+        }
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // BC6H decoders that write R16G16B16A16_FLOAT texels directly, several blocks at a time
+    inline BC_DECODE_F16_BATCH GetF16BatchDecoder(_In_ DXGI_FORMAT cformat, _In_ DXGI_FORMAT format) noexcept
+    {
+        if (format != DXGI_FORMAT_R16G16B16A16_FLOAT)
+            return nullptr;
+
+        switch (cformat)
+        {
+        case DXGI_FORMAT_BC6H_UF16: return D3DXDecodeBC6HUF16Batch;
+        case DXGI_FORMAT_BC6H_SF16: return D3DXDecodeBC6HSF16Batch;
+        default:                    return nullptr;
+        }
+    }
+
+
     //-------------------------------------------------------------------------------------
     HRESULT DecompressBC(_In_ const Image& cImage, _In_ const Image& result) noexcept
     {
@@ -485,7 +929,12 @@ namespace
             return HRESULT_E_NOT_SUPPORTED;
         }
 
+        const BC_DECODE_RGBA8 pfDecodeRGBA8 = GetRGBA8Decoder(cformat, format);
+        const BC_DECODE_F16_BATCH pfDecodeF16Batch = GetF16BatchDecoder(cformat, format);
+
         XM_ALIGNED_DATA(16) XMVECTOR temp[16];
+        uint32_t tempRGBA8[NUM_PIXELS_PER_BLOCK];
+        PackedVector::XMHALF4 tempF16[BC_DECODE_BATCH_SIZE * NUM_PIXELS_PER_BLOCK];
         const uint8_t *pSrc = cImage.pixels;
         const size_t rowPitch = result.rowPitch;
         for (size_t h = 0; h < cImage.height; h += 4)
@@ -493,9 +942,48 @@ namespace
             const uint8_t *sptr = pSrc;
             uint8_t* dptr = pDest;
             const size_t ph = std::min<size_t>(4, cImage.height - h);
+
+            if (pfDecodeF16Batch)
+            {
+                const size_t nblocks = std::min<size_t>((cImage.width + 3) / 4, cImage.rowPitch / sbpp);
+                for (size_t bx = 0; bx < nblocks; bx += BC_DECODE_BATCH_SIZE)
+                {
+                    const size_t count = std::min<size_t>(BC_DECODE_BATCH_SIZE, nblocks - bx);
+                    pfDecodeF16Batch(tempF16, sptr + bx * sbpp, count);
+
+                    for (size_t j = 0; j < count; ++j)
+                    {
+                        const size_t w = (bx + j) * 4;
+                        const size_t pw = std::min<size_t>(4, cImage.width - w);
+                        for (size_t y = 0; y < ph; ++y)
+                        {
+                            memcpy(dptr + rowPitch * y + w * sizeof(PackedVector::XMHALF4), &tempF16[j * NUM_PIXELS_PER_BLOCK + y * 4], pw * sizeof(PackedVector::XMHALF4));
+                        }
+                    }
+                }
+
+                pSrc += cImage.rowPitch;
+                pDest += rowPitch * 4;
+                continue;
+            }
             size_t w = 0;
             for (size_t count = 0; (count < cImage.rowPitch) && (w < cImage.width); count += sbpp, w += 4)
             {
+                if (pfDecodeRGBA8)
+                {
+                    pfDecodeRGBA8(tempRGBA8, sptr);
+
+                    const size_t pw = std::min<size_t>(4, cImage.width - w);
+                    for (size_t y = 0; y < ph; ++y)
+                    {
+                        memcpy(dptr + rowPitch * y, &tempRGBA8[y * 4], pw * sizeof(uint32_t));
+                    }
+
+                    sptr += sbpp;
+                    dptr += dbpp * 4;
+                    continue;
+                }
+
                 pfDecode(temp, sptr);
                 ConvertScanline(temp, 16, format, cformat, TEX_FILTER_DEFAULT);
 
@@ -533,6 +1021,105 @@ namespace
 
         return S_OK;
     }
+
+
+    //-------------------------------------------------------------------------------------
+    enum BC_BLOCK_ALPHA : uint32_t
+    {
+        BC_BLOCK_ALPHA_OPAQUE,
+        BC_BLOCK_ALPHA_NOT_OPAQUE,
+        BC_BLOCK_ALPHA_UNKNOWN,
+    };
+
+    // Smallest 8-bit alpha that passes ALPHA_OPAQUE_THRESHOLD_BC
+    constexpr uint32_t c_OpaqueAlphaBC = 253;
+
+    // Classifies a full 4x4 block using only integer tests on the encoded data.
+    // Returns BC_BLOCK_ALPHA_UNKNOWN when the block has to be decoded to decide.
+    BC_BLOCK_ALPHA ClassifyBlockAlpha(_In_ DXGI_FORMAT cformat, _In_reads_(16) const uint8_t* pBC) noexcept
+    {
+        switch (cformat)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            {
+                auto pBC1 = reinterpret_cast<const D3DX_BC1*>(pBC);
+                if (pBC1->rgb[0] > pBC1->rgb[1])
+                    return BC_BLOCK_ALPHA_OPAQUE;
+
+                // The three color mode uses index 3 for transparent black
+                const uint32_t dw = pBC1->bitmap;
+                return (dw & (dw >> 1) & 0x55555555) ? BC_BLOCK_ALPHA_NOT_OPAQUE : BC_BLOCK_ALPHA_OPAQUE;
+            }
+
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+            {
+                // Any 4-bit alpha below 15 is under the threshold
+                auto pBC2 = reinterpret_cast<const D3DX_BC2*>(pBC);
+                return (pBC2->bitmap[0] == UINT32_MAX && pBC2->bitmap[1] == UINT32_MAX)
+                    ? BC_BLOCK_ALPHA_OPAQUE : BC_BLOCK_ALPHA_NOT_OPAQUE;
+            }
+
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            {
+                auto pBC3 = reinterpret_cast<const D3DX_BC3*>(pBC);
+                const uint32_t a0 = pBC3->alpha[0];
+                const uint32_t a1 = pBC3->alpha[1];
+
+                if (a0 > a1)
+                {
+                    // 8 alpha mode, every palette entry lies between the two endpoints
+                    return (a1 >= c_OpaqueAlphaBC) ? BC_BLOCK_ALPHA_OPAQUE : BC_BLOCK_ALPHA_UNKNOWN;
+                }
+
+                if (a0 >= c_OpaqueAlphaBC)
+                {
+                    // 6 alpha mode, index 6 is the only entry that can be transparent
+                    for (size_t iSet = 0; iSet < 2; ++iSet)
+                    {
+                        uint32_t dw = uint32_t(pBC3->bitmap[iSet * 3])
+                            | (uint32_t(pBC3->bitmap[iSet * 3 + 1]) << 8)
+                            | (uint32_t(pBC3->bitmap[iSet * 3 + 2]) << 16);
+
+                        for (size_t i = 0; i < 8; ++i, dw >>= 3)
+                        {
+                            if ((dw & 0x7) == 6)
+                                return BC_BLOCK_ALPHA_NOT_OPAQUE;
+                        }
+                    }
+
+                    return BC_BLOCK_ALPHA_OPAQUE;
+                }
+
+                return BC_BLOCK_ALPHA_UNKNOWN;
+            }
+
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            {
+                // Modes 0-3 do not store alpha
+                if (pBC[0] & 0x0F)
+                    return BC_BLOCK_ALPHA_OPAQUE;
+
+                if ((pBC[0] & 0x7F) == 0x40)
+                {
+                    // Mode 6 stores A0, A1 and P0 in bits 49-63 and P1 in bit 64.
+                    // If all of them are set both endpoints have an alpha of 255.
+                    uint64_t lo;
+                    memcpy(&lo, pBC, sizeof(lo));
+                    if ((lo >> 49) == 0x7FFF && (pBC[8] & 0x1))
+                        return BC_BLOCK_ALPHA_OPAQUE;
+                }
+
+                return BC_BLOCK_ALPHA_UNKNOWN;
+            }
+
+        default:
+            return BC_BLOCK_ALPHA_UNKNOWN;
+        }
+    }
 }
 
 //-------------------------------------------------------------------------------------
@@ -571,7 +1158,7 @@ bool DirectX::Internal::IsAlphaAllOpaqueBC(_In_ const Image& cImage) noexcept
     }
 
     // Scan blocks for non-opaque alpha
-    static const XMVECTORF32 threshold = { { { 0.99f, 0.99f, 0.99f, 0.99f } } };
+    const XMVECTOR threshold = XMVectorReplicate(ALPHA_OPAQUE_THRESHOLD_BC);
 
     XM_ALIGNED_DATA(16) XMVECTOR temp[16];
     const uint8_t* pPixels = cImage.pixels;
@@ -582,11 +1169,25 @@ bool DirectX::Internal::IsAlphaAllOpaqueBC(_In_ const Image& cImage) noexcept
         size_t w = 0;
         for (size_t count = 0; (count < cImage.rowPitch) && (w < cImage.width); count += sbpp, w += 4)
         {
-            pfDecode(temp, ptr);
-
             const size_t pw = std::min<size_t>(4, cImage.width - w);
             assert(pw > 0 && ph > 0);
 
+            if (pw == 4 && ph == 4)
+            {
+                // Most blocks can be classified from the encoded bits alone
+                const BC_BLOCK_ALPHA blockAlpha = ClassifyBlockAlpha(cformat, ptr);
+                if (blockAlpha == BC_BLOCK_ALPHA_NOT_OPAQUE)
+                    return false;
+
+                if (blockAlpha == BC_BLOCK_ALPHA_OPAQUE)
+                {
+                    ptr += sbpp;
+                    continue;
+                }
+            }
+
+            pfDecode(temp, ptr);
+
             if (pw == 4 && ph == 4)
             {
                 // Full blocks
@@ -666,7 +1267,9 @@ HRESULT DirectX::CompressEx(
     DXGI_FORMAT format,
     const CompressOptions& options,
     ScratchImage& image,
-    std::function<bool __cdecl(size_t, size_t)> statusCallback)
+    std::function<bool __cdecl(size_t, size_t)> statusCallback,
+    AlphaStatistics* alphaStats,
+    ScratchImage* blockErrorMap)
 {
     if (IsCompressed(srcImage.format) || !IsCompressed(format))
         return E_INVALIDARG;
@@ -697,18 +1300,7 @@ HRESULT DirectX::CompressEx(
     }
 
     // Compress single image
-    if (options.flags & TEX_COMPRESS_PARALLEL)
-    {
-    #ifndef _OPENMP
-        hr = E_NOTIMPL;
-    #else
-        hr = CompressBC_Parallel(srcImage, *img, GetBCFlags(options.flags), GetSRGBFlags(options.flags), options.threshold, statusCallback);
-    #endif // _OPENMP
-    }
-    else
-    {
-        hr = CompressBC(srcImage, *img, GetBCFlags(options.flags), GetSRGBFlags(options.flags), options.threshold, statusCallback);
-    }
+    hr = CompressImage(srcImage, *img, options, statusCallback, alphaStats, blockErrorMap);
 
     if (FAILED(hr))
     {
@@ -736,7 +1328,9 @@ HRESULT DirectX::CompressEx(
     DXGI_FORMAT format,
     const CompressOptions& options,
     ScratchImage& cImages,
-    std::function<bool __cdecl(size_t, size_t)> statusCallback)
+    std::function<bool __cdecl(size_t, size_t)> statusCallback,
+    AlphaStatistics* alphaStats,
+    ScratchImage* blockErrorMaps)
 {
     if (!srcImages || !nimages)
         return E_INVALIDARG;
@@ -760,7 +1354,7 @@ HRESULT DirectX::CompressEx(
         // the CompressEx overload that takes a single image.
         // This provides a better user experience as progress will be reported as the image
         // is being processed, instead of after processing has been completed.
-        return CompressEx(srcImages[0], format, options, cImages, statusCallback);
+        return CompressEx(srcImages[0], format, options, cImages, statusCallback, alphaStats, blockErrorMaps);
     }
 
     TexMetadata mdata2 = metadata;
@@ -803,18 +1397,8 @@ HRESULT DirectX::CompressEx(
             return E_FAIL;
         }
 
-        if (options.flags & TEX_COMPRESS_PARALLEL)
-        {
-        #ifndef _OPENMP
-            hr = E_NOTIMPL;
-        #else
-            hr = CompressBC_Parallel(src, dest[index], GetBCFlags(options.flags), GetSRGBFlags(options.flags), options.threshold, nullptr);
-        #endif // _OPENMP
-        }
-        else
-        {
-            hr = CompressBC(src, dest[index], GetBCFlags(options.flags), GetSRGBFlags(options.flags), options.threshold, nullptr);
-        }
+        hr = CompressImage(src, dest[index], options, nullptr, alphaStats ? &alphaStats[index] : nullptr,
+            blockErrorMaps ? &blockErrorMaps[index] : nullptr);
 
         if (FAILED(hr))
         {
@@ -896,6 +1480,90 @@ HRESULT DirectX::Decompress(
     return hr;
 }
 
+_Use_decl_annotations_
+HRESULT DirectX::DecompressRegion(
+    const Image& cImage,
+    const Rect& rect,
+    DXGI_FORMAT format,
+    ScratchImage& image) noexcept
+{
+    if (!IsCompressed(cImage.format) || IsCompressed(format))
+        return E_INVALIDARG;
+
+    if (!cImage.pixels)
+        return E_POINTER;
+
+    if (!rect.w || !rect.h
+        || (rect.x >= cImage.width) || (rect.y >= cImage.height)
+        || (rect.w > cImage.width - rect.x) || (rect.h > cImage.height - rect.y))
+        return E_INVALIDARG;
+
+    if (format == DXGI_FORMAT_UNKNOWN)
+    {
+        // Pick a default decompressed format based on BC input format
+        format = DefaultDecompress(cImage.format);
+        if (format == DXGI_FORMAT_UNKNOWN)
+        {
+            // Input is not a compressed format
+            return E_INVALIDARG;
+        }
+    }
+    else
+    {
+        if (!IsValid(format))
+            return E_INVALIDARG;
+
+        if (IsTypeless(format) || IsPlanar(format) || IsPalettized(format))
+            return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    // Describe the block-aligned part of the source that covers the rectangle
+    const size_t blockBytes = BitsPerPixel(cImage.format) * NUM_PIXELS_PER_BLOCK / 8;
+    const size_t bx = rect.x / 4;
+    const size_t by = rect.y / 4;
+
+    Image blocks = {};
+    blocks.width = std::min<size_t>(cImage.width, (rect.x + rect.w + 3) & ~size_t(3)) - bx * 4;
+    blocks.height = std::min<size_t>(cImage.height, (rect.y + rect.h + 3) & ~size_t(3)) - by * 4;
+    blocks.format = cImage.format;
+    blocks.rowPitch = cImage.rowPitch;
+    blocks.slicePitch = cImage.rowPitch * ((blocks.height + 3) / 4);
+    blocks.pixels = cImage.pixels + by * cImage.rowPitch + bx * blockBytes;
+
+    const bool aligned = (blocks.width == rect.w) && (blocks.height == rect.h);
+
+    ScratchImage temp;
+    HRESULT hr = aligned ? S_OK : temp.Initialize2D(format, blocks.width, blocks.height, 1, 1);
+    if (FAILED(hr))
+        return hr;
+
+    hr = image.Initialize2D(format, rect.w, rect.h, 1, 1);
+    if (FAILED(hr))
+        return hr;
+
+    const Image *img = image.GetImage(0, 0, 0);
+    const Image *dimg = aligned ? img : temp.GetImage(0, 0, 0);
+    if (!img || !dimg)
+    {
+        image.Release();
+        return E_POINTER;
+    }
+
+    hr = DecompressBC(blocks, *dimg);
+
+    if (SUCCEEDED(hr) && !aligned)
+    {
+        // Trim the partial blocks at the edges of the rectangle
+        const Rect srcRect(rect.x - bx * 4, rect.y - by * 4, rect.w, rect.h);
+        hr = CopyRectangle(*dimg, srcRect, *img, TEX_FILTER_DEFAULT, 0, 0);
+    }
+
+    if (FAILED(hr))
+        image.Release();
+
+    return hr;
+}
+
 _Use_decl_annotations_
 HRESULT DirectX::Decompress(
     const Image* cImages,
@@ -35,7 +35,8 @@ namespace
         const Image& srcImage,
         ScratchImage& image,
         bool srgb,
-        TEX_FILTER_FLAGS filter) noexcept
+        TEX_FILTER_FLAGS filter,
+        AlphaStatistics* alphaStats) noexcept
     {
         if (!srcImage.pixels)
             return E_POINTER;
@@ -78,6 +79,11 @@ namespace
 
             ConvertScanline(scanline.get(), srcImage.width, format, srcImage.format, filter);
 
+            if (alphaStats)
+            {
+                UpdateAlphaStatistics(*alphaStats, scanline.get(), srcImage.width, ALPHA_OPAQUE_THRESHOLD_BC);
+            }
+
             if (!StoreScanline(pDest, img->rowPitch, format, scanline.get(), srcImage.width))
             {
                 image.Release();
@@ -98,7 +104,8 @@ namespace
     HRESULT ConvertToRGBAF32(
         const Image& srcImage,
         ScratchImage& image,
-        TEX_FILTER_FLAGS filter) noexcept
+        TEX_FILTER_FLAGS filter,
+        AlphaStatistics* alphaStats) noexcept
     {
         if (!srcImage.pixels)
             return E_POINTER;
@@ -132,6 +139,11 @@ namespace
 
             ConvertScanline(reinterpret_cast<XMVECTOR*>(pDest), srcImage.width, DXGI_FORMAT_R32G32B32A32_FLOAT, srcImage.format, filter);
 
+            if (alphaStats)
+            {
+                UpdateAlphaStatistics(*alphaStats, reinterpret_cast<const XMVECTOR*>(pDest), srcImage.width, ALPHA_OPAQUE_THRESHOLD_BC);
+            }
+
             pSrc += srcImage.rowPitch;
             pDest += img->rowPitch;
         }
@@ -147,7 +159,8 @@ namespace
         _In_ GPUCompressBC* gpubc,
         const Image& srcImage,
         const Image& destImage,
-        TEX_COMPRESS_FLAGS compress)
+        TEX_COMPRESS_FLAGS compress,
+        _Out_opt_ AlphaStatistics* alphaStats)
     {
         if (!gpubc)
             return E_POINTER;
@@ -164,6 +177,13 @@ namespace
         if (sformat == tformat)
         {
             // Input is already in our required source format
+            if (alphaStats)
+            {
+                HRESULT hr = ComputeAlphaStatistics(srcImage, ALPHA_OPAQUE_THRESHOLD_BC, *alphaStats);
+                if (FAILED(hr))
+                    return hr;
+            }
+
             return gpubc->Compress(srcImage, destImage);
         }
         else
@@ -174,18 +194,23 @@ namespace
 
             const auto srgb = GetSRGBFlags(compress);
 
+            if (alphaStats)
+            {
+                ResetAlphaStatistics(*alphaStats);
+            }
+
             switch (tformat)
             {
             case DXGI_FORMAT_R8G8B8A8_UNORM:
-                hr = ConvertToRGBA32(srcImage, image, false, srgb);
+                hr = ConvertToRGBA32(srcImage, image, false, srgb, alphaStats);
                 break;
 
             case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-                hr = ConvertToRGBA32(srcImage, image, true, srgb);
+                hr = ConvertToRGBA32(srcImage, image, true, srgb, alphaStats);
                 break;
 
             case DXGI_FORMAT_R32G32B32A32_FLOAT:
-                hr = ConvertToRGBAF32(srcImage, image, srgb);
+                hr = ConvertToRGBAF32(srcImage, image, srgb, alphaStats);
                 break;
 
             default:
@@ -252,7 +277,8 @@ HRESULT DirectX::CompressEx(
     DXGI_FORMAT format,
     const CompressOptions& options,
     ScratchImage& image,
-    std::function<bool __cdecl(size_t, size_t)> statusCallback)
+    std::function<bool __cdecl(size_t, size_t)> statusCallback,
+    AlphaStatistics* alphaStats)
 {
     if (!pDevice || IsCompressed(srcImage.format) || !IsCompressed(format))
         return E_INVALIDARG;
@@ -298,7 +324,7 @@ HRESULT DirectX::CompressEx(
         }
     }
 
-    hr = GPUCompress(gpubc.get(), srcImage, *img, options.flags);
+    hr = GPUCompress(gpubc.get(), srcImage, *img, options.flags, alphaStats);
 
     if (FAILED(hr))
     {
@@ -327,7 +353,8 @@ HRESULT DirectX::CompressEx(
     DXGI_FORMAT format,
     const CompressOptions& options,
     ScratchImage& cImages,
-    std::function<bool __cdecl(size_t, size_t)> statusCallback)
+    std::function<bool __cdecl(size_t, size_t)> statusCallback,
+    AlphaStatistics* alphaStats)
 {
     if (!pDevice || !srcImages || !nimages)
         return E_INVALIDARG;
@@ -417,7 +444,7 @@ HRESULT DirectX::CompressEx(
                         return E_FAIL;
                     }
 
-                    hr = GPUCompress(gpubc.get(), src, dest[index], options.flags);
+                    hr = GPUCompress(gpubc.get(), src, dest[index], options.flags, alphaStats ? &alphaStats[index] : nullptr);
                     if (FAILED(hr))
                     {
                         cImages.Release();
@@ -478,7 +505,7 @@ HRESULT DirectX::CompressEx(
                         return E_FAIL;
                     }
 
-                    hr = GPUCompress(gpubc.get(), src, dest[index], options.flags);
+                    hr = GPUCompress(gpubc.get(), src, dest[index], options.flags, alphaStats ? &alphaStats[index] : nullptr);
                     if (FAILED(hr))
                     {
                         cImages.Release();
@@ -354,23 +354,20 @@ void DirectX::Internal::CopyScanline(
                 if (pDestination == pSource)
                 {
                     auto dPtr = static_cast<uint32_t*>(pDestination);
-                    for (size_t count = 0; count < (outSize - 3); count += 4)
+                    const size_t count = outSize / 4;
+                    for (size_t i = 0; i < count; ++i)
                     {
-                        uint32_t t = *dPtr & 0xFFFFFF;
-                        t |= alpha;
-                        *(dPtr++) = t;
+                        dPtr[i] = (dPtr[i] & 0xFFFFFF) | alpha;
                     }
                 }
                 else
                 {
                     const uint32_t * __restrict sPtr = static_cast<const uint32_t*>(pSource);
                     uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
-                    const size_t size = std::min<size_t>(outSize, inSize);
-                    for (size_t count = 0; count < (size - 3); count += 4)
+                    const size_t count = std::min<size_t>(outSize, inSize) / 4;
+                    for (size_t i = 0; i < count; ++i)
                     {
-                        uint32_t t = *(sPtr++) & 0xFFFFFF;
-                        t |= alpha;
-                        *(dPtr++) = t;
+                        dPtr[i] = (sPtr[i] & 0xFFFFFF) | alpha;
                     }
                 }
             }
@@ -460,36 +457,39 @@ void DirectX::Internal::SwizzleScanline(
             if (tflags & TEXP_SCANLINE_LEGACY)
             {
                 // Swap Red (R) and Blue (B) channel (used for D3DFMT_A2R10G10B10 legacy sources)
+                // Alpha handling is hoisted so the loops below stay branch-free and vectorize
+                const uint32_t keep = (tflags & TEXP_SCANLINE_SETALPHA) ? 0x000ffc00 : 0xC00ffc00;
+                const uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xC0000000 : 0;
+
                 if (pDestination == pSource)
                 {
                     auto dPtr = static_cast<uint32_t*>(pDestination);
-                    for (size_t count = 0; count < (outSize - 3); count += 4)
+                    const size_t count = outSize / 4;
+                    for (size_t i = 0; i < count; ++i)
                     {
-                        const uint32_t t = *dPtr;
+                        const uint32_t t = dPtr[i];
 
                         uint32_t t1 = (t & 0x3ff00000) >> 20;
                         uint32_t t2 = (t & 0x000003ff) << 20;
-                        uint32_t t3 = (t & 0x000ffc00);
-                        uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xC0000000 : (t & 0xC0000000);
+                        uint32_t t3 = (t & keep);
 
-                        *(dPtr++) = t1 | t2 | t3 | ta;
+                        dPtr[i] = t1 | t2 | t3 | ta;
                     }
                 }
                 else
                 {
                     const uint32_t * __restrict sPtr = static_cast<const uint32_t*>(pSource);
                     uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
-                    const size_t size = std::min<size_t>(outSize, inSize);
-                    for (size_t count = 0; count < (size - 3); count += 4)
+                    const size_t count = std::min<size_t>(outSize, inSize) / 4;
+                    for (size_t i = 0; i < count; ++i)
                     {
-                        const uint32_t t = *(sPtr++);
+                        const uint32_t t = sPtr[i];
 
                         uint32_t t1 = (t & 0x3ff00000) >> 20;
                         uint32_t t2 = (t & 0x000003ff) << 20;
-                        uint32_t t3 = (t & 0x000ffc00);
-                        uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xC0000000 : (t & 0xC0000000);
+                        uint32_t t3 = (t & keep);
 
-                        *(dPtr++) = t1 | t2 | t3 | ta;
+                        dPtr[i] = t1 | t2 | t3 | ta;
                     }
                 }
                 return;
@@ -510,36 +510,38 @@ void DirectX::Internal::SwizzleScanline(
         if (inSize >= 4 && outSize >= 4)
         {
             // Swap Red (R) and Blue (B) channels (used to convert from DXGI 1.1 BGR formats to DXGI 1.0 RGB)
+            const uint32_t keep = (tflags & TEXP_SCANLINE_SETALPHA) ? 0x0000ff00 : 0xff00ff00;
+            const uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : 0;
+
             if (pDestination == pSource)
             {
                 auto dPtr = static_cast<uint32_t*>(pDestination);
-                for (size_t count = 0; count < (outSize - 3); count += 4)
+                const size_t count = outSize / 4;
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const uint32_t t = *dPtr;
+                    const uint32_t t = dPtr[i];
 
                     uint32_t t1 = (t & 0x00ff0000) >> 16;
                     uint32_t t2 = (t & 0x000000ff) << 16;
-                    uint32_t t3 = (t & 0x0000ff00);
-                    uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : (t & 0xFF000000);
+                    uint32_t t3 = (t & keep);
 
-                    *(dPtr++) = t1 | t2 | t3 | ta;
+                    dPtr[i] = t1 | t2 | t3 | ta;
                 }
             }
             else
             {
                 const uint32_t * __restrict sPtr = static_cast<const uint32_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
-                const size_t size = std::min<size_t>(outSize, inSize);
-                for (size_t count = 0; count < (size - 3); count += 4)
+                const size_t count = std::min<size_t>(outSize, inSize) / 4;
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const uint32_t t = *(sPtr++);
+                    const uint32_t t = sPtr[i];
 
                     uint32_t t1 = (t & 0x00ff0000) >> 16;
                     uint32_t t2 = (t & 0x000000ff) << 16;
-                    uint32_t t3 = (t & 0x0000ff00);
-                    uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : (t & 0xFF000000);
+                    uint32_t t3 = (t & keep);
 
-                    *(dPtr++) = t1 | t2 | t3 | ta;
+                    dPtr[i] = t1 | t2 | t3 | ta;
                 }
             }
             return;
@@ -622,6 +624,9 @@ bool DirectX::Internal::ExpandScanline(
     assert(IsValid(outFormat) && !IsPlanar(outFormat) && !IsPalettized(outFormat));
     assert(IsValid(inFormat) && !IsPlanar(inFormat) && !IsPalettized(inFormat));
 
+    // Loops are written over a precomputed texel count with the alpha override hoisted, so they vectorize
+    const uint32_t alpha = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : 0;
+
     switch (static_cast<int>(inFormat))
     {
     case DXGI_FORMAT_B5G6R5_UNORM:
@@ -634,15 +639,16 @@ bool DirectX::Internal::ExpandScanline(
             const uint16_t * __restrict sPtr = static_cast<const uint16_t*>(pSource);
             uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-            for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+            const size_t count = std::min<size_t>(inSize / 2, outSize / 4);
+            for (size_t i = 0; i < count; ++i)
             {
-                const uint16_t t = *(sPtr++);
+                const uint16_t t = sPtr[i];
 
                 uint32_t t1 = uint32_t(((t & 0xf800) >> 8) | ((t & 0xe000) >> 13));
                 uint32_t t2 = uint32_t(((t & 0x07e0) << 5) | ((t & 0x0600) >> 5));
                 uint32_t t3 = uint32_t(((t & 0x001f) << 19) | ((t & 0x001c) << 14));
 
-                *(dPtr++) = t1 | t2 | t3 | 0xff000000;
+                dPtr[i] = t1 | t2 | t3 | 0xff000000;
             }
             return true;
         }
@@ -658,16 +664,17 @@ bool DirectX::Internal::ExpandScanline(
             const uint16_t * __restrict sPtr = static_cast<const uint16_t*>(pSource);
             uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-            for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+            const size_t count = std::min<size_t>(inSize / 2, outSize / 4);
+            for (size_t i = 0; i < count; ++i)
             {
-                const uint16_t t = *(sPtr++);
+                const uint16_t t = sPtr[i];
 
                 uint32_t t1 = uint32_t(((t & 0x7c00) >> 7) | ((t & 0x7000) >> 12));
                 uint32_t t2 = uint32_t(((t & 0x03e0) << 6) | ((t & 0x0380) << 1));
                 uint32_t t3 = uint32_t(((t & 0x001f) << 19) | ((t & 0x001c) << 14));
-                uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : ((t & 0x8000) ? 0xff000000 : 0);
+                uint32_t ta = alpha | ((t & 0x8000) ? 0xff000000 : 0);
 
-                *(dPtr++) = t1 | t2 | t3 | ta;
+                dPtr[i] = t1 | t2 | t3 | ta;
             }
             return true;
         }
@@ -683,16 +690,17 @@ bool DirectX::Internal::ExpandScanline(
             const uint16_t * __restrict sPtr = static_cast<const uint16_t*>(pSource);
             uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-            for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+            const size_t count = std::min<size_t>(inSize / 2, outSize / 4);
+            for (size_t i = 0; i < count; ++i)
             {
-                const uint16_t t = *(sPtr++);
+                const uint16_t t = sPtr[i];
 
                 uint32_t t1 = uint32_t(((t & 0x0f00) >> 4) | ((t & 0x0f00) >> 8));
                 uint32_t t2 = uint32_t(((t & 0x00f0) << 8) | ((t & 0x00f0) << 4));
                 uint32_t t3 = uint32_t(((t & 0x000f) << 20) | ((t & 0x000f) << 16));
-                uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : uint32_t(((t & 0xf000) << 16) | ((t & 0xf000) << 12));
+                uint32_t ta = alpha | uint32_t(((t & 0xf000) << 16) | ((t & 0xf000) << 12));
 
-                *(dPtr++) = t1 | t2 | t3 | ta;
+                dPtr[i] = t1 | t2 | t3 | ta;
             }
             return true;
         }
@@ -708,16 +716,17 @@ bool DirectX::Internal::ExpandScanline(
             const uint16_t * __restrict sPtr = static_cast<const uint16_t*>(pSource);
             uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-            for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+            const size_t count = std::min<size_t>(inSize / 2, outSize / 4);
+            for (size_t i = 0; i < count; ++i)
             {
-                const uint16_t t = *(sPtr++);
+                const uint16_t t = sPtr[i];
 
                 uint32_t t1 = uint32_t(((t & 0xf000) >> 8) | ((t & 0xf000) >> 12));
                 uint32_t t2 = uint32_t((t & 0x0f00) | ((t & 0x0f00) << 4));
                 uint32_t t3 = uint32_t(((t & 0x00f0) << 16) | ((t & 0x00f0) << 12));
-                uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : uint32_t(((t & 0x000f) << 28) | ((t & 0x000f) << 24));
+                uint32_t ta = alpha | uint32_t(((t & 0x000f) << 28) | ((t & 0x000f) << 24));
 
-                *(dPtr++) = t1 | t2 | t3 | ta;
+                dPtr[i] = t1 | t2 | t3 | ta;
             }
             return true;
         }
@@ -4805,7 +4814,8 @@ namespace
         _In_ const Image& destImage,
         _In_ float threshold,
         size_t z,
-        const std::function<bool __cdecl(size_t, size_t)>& statusCallback) noexcept
+        const std::function<bool __cdecl(size_t, size_t)>& statusCallback,
+        AlphaStatistics* alphaStats) noexcept
     {
         assert(srcImage.width == destImage.width);
         assert(srcImage.height == destImage.height);
@@ -4817,6 +4827,11 @@ namespace
 
         size_t width = srcImage.width;
 
+        if (alphaStats)
+        {
+            ResetAlphaStatistics(*alphaStats);
+        }
+
         if (filter & TEX_FILTER_DITHER_DIFFUSION)
         {
             // Error diffusion dithering (aka Floyd-Steinberg dithering)
@@ -4842,6 +4857,11 @@ namespace
 
                 ConvertScanline(scanline.get(), width, destImage.format, srcImage.format, filter);
 
+                if (alphaStats)
+                {
+                    UpdateAlphaStatistics(*alphaStats, scanline.get(), width, ALPHA_OPAQUE_THRESHOLD);
+                }
+
                 if (!StoreScanlineDither(pDest, destImage.rowPitch, destImage.format, scanline.get(), width, threshold, h, z, pDiffusionErrors))
                     return E_FAIL;
 
@@ -4873,6 +4893,11 @@ namespace
 
                     ConvertScanline(scanline.get(), width, destImage.format, srcImage.format, filter);
 
+                    if (alphaStats)
+                    {
+                        UpdateAlphaStatistics(*alphaStats, scanline.get(), width, ALPHA_OPAQUE_THRESHOLD);
+                    }
+
                     if (!StoreScanlineDither(pDest, destImage.rowPitch, destImage.format, scanline.get(), width, threshold, h, z, nullptr))
                         return E_FAIL;
 
@@ -4898,6 +4923,11 @@ namespace
 
                     ConvertScanline(scanline.get(), width, destImage.format, srcImage.format, filter);
 
+                    if (alphaStats)
+                    {
+                        UpdateAlphaStatistics(*alphaStats, scanline.get(), width, ALPHA_OPAQUE_THRESHOLD);
+                    }
+
                     if (!StoreScanline(pDest, destImage.rowPitch, destImage.format, scanline.get(), width, threshold))
                         return E_FAIL;
 
@@ -4910,6 +4940,99 @@ namespace
         return S_OK;
     }
 
+    //-------------------------------------------------------------------------------------
+    // In-place conversion helpers
+    //-------------------------------------------------------------------------------------
+
+    // Filter flags that change pixel values beyond the format conversion itself
+    constexpr uint32_t c_InPlaceValueFlags = TEX_FILTER_DITHER_MASK | TEX_FILTER_FLOAT_X2BIAS
+        | TEX_FILTER_RGB_COPY_RED | TEX_FILTER_RGB_COPY_GREEN | TEX_FILTER_RGB_COPY_BLUE | TEX_FILTER_RGB_COPY_ALPHA;
+
+    // Returns true if ConvertScanline would not apply a gamma conversion
+    inline bool IsSRGBNeutral(_In_ DXGI_FORMAT srcFormat, _In_ DXGI_FORMAT destFormat, _In_ TEX_FILTER_FLAGS filter) noexcept
+    {
+        const bool srgbIn = IsSRGB(srcFormat) || (filter & TEX_FILTER_SRGB_IN);
+        const bool srgbOut = IsSRGB(destFormat) || (filter & TEX_FILTER_SRGB_OUT);
+        return srgbIn == srgbOut;
+    }
+
+    enum IN_PLACE_CONVERSION : uint32_t
+    {
+        IN_PLACE_GENERIC,       // Load, convert and store each scanline
+        IN_PLACE_REINTERPRET,   // Only the format changes
+        IN_PLACE_SWIZZLE,       // Swap the red and blue channels
+        IN_PLACE_SWIZZLE_ALPHA, // Swap the red and blue channels and set alpha to opaque
+    };
+
+    IN_PLACE_CONVERSION GetInPlaceConversion(
+        _In_ DXGI_FORMAT srcFormat,
+        _In_ DXGI_FORMAT destFormat,
+        _In_ TEX_FILTER_FLAGS filter) noexcept
+    {
+        if ((filter & c_InPlaceValueFlags) || !IsSRGBNeutral(srcFormat, destFormat, filter))
+            return IN_PLACE_GENERIC;
+
+        if (MakeLinear(srcFormat) == MakeLinear(destFormat))
+            return IN_PLACE_REINTERPRET;
+
+        const DXGI_FORMAT src = MakeLinear(srcFormat);
+        const DXGI_FORMAT dest = MakeLinear(destFormat);
+
+        if (dest == DXGI_FORMAT_R8G8B8A8_UNORM)
+        {
+            if (src == DXGI_FORMAT_B8G8R8A8_UNORM)
+                return IN_PLACE_SWIZZLE;
+            if (src == DXGI_FORMAT_B8G8R8X8_UNORM)
+                return IN_PLACE_SWIZZLE_ALPHA;
+        }
+        else if (dest == DXGI_FORMAT_B8G8R8A8_UNORM && src == DXGI_FORMAT_R8G8B8A8_UNORM)
+        {
+            return IN_PLACE_SWIZZLE;
+        }
+
+        return IN_PLACE_GENERIC;
+    }
+
+    HRESULT ConvertImageInPlace(
+        _In_ const Image& image,
+        _In_ DXGI_FORMAT format,
+        _In_ IN_PLACE_CONVERSION conversion,
+        _In_ TEX_FILTER_FLAGS filter,
+        _In_ float threshold,
+        size_t z) noexcept
+    {
+        switch (conversion)
+        {
+        case IN_PLACE_SWIZZLE:
+        case IN_PLACE_SWIZZLE_ALPHA:
+            {
+                const uint32_t tflags = (conversion == IN_PLACE_SWIZZLE_ALPHA) ? TEXP_SCANLINE_SETALPHA : TEXP_SCANLINE_NONE;
+                const size_t rowSize = image.width * 4;
+
+                uint8_t* pPixels = image.pixels;
+                for (size_t h = 0; h < image.height; ++h)
+                {
+                    SwizzleScanline(pPixels, rowSize, pPixels, rowSize, image.format, tflags);
+                    pPixels += image.rowPitch;
+                }
+            }
+            return S_OK;
+
+        case IN_PLACE_REINTERPRET:
+            return S_OK;
+
+        default:
+            {
+                // Each row is loaded in full before it is stored, so the source
+                // and destination can share the same memory
+                Image destImage = image;
+                destImage.format = format;
+
+                return ConvertCustom(image, filter, destImage, threshold, z, nullptr, nullptr);
+            }
+        }
+    }
+
     //-------------------------------------------------------------------------------------
     DXGI_FORMAT PlanarToSingle(_In_ DXGI_FORMAT format) noexcept
     {
@@ -5106,7 +5229,8 @@ HRESULT DirectX::ConvertEx(
     DXGI_FORMAT format,
     const ConvertOptions& options,
     ScratchImage& image,
-    std::function<bool __cdecl(size_t, size_t)> statusCallback)
+    std::function<bool __cdecl(size_t, size_t)> statusCallback,
+    AlphaStatistics* alphaStats)
 {
     if ((srcImage.format == format) || !IsValid(format))
         return E_INVALIDARG;
@@ -5147,10 +5271,16 @@ HRESULT DirectX::ConvertEx(
     if (UseWICConversion(options.filter, srcImage.format, format, pfGUID, targetGUID))
     {
         hr = ConvertUsingWIC(srcImage, pfGUID, targetGUID, options.filter, options.threshold, *rimage);
+
+        // WIC does not expose the converted pixels, use the source alpha instead
+        if (SUCCEEDED(hr) && alphaStats)
+        {
+            hr = ComputeAlphaStatistics(srcImage, ALPHA_OPAQUE_THRESHOLD, *alphaStats);
+        }
     }
     else
     {
-        hr = ConvertCustom(srcImage, options.filter, *rimage, options.threshold, 0, statusCallback);
+        hr = ConvertCustom(srcImage, options.filter, *rimage, options.threshold, 0, statusCallback, alphaStats);
     }
 
     if (FAILED(hr))
@@ -5200,7 +5330,8 @@ HRESULT DirectX::ConvertEx(
     DXGI_FORMAT format,
     const ConvertOptions& options,
     ScratchImage& result,
-    std::function<bool __cdecl(size_t, size_t)> statusCallback)
+    std::function<bool __cdecl(size_t, size_t)> statusCallback,
+    AlphaStatistics* alphaStats)
 {
     if (!srcImages || !nimages || (metadata.format == format) || !IsValid(format))
         return E_INVALIDARG;
@@ -5224,7 +5355,7 @@ HRESULT DirectX::ConvertEx(
         // the ConvertEx overload that takes a single image.
         // This provides a better user experience as progress will be reported as the image
         // is being processed, instead of after processing has been completed.
-        return ConvertEx(srcImages[0], format, options, result, statusCallback);
+        return ConvertEx(srcImages[0], format, options, result, statusCallback, alphaStats);
     }
 
     TexMetadata mdata2 = metadata;
@@ -5286,13 +5417,20 @@ HRESULT DirectX::ConvertEx(
                 return E_FAIL;
             }
 
+            AlphaStatistics* imageAlphaStats = alphaStats ? &alphaStats[index] : nullptr;
+
             if (usewic)
             {
                 hr = ConvertUsingWIC(src, pfGUID, targetGUID, options.filter, options.threshold, dst);
+
+                if (SUCCEEDED(hr) && imageAlphaStats)
+                {
+                    hr = ComputeAlphaStatistics(src, ALPHA_OPAQUE_THRESHOLD, *imageAlphaStats);
+                }
             }
             else
             {
-                hr = ConvertCustom(src, options.filter, dst, options.threshold, 0, nullptr);
+                hr = ConvertCustom(src, options.filter, dst, options.threshold, 0, nullptr, imageAlphaStats);
             }
 
             if (FAILED(hr))
@@ -5348,13 +5486,20 @@ HRESULT DirectX::ConvertEx(
                         return E_FAIL;
                     }
 
+                    AlphaStatistics* imageAlphaStats = alphaStats ? &alphaStats[index] : nullptr;
+
                     if (usewic)
                     {
                         hr = ConvertUsingWIC(src, pfGUID, targetGUID, options.filter, options.threshold, dst);
+
+                        if (SUCCEEDED(hr) && imageAlphaStats)
+                        {
+                            hr = ComputeAlphaStatistics(src, ALPHA_OPAQUE_THRESHOLD, *imageAlphaStats);
+                        }
                     }
                     else
                     {
-                        hr = ConvertCustom(src, options.filter, dst, options.threshold, slice, nullptr);
+                        hr = ConvertCustom(src, options.filter, dst, options.threshold, slice, nullptr, imageAlphaStats);
                     }
 
                     if (FAILED(hr))
@@ -5397,6 +5542,115 @@ HRESULT DirectX::ConvertEx(
 }
 
 
+//-------------------------------------------------------------------------------------
+// Convert image in-place (formats with the same bits per pixel)
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::ConvertInPlace(
+    ScratchImage& image,
+    DXGI_FORMAT format,
+    TEX_FILTER_FLAGS filter,
+    float threshold) noexcept
+{
+    const TexMetadata& metadata = image.GetMetadata();
+
+    if (!image.GetImages() || (metadata.format == format) || !IsValid(format))
+        return E_INVALIDARG;
+
+    if (IsCompressed(metadata.format) || IsCompressed(format)
+        || IsPlanar(metadata.format) || IsPlanar(format)
+        || IsPalettized(metadata.format) || IsPalettized(format)
+        || IsTypeless(metadata.format) || IsTypeless(format)
+        || IsPacked(metadata.format) || IsPacked(format)
+        || IsVideo(metadata.format) || IsVideo(format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if (BitsPerPixel(metadata.format) != BitsPerPixel(format))
+        return E_INVALIDARG;
+
+    if ((metadata.width > UINT32_MAX) || (metadata.height > UINT32_MAX))
+        return E_INVALIDARG;
+
+    // Each row is converted where it is, so both formats must lay it out with the same size
+    {
+        size_t srcRowPitch, srcSlicePitch, destRowPitch, destSlicePitch;
+        HRESULT hr = ComputePitch(metadata.format, metadata.width, metadata.height, srcRowPitch, srcSlicePitch, CP_FLAGS_NONE);
+        if (FAILED(hr))
+            return hr;
+
+        hr = ComputePitch(format, metadata.width, metadata.height, destRowPitch, destSlicePitch, CP_FLAGS_NONE);
+        if (FAILED(hr))
+            return hr;
+
+        if ((srcRowPitch != destRowPitch) || (srcSlicePitch != destSlicePitch))
+            return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    const IN_PLACE_CONVERSION conversion = GetInPlaceConversion(metadata.format, format, filter);
+
+    const Image* images = image.GetImages();
+    const size_t nimages = image.GetImageCount();
+
+    HRESULT hr = S_OK;
+
+    switch (metadata.dimension)
+    {
+    case TEX_DIMENSION_TEXTURE1D:
+    case TEX_DIMENSION_TEXTURE2D:
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            hr = ConvertImageInPlace(images[index], format, conversion, filter, threshold, 0);
+            if (FAILED(hr))
+                break;
+        }
+        break;
+
+    case TEX_DIMENSION_TEXTURE3D:
+        {
+            size_t index = 0;
+            size_t d = metadata.depth;
+            for (size_t level = 0; level < metadata.mipLevels && SUCCEEDED(hr); ++level)
+            {
+                for (size_t slice = 0; slice < d; ++slice, ++index)
+                {
+                    if (index >= nimages)
+                    {
+                        hr = E_FAIL;
+                        break;
+                    }
+
+                    hr = ConvertImageInPlace(images[index], format, conversion, filter, threshold, slice);
+                    if (FAILED(hr))
+                        break;
+                }
+
+                if (d > 1)
+                    d >>= 1;
+            }
+        }
+        break;
+
+    default:
+        return E_FAIL;
+    }
+
+    if (FAILED(hr))
+    {
+        // The pixels may be partially converted
+        image.Release();
+        return hr;
+    }
+
+    if (!image.OverrideFormat(format))
+    {
+        image.Release();
+        return E_FAIL;
+    }
+
+    return S_OK;
+}
+
+
 //-------------------------------------------------------------------------------------
 // Convert image from planar to single plane (image)
 //-------------------------------------------------------------------------------------
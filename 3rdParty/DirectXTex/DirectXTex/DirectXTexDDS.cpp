@@ -13,6 +13,15 @@
 
 #include "DDS.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#pragma warning(disable : 4616 6993)
+#endif
+
 using namespace DirectX;
 using namespace DirectX::Internal;
 
@@ -915,8 +924,9 @@ HRESULT DirectX::EncodeDDSHeader(
     if (FAILED(hr))
         return hr;
 
-    if (slicePitch > UINT32_MAX
-        || rowPitch > UINT32_MAX)
+    // Only the pitch stored in the header has to fit in 32 bits, so uncompressed
+    // surfaces larger than 4 GB can still be written
+    if (IsCompressed(metadata.format) ? (slicePitch > UINT32_MAX) : (rowPitch > UINT32_MAX))
         return E_FAIL;
 
     if (IsCompressed(metadata.format))
@@ -1055,6 +1065,9 @@ namespace
         assert(pSource && inSize > 0);
         assert(IsValid(outFormat) && !IsPlanar(outFormat) && !IsPalettized(outFormat));
 
+        // Loops are written over a precomputed texel count with the alpha override hoisted, so they vectorize
+        const uint32_t alpha = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : 0;
+
         switch (inFormat)
         {
         case TEXP_LEGACY_R8G8B8:
@@ -1067,15 +1080,15 @@ namespace
                 const uint8_t * __restrict sPtr = static_cast<const uint8_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < (inSize - 2)) && (ocount < (outSize - 3))); icount += 3, ocount += 4)
+                const size_t count = std::min<size_t>(inSize / 3, outSize / 4);
+                for (size_t i = 0; i < count; ++i)
                 {
                     // 24bpp Direct3D 9 files are actually BGR, so need to swizzle as well
-                    uint32_t t1 = uint32_t(*(sPtr) << 16);
-                    uint32_t t2 = uint32_t(*(sPtr + 1) << 8);
-                    uint32_t t3 = uint32_t(*(sPtr + 2));
+                    uint32_t t1 = uint32_t(sPtr[i * 3] << 16);
+                    uint32_t t2 = uint32_t(sPtr[i * 3 + 1] << 8);
+                    uint32_t t3 = uint32_t(sPtr[i * 3 + 2]);
 
-                    *(dPtr++) = t1 | t2 | t3 | 0xff000000;
-                    sPtr += 3;
+                    dPtr[i] = t1 | t2 | t3 | 0xff000000;
                 }
                 return true;
             }
@@ -1091,15 +1104,16 @@ namespace
                     const uint8_t* __restrict sPtr = static_cast<const uint8_t*>(pSource);
                     uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                    for (size_t ocount = 0, icount = 0; ((icount < inSize) && (ocount < (outSize - 3))); ++icount, ocount += 4)
+                    const size_t count = std::min<size_t>(inSize, outSize / 4);
+                    for (size_t i = 0; i < count; ++i)
                     {
-                        const uint8_t t = *(sPtr++);
+                        const uint8_t t = sPtr[i];
 
                         uint32_t t1 = uint32_t((t & 0xe0) | ((t & 0xe0) >> 3) | ((t & 0xc0) >> 6));
                         uint32_t t2 = uint32_t(((t & 0x1c) << 11) | ((t & 0x1c) << 8) | ((t & 0x18) << 5));
                         uint32_t t3 = uint32_t(((t & 0x03) << 22) | ((t & 0x03) << 20) | ((t & 0x03) << 18) | ((t & 0x03) << 16));
 
-                        *(dPtr++) = t1 | t2 | t3 | 0xff000000;
+                        dPtr[i] = t1 | t2 | t3 | 0xff000000;
                     }
                     return true;
                 }
@@ -1112,15 +1126,16 @@ namespace
                     const uint8_t* __restrict sPtr = static_cast<const uint8_t*>(pSource);
                     uint16_t * __restrict dPtr = static_cast<uint16_t*>(pDestination);
 
-                    for (size_t ocount = 0, icount = 0; ((icount < inSize) && (ocount < (outSize - 1))); ++icount, ocount += 2)
+                    const size_t count = std::min<size_t>(inSize, outSize / 2);
+                    for (size_t i = 0; i < count; ++i)
                     {
-                        const unsigned t = *(sPtr++);
+                        const unsigned t = sPtr[i];
 
                         unsigned t1 = ((t & 0xe0u) << 8) | ((t & 0xc0u) << 5);
                         unsigned t2 = ((t & 0x1cu) << 6) | ((t & 0x1cu) << 3);
                         unsigned t3 = ((t & 0x03u) << 3) | ((t & 0x03u) << 1) | ((t & 0x02) >> 1);
 
-                        *(dPtr++) = static_cast<uint16_t>(t1 | t2 | t3);
+                        dPtr[i] = static_cast<uint16_t>(t1 | t2 | t3);
                     }
                     return true;
                 }
@@ -1140,16 +1155,17 @@ namespace
                 const uint16_t* __restrict sPtr = static_cast<const uint16_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+                const size_t count = std::min<size_t>(inSize / 2, outSize / 4);
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const uint16_t t = *(sPtr++);
+                    const uint16_t t = sPtr[i];
 
                     uint32_t t1 = uint32_t((t & 0x00e0) | ((t & 0x00e0) >> 3) | ((t & 0x00c0) >> 6));
                     uint32_t t2 = uint32_t(((t & 0x001c) << 11) | ((t & 0x001c) << 8) | ((t & 0x0018) << 5));
                     uint32_t t3 = uint32_t(((t & 0x0003) << 22) | ((t & 0x0003) << 20) | ((t & 0x0003) << 18) | ((t & 0x0003) << 16));
-                    uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : uint32_t((t & 0xff00) << 16);
+                    uint32_t ta = alpha | uint32_t((t & 0xff00) << 16);
 
-                    *(dPtr++) = t1 | t2 | t3 | ta;
+                    dPtr[i] = t1 | t2 | t3 | ta;
                 }
                 return true;
             }
@@ -1165,11 +1181,12 @@ namespace
                 const uint8_t* __restrict sPtr = static_cast<const uint8_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < inSize) && (ocount < (outSize - 3))); ++icount, ocount += 4)
+                const size_t count = std::min<size_t>(inSize, outSize / 4);
+                for (size_t i = 0; i < count; ++i)
                 {
-                    uint8_t t = *(sPtr++);
+                    uint8_t t = sPtr[i];
 
-                    *(dPtr++) = pal8[t];
+                    dPtr[i] = pal8[t];
                 }
                 return true;
             }
@@ -1185,14 +1202,15 @@ namespace
                 const uint16_t* __restrict sPtr = static_cast<const uint16_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+                const size_t count = std::min<size_t>(inSize / 2, outSize / 4);
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const uint16_t t = *(sPtr++);
+                    const uint16_t t = sPtr[i];
 
                     uint32_t t1 = pal8[t & 0xff];
-                    uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : uint32_t((t & 0xff00) << 16);
+                    uint32_t ta = alpha | uint32_t((t & 0xff00) << 16);
 
-                    *(dPtr++) = t1 | ta;
+                    dPtr[i] = t1 | ta;
                 }
                 return true;
             }
@@ -1208,14 +1226,15 @@ namespace
                     const uint8_t * __restrict sPtr = static_cast<const uint8_t*>(pSource);
                     uint16_t * __restrict dPtr = static_cast<uint16_t*>(pDestination);
 
-                    for (size_t ocount = 0, icount = 0; ((icount < inSize) && (ocount < (outSize - 1))); ++icount, ocount += 2)
+                    const size_t count = std::min<size_t>(inSize, outSize / 2);
+                    for (size_t i = 0; i < count; ++i)
                     {
-                        const unsigned t = *(sPtr++);
+                        const unsigned t = sPtr[i];
 
                         unsigned t1 = (t & 0x0fu);
                         unsigned ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xf000u : ((t & 0xf0u) << 8);
 
-                        *(dPtr++) = static_cast<uint16_t>(t1 | (t1 << 4) | (t1 << 8) | ta);
+                        dPtr[i] = static_cast<uint16_t>(t1 | (t1 << 4) | (t1 << 8) | ta);
                     }
                     return true;
                 }
@@ -1228,14 +1247,15 @@ namespace
                     const uint8_t * __restrict sPtr = static_cast<const uint8_t*>(pSource);
                     uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                    for (size_t ocount = 0, icount = 0; ((icount < inSize) && (ocount < (outSize - 3))); ++icount, ocount += 4)
+                    const size_t count = std::min<size_t>(inSize, outSize / 4);
+                    for (size_t i = 0; i < count; ++i)
                     {
-                        const uint8_t t = *(sPtr++);
+                        const uint8_t t = sPtr[i];
 
                         uint32_t t1 = uint32_t(((t & 0x0f) << 4) | (t & 0x0f));
-                        uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : uint32_t(((t & 0xf0) << 24) | ((t & 0xf0) << 20));
+                        uint32_t ta = alpha | uint32_t(((t & 0xf0) << 24) | ((t & 0xf0) << 20));
 
-                        *(dPtr++) = t1 | (t1 << 8) | (t1 << 16) | ta;
+                        dPtr[i] = t1 | (t1 << 8) | (t1 << 16) | ta;
                     }
                     return true;
                 }
@@ -1255,16 +1275,17 @@ namespace
                 const uint16_t * __restrict sPtr = static_cast<const uint16_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+                const size_t count = std::min<size_t>(inSize / 2, outSize / 4);
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const uint32_t t = *(sPtr++);
+                    const uint32_t t = sPtr[i];
 
                     uint32_t t1 = uint32_t((t & 0x0f00) >> 4) | ((t & 0x0f00) >> 8);
                     uint32_t t2 = uint32_t((t & 0x00f0) << 8) | ((t & 0x00f0) << 4);
                     uint32_t t3 = uint32_t((t & 0x000f) << 20) | ((t & 0x000f) << 16);
-                    uint32_t ta = uint32_t((tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : (((t & 0xf000) << 16) | ((t & 0xf000) << 12)));
+                    uint32_t ta = alpha | uint32_t(((t & 0xf000) << 16) | ((t & 0xf000) << 12));
 
-                    *(dPtr++) = t1 | t2 | t3 | ta;
+                    dPtr[i] = t1 | t2 | t3 | ta;
                 }
                 return true;
             }
@@ -1280,13 +1301,14 @@ namespace
                 const uint8_t * __restrict sPtr = static_cast<const uint8_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < inSize) && (ocount < (outSize - 3))); ++icount, ocount += 4)
+                const size_t count = std::min<size_t>(inSize, outSize / 4);
+                for (size_t i = 0; i < count; ++i)
                 {
-                    uint32_t t1 = *(sPtr++);
+                    uint32_t t1 = sPtr[i];
                     uint32_t t2 = (t1 << 8);
                     uint32_t t3 = (t1 << 16);
 
-                    *(dPtr++) = t1 | t2 | t3 | 0xff000000;
+                    dPtr[i] = t1 | t2 | t3 | 0xff000000;
                 }
                 return true;
             }
@@ -1302,15 +1324,16 @@ namespace
                 const uint16_t* __restrict sPtr = static_cast<const uint16_t*>(pSource);
                 uint64_t * __restrict dPtr = static_cast<uint64_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 7))); icount += 2, ocount += 8)
+                const size_t count = std::min<size_t>(inSize / 2, outSize / 8);
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const uint16_t t = *(sPtr++);
+                    const uint16_t t = sPtr[i];
 
                     uint64_t t1 = t;
                     uint64_t t2 = (t1 << 16);
                     uint64_t t3 = (t1 << 32);
 
-                    *(dPtr++) = t1 | t2 | t3 | 0xffff000000000000;
+                    dPtr[i] = t1 | t2 | t3 | 0xffff000000000000;
                 }
                 return true;
             }
@@ -1326,16 +1349,17 @@ namespace
                 const uint16_t* __restrict sPtr = static_cast<const uint16_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+                const size_t count = std::min<size_t>(inSize / 2, outSize / 4);
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const uint16_t t = *(sPtr++);
+                    const uint16_t t = sPtr[i];
 
                     uint32_t t1 = uint32_t(t & 0xff);
                     uint32_t t2 = uint32_t(t1 << 8);
                     uint32_t t3 = uint32_t(t1 << 16);
-                    uint32_t ta = (tflags & TEXP_SCANLINE_SETALPHA) ? 0xff000000 : uint32_t((t & 0xff00) << 16);
+                    uint32_t ta = alpha | uint32_t((t & 0xff00) << 16);
 
-                    *(dPtr++) = t1 | t2 | t3 | ta;
+                    dPtr[i] = t1 | t2 | t3 | ta;
                 }
                 return true;
             }
@@ -1351,9 +1375,10 @@ namespace
                 const uint16_t* __restrict sPtr = static_cast<const uint16_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
 
-                for (size_t ocount = 0, icount = 0; ((icount < (inSize - 1)) && (ocount < (outSize - 3))); icount += 2, ocount += 4)
+                const size_t count = std::min<size_t>(inSize / 2, outSize / 4);
+                for (size_t i = 0; i < count; ++i)
                 {
-                    const uint16_t t = *(sPtr++);
+                    const uint16_t t = sPtr[i];
 
                     // Converts unsigned 6-bit/signed 5-bit/signed 5-bit bump luminance to 8:8:8:8 unsigned
                     uint32_t t1 = ((t & 0xFC00) >> 8) | ((t & 0xC000) >> 14);
@@ -1365,7 +1390,7 @@ namespace
                     auto t2 = static_cast<uint32_t>(u << 3 | u >> 2);
                     auto t3 = static_cast<uint32_t>(v << 3 | v >> 2);
 
-                    *(dPtr++) = t1 | (t2 << 8) | (t3 << 16) | 0xff000000;
+                    dPtr[i] = t1 | (t2 << 8) | (t3 << 16) | 0xff000000;
                 }
                 return true;
             }
@@ -1456,6 +1481,124 @@ namespace
         }
     }
 
+    //-------------------------------------------------------------------------------------
+    // Converts or copies a band of scanlines for CopyImage
+    //-------------------------------------------------------------------------------------
+    _Success_(return)
+        bool CopyScanlineBand(
+        _Out_writes_bytes_(dpitch * height) uint8_t* pDest,
+        size_t dpitch,
+        _In_reads_bytes_(spitch * height) const uint8_t* pSrc,
+        size_t spitch,
+        size_t height,
+        _In_ DXGI_FORMAT format,
+        uint32_t convFlags,
+        uint32_t tflags,
+        _In_reads_opt_(256) const uint32_t* pal8) noexcept
+    {
+        for (size_t h = 0; h < height; ++h)
+        {
+            if (convFlags & CONV_FLAGS_EXPAND)
+            {
+                if (convFlags & CONV_FLAGS_4444)
+                {
+                    if (!ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
+                        pSrc, spitch,
+                        (convFlags & CONF_FLAGS_11ON12) ? WIN11_DXGI_FORMAT_A4B4G4R4_UNORM : DXGI_FORMAT_B4G4R4A4_UNORM,
+                        tflags))
+                        return false;
+                }
+                else if (convFlags & (CONV_FLAGS_565 | CONV_FLAGS_5551))
+                {
+                    if (!ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
+                        pSrc, spitch,
+                        (convFlags & CONV_FLAGS_565) ? DXGI_FORMAT_B5G6R5_UNORM : DXGI_FORMAT_B5G5R5A1_UNORM,
+                        tflags))
+                        return false;
+                }
+                else
+                {
+                    const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
+                    if (!LegacyExpandScanline(pDest, dpitch, format,
+                        pSrc, spitch, lformat, pal8,
+                        tflags))
+                        return false;
+                }
+            }
+            else if (convFlags & CONV_FLAGS_SWIZZLE)
+            {
+                SwizzleScanline(pDest, dpitch, pSrc, spitch, format, tflags);
+            }
+            else if (convFlags & (CONV_FLAGS_L8U8V8 | CONV_FLAGS_WUV10))
+            {
+                const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
+                if (!LegacyConvertScanline(pDest, dpitch, format,
+                    pSrc, spitch, lformat, tflags))
+                    return false;
+            }
+            else
+            {
+                CopyScanline(pDest, dpitch, pSrc, spitch, format, tflags);
+            }
+
+            pSrc += spitch;
+            pDest += dpitch;
+        }
+
+        return true;
+    }
+
+    // Number of scanlines each thread converts in CopyImage
+    constexpr size_t c_CopyBandRows = 64;
+
+    HRESULT CopyScanlines(
+        _Out_writes_bytes_(dpitch * height) uint8_t* pDest,
+        size_t dpitch,
+        _In_reads_bytes_(spitch * height) const uint8_t* pSrc,
+        size_t spitch,
+        size_t height,
+        _In_ DXGI_FORMAT format,
+        uint32_t convFlags,
+        uint32_t tflags,
+        _In_reads_opt_(256) const uint32_t* pal8) noexcept
+    {
+        const size_t bands = (height + c_CopyBandRows - 1) / c_CopyBandRows;
+
+        bool succeeded = true;
+    #ifdef _OPENMP
+    #pragma omp parallel for if (bands > 1) shared(succeeded)
+    #endif
+        for (int band = 0; band < static_cast<int>(bands); ++band)
+        {
+            const size_t row = size_t(band) * c_CopyBandRows;
+            const size_t rowCount = std::min(c_CopyBandRows, height - row);
+
+            if (!CopyScanlineBand(pDest + row * dpitch, dpitch, pSrc + row * spitch, spitch, rowCount,
+                format, convFlags, tflags, pal8))
+            {
+                succeeded = false;
+            }
+        }
+
+        return succeeded ? S_OK : E_FAIL;
+    }
+
+    // Pitch flags describing the source layout of legacy formats that are expanded on load
+    CP_FLAGS GetExpandedPitchFlags(CP_FLAGS cpFlags, uint32_t convFlags) noexcept
+    {
+        if (convFlags & CONV_FLAGS_EXPAND)
+        {
+            if (convFlags & CONV_FLAGS_888)
+                cpFlags |= CP_FLAGS_24BPP;
+            else if (convFlags & (CONV_FLAGS_565 | CONV_FLAGS_5551 | CONV_FLAGS_4444 | CONV_FLAGS_8332 | CONV_FLAGS_A8P8 | CONV_FLAGS_L16 | CONV_FLAGS_A8L8 | CONV_FLAGS_L6V5U5))
+                cpFlags |= CP_FLAGS_16BPP;
+            else if (convFlags & (CONV_FLAGS_44 | CONV_FLAGS_332 | CONV_FLAGS_PAL8 | CONV_FLAGS_L8))
+                cpFlags |= CP_FLAGS_8BPP;
+        }
+
+        return cpFlags;
+    }
+
     //-------------------------------------------------------------------------------------
     // Converts or copies image data from pPixels into scratch image data
     //-------------------------------------------------------------------------------------
@@ -1474,15 +1617,7 @@ namespace
         if (!size)
             return E_FAIL;
 
-        if (convFlags & CONV_FLAGS_EXPAND)
-        {
-            if (convFlags & CONV_FLAGS_888)
-                cpFlags |= CP_FLAGS_24BPP;
-            else if (convFlags & (CONV_FLAGS_565 | CONV_FLAGS_5551 | CONV_FLAGS_4444 | CONV_FLAGS_8332 | CONV_FLAGS_A8P8 | CONV_FLAGS_L16 | CONV_FLAGS_A8L8 | CONV_FLAGS_L6V5U5))
-                cpFlags |= CP_FLAGS_16BPP;
-            else if (convFlags & (CONV_FLAGS_44 | CONV_FLAGS_332 | CONV_FLAGS_PAL8 | CONV_FLAGS_L8))
-                cpFlags |= CP_FLAGS_8BPP;
-        }
+        cpFlags = GetExpandedPitchFlags(cpFlags, convFlags);
 
         size_t pixelSize, nimages;
         HRESULT hr = DetermineImageArray(metadata, cpFlags, nimages, pixelSize);
@@ -1593,54 +1728,10 @@ namespace
                         }
                         else
                         {
-                            for (size_t h = 0; h < images[index].height; ++h)
-                            {
-                                if (convFlags & CONV_FLAGS_EXPAND)
-                                {
-                                    if (convFlags & CONV_FLAGS_4444)
-                                    {
-                                        if (!ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
-                                            pSrc, spitch,
-                                            (convFlags & CONF_FLAGS_11ON12) ? WIN11_DXGI_FORMAT_A4B4G4R4_UNORM : DXGI_FORMAT_B4G4R4A4_UNORM,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                    else if (convFlags & (CONV_FLAGS_565 | CONV_FLAGS_5551))
-                                    {
-                                        if (!ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
-                                            pSrc, spitch,
-                                            (convFlags & CONV_FLAGS_565) ? DXGI_FORMAT_B5G6R5_UNORM : DXGI_FORMAT_B5G5R5A1_UNORM,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                    else
-                                    {
-                                        const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
-                                        if (!LegacyExpandScanline(pDest, dpitch, metadata.format,
-                                            pSrc, spitch, lformat, pal8,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                }
-                                else if (convFlags & CONV_FLAGS_SWIZZLE)
-                                {
-                                    SwizzleScanline(pDest, dpitch, pSrc, spitch, metadata.format, tflags);
-                                }
-                                else if (convFlags & (CONV_FLAGS_L8U8V8 | CONV_FLAGS_WUV10))
-                                {
-                                    const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
-                                    if (!LegacyConvertScanline(pDest, dpitch, metadata.format,
-                                        pSrc, spitch, lformat, tflags))
-                                        return E_FAIL;
-                                }
-                                else
-                                {
-                                    CopyScanline(pDest, dpitch, pSrc, spitch, metadata.format, tflags);
-                                }
-
-                                pSrc += spitch;
-                                pDest += dpitch;
-                            }
+                            hr = CopyScanlines(pDest, dpitch, pSrc, spitch, images[index].height,
+                                metadata.format, convFlags, tflags, pal8);
+                            if (FAILED(hr))
+                                return hr;
                         }
                     }
                 }
@@ -1699,54 +1790,10 @@ namespace
                         }
                         else
                         {
-                            for (size_t h = 0; h < images[index].height; ++h)
-                            {
-                                if (convFlags & CONV_FLAGS_EXPAND)
-                                {
-                                    if (convFlags & CONV_FLAGS_4444)
-                                    {
-                                        if (!ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
-                                            pSrc, spitch,
-                                            (convFlags & CONF_FLAGS_11ON12) ? WIN11_DXGI_FORMAT_A4B4G4R4_UNORM : DXGI_FORMAT_B4G4R4A4_UNORM,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                    else if (convFlags & (CONV_FLAGS_565 | CONV_FLAGS_5551))
-                                    {
-                                        if (!ExpandScanline(pDest, dpitch, DXGI_FORMAT_R8G8B8A8_UNORM,
-                                            pSrc, spitch,
-                                            (convFlags & CONV_FLAGS_565) ? DXGI_FORMAT_B5G6R5_UNORM : DXGI_FORMAT_B5G5R5A1_UNORM,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                    else
-                                    {
-                                        const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
-                                        if (!LegacyExpandScanline(pDest, dpitch, metadata.format,
-                                            pSrc, spitch, lformat, pal8,
-                                            tflags))
-                                            return E_FAIL;
-                                    }
-                                }
-                                else if (convFlags & CONV_FLAGS_SWIZZLE)
-                                {
-                                    SwizzleScanline(pDest, dpitch, pSrc, spitch, metadata.format, tflags);
-                                }
-                                else if (convFlags & (CONV_FLAGS_L8U8V8 | CONV_FLAGS_WUV10))
-                                {
-                                    const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
-                                    if (!LegacyConvertScanline(pDest, dpitch, metadata.format,
-                                        pSrc, spitch, lformat, tflags))
-                                        return E_FAIL;
-                                }
-                                else
-                                {
-                                    CopyScanline(pDest, dpitch, pSrc, spitch, metadata.format, tflags);
-                                }
-
-                                pSrc += spitch;
-                                pDest += dpitch;
-                            }
+                            hr = CopyScanlines(pDest, dpitch, pSrc, spitch, images[index].height,
+                                metadata.format, convFlags, tflags, pal8);
+                            if (FAILED(hr))
+                                return hr;
                         }
                     }
 
@@ -1763,175 +1810,609 @@ namespace
         return S_OK;
     }
 
-    HRESULT CopyImageInPlace(uint32_t convFlags, _In_ const ScratchImage& image) noexcept
-    {
-        if (!image.GetPixels())
-            return E_FAIL;
+    // Size of the chunks the image data is read and converted in
+    constexpr size_t c_ReadChunkSize = 4 * 1024 * 1024;
 
-        const Image* images = image.GetImages();
-        if (!images)
-            return E_FAIL;
+    // Number of chunks that can be read ahead of the conversion
+    constexpr size_t c_ReadAheadChunks = 2;
 
-        const TexMetadata& metadata = image.GetMetadata();
+    using ReadProc = HRESULT(*)(void* context, void* buffer, size_t count) noexcept;
 
-        if (IsPlanar(metadata.format))
-            return HRESULT_E_NOT_SUPPORTED;
+    // Largest count passed to a single ImageIOCallbacks Read or Write, which take a DWORD
+    constexpr size_t c_MaxIOCallbacksCount = 0x40000000;
 
-        uint32_t tflags = (convFlags & CONV_FLAGS_NOALPHA) ? TEXP_SCANLINE_SETALPHA : 0u;
-        if (convFlags & CONV_FLAGS_SWIZZLE)
-            tflags |= TEXP_SCANLINE_LEGACY;
+    HRESULT ReadFromIOCallbacks(void* context, void* buffer, size_t count) noexcept
+    {
+        auto pIOCallbacks = static_cast<const ImageIOCallbacks*>(context);
+        auto pDest = static_cast<uint8_t*>(buffer);
 
-        for (size_t i = 0; i < image.GetImageCount(); ++i)
+        while (count > 0)
         {
-            const Image* img = &images[i];
-            uint8_t *pPixels = img->pixels;
-            if (!pPixels)
-                return E_POINTER;
+            const size_t bytes = std::min(count, c_MaxIOCallbacksCount);
 
-            size_t rowPitch = img->rowPitch;
-
-            for (size_t h = 0; h < img->height; ++h)
-            {
-                if (convFlags & CONV_FLAGS_SWIZZLE)
-                {
-                    SwizzleScanline(pPixels, rowPitch, pPixels, rowPitch, metadata.format, tflags);
-                }
-                else if (convFlags & (CONV_FLAGS_L8U8V8 | CONV_FLAGS_WUV10))
-                {
-                    const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
-                    if (!LegacyConvertScanline(pPixels, rowPitch, metadata.format, pPixels, rowPitch, lformat, tflags))
-                    {
-                        return E_UNEXPECTED;
-                    }
-                }
-                else
-                {
-                    CopyScanline(pPixels, rowPitch, pPixels, rowPitch, metadata.format, tflags);
-                }
+            const HRESULT hr = pIOCallbacks->Read(pDest, static_cast<DWORD>(bytes));
+            if (FAILED(hr))
+                return hr;
 
-                pPixels += rowPitch;
-            }
+            pDest += bytes;
+            count -= bytes;
         }
 
         return S_OK;
     }
-}
 
+    HRESULT WriteToIOCallbacks(
+        _In_ const ImageIOCallbacks* pIOCallbacks,
+        _In_reads_bytes_(count) const void* buffer,
+        size_t count) noexcept
+    {
+        auto pSrc = static_cast<const uint8_t*>(buffer);
 
-//=====================================================================================
-// Entry-points
-//=====================================================================================
-
-//-------------------------------------------------------------------------------------
-// Obtain metadata from DDS file in memory/on disk
-//-------------------------------------------------------------------------------------
-
-_Use_decl_annotations_
-HRESULT DirectX::GetMetadataFromDDSMemory(
-    const uint8_t* pSource,
-    size_t size,
-    DDS_FLAGS flags,
-    TexMetadata& metadata) noexcept
-{
-    return GetMetadataFromDDSMemoryEx(pSource, size, flags, metadata, nullptr);
-}
-
-_Use_decl_annotations_
-HRESULT DirectX::GetMetadataFromDDSMemoryEx(
-    const uint8_t* pSource,
-    size_t size,
-    DDS_FLAGS flags,
-    TexMetadata& metadata,
-    DDSMetaData* ddPixelFormat) noexcept
-{
-    if (!pSource || size == 0)
-        return E_INVALIDARG;
+        while (count > 0)
+        {
+            const size_t bytes = std::min(count, c_MaxIOCallbacksCount);
 
-    uint32_t convFlags = 0;
-    return DecodeDDSHeader(pSource, size, flags, metadata, ddPixelFormat, convFlags);
-}
+            const HRESULT hr = pIOCallbacks->Write(pSrc, static_cast<DWORD>(bytes));
+            if (FAILED(hr))
+                return hr;
 
-_Use_decl_annotations_
-HRESULT DirectX::GetMetadataFromDDSFile(
-    const wchar_t* szFile,
-    DDS_FLAGS flags,
-    TexMetadata& metadata) noexcept
-{
-    return GetMetadataFromDDSFileEx(szFile, flags, metadata, nullptr);
-}
+            pSrc += bytes;
+            count -= bytes;
+        }
 
-_Use_decl_annotations_
-HRESULT DirectX::GetMetadataFromDDSFileEx(
-    const wchar_t* szFile,
-    DDS_FLAGS flags,
-    TexMetadata& metadata,
-    DDSMetaData* ddPixelFormat) noexcept
-{
-    if (!szFile)
-        return E_INVALIDARG;
+        return S_OK;
+    }
 
 #ifdef _WIN32
-    ScopedHandle hFile(safe_handle(CreateFile2(
-        szFile,
-        GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING,
-        nullptr)));
-    if (!hFile)
+    HRESULT ReadFromFile(void* context, void* buffer, size_t count) noexcept
     {
-        return HRESULT_FROM_WIN32(GetLastError());
-    }
+        if (count > UINT32_MAX)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
 
-    // Get the file size
-    FILE_STANDARD_INFO fileInfo;
-    if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+        DWORD bytesRead = 0;
+        if (!ReadFile(static_cast<HANDLE>(context), buffer, static_cast<DWORD>(count), &bytesRead, nullptr))
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        return (bytesRead == count) ? S_OK : E_FAIL;
+    }
+#else
+    HRESULT ReadFromFile(void* context, void* buffer, size_t count) noexcept
     {
-        return HRESULT_FROM_WIN32(GetLastError());
+        auto inFile = static_cast<std::ifstream*>(context);
+
+        inFile->read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(count));
+        return (*inFile) ? S_OK : E_FAIL;
     }
+#endif
 
-    // File is too big for 32-bit allocation, so reject read (4 GB should be plenty large enough for a valid DDS file)
-    if (fileInfo.EndOfFile.HighPart > 0)
+    //-------------------------------------------------------------------------------------
+    // Sequential reader that fetches the next chunks of image data on a background thread,
+    // so reading the file overlaps with converting the chunks that were already read
+    //-------------------------------------------------------------------------------------
+    class ReadAheadStream
     {
-        return HRESULT_E_FILE_TOO_LARGE;
-    }
+    public:
+        ReadAheadStream(_In_ ReadProc read, _In_opt_ void* context, size_t size) noexcept :
+            m_read(read),
+            m_context(context),
+            m_size(size),
+            m_position(0),
+            m_readIndex(0),
+            m_readOffset(0),
+            m_stop(false),
+            m_chunks{}
+        {
+        }
 
-    const size_t len = fileInfo.EndOfFile.LowPart;
-#else // !WIN32
-    std::ifstream inFile(std::filesystem::path(szFile), std::ios::in | std::ios::binary | std::ios::ate);
-    if (!inFile)
-        return E_FAIL;
+        ReadAheadStream(const ReadAheadStream&) = delete;
+        ReadAheadStream& operator=(const ReadAheadStream&) = delete;
 
-    std::streampos fileLen = inFile.tellg();
-    if (!inFile)
-        return E_FAIL;
+        ~ReadAheadStream()
+        {
+            Stop();
+        }
 
-    if (fileLen > UINT32_MAX)
-        return HRESULT_E_FILE_TOO_LARGE;
+        // Small images, or a failure to allocate the chunks or start the thread, fall back to
+        // reading synchronously from the source
+        void Start() noexcept
+        {
+            if (m_size <= c_ReadChunkSize)
+                return;
 
-    inFile.seekg(0, std::ios::beg);
-    if (!inFile)
-        return E_FAIL;
+            for (auto& chunk : m_chunks)
+            {
+                chunk.data.reset(new (std::nothrow) uint8_t[c_ReadChunkSize]);
+                if (!chunk.data)
+                {
+                    ReleaseChunks();
+                    return;
+                }
+            }
 
-    const size_t len = fileLen;
-#endif
+            try
+            {
+                m_worker = std::thread(&ReadAheadStream::Worker, this);
+            }
+            catch (...)
+            {
+                ReleaseChunks();
+            }
+        }
 
-    // Need at least enough data to fill the standard header and magic number to be a valid DDS
-    if (len < DDS_MIN_HEADER_SIZE)
-    {
-        return E_FAIL;
-    }
+        HRESULT Read(_Out_writes_bytes_(count) void* buffer, size_t count) noexcept
+        {
+            if (count > (m_size - m_position))
+                return HRESULT_E_HANDLE_EOF;
 
-    // Read the header in (including extended header if present)
-    uint8_t header[DDS_DX10_HEADER_SIZE] = {};
+            m_position += count;
 
-#ifdef _WIN32
-    DWORD bytesRead = 0;
-    if (!ReadFile(hFile.get(), header, DDS_DX10_HEADER_SIZE, &bytesRead, nullptr))
-    {
-        return HRESULT_FROM_WIN32(GetLastError());
-    }
+            if (!m_worker.joinable())
+                return m_read(m_context, buffer, count);
 
-    const auto headerLen = static_cast<size_t>(bytesRead);
-#else
-    const auto headerLen = std::min<size_t>(len, DDS_DX10_HEADER_SIZE);
+            auto pDest = static_cast<uint8_t*>(buffer);
+            while (count > 0)
+            {
+                Chunk& chunk = m_chunks[m_readIndex % c_ReadAheadChunks];
+
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_filled.wait(lock, [&chunk] { return chunk.filled; });
+                }
+
+                if (FAILED(chunk.hr))
+                    return chunk.hr;
+
+                const size_t bytes = std::min(count, chunk.size - m_readOffset);
+                memcpy(pDest, chunk.data.get() + m_readOffset, bytes);
+
+                pDest += bytes;
+                count -= bytes;
+                m_readOffset += bytes;
+
+                if (m_readOffset == chunk.size)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        chunk.filled = false;
+                    }
+                    m_emptied.notify_one();
+
+                    ++m_readIndex;
+                    m_readOffset = 0;
+                }
+            }
+
+            return S_OK;
+        }
+
+    private:
+        struct Chunk
+        {
+            std::unique_ptr<uint8_t[]> data;
+            size_t size;
+            HRESULT hr;
+            bool filled;
+        };
+
+        void Worker() noexcept
+        {
+            size_t offset = 0;
+            for (size_t index = 0; offset < m_size; ++index)
+            {
+                Chunk& chunk = m_chunks[index % c_ReadAheadChunks];
+
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_emptied.wait(lock, [this, &chunk] { return m_stop || !chunk.filled; });
+                    if (m_stop)
+                        return;
+                }
+
+                const size_t bytes = std::min(c_ReadChunkSize, m_size - offset);
+                const HRESULT hr = m_read(m_context, chunk.data.get(), bytes);
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    chunk.size = bytes;
+                    chunk.hr = hr;
+                    chunk.filled = true;
+                }
+                m_filled.notify_one();
+
+                if (FAILED(hr))
+                    return;
+
+                offset += bytes;
+            }
+        }
+
+        void Stop() noexcept
+        {
+            if (!m_worker.joinable())
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_emptied.notify_one();
+
+            m_worker.join();
+        }
+
+        void ReleaseChunks() noexcept
+        {
+            for (auto& chunk : m_chunks)
+            {
+                chunk.data.reset();
+            }
+        }
+
+        ReadProc                m_read;
+        void*                   m_context;
+        size_t                  m_size;
+        size_t                  m_position;
+        size_t                  m_readIndex;
+        size_t                  m_readOffset;
+        bool                    m_stop;
+        Chunk                   m_chunks[c_ReadAheadChunks];
+        std::mutex              m_mutex;
+        std::condition_variable m_filled;
+        std::condition_variable m_emptied;
+        std::thread             m_worker;
+    };
+
+    //-------------------------------------------------------------------------------------
+    // Reads legacy format image data from the callbacks a band of scanlines at a time,
+    // expanding each band into the scratch image before reading the next
+    //-------------------------------------------------------------------------------------
+    HRESULT ReadAndExpandImage(
+        _In_ ReadProc read,
+        _In_opt_ void* context,
+        _In_ size_t size,
+        _In_ const TexMetadata& metadata,
+        _In_ CP_FLAGS cpFlags,
+        _In_ uint32_t convFlags,
+        _In_reads_opt_(256) const uint32_t *pal8,
+        _In_ const ScratchImage& image) noexcept
+    {
+        assert(read);
+        assert(image.GetPixels());
+        assert(convFlags & CONV_FLAGS_EXPAND);
+
+        if (!size)
+            return E_FAIL;
+
+        if (IsCompressed(metadata.format) || IsPlanar(metadata.format))
+            return E_UNEXPECTED;
+
+        cpFlags = GetExpandedPitchFlags(cpFlags, convFlags);
+
+        size_t pixelSize, nimages;
+        HRESULT hr = DetermineImageArray(metadata, cpFlags, nimages, pixelSize);
+        if (FAILED(hr))
+            return hr;
+
+        if ((nimages == 0) || (nimages != image.GetImageCount()))
+        {
+            return E_FAIL;
+        }
+
+        if (pixelSize > size)
+        {
+            return HRESULT_E_HANDLE_EOF;
+        }
+
+        const Image* images = image.GetImages();
+        if (!images)
+        {
+            return E_FAIL;
+        }
+
+        ReadAheadStream stream(read, context, pixelSize);
+        stream.Start();
+
+        // The top-level image has the widest scanlines
+        size_t maxPitch, slicePitch;
+        hr = ComputePitch(metadata.format, metadata.width, metadata.height, maxPitch, slicePitch, cpFlags);
+        if (FAILED(hr))
+            return hr;
+
+        if (!maxPitch)
+            return E_FAIL;
+
+        const size_t chunkRows = std::max<size_t>(1, c_ReadChunkSize / maxPitch);
+
+        std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[chunkRows * maxPitch]);
+        if (!temp)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        uint32_t tflags = (convFlags & CONV_FLAGS_NOALPHA) ? TEXP_SCANLINE_SETALPHA : 0u;
+        if (convFlags & CONV_FLAGS_SWIZZLE)
+            tflags |= TEXP_SCANLINE_LEGACY;
+
+        // Scratch images are stored in the same order as the file
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const Image& img = images[index];
+
+            uint8_t *pDest = img.pixels;
+            if (!pDest)
+                return E_POINTER;
+
+            size_t spitch;
+            hr = ComputePitch(metadata.format, img.width, img.height, spitch, slicePitch, cpFlags);
+            if (FAILED(hr))
+                return hr;
+
+            if (spitch > maxPitch)
+                return E_FAIL;
+
+            for (size_t row = 0; row < img.height; row += chunkRows)
+            {
+                const size_t rowCount = std::min(chunkRows, img.height - row);
+
+                hr = stream.Read(temp.get(), rowCount * spitch);
+                if (FAILED(hr))
+                    return hr;
+
+                hr = CopyScanlines(pDest + row * img.rowPitch, img.rowPitch, temp.get(), spitch, rowCount,
+                    metadata.format, convFlags, tflags, pal8);
+                if (FAILED(hr))
+                    return hr;
+            }
+        }
+
+        return S_OK;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Applies the swizzle/alpha/legacy fix-ups in place to a band of scanlines
+    //-------------------------------------------------------------------------------------
+    _Success_(return)
+        bool FixScanlineBand(
+            _Inout_updates_bytes_(rowPitch * height) uint8_t* pPixels,
+            size_t rowPitch,
+            size_t height,
+            _In_ DXGI_FORMAT format,
+            uint32_t convFlags,
+            uint32_t tflags) noexcept
+    {
+        const TEXP_LEGACY_FORMAT lformat = FindLegacyFormat(convFlags);
+
+        for (size_t h = 0; h < height; ++h)
+        {
+            if (convFlags & CONV_FLAGS_SWIZZLE)
+            {
+                SwizzleScanline(pPixels, rowPitch, pPixels, rowPitch, format, tflags);
+            }
+            else if (convFlags & (CONV_FLAGS_L8U8V8 | CONV_FLAGS_WUV10))
+            {
+                if (!LegacyConvertScanline(pPixels, rowPitch, format, pPixels, rowPitch, lformat, tflags))
+                    return false;
+            }
+            else
+            {
+                CopyScanline(pPixels, rowPitch, pPixels, rowPitch, format, tflags);
+            }
+
+            pPixels += rowPitch;
+        }
+
+        return true;
+    }
+
+    HRESULT FixScanlines(
+        _Inout_updates_bytes_(rowPitch * height) uint8_t* pPixels,
+        size_t rowPitch,
+        size_t height,
+        _In_ DXGI_FORMAT format,
+        uint32_t convFlags,
+        uint32_t tflags) noexcept
+    {
+        const size_t bands = (height + c_CopyBandRows - 1) / c_CopyBandRows;
+
+        bool succeeded = true;
+    #ifdef _OPENMP
+    #pragma omp parallel for if (bands > 1) shared(succeeded)
+    #endif
+        for (int band = 0; band < static_cast<int>(bands); ++band)
+        {
+            const size_t row = size_t(band) * c_CopyBandRows;
+            const size_t rowCount = std::min(c_CopyBandRows, height - row);
+
+            if (!FixScanlineBand(pPixels + row * rowPitch, rowPitch, rowCount, format, convFlags, tflags))
+            {
+                succeeded = false;
+            }
+        }
+
+        return succeeded ? S_OK : E_UNEXPECTED;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Reads image data straight into the scratch image a band of scanlines at a time,
+    // applying the in-place fix-ups to each band while it is still in cache
+    //-------------------------------------------------------------------------------------
+    HRESULT ReadAndFixImage(
+        _In_ ReadProc read,
+        _In_opt_ void* context,
+        uint32_t convFlags,
+        _In_ const ScratchImage& image) noexcept
+    {
+        assert(read);
+
+        if (!image.GetPixels())
+            return E_FAIL;
+
+        const Image* images = image.GetImages();
+        if (!images)
+            return E_FAIL;
+
+        const TexMetadata& metadata = image.GetMetadata();
+
+        if (IsPlanar(metadata.format))
+            return HRESULT_E_NOT_SUPPORTED;
+
+        uint32_t tflags = (convFlags & CONV_FLAGS_NOALPHA) ? TEXP_SCANLINE_SETALPHA : 0u;
+        if (convFlags & CONV_FLAGS_SWIZZLE)
+            tflags |= TEXP_SCANLINE_LEGACY;
+
+        ReadAheadStream stream(read, context, image.GetPixelsSize());
+        stream.Start();
+
+        // Scratch images are stored contiguously in the same order and pitch as the file
+        for (size_t i = 0; i < image.GetImageCount(); ++i)
+        {
+            const Image* img = &images[i];
+            uint8_t *pPixels = img->pixels;
+            if (!pPixels)
+                return E_POINTER;
+
+            const size_t rowPitch = img->rowPitch;
+            if (!rowPitch)
+                return E_FAIL;
+
+            const size_t chunkRows = std::max<size_t>(1, c_ReadChunkSize / rowPitch);
+
+            for (size_t row = 0; row < img->height; row += chunkRows)
+            {
+                const size_t rowCount = std::min(chunkRows, img->height - row);
+                uint8_t* pDest = pPixels + row * rowPitch;
+
+                HRESULT hr = stream.Read(pDest, rowCount * rowPitch);
+                if (FAILED(hr))
+                    return hr;
+
+                hr = FixScanlines(pDest, rowPitch, rowCount, metadata.format, convFlags, tflags);
+                if (FAILED(hr))
+                    return hr;
+            }
+        }
+
+        return S_OK;
+    }
+}
+
+
+//=====================================================================================
+// Entry-points
+//=====================================================================================
+
+//-------------------------------------------------------------------------------------
+// Obtain metadata from DDS file in memory/on disk
+//-------------------------------------------------------------------------------------
+
+_Use_decl_annotations_
+HRESULT DirectX::GetMetadataFromDDSMemory(
+    const uint8_t* pSource,
+    size_t size,
+    DDS_FLAGS flags,
+    TexMetadata& metadata) noexcept
+{
+    return GetMetadataFromDDSMemoryEx(pSource, size, flags, metadata, nullptr);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::GetMetadataFromDDSMemoryEx(
+    const uint8_t* pSource,
+    size_t size,
+    DDS_FLAGS flags,
+    TexMetadata& metadata,
+    DDSMetaData* ddPixelFormat) noexcept
+{
+    if (!pSource || size == 0)
+        return E_INVALIDARG;
+
+    uint32_t convFlags = 0;
+    return DecodeDDSHeader(pSource, size, flags, metadata, ddPixelFormat, convFlags);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::GetMetadataFromDDSFile(
+    const wchar_t* szFile,
+    DDS_FLAGS flags,
+    TexMetadata& metadata) noexcept
+{
+    return GetMetadataFromDDSFileEx(szFile, flags, metadata, nullptr);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::GetMetadataFromDDSFileEx(
+    const wchar_t* szFile,
+    DDS_FLAGS flags,
+    TexMetadata& metadata,
+    DDSMetaData* ddPixelFormat) noexcept
+{
+    if (!szFile)
+        return E_INVALIDARG;
+
+#ifdef _WIN32
+    ScopedHandle hFile(safe_handle(CreateFile2(
+        szFile,
+        GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING,
+        nullptr)));
+    if (!hFile)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // Get the file size
+    FILE_STANDARD_INFO fileInfo;
+    if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // File is too big for 32-bit allocation, so reject read (4 GB should be plenty large enough for a valid DDS file)
+    if (fileInfo.EndOfFile.HighPart > 0)
+    {
+        return HRESULT_E_FILE_TOO_LARGE;
+    }
+
+    const size_t len = fileInfo.EndOfFile.LowPart;
+#else // !WIN32
+    std::ifstream inFile(std::filesystem::path(szFile), std::ios::in | std::ios::binary | std::ios::ate);
+    if (!inFile)
+        return E_FAIL;
+
+    std::streampos fileLen = inFile.tellg();
+    if (!inFile)
+        return E_FAIL;
+
+    if (fileLen > UINT32_MAX)
+        return HRESULT_E_FILE_TOO_LARGE;
+
+    inFile.seekg(0, std::ios::beg);
+    if (!inFile)
+        return E_FAIL;
+
+    const size_t len = fileLen;
+#endif
+
+    // Need at least enough data to fill the standard header and magic number to be a valid DDS
+    if (len < DDS_MIN_HEADER_SIZE)
+    {
+        return E_FAIL;
+    }
+
+    // Read the header in (including extended header if present)
+    uint8_t header[DDS_DX10_HEADER_SIZE] = {};
+
+#ifdef _WIN32
+    DWORD bytesRead = 0;
+    if (!ReadFile(hFile.get(), header, DDS_DX10_HEADER_SIZE, &bytesRead, nullptr))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    const auto headerLen = static_cast<size_t>(bytesRead);
+#else
+    const auto headerLen = std::min<size_t>(len, DDS_DX10_HEADER_SIZE);
 
     inFile.read(reinterpret_cast<char*>(header), headerLen);
     if (!inFile)
@@ -2230,7 +2711,31 @@ HRESULT DirectX::LoadFromDDSFileEx(
         }
     }
 
-    if ((convFlags & CONV_FLAGS_EXPAND) || (flags & (DDS_FLAGS_LEGACY_DWORD | DDS_FLAGS_BAD_DXTN_TAILS)))
+#ifdef _WIN32
+    void* const readContext = hFile.get();
+#else
+    void* const readContext = &inFile;
+#endif
+
+    if (convFlags & CONV_FLAGS_EXPAND)
+    {
+        const CP_FLAGS cflags = (flags & DDS_FLAGS_LEGACY_DWORD) ? CP_FLAGS_LEGACY_DWORD : CP_FLAGS_NONE;
+
+        hr = ReadAndExpandImage(ReadFromFile,
+            readContext,
+            remaining,
+            mdata,
+            cflags,
+            convFlags,
+            pal8.get(),
+            image);
+        if (FAILED(hr))
+        {
+            image.Release();
+            return hr;
+        }
+    }
+    else if (flags & (DDS_FLAGS_LEGACY_DWORD | DDS_FLAGS_BAD_DXTN_TAILS))
     {
         std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[remaining]);
         if (!temp)
@@ -2297,38 +2802,40 @@ HRESULT DirectX::LoadFromDDSFileEx(
             return HRESULT_E_ARITHMETIC_OVERFLOW;
         }
 
-    #ifdef _WIN32
-        const auto pixelBytes = static_cast<DWORD>(image.GetPixelsSize());
-        if (!ReadFile(hFile.get(), image.GetPixels(), pixelBytes, &bytesRead, nullptr))
-        {
-            image.Release();
-            return HRESULT_FROM_WIN32(GetLastError());
-        }
-
-        if (bytesRead != pixelBytes)
-        {
-            image.Release();
-            return E_FAIL;
-        }
-    #else
-        inFile.read(reinterpret_cast<char*>(image.GetPixels()), image.GetPixelsSize());
-        if (!inFile)
-        {
-            image.Release();
-            return E_FAIL;
-        }
-    #endif
-
         if (convFlags & (CONV_FLAGS_SWIZZLE | CONV_FLAGS_NOALPHA | CONV_FLAGS_L8U8V8 | CONV_FLAGS_WUV10))
         {
-            // Swizzle/copy image in place
-            hr = CopyImageInPlace(convFlags, image);
+            // Read in bands and swizzle/copy each band in place
+            hr = ReadAndFixImage(ReadFromFile, readContext, convFlags, image);
             if (FAILED(hr))
             {
                 image.Release();
                 return hr;
             }
         }
+        else
+        {
+        #ifdef _WIN32
+            const auto pixelBytes = static_cast<DWORD>(image.GetPixelsSize());
+            if (!ReadFile(hFile.get(), image.GetPixels(), pixelBytes, &bytesRead, nullptr))
+            {
+                image.Release();
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
+
+            if (bytesRead != pixelBytes)
+            {
+                image.Release();
+                return E_FAIL;
+            }
+        #else
+            inFile.read(reinterpret_cast<char*>(image.GetPixels()), image.GetPixelsSize());
+            if (!inFile)
+            {
+                image.Release();
+                return E_FAIL;
+            }
+        #endif
+        }
     }
 
     if (metadata)
@@ -2340,204 +2847,463 @@ HRESULT DirectX::LoadFromDDSFileEx(
 //-------------------------------------------------------------------------------------
 // Load a DDS file using the specified I/O callbacks
 //-------------------------------------------------------------------------------------
-_Use_decl_annotations_
-HRESULT DirectX::LoadFromDDSIOCallbacks(
-    const ImageIOCallbacks* pIOCallbacks,
-    DirectX::DDS_FLAGS flags,
-    TexMetadata* metadata,
-    DDSMetaData* ddPixelFormat,
-    ScratchImage& image)
+namespace
 {
-    if (!pIOCallbacks)
-        return E_INVALIDARG;
+    //-------------------------------------------------------------------------------------
+    // Seeks to the smallest stored mip level that is at least minWidth by minHeight and
+    // describes it as a single image, reading only the first array item or volume slice.
+    // levelSize is the size of that image in the file.
+    //-------------------------------------------------------------------------------------
+    HRESULT SeekToPreviewLevel(
+        _In_ const ImageIOCallbacks* pIOCallbacks,
+        DDS_FLAGS flags,
+        uint32_t convFlags,
+        size_t minWidth,
+        size_t minHeight,
+        size_t len,
+        _Inout_ size_t& offset,
+        _Inout_ TexMetadata& mdata,
+        _Out_ size_t& levelSize) noexcept
+    {
+        levelSize = 0;
+
+        // The levels are laid out the way CopyImage reads them
+        CP_FLAGS cpFlags = (flags & DDS_FLAGS_LEGACY_DWORD) ? CP_FLAGS_LEGACY_DWORD : CP_FLAGS_NONE;
+        if (flags & DDS_FLAGS_BAD_DXTN_TAILS)
+        {
+            cpFlags |= CP_FLAGS_BAD_DXTN_TAILS;
+        }
+        cpFlags = GetExpandedPitchFlags(cpFlags, convFlags);
 
-    image.Release();
+        // The levels of the first item are stored first, volume levels store all their slices
+        size_t width = mdata.width;
+        size_t height = mdata.height;
+        size_t depth = (mdata.dimension == TEX_DIMENSION_TEXTURE3D) ? mdata.depth : 1;
+        size_t skip = 0;
+
+        for (size_t level = 1; level < mdata.mipLevels; ++level)
+        {
+            const size_t nextWidth = std::max<size_t>(1, width >> 1);
+            const size_t nextHeight = std::max<size_t>(1, height >> 1);
+            if (nextWidth < minWidth || nextHeight < minHeight)
+                break;
+
+            size_t rowPitch, slicePitch;
+            HRESULT hr = ComputePitch(mdata.format, width, height, rowPitch, slicePitch, cpFlags);
+            if (FAILED(hr))
+                return hr;
+
+            skip += slicePitch * depth;
+            width = nextWidth;
+            height = nextHeight;
+            depth = std::max<size_t>(1, depth >> 1);
+        }
+
+        size_t rowPitch;
+        HRESULT hr = ComputePitch(mdata.format, width, height, rowPitch, levelSize, cpFlags);
+        if (FAILED(hr))
+            return hr;
+
+        if ((skip > 0) && ((skip >= len - offset) || (levelSize > len - offset - skip)))
+        {
+            // The mip count does not match the file, fall back to the top-level image
+            skip = 0;
+            width = mdata.width;
+            height = mdata.height;
+
+            hr = ComputePitch(mdata.format, width, height, rowPitch, levelSize, cpFlags);
+            if (FAILED(hr))
+                return hr;
+        }
 
-    // Get the file size
-    LARGE_INTEGER fileSize;
+        if (skip > 0)
+        {
+            hr = pIOCallbacks->Seek(static_cast<INT64>(offset + skip), FILE_BEGIN);
+            if (FAILED(hr))
+                return hr;
 
-    HRESULT hr = pIOCallbacks->GetSize(&fileSize.QuadPart);
+            offset += skip;
+        }
 
-    if (FAILED(hr))
-    {
-        return hr;
-    }
+        mdata.width = width;
+        mdata.height = height;
+        mdata.depth = 1;
+        mdata.arraySize = 1;
+        mdata.mipLevels = 1;
+        mdata.miscFlags &= ~static_cast<uint32_t>(TEX_MISC_TEXTURECUBE);
 
-    // File is too big for 32-bit allocation, so reject read (4 GB should be plenty large enough for a valid DDS file)
-    if (fileSize.HighPart > 0)
-    {
-        return HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE);
+        return S_OK;
     }
 
-    // Need at least enough data to fill the standard header and magic number to be a valid DDS
-    if (fileSize.LowPart < DDS_MIN_HEADER_SIZE)
+    //-------------------------------------------------------------------------------------
+    // Reads and decodes the header through the I/O callbacks, leaving the callbacks
+    // positioned at offset, the start of the data that follows the header
+    //-------------------------------------------------------------------------------------
+    HRESULT ReadDDSHeaderFromIOCallbacks(
+        _In_ const ImageIOCallbacks* pIOCallbacks,
+        DDS_FLAGS flags,
+        _Out_ size_t& len,
+        _Out_ size_t& offset,
+        _Out_ TexMetadata& mdata,
+        _Out_opt_ DDSMetaData* ddPixelFormat,
+        _Out_ uint32_t& convFlags)
     {
-        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
-    }
+        len = offset = 0;
+        convFlags = 0;
 
-    // Read the header in (including extended header if present)
-    uint8_t header[DDS_DX10_HEADER_SIZE] = {};
-    size_t headerLength = DDS_DX10_HEADER_SIZE;
+        // Get the file size
+        LARGE_INTEGER fileSize;
 
-    hr = pIOCallbacks->Read(header, DDS_DX10_HEADER_SIZE);
+        HRESULT hr = pIOCallbacks->GetSize(&fileSize.QuadPart);
 
-    if (FAILED(hr))
-    {
-        if (hr == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF))
-        {
-            headerLength = fileSize.LowPart;
-        }
-        else
+        if (FAILED(hr))
         {
             return hr;
         }
-    }
-
-    uint32_t convFlags = 0;
-    TexMetadata mdata;
-    hr = DecodeDDSHeader(header, headerLength, flags, mdata, ddPixelFormat, convFlags);
-    if (FAILED(hr))
-        return hr;
 
-    DWORD offset = DDS_DX10_HEADER_SIZE;
-
-    if (!(convFlags & CONV_FLAGS_DX10))
-    {
-        // Must reset file position since we read more than the standard header above
-        hr = pIOCallbacks->Seek(DDS_MIN_HEADER_SIZE, FILE_BEGIN);
+        if (fileSize.QuadPart < 0)
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
 
-        if (FAILED(hr))
+        // Files over 4 GB are only read when large files are allowed, and never past what can be addressed
+        if (fileSize.HighPart > 0)
         {
-            return hr;
+            if (!(flags & DDS_FLAGS_ALLOW_LARGE_FILES)
+                || (static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX))
+            {
+                return HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE);
+            }
         }
 
-        offset = sizeof(uint32_t) + sizeof(DDS_HEADER);
-    }
+        len = static_cast<size_t>(fileSize.QuadPart);
 
-    std::unique_ptr<uint32_t[]> pal8;
-    if (convFlags & CONV_FLAGS_PAL8)
-    {
-        pal8.reset(new (std::nothrow) uint32_t[256]);
-        if (!pal8)
+        // Need at least enough data to fill the standard header and magic number to be a valid DDS
+        if (len < DDS_MIN_HEADER_SIZE)
         {
-            return E_OUTOFMEMORY;
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
         }
 
-        hr = pIOCallbacks->Read(pal8.get(), 256 * sizeof(uint32_t));
+        // Read the header in (including extended header if present)
+        uint8_t header[DDS_DX10_HEADER_SIZE] = {};
+        size_t headerLength = DDS_DX10_HEADER_SIZE;
+
+        hr = pIOCallbacks->Read(header, DDS_DX10_HEADER_SIZE);
 
         if (FAILED(hr))
         {
-            return hr;
+            if (hr == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF))
+            {
+                headerLength = std::min<size_t>(len, DDS_DX10_HEADER_SIZE);
+            }
+            else
+            {
+                return hr;
+            }
         }
 
-        offset += (256 * sizeof(uint32_t));
-    }
-
-    DWORD remaining = fileSize.LowPart - offset;
-    if (remaining == 0)
-        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        hr = DecodeDDSHeader(header, headerLength, flags, mdata, ddPixelFormat, convFlags);
+        if (FAILED(hr))
+            return hr;
 
-    hr = image.Initialize(mdata);
-    if (FAILED(hr))
-        return hr;
+        offset = DDS_DX10_HEADER_SIZE;
 
-    if (flags & DDS_FLAGS_PERMISSIVE)
-    {
-        // For cubemaps, DDS_HEADER_DXT10.arraySize is supposed to be 'number of cubes'.
-        // This handles cases where the value is incorrectly written as the original 6*numCubes value.
-        if ((mdata.miscFlags & TEX_MISC_TEXTURECUBE)
-            && (convFlags & CONV_FLAGS_DX10)
-            && (image.GetPixelsSize() > remaining)
-            && ((mdata.arraySize % 6) == 0))
+        if (!(convFlags & CONV_FLAGS_DX10))
         {
-            mdata.arraySize = mdata.arraySize / 6;
-            hr = image.Initialize(mdata);
-            if (FAILED(hr))
-                return hr;
+            // Must reset file position since we read more than the standard header above
+            hr = pIOCallbacks->Seek(DDS_MIN_HEADER_SIZE, FILE_BEGIN);
 
-            if (image.GetPixelsSize() > remaining)
+            if (FAILED(hr))
             {
-                image.Release();
-                return HRESULT_E_HANDLE_EOF;
+                return hr;
             }
+
+            offset = sizeof(uint32_t) + sizeof(DDS_HEADER);
         }
+
+        return S_OK;
     }
 
-    if ((convFlags & CONV_FLAGS_EXPAND) || (flags & (DDS_FLAGS_LEGACY_DWORD | DDS_FLAGS_BAD_DXTN_TAILS)))
+    HRESULT LoadFromDDSIOCallbacksImpl(
+        _In_ const ImageIOCallbacks* pIOCallbacks,
+        DDS_FLAGS flags,
+        bool preview,
+        size_t minWidth,
+        size_t minHeight,
+        _Out_opt_ TexMetadata* metadata,
+        _Out_opt_ DDSMetaData* ddPixelFormat,
+        _Out_ ScratchImage& image)
     {
-        std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[remaining]);
-        if (!temp)
-        {
-            image.Release();
-            return E_OUTOFMEMORY;
-        }
+        if (!pIOCallbacks)
+            return E_INVALIDARG;
 
-        hr = pIOCallbacks->Read(temp.get(), remaining);
+        image.Release();
 
+        size_t len;
+        size_t offset;
+        uint32_t convFlags;
+        TexMetadata mdata;
+        // Previews need the real mip count to pick a level
+        HRESULT hr = ReadDDSHeaderFromIOCallbacks(pIOCallbacks, preview ? (flags & ~DDS_FLAGS_IGNORE_MIPS) : flags,
+            len, offset, mdata, ddPixelFormat, convFlags);
         if (FAILED(hr))
-        {
-            image.Release();
             return hr;
-        }
 
-        CP_FLAGS cflags = CP_FLAGS_NONE;
-        if (flags & DDS_FLAGS_LEGACY_DWORD)
+        std::unique_ptr<uint32_t[]> pal8;
+        if (convFlags & CONV_FLAGS_PAL8)
         {
-            cflags |= CP_FLAGS_LEGACY_DWORD;
+            pal8.reset(new (std::nothrow) uint32_t[256]);
+            if (!pal8)
+            {
+                return E_OUTOFMEMORY;
+            }
+
+            hr = pIOCallbacks->Read(pal8.get(), 256 * sizeof(uint32_t));
+
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            offset += (256 * sizeof(uint32_t));
         }
-        if (flags & DDS_FLAGS_BAD_DXTN_TAILS)
+
+        size_t remaining = len - offset;
+
+        if (preview)
         {
-            cflags |= CP_FLAGS_BAD_DXTN_TAILS;
+            size_t levelSize;
+            hr = SeekToPreviewLevel(pIOCallbacks, flags, convFlags, minWidth, minHeight, len, offset, mdata, levelSize);
+            if (FAILED(hr))
+                return hr;
+
+            // Only the selected level is read, even when the whole remaining buffer is copied
+            remaining = std::min(len - offset, levelSize);
         }
 
-        hr = CopyImage(temp.get(),
-            remaining,
-            mdata,
-            cflags,
-            convFlags,
-            pal8.get(),
-            image);
+        if (remaining == 0)
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+        hr = image.Initialize(mdata);
         if (FAILED(hr))
-        {
-            image.Release();
             return hr;
-        }
-    }
-    else
-    {
-        if (remaining < image.GetPixelsSize())
+
+        if (flags & DDS_FLAGS_PERMISSIVE)
         {
-            image.Release();
-            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            // For cubemaps, DDS_HEADER_DXT10.arraySize is supposed to be 'number of cubes'.
+            // This handles cases where the value is incorrectly written as the original 6*numCubes value.
+            if ((mdata.miscFlags & TEX_MISC_TEXTURECUBE)
+                && (convFlags & CONV_FLAGS_DX10)
+                && (image.GetPixelsSize() > remaining)
+                && ((mdata.arraySize % 6) == 0))
+            {
+                mdata.arraySize = mdata.arraySize / 6;
+                hr = image.Initialize(mdata);
+                if (FAILED(hr))
+                    return hr;
+
+                if (image.GetPixelsSize() > remaining)
+                {
+                    image.Release();
+                    return HRESULT_E_HANDLE_EOF;
+                }
+            }
         }
 
-        if (image.GetPixelsSize() > UINT32_MAX)
+        if (convFlags & CONV_FLAGS_EXPAND)
         {
-            image.Release();
-            return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
+            const CP_FLAGS cflags = (flags & DDS_FLAGS_LEGACY_DWORD) ? CP_FLAGS_LEGACY_DWORD : CP_FLAGS_NONE;
+
+            hr = ReadAndExpandImage(ReadFromIOCallbacks,
+                const_cast<ImageIOCallbacks*>(pIOCallbacks),
+                remaining,
+                mdata,
+                cflags,
+                convFlags,
+                pal8.get(),
+                image);
+            if (FAILED(hr))
+            {
+                image.Release();
+                return hr;
+            }
         }
+        else if (flags & (DDS_FLAGS_LEGACY_DWORD | DDS_FLAGS_BAD_DXTN_TAILS))
+        {
+            std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[remaining]);
+            if (!temp)
+            {
+                image.Release();
+                return E_OUTOFMEMORY;
+            }
+
+            hr = ReadFromIOCallbacks(const_cast<ImageIOCallbacks*>(pIOCallbacks), temp.get(), remaining);
 
-        const DWORD pixelSize = static_cast<DWORD>(image.GetPixelsSize());
+            if (FAILED(hr))
+            {
+                image.Release();
+                return hr;
+            }
 
-        hr = pIOCallbacks->Read(image.GetPixels(), pixelSize);
+            CP_FLAGS cflags = CP_FLAGS_NONE;
+            if (flags & DDS_FLAGS_LEGACY_DWORD)
+            {
+                cflags |= CP_FLAGS_LEGACY_DWORD;
+            }
+            if (flags & DDS_FLAGS_BAD_DXTN_TAILS)
+            {
+                cflags |= CP_FLAGS_BAD_DXTN_TAILS;
+            }
 
-        if (FAILED(hr))
-        {
-            image.Release();
-            return hr;
+            hr = CopyImage(temp.get(),
+                remaining,
+                mdata,
+                cflags,
+                convFlags,
+                pal8.get(),
+                image);
+            if (FAILED(hr))
+            {
+                image.Release();
+                return hr;
+            }
         }
-
-        if (convFlags & (CONV_FLAGS_SWIZZLE | CONV_FLAGS_NOALPHA | CONV_FLAGS_L8U8V8 | CONV_FLAGS_WUV10))
+        else
         {
-            // Swizzle/copy image in place
-            hr = CopyImageInPlace(convFlags, image);
+            if (remaining < image.GetPixelsSize())
+            {
+                image.Release();
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
+
+            if (convFlags & (CONV_FLAGS_SWIZZLE | CONV_FLAGS_NOALPHA | CONV_FLAGS_L8U8V8 | CONV_FLAGS_WUV10))
+            {
+                // Read in bands and swizzle/copy each band in place
+                hr = ReadAndFixImage(ReadFromIOCallbacks, const_cast<ImageIOCallbacks*>(pIOCallbacks), convFlags, image);
+            }
+            else
+            {
+                hr = ReadFromIOCallbacks(const_cast<ImageIOCallbacks*>(pIOCallbacks), image.GetPixels(), image.GetPixelsSize());
+            }
+
             if (FAILED(hr))
             {
                 image.Release();
                 return hr;
             }
         }
+
+        if (metadata)
+            memcpy(metadata, &mdata, sizeof(TexMetadata));
+
+        return S_OK;
     }
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::LoadFromDDSIOCallbacks(
+    const ImageIOCallbacks* pIOCallbacks,
+    DirectX::DDS_FLAGS flags,
+    TexMetadata* metadata,
+    DDSMetaData* ddPixelFormat,
+    ScratchImage& image)
+{
+    return LoadFromDDSIOCallbacksImpl(pIOCallbacks, flags, false, 0, 0, metadata, ddPixelFormat, image);
+}
+
+//-------------------------------------------------------------------------------------
+// Load a low resolution preview of a DDS file using the specified I/O callbacks
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::LoadPreviewFromDDSIOCallbacks(
+    const ImageIOCallbacks* pIOCallbacks,
+    DirectX::DDS_FLAGS flags,
+    size_t minWidth,
+    size_t minHeight,
+    TexMetadata* metadata,
+    DDSMetaData* ddPixelFormat,
+    ScratchImage& image)
+{
+    return LoadFromDDSIOCallbacksImpl(pIOCallbacks, flags, true, minWidth, minHeight, metadata, ddPixelFormat, image);
+}
+
+//-------------------------------------------------------------------------------------
+// Load a rectangle of a block compressed DDS file using the specified I/O callbacks
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::LoadRegionFromDDSIOCallbacks(
+    const ImageIOCallbacks* pIOCallbacks,
+    DirectX::DDS_FLAGS flags,
+    const Rect& rect,
+    DXGI_FORMAT format,
+    TexMetadata* metadata,
+    ScratchImage& image)
+{
+    if (!pIOCallbacks)
+        return E_INVALIDARG;
+
+    image.Release();
+
+    size_t len;
+    size_t offset;
+    uint32_t convFlags;
+    TexMetadata mdata;
+    HRESULT hr = ReadDDSHeaderFromIOCallbacks(pIOCallbacks, flags, len, offset, mdata, nullptr, convFlags);
+    if (FAILED(hr))
+        return hr;
+
+    // Only block compressed data can be read a row of blocks at a time without converting it
+    if (!IsCompressed(mdata.format) || (convFlags & ~CONV_FLAGS_DX10))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if (!rect.w || !rect.h
+        || (rect.x >= mdata.width) || (rect.y >= mdata.height)
+        || (rect.w > mdata.width - rect.x) || (rect.h > mdata.height - rect.y))
+        return E_INVALIDARG;
+
+    // The rectangle is taken from the top-level image of the first item, which is stored
+    // directly after the header
+    size_t rowPitch, slicePitch;
+    hr = ComputePitch(mdata.format, mdata.width, mdata.height, rowPitch, slicePitch, CP_FLAGS_NONE);
+    if (FAILED(hr))
+        return hr;
+
+    // Read only the rows of blocks that cover the rectangle
+    const size_t firstBlockRow = rect.y / 4;
+    const size_t lastBlockRow = (rect.y + rect.h + 3) / 4;
+    const size_t readOffset = offset + firstBlockRow * rowPitch;
+    const size_t readSize = (lastBlockRow - firstBlockRow) * rowPitch;
+
+    if ((readOffset > len) || (readSize > len - readOffset))
+        return HRESULT_E_HANDLE_EOF;
+
+    std::unique_ptr<uint8_t[]> blockRows(new (std::nothrow) uint8_t[readSize]);
+    if (!blockRows)
+        return E_OUTOFMEMORY;
+
+    if (readOffset != offset)
+    {
+        hr = pIOCallbacks->Seek(static_cast<INT64>(readOffset), FILE_BEGIN);
+        if (FAILED(hr))
+            return hr;
+    }
+
+    hr = ReadFromIOCallbacks(const_cast<ImageIOCallbacks*>(pIOCallbacks), blockRows.get(), readSize);
+    if (FAILED(hr))
+        return hr;
+
+    Image cImage = {};
+    cImage.width = mdata.width;
+    cImage.height = std::min<size_t>(mdata.height - firstBlockRow * 4, (lastBlockRow - firstBlockRow) * 4);
+    cImage.format = mdata.format;
+    cImage.rowPitch = rowPitch;
+    cImage.slicePitch = readSize;
+    cImage.pixels = blockRows.get();
+
+    const Rect blockRowsRect(rect.x, rect.y - firstBlockRow * 4, rect.w, rect.h);
+    hr = DecompressRegion(cImage, blockRowsRect, format, image);
+    if (FAILED(hr))
+        return hr;
 
     if (metadata)
         memcpy(metadata, &mdata, sizeof(TexMetadata));
@@ -3124,9 +3890,9 @@ HRESULT DirectX::SaveToDDSIOCallbacks(
                 if (FAILED(hr))
                     return hr;
 
-                if ((images[index].slicePitch == ddsSlicePitch) && (ddsSlicePitch <= UINT32_MAX))
+                if (images[index].slicePitch == ddsSlicePitch)
                 {
-                    hr = pIOCallbacks->Write(images[index].pixels, static_cast<DWORD>(ddsSlicePitch));
+                    hr = WriteToIOCallbacks(pIOCallbacks, images[index].pixels, ddsSlicePitch);
 
                     if (FAILED(hr))
                     {
@@ -3142,15 +3908,12 @@ HRESULT DirectX::SaveToDDSIOCallbacks(
                         return E_FAIL;
                     }
 
-                    if (ddsRowPitch > UINT32_MAX)
-                        return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
-
                     const uint8_t * __restrict sPtr = images[index].pixels;
 
                     size_t lines = ComputeScanlines(metadata.format, images[index].height);
                     for (size_t j = 0; j < lines; ++j)
                     {
-                        hr = pIOCallbacks->Write(sPtr, static_cast<DWORD>(ddsRowPitch));
+                        hr = WriteToIOCallbacks(pIOCallbacks, sPtr, ddsRowPitch);
 
                         if (FAILED(hr))
                         {
@@ -3191,9 +3954,9 @@ HRESULT DirectX::SaveToDDSIOCallbacks(
                 if (FAILED(hr))
                     return hr;
 
-                if ((images[index].slicePitch == ddsSlicePitch) && (ddsSlicePitch <= UINT32_MAX))
+                if (images[index].slicePitch == ddsSlicePitch)
                 {
-                    hr = pIOCallbacks->Write(images[index].pixels, static_cast<DWORD>(ddsSlicePitch));
+                    hr = WriteToIOCallbacks(pIOCallbacks, images[index].pixels, ddsSlicePitch);
 
                     if (FAILED(hr))
                     {
@@ -3209,15 +3972,12 @@ HRESULT DirectX::SaveToDDSIOCallbacks(
                         return E_FAIL;
                     }
 
-                    if (ddsRowPitch > UINT32_MAX)
-                        return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
-
                     const uint8_t * __restrict sPtr = images[index].pixels;
 
                     size_t lines = ComputeScanlines(metadata.format, images[index].height);
                     for (size_t j = 0; j < lines; ++j)
                     {
-                        hr = pIOCallbacks->Write(sPtr, static_cast<DWORD>(ddsRowPitch));
+                        hr = WriteToIOCallbacks(pIOCallbacks, sPtr, ddsRowPitch);
 
                         if (FAILED(hr))
                         {
@@ -11,10 +11,18 @@
 
 #include "DirectXTexP.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#pragma warning(disable : 4616 6993)
+#endif
+
 using namespace DirectX;
 using namespace DirectX::Internal;
 
 #ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+
 namespace
 {
     inline void * _aligned_malloc(size_t size, size_t alignment)
@@ -27,6 +35,132 @@ namespace
 }
 #endif
 
+namespace
+{
+    inline uint8_t* AllocatePixelMemory(_In_opt_ IScratchImageAllocator* allocator, size_t size) noexcept
+    {
+        if (allocator)
+            return static_cast<uint8_t*>(allocator->Allocate(size, 16));
+
+        return static_cast<uint8_t*>(_aligned_malloc(size, 16));
+    }
+
+    void ClearPixelMemory(_In_opt_ const IScratchImageAllocator* allocator, _Out_writes_bytes_all_(size) uint8_t* pixels, size_t size) noexcept
+    {
+        if (allocator && allocator->IsZeroInitialized(size))
+            return;
+
+        memset(pixels, 0, size);
+    }
+
+    // Size of the pages used by PageAllocator, explicit large pages are 2 MB on x64 and ARM64
+    constexpr size_t c_LargePageSize = 2 * 1024 * 1024;
+
+    inline size_t RoundToLargePage(size_t size) noexcept
+    {
+        return (size + c_LargePageSize - 1) & ~(c_LargePageSize - 1);
+    }
+
+    // Number of scanlines (or rows of 4x4 blocks) each thread checks when scanning for alpha
+    constexpr size_t c_AlphaScanBandRows = 64;
+
+    //-------------------------------------------------------------------------------------
+    // Returns the bits that hold alpha for formats that can be scanned without conversion,
+    // or 0 if the format has to go through LoadScanline.
+    //-------------------------------------------------------------------------------------
+    constexpr uint32_t GetPackedAlphaMask(DXGI_FORMAT format) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return 0xFF000000;
+
+        case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            return 0xC0000000;
+
+        default:
+            return 0;
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Checks a 32bpp image for non-opaque alpha, 16 pixels at a time.
+    //-------------------------------------------------------------------------------------
+    bool IsAlphaAllOpaquePacked(_In_ const Image& img, uint32_t alphaMask) noexcept
+    {
+        const XMVECTOR mask = XMVectorReplicateInt(alphaMask);
+
+        const uint8_t* pPixels = img.pixels;
+        for (size_t h = 0; h < img.height; ++h)
+        {
+            auto sPtr = reinterpret_cast<const uint32_t*>(pPixels);
+
+            size_t w = 0;
+            for (; (w + 16) <= img.width; w += 16, sPtr += 16)
+            {
+                XMVECTOR v = XMLoadInt4(sPtr);
+                v = XMVectorAndInt(v, XMLoadInt4(sPtr + 4));
+                v = XMVectorAndInt(v, XMLoadInt4(sPtr + 8));
+                v = XMVectorAndInt(v, XMLoadInt4(sPtr + 12));
+
+                if (!XMVector4EqualInt(XMVectorAndInt(v, mask), mask))
+                    return false;
+            }
+
+            uint32_t t = alphaMask;
+            for (; w < img.width; ++w)
+            {
+                t &= *sPtr++;
+            }
+
+            if ((t & alphaMask) != alphaMask)
+                return false;
+
+            pPixels += img.rowPitch;
+        }
+
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Checks any other uncompressed format, using the same threshold as the original scan.
+    //-------------------------------------------------------------------------------------
+    bool IsAlphaAllOpaqueScanline(_In_ const Image& img) noexcept
+    {
+        auto scanline = make_AlignedArrayXMVECTOR(img.width);
+        if (!scanline)
+            return false;
+
+        const XMVECTOR threshold = XMVectorReplicate(ALPHA_OPAQUE_THRESHOLD);
+
+        const uint8_t *pPixels = img.pixels;
+        for (size_t h = 0; h < img.height; ++h)
+        {
+            if (!LoadScanline(scanline.get(), img.width, pPixels, img.rowPitch, img.format))
+                return false;
+
+            const XMVECTOR* ptr = scanline.get();
+            for (size_t w = 0; w < img.width; ++w)
+            {
+                const XMVECTOR alpha = XMVectorSplatW(*ptr);
+                if (XMVector4Less(alpha, threshold))
+                    return false;
+                ++ptr;
+            }
+
+            pPixels += img.rowPitch;
+        }
+
+        return true;
+    }
+}
+
 //-------------------------------------------------------------------------------------
 // Determines number of image array entries and pixel size
 //-------------------------------------------------------------------------------------
@@ -268,6 +402,126 @@ bool DirectX::Internal::SetupImageArray(
 }
 
 
+//=====================================================================================
+// PageAllocator - OS page allocation policy for large images
+//=====================================================================================
+
+_Use_decl_annotations_
+void* PageAllocator::Allocate(size_t size, size_t alignment) noexcept
+{
+    if (size < m_minSize || !size)
+        return _aligned_malloc(size, alignment);
+
+    const size_t allocSize = RoundToLargePage(size);
+    void* ptr = nullptr;
+
+#ifdef _WIN32
+    if (m_flags & TEX_ALLOC_LARGE_PAGES)
+    {
+        // Requires the 'Lock pages in memory' privilege, falls back to normal pages without it
+        const size_t largePageMinimum = GetLargePageMinimum();
+        if (largePageMinimum > 0 && (allocSize % largePageMinimum) == 0)
+        {
+            ptr = VirtualAlloc(nullptr, allocSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        }
+    }
+
+    if (!ptr)
+    {
+        ptr = VirtualAlloc(nullptr, allocSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+#else
+#ifdef MAP_HUGETLB
+    if (m_flags & TEX_ALLOC_LARGE_PAGES)
+    {
+        ptr = mmap(nullptr, allocSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr == MAP_FAILED)
+            ptr = nullptr;
+    }
+#endif
+
+    if (!ptr)
+    {
+        ptr = mmap(nullptr, allocSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED)
+            return nullptr;
+
+    #ifdef MADV_HUGEPAGE
+        // Must come before any page is faulted in, pages that are already mapped stay 4 KB
+        if (m_flags & TEX_ALLOC_TRANSPARENT_HUGE_PAGES)
+        {
+            std::ignore = madvise(ptr, allocSize, MADV_HUGEPAGE);
+        }
+    #endif
+    }
+
+    if (!(m_flags & TEX_ALLOC_FIRST_TOUCH))
+    {
+        // Fault in every page now rather than during the first pass over the image
+        bool populated = false;
+    #ifdef MADV_POPULATE_WRITE
+        populated = (madvise(ptr, allocSize, MADV_POPULATE_WRITE) == 0);
+    #endif
+        if (!populated)
+        {
+            // Kernels before 5.14, touch each base page
+            const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            auto pages = static_cast<volatile uint8_t*>(ptr);
+            for (size_t offset = 0; offset < allocSize; offset += pageSize)
+            {
+                pages[offset] = 0;
+            }
+        }
+    }
+#endif
+
+    return ptr;
+}
+
+_Use_decl_annotations_
+void PageAllocator::Free(void* ptr, size_t size) noexcept
+{
+    if (!ptr)
+        return;
+
+    if (size < m_minSize || !size)
+    {
+        _aligned_free(ptr);
+        return;
+    }
+
+#ifdef _WIN32
+    std::ignore = VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    std::ignore = munmap(ptr, RoundToLargePage(size));
+#endif
+}
+
+_Use_decl_annotations_
+bool PageAllocator::IsZeroInitialized(size_t size) const noexcept
+{
+    // Pages from the OS are always zero-filled
+    return (size >= m_minSize) && (size > 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+// Frees the per-thread scanline caches
+//-------------------------------------------------------------------------------------
+void DirectX::ReleaseScanlineCaches() noexcept
+{
+    ScanlineArena::Trim();
+
+#ifdef _OPENMP
+    // Each worker of the default team owns its own cache
+    #pragma omp parallel
+    {
+        ScanlineArena::Trim();
+    }
+#endif
+}
+
+
 //=====================================================================================
 // ScratchImage - Bitmap image container
 //=====================================================================================
@@ -283,11 +537,15 @@ ScratchImage& ScratchImage::operator= (ScratchImage&& moveFrom) noexcept
         m_metadata = moveFrom.m_metadata;
         m_image = moveFrom.m_image;
         m_memory = moveFrom.m_memory;
+        m_memoryAllocator = moveFrom.m_memoryAllocator;
+        if (!m_allocator)
+            m_allocator = moveFrom.m_allocator;
 
         moveFrom.m_nimages = 0;
         moveFrom.m_size = 0;
         moveFrom.m_image = nullptr;
         moveFrom.m_memory = nullptr;
+        moveFrom.m_memoryAllocator = nullptr;
     }
     return *this;
 }
@@ -367,13 +625,14 @@ HRESULT ScratchImage::Initialize(const TexMetadata& mdata, CP_FLAGS flags) noexc
     m_nimages = nimages;
     memset(m_image, 0, sizeof(Image) * nimages);
 
-    m_memory = static_cast<uint8_t*>(_aligned_malloc(pixelSize, 16));
+    m_memory = AllocatePixelMemory(m_allocator, pixelSize);
     if (!m_memory)
     {
         Release();
         return E_OUTOFMEMORY;
     }
-    memset(m_memory, 0, pixelSize);
+    m_memoryAllocator = m_allocator;
+    ClearPixelMemory(m_allocator, m_memory, pixelSize);
     m_size = pixelSize;
 
     if (!SetupImageArray(m_memory, pixelSize, m_metadata, flags, m_image, nimages))
@@ -437,13 +696,14 @@ HRESULT ScratchImage::Initialize2D(DXGI_FORMAT fmt, size_t width, size_t height,
     m_nimages = nimages;
     memset(m_image, 0, sizeof(Image) * nimages);
 
-    m_memory = static_cast<uint8_t*>(_aligned_malloc(pixelSize, 16));
+    m_memory = AllocatePixelMemory(m_allocator, pixelSize);
     if (!m_memory)
     {
         Release();
         return E_OUTOFMEMORY;
     }
-    memset(m_memory, 0, pixelSize);
+    m_memoryAllocator = m_allocator;
+    ClearPixelMemory(m_allocator, m_memory, pixelSize);
     m_size = pixelSize;
 
     if (!SetupImageArray(m_memory, pixelSize, m_metadata, flags, m_image, nimages))
@@ -496,13 +756,14 @@ HRESULT ScratchImage::Initialize3D(DXGI_FORMAT fmt, size_t width, size_t height,
     m_nimages = nimages;
     memset(m_image, 0, sizeof(Image) * nimages);
 
-    m_memory = static_cast<uint8_t*>(_aligned_malloc(pixelSize, 16));
+    m_memory = AllocatePixelMemory(m_allocator, pixelSize);
     if (!m_memory)
     {
         Release();
         return E_OUTOFMEMORY;
     }
-    memset(m_memory, 0, pixelSize);
+    m_memoryAllocator = m_allocator;
+    ClearPixelMemory(m_allocator, m_memory, pixelSize);
     m_size = pixelSize;
 
     if (!SetupImageArray(m_memory, pixelSize, m_metadata, flags, m_image, nimages))
@@ -709,7 +970,6 @@ HRESULT ScratchImage::Initialize3DFromImages(const Image* images, size_t depth,
 void ScratchImage::Release() noexcept
 {
     m_nimages = 0;
-    m_size = 0;
 
     if (m_image)
     {
@@ -719,13 +979,31 @@ void ScratchImage::Release() noexcept
 
     if (m_memory)
     {
-        _aligned_free(m_memory);
+        if (m_memoryAllocator)
+        {
+            m_memoryAllocator->Free(m_memory, m_size);
+        }
+        else
+        {
+            _aligned_free(m_memory);
+        }
         m_memory = nullptr;
     }
 
+    m_memoryAllocator = nullptr;
+    m_size = 0;
+
     memset(&m_metadata, 0, sizeof(m_metadata));
 }
 
+_Use_decl_annotations_
+void ScratchImage::SetAllocator(IScratchImageAllocator* allocator) noexcept
+{
+    Release();
+
+    m_allocator = allocator;
+}
+
 _Use_decl_annotations_
 bool ScratchImage::OverrideFormat(DXGI_FORMAT f) noexcept
 {
@@ -805,48 +1083,65 @@ bool ScratchImage::IsAlphaAllOpaque() const noexcept
     if (!HasAlpha(m_metadata.format))
         return true;
 
-    if (IsCompressed(m_metadata.format))
-    {
-        for (size_t index = 0; index < m_nimages; ++index)
-        {
-            if (!IsAlphaAllOpaqueBC(m_image[index]))
-                return false;
-        }
-    }
-    else
-    {
-        auto scanline = make_AlignedArrayXMVECTOR(m_metadata.width);
-        if (!scanline)
-            return false;
+    const bool compressed = IsCompressed(m_metadata.format);
+    const uint32_t alphaMask = compressed ? 0 : GetPackedAlphaMask(m_metadata.format);
 
-        static const XMVECTORF32 threshold = { { { 0.997f, 0.997f, 0.997f, 0.997f } } };
+    // Each image is split into bands of rows (block rows for BC) which are checked
+    // independently, the first band that finds a non-opaque pixel stops the others.
+    bool opaque = true;
 
-        for (size_t index = 0; index < m_nimages; ++index)
+    for (size_t index = 0; index < m_nimages && opaque; ++index)
+    {
+    #pragma warning( suppress : 6011 )
+        const Image& img = m_image[index];
+        assert(img.pixels);
+
+        const size_t rowHeight = compressed ? 4 : 1;
+        const size_t rows = ComputeScanlines(img.format, img.height);
+        const size_t bands = (rows + c_AlphaScanBandRows - 1) / c_AlphaScanBandRows;
+
+    #ifdef _OPENMP
+    #pragma omp parallel for if (bands > 1) shared(opaque)
+    #endif
+        for (int band = 0; band < static_cast<int>(bands); ++band)
         {
-        #pragma warning( suppress : 6011 )
-            const Image& img = m_image[index];
-
-            const uint8_t *pPixels = img.pixels;
-            assert(pPixels);
-
-            for (size_t h = 0; h < img.height; ++h)
+        #ifdef _OPENMP
+        #pragma omp flush (opaque)
+        #endif
+            if (!opaque)
+                continue;
+
+            const size_t row = size_t(band) * c_AlphaScanBandRows;
+            const size_t rowCount = std::min(c_AlphaScanBandRows, rows - row);
+
+            Image bandImage = img;
+            bandImage.height = std::min(rowCount * rowHeight, img.height - row * rowHeight);
+            bandImage.slicePitch = rowCount * img.rowPitch;
+            bandImage.pixels = img.pixels + row * img.rowPitch;
+
+            bool bandOpaque;
+            if (compressed)
             {
-                if (!LoadScanline(scanline.get(), img.width, pPixels, img.rowPitch, img.format))
-                    return false;
-
-                const XMVECTOR* ptr = scanline.get();
-                for (size_t w = 0; w < img.width; ++w)
-                {
-                    const XMVECTOR alpha = XMVectorSplatW(*ptr);
-                    if (XMVector4Less(alpha, threshold))
-                        return false;
-                    ++ptr;
-                }
+                bandOpaque = IsAlphaAllOpaqueBC(bandImage);
+            }
+            else if (alphaMask)
+            {
+                bandOpaque = IsAlphaAllOpaquePacked(bandImage, alphaMask);
+            }
+            else
+            {
+                bandOpaque = IsAlphaAllOpaqueScanline(bandImage);
+            }
 
-                pPixels += img.rowPitch;
+            if (!bandOpaque)
+            {
+                opaque = false;
+            #ifdef _OPENMP
+            #pragma omp flush (opaque)
+            #endif
             }
         }
     }
 
-    return true;
+    return opaque;
 }
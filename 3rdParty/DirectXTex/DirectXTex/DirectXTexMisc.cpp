@@ -261,9 +261,134 @@ namespace
 
         return S_OK;
     }
+
+    // Alpha values that are stored as zero by every supported format
+    const XMVECTORF32 g_AlphaTransparent = { { { 0.001f, 0.001f, 0.001f, 0.001f } } };
 };
 
 
+//=====================================================================================
+// Alpha statistics
+//=====================================================================================
+
+_Use_decl_annotations_
+void DirectX::Internal::ResetAlphaStatistics(AlphaStatistics& stats) noexcept
+{
+    stats.minAlpha = 1.f;
+    stats.maxAlpha = 0.f;
+    stats.allOpaque = true;
+    stats.allTransparent = true;
+    stats.oneBit = true;
+}
+
+_Use_decl_annotations_
+void DirectX::Internal::UpdateAlphaStatistics(
+    AlphaStatistics& stats,
+    const XMVECTOR* pPixels,
+    size_t count,
+    float opaqueThreshold) noexcept
+{
+    assert(pPixels != nullptr);
+
+    const XMVECTOR vOpaque = XMVectorReplicate(opaqueThreshold);
+
+    XMVECTOR vMin = XMVectorReplicate(stats.minAlpha);
+    XMVECTOR vMax = XMVectorReplicate(stats.maxAlpha);
+    XMVECTOR oneBit = XMVectorTrueInt();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const XMVECTOR alpha = XMVectorSplatW(pPixels[i]);
+        vMin = XMVectorMin(vMin, alpha);
+        vMax = XMVectorMax(vMax, alpha);
+
+        const XMVECTOR extreme = XMVectorOrInt(XMVectorGreaterOrEqual(alpha, vOpaque), XMVectorLessOrEqual(alpha, g_AlphaTransparent));
+        oneBit = XMVectorAndInt(oneBit, extreme);
+    }
+
+    stats.minAlpha = XMVectorGetX(vMin);
+    stats.maxAlpha = XMVectorGetX(vMax);
+    stats.allOpaque = XMVector4GreaterOrEqual(vMin, vOpaque);
+    stats.allTransparent = XMVector4LessOrEqual(vMax, g_AlphaTransparent);
+    stats.oneBit = stats.oneBit && XMVector4EqualInt(oneBit, XMVectorTrueInt());
+}
+
+_Use_decl_annotations_
+void DirectX::Internal::UpdateAlphaStatistics(
+    AlphaStatistics& stats,
+    const XMVECTOR* pPixels,
+    size_t count,
+    float opaqueThreshold,
+    float threshold) noexcept
+{
+    assert(pPixels != nullptr);
+
+    const XMVECTOR vOpaque = XMVectorReplicate(opaqueThreshold);
+    const XMVECTOR vThreshold = XMVectorReplicate(threshold);
+
+    XMVECTOR vMin = XMVectorReplicate(stats.minAlpha);
+    XMVECTOR vMax = XMVectorReplicate(stats.maxAlpha);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const XMVECTOR alpha = XMVectorSelect(g_XMOne, g_XMZero, XMVectorLess(XMVectorSplatW(pPixels[i]), vThreshold));
+        vMin = XMVectorMin(vMin, alpha);
+        vMax = XMVectorMax(vMax, alpha);
+    }
+
+    stats.minAlpha = XMVectorGetX(vMin);
+    stats.maxAlpha = XMVectorGetX(vMax);
+    stats.allOpaque = XMVector4GreaterOrEqual(vMin, vOpaque);
+    stats.allTransparent = XMVector4LessOrEqual(vMax, g_AlphaTransparent);
+}
+
+_Use_decl_annotations_
+void DirectX::Internal::MergeAlphaStatistics(AlphaStatistics& stats, const AlphaStatistics& other) noexcept
+{
+    stats.minAlpha = std::min(stats.minAlpha, other.minAlpha);
+    stats.maxAlpha = std::max(stats.maxAlpha, other.maxAlpha);
+    stats.allOpaque = stats.allOpaque && other.allOpaque;
+    stats.allTransparent = stats.allTransparent && other.allTransparent;
+    stats.oneBit = stats.oneBit && other.oneBit;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::Internal::ComputeAlphaStatistics(const Image& image, float opaqueThreshold, AlphaStatistics& stats) noexcept
+{
+    ResetAlphaStatistics(stats);
+
+    if (!image.pixels)
+        return E_POINTER;
+
+    if (IsCompressed(image.format) || IsPlanar(image.format) || IsPalettized(image.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if (!HasAlpha(image.format))
+    {
+        stats.maxAlpha = 1.f;
+        stats.allTransparent = false;
+        return S_OK;
+    }
+
+    auto scanline = make_AlignedArrayXMVECTOR(image.width);
+    if (!scanline)
+        return E_OUTOFMEMORY;
+
+    const uint8_t *pSrc = image.pixels;
+    for (size_t h = 0; h < image.height; ++h)
+    {
+        if (!LoadScanline(scanline.get(), image.width, pSrc, image.rowPitch, image.format))
+            return E_FAIL;
+
+        UpdateAlphaStatistics(stats, scanline.get(), image.width, opaqueThreshold);
+
+        pSrc += image.rowPitch;
+    }
+
+    return S_OK;
+}
+
+
 //=====================================================================================
 // Entry points
 //=====================================================================================
@@ -440,7 +440,23 @@ namespace DirectX
 
         //---------------------------------------------------------------------------------
         // Misc helper functions
+        constexpr float ALPHA_OPAQUE_THRESHOLD = 0.997f;
+        constexpr float ALPHA_OPAQUE_THRESHOLD_BC = 0.99f;
+            // Smallest alpha that ScratchImage::IsAlphaAllOpaque treats as opaque for uncompressed and BC formats
+
         bool __cdecl IsAlphaAllOpaqueBC(_In_ const Image& cImage) noexcept;
+
+        void __cdecl ResetAlphaStatistics(_Out_ AlphaStatistics& stats) noexcept;
+        void __cdecl UpdateAlphaStatistics(
+            _Inout_ AlphaStatistics& stats,
+            _In_reads_(count) const XMVECTOR* pPixels, _In_ size_t count, _In_ float opaqueThreshold) noexcept;
+        void __cdecl UpdateAlphaStatistics(
+            _Inout_ AlphaStatistics& stats,
+            _In_reads_(count) const XMVECTOR* pPixels, _In_ size_t count, _In_ float opaqueThreshold, _In_ float threshold) noexcept;
+            // Treats alpha as 1-bit using threshold, the same way as the BC1 encoder
+        void __cdecl MergeAlphaStatistics(_Inout_ AlphaStatistics& stats, _In_ const AlphaStatistics& other) noexcept;
+        HRESULT __cdecl ComputeAlphaStatistics(_In_ const Image& image, _In_ float opaqueThreshold, _Out_ AlphaStatistics& stats) noexcept;
+            // opaqueThreshold is the ALPHA_OPAQUE_THRESHOLD* value for the format the statistics describe
         bool __cdecl CalculateMipLevels(_In_ size_t width, _In_ size_t height, _Inout_ size_t& mipLevels) noexcept;
         bool __cdecl CalculateMipLevels3D(_In_ size_t width, _In_ size_t height, _In_ size_t depth,
             _Inout_ size_t& mipLevels) noexcept;
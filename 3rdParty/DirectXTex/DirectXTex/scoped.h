@@ -33,16 +33,8 @@ inline ScopedAlignedArrayFloat make_AlignedArrayFloat(uint64_t count)
     return ScopedAlignedArrayFloat(static_cast<float*>(ptr));
 }
 
-using ScopedAlignedArrayXMVECTOR = std::unique_ptr<DirectX::XMVECTOR[], aligned_deleter>;
-
-inline ScopedAlignedArrayXMVECTOR make_AlignedArrayXMVECTOR(uint64_t count)
-{
-    uint64_t size = sizeof(DirectX::XMVECTOR) * count;
-    if (size > static_cast<uint64_t>(UINT32_MAX))
-        return nullptr;
-    auto ptr = aligned_alloc(16, static_cast<size_t>(size));
-    return ScopedAlignedArrayXMVECTOR(static_cast<DirectX::XMVECTOR*>(ptr));
-}
+inline void* scanline_alloc(size_t size) noexcept { return aligned_alloc(16, (size + 15u) & ~size_t(0xF)); }
+inline void scanline_free(void* p) noexcept { free(p); }
 
 #else // WIN32
 //---------------------------------------------------------------------------------
@@ -61,16 +53,8 @@ inline ScopedAlignedArrayFloat make_AlignedArrayFloat(uint64_t count)
     return ScopedAlignedArrayFloat(static_cast<float*>(ptr));
 }
 
-using ScopedAlignedArrayXMVECTOR = std::unique_ptr<DirectX::XMVECTOR[], aligned_deleter>;
-
-inline ScopedAlignedArrayXMVECTOR make_AlignedArrayXMVECTOR(uint64_t count)
-{
-    const uint64_t size = sizeof(DirectX::XMVECTOR) * count;
-    if (size > static_cast<uint64_t>(UINT32_MAX))
-        return nullptr;
-    auto ptr = _aligned_malloc(static_cast<size_t>(size), 16);
-    return ScopedAlignedArrayXMVECTOR(static_cast<DirectX::XMVECTOR*>(ptr));
-}
+inline void* scanline_alloc(size_t size) noexcept { return _aligned_malloc(size, 16); }
+inline void scanline_free(void* p) noexcept { _aligned_free(p); }
 
 //---------------------------------------------------------------------------------
 struct handle_closer { void operator()(HANDLE h) noexcept { assert(h != INVALID_HANDLE_VALUE); if (h) CloseHandle(h); } };
@@ -110,3 +94,144 @@ private:
 };
 
 #endif // WIN32
+
+//---------------------------------------------------------------------------------
+// Scanline buffers are recycled through a small per-thread cache, so operations that
+// run once per image (or per OpenMP worker) do not allocate and page in new memory.
+// Each thread keeps at most c_MaxCachedBytes, DirectX::ReleaseScanlineCaches frees them.
+namespace ScanlineArena
+{
+    constexpr size_t c_HeaderSize = 16;
+    constexpr size_t c_Granularity = 4096;
+    constexpr size_t c_MaxCachedBlocks = 4;
+    constexpr size_t c_MaxCachedBlockSize = 1024 * 1024;
+    constexpr size_t c_MaxCachedBytes = 2 * 1024 * 1024;
+
+    struct Cache
+    {
+        void*  blocks[c_MaxCachedBlocks];
+        size_t sizes[c_MaxCachedBlocks];
+        size_t totalSize;
+
+        Cache() noexcept : blocks{}, sizes{}, totalSize(0) {}
+
+        Cache(const Cache&) = delete;
+        Cache& operator=(const Cache&) = delete;
+
+        ~Cache() { Clear(); }
+
+        void Clear() noexcept
+        {
+            for (size_t i = 0; i < c_MaxCachedBlocks; ++i)
+            {
+                if (blocks[i])
+                    scanline_free(blocks[i]);
+                blocks[i] = nullptr;
+                sizes[i] = 0;
+            }
+            totalSize = 0;
+        }
+    };
+
+    inline Cache& GetCache() noexcept
+    {
+        static thread_local Cache s_cache;
+        return s_cache;
+    }
+
+    // Blocks store their usable size in a header so they can be returned to the cache
+    inline void* Allocate(size_t size) noexcept
+    {
+        Cache& cache = GetCache();
+
+        size_t best = c_MaxCachedBlocks;
+        for (size_t i = 0; i < c_MaxCachedBlocks; ++i)
+        {
+            if (cache.blocks[i] && cache.sizes[i] >= size
+                && (best == c_MaxCachedBlocks || cache.sizes[i] < cache.sizes[best]))
+            {
+                best = i;
+            }
+        }
+
+        if (best < c_MaxCachedBlocks)
+        {
+            auto block = static_cast<uint8_t*>(cache.blocks[best]);
+            cache.totalSize -= cache.sizes[best];
+            cache.blocks[best] = nullptr;
+            cache.sizes[best] = 0;
+            return block + c_HeaderSize;
+        }
+
+        const size_t capacity = (size + c_Granularity - 1) & ~(c_Granularity - 1);
+
+        auto block = static_cast<uint8_t*>(scanline_alloc(capacity + c_HeaderSize));
+        if (!block)
+            return nullptr;
+
+        *reinterpret_cast<size_t*>(block) = capacity;
+        return block + c_HeaderSize;
+    }
+
+    inline void Free(void* p) noexcept
+    {
+        if (!p)
+            return;
+
+        auto block = static_cast<uint8_t*>(p) - c_HeaderSize;
+        const size_t capacity = *reinterpret_cast<const size_t*>(block);
+
+        if (capacity <= c_MaxCachedBlockSize)
+        {
+            Cache& cache = GetCache();
+
+            // Use an empty slot, otherwise replace the smallest block if it is smaller
+            size_t slot = 0;
+            for (size_t i = 0; i < c_MaxCachedBlocks; ++i)
+            {
+                if (!cache.blocks[i])
+                {
+                    slot = i;
+                    break;
+                }
+
+                if (cache.sizes[i] < cache.sizes[slot])
+                    slot = i;
+            }
+
+            // Keep the block only if it is larger than the one it replaces and the cache stays under its limit
+            if ((!cache.blocks[slot] || cache.sizes[slot] < capacity)
+                && (cache.totalSize - cache.sizes[slot] + capacity <= c_MaxCachedBytes))
+            {
+                if (cache.blocks[slot])
+                    scanline_free(cache.blocks[slot]);
+
+                cache.totalSize += capacity - cache.sizes[slot];
+                cache.blocks[slot] = block;
+                cache.sizes[slot] = capacity;
+                return;
+            }
+        }
+
+        scanline_free(block);
+    }
+
+    // Frees the blocks cached by the calling thread
+    inline void Trim() noexcept
+    {
+        GetCache().Clear();
+    }
+}
+
+struct scanline_deleter { void operator()(void* p) noexcept { ScanlineArena::Free(p); } };
+
+using ScopedAlignedArrayXMVECTOR = std::unique_ptr<DirectX::XMVECTOR[], scanline_deleter>;
+
+inline ScopedAlignedArrayXMVECTOR make_AlignedArrayXMVECTOR(uint64_t count)
+{
+    const uint64_t size = sizeof(DirectX::XMVECTOR) * count;
+    if (size > static_cast<uint64_t>(UINT32_MAX))
+        return nullptr;
+    auto ptr = ScanlineArena::Allocate(static_cast<size_t>(size));
+    return ScopedAlignedArrayXMVECTOR(static_cast<DirectX::XMVECTOR*>(ptr));
+}
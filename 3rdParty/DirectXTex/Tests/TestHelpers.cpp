@@ -0,0 +1,207 @@
+//-------------------------------------------------------------------------------------
+// TestHelpers.cpp
+//
+// Shared helpers for the DirectXTex tests
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+
+#include <cmath>
+
+using namespace DirectX;
+
+void TestHelpers::FillTestPattern(const Image& image, uint32_t seed, bool withAlpha)
+{
+    assert(image.format == DXGI_FORMAT_R8G8B8A8_UNORM);
+
+    Random rng(seed);
+
+    // Low frequency waves give the smooth areas, each channel with its own phase
+    float freq[3][2];
+    float phase[3];
+    for (size_t c = 0; c < 3; ++c)
+    {
+        freq[c][0] = 0.01f + rng.NextFloat() * 0.08f;
+        freq[c][1] = 0.01f + rng.NextFloat() * 0.08f;
+        phase[c] = rng.NextFloat() * 6.2831853f;
+    }
+
+    // A few flat rectangles give the hard edges
+    struct Rect { size_t x0, y0, x1, y1; uint8_t color[4]; };
+    Rect rects[6];
+    for (auto& rect : rects)
+    {
+        rect.x0 = rng.Next() % image.width;
+        rect.y0 = rng.Next() % image.height;
+        rect.x1 = rect.x0 + 1 + rng.Next() % (image.width / 2 + 1);
+        rect.y1 = rect.y0 + 1 + rng.Next() % (image.height / 2 + 1);
+        for (auto& c : rect.color)
+            c = static_cast<uint8_t>(rng.Next());
+        if (!withAlpha)
+            rect.color[3] = 255;
+    }
+
+    for (size_t y = 0; y < image.height; ++y)
+    {
+        uint8_t* pixel = image.pixels + y * image.rowPitch;
+        for (size_t x = 0; x < image.width; ++x, pixel += 4)
+        {
+            const Rect* hit = nullptr;
+            for (const auto& rect : rects)
+            {
+                if (x >= rect.x0 && x < rect.x1 && y >= rect.y0 && y < rect.y1)
+                    hit = &rect;
+            }
+
+            const int noise = int(rng.Next() % 13) - 6;
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+                int value;
+                if (hit)
+                {
+                    value = hit->color[c];
+                }
+                else
+                {
+                    const float wave = sinf(float(x) * freq[c][0] + float(y) * freq[c][1] + phase[c]);
+                    value = int(127.5f + 110.f * wave);
+                }
+                value += noise;
+                pixel[c] = static_cast<uint8_t>(std::min(255, std::max(0, value)));
+            }
+
+            if (!withAlpha)
+            {
+                pixel[3] = 255;
+            }
+            else if (hit)
+            {
+                pixel[3] = hit->color[3];
+            }
+            else
+            {
+                // Smooth alpha ramp with a fully transparent band
+                const size_t band = (x + y) % 64;
+                pixel[3] = (band < 8) ? 0 : static_cast<uint8_t>(255 - ((x * 255) / image.width) / 2);
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------
+bool TestHelpers::MatchesRectangle(const Image& image, const Rect& rect, const Image& region)
+{
+    if (region.format != image.format || region.width != rect.w || region.height != rect.h)
+        return false;
+
+    const size_t bytesPerPixel = BitsPerPixel(image.format) / 8;
+
+    for (size_t y = 0; y < rect.h; ++y)
+    {
+        const uint8_t* expected = image.pixels + (rect.y + y) * image.rowPitch + rect.x * bytesPerPixel;
+        if (memcmp(expected, region.pixels + y * region.rowPitch, rect.w * bytesPerPixel) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+namespace
+{
+    TestHelpers::MemoryStream* g_stream = nullptr;
+}
+
+TestHelpers::MemoryStream::MemoryStream(std::vector<uint8_t> data) noexcept :
+    m_data(std::move(data)),
+    m_position(0),
+    m_failOffset(SIZE_MAX),
+    m_failHR(S_OK),
+    m_bytesRead(0),
+    m_activeCalls(0),
+    m_concurrent(false),
+    m_callbacks{ Read, Write, Seek, GetSize }
+{
+    assert(!g_stream);
+    g_stream = this;
+}
+
+TestHelpers::MemoryStream::~MemoryStream()
+{
+    g_stream = nullptr;
+}
+
+TestHelpers::MemoryStream::CallScope::CallScope() noexcept
+{
+    if (g_stream->m_activeCalls.fetch_add(1) != 0)
+        g_stream->m_concurrent = true;
+}
+
+TestHelpers::MemoryStream::CallScope::~CallScope()
+{
+    g_stream->m_activeCalls.fetch_sub(1);
+}
+
+HRESULT __stdcall TestHelpers::MemoryStream::Read(void* buffer, const DWORD count)
+{
+    const CallScope scope;
+    MemoryStream& stream = *g_stream;
+
+    if (count > stream.m_data.size() - stream.m_position)
+        return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+    if (stream.m_position + count > stream.m_failOffset)
+        return stream.m_failHR;
+
+    memcpy(buffer, stream.m_data.data() + stream.m_position, count);
+    stream.m_position += count;
+    stream.m_bytesRead += count;
+    return S_OK;
+}
+
+HRESULT __stdcall TestHelpers::MemoryStream::Write(const void* buffer, const DWORD count)
+{
+    const CallScope scope;
+    MemoryStream& stream = *g_stream;
+
+    if (stream.m_position + count > stream.m_data.size())
+        stream.m_data.resize(stream.m_position + count);
+
+    memcpy(stream.m_data.data() + stream.m_position, buffer, count);
+    stream.m_position += count;
+    return S_OK;
+}
+
+HRESULT __stdcall TestHelpers::MemoryStream::Seek(const INT64 position, const INT32 origin)
+{
+    const CallScope scope;
+    MemoryStream& stream = *g_stream;
+
+    INT64 base = 0;
+    if (origin == FILE_CURRENT)
+        base = static_cast<INT64>(stream.m_position);
+    else if (origin == FILE_END)
+        base = static_cast<INT64>(stream.m_data.size());
+
+    const INT64 target = base + position;
+    if (target < 0 || target > static_cast<INT64>(stream.m_data.size()))
+        return E_INVALIDARG;
+
+    stream.m_position = static_cast<size_t>(target);
+    return S_OK;
+}
+
+HRESULT __stdcall TestHelpers::MemoryStream::GetSize(INT64* size)
+{
+    const CallScope scope;
+
+    if (!size)
+        return E_POINTER;
+
+    *size = static_cast<INT64>(g_stream->m_data.size());
+    return S_OK;
+}
@@ -0,0 +1,95 @@
+//-------------------------------------------------------------------------------------
+// TestHelpers.h
+//
+// Shared helpers for the DirectXTex tests
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "DirectXTexP.h"
+
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+#define TEST_CHECK(expr) \
+    do { if (!(expr)) { printf("    FAILED: %s (%s:%d)\n", #expr, __FILE__, __LINE__); return false; } } while (0)
+
+#define TEST_CHECK_HR(expr) \
+    do { const HRESULT hr_ = (expr); if (FAILED(hr_)) { printf("    FAILED: %s returned %08X (%s:%d)\n", #expr, static_cast<unsigned int>(hr_), __FILE__, __LINE__); return false; } } while (0)
+
+namespace TestHelpers
+{
+    // Deterministic pseudo-random numbers, so failures reproduce on every platform
+    class Random
+    {
+    public:
+        explicit Random(uint32_t seed) noexcept : m_state(seed ? seed : 1u) {}
+
+        uint32_t Next() noexcept
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state;
+        }
+
+        float NextFloat() noexcept { return float(Next() >> 8) / 16777215.f; }
+
+    private:
+        uint32_t m_state;
+    };
+
+    // Fills an R8G8B8A8_UNORM image with smooth gradients, noise and a few hard edges, which is
+    // close enough to photographic content to exercise every encoder mode
+    void FillTestPattern(_In_ const DirectX::Image& image, _In_ uint32_t seed, _In_ bool withAlpha);
+
+    // True when region holds the pixels of image inside rect, both in the same format
+    bool MatchesRectangle(_In_ const DirectX::Image& image, _In_ const DirectX::Rect& rect, _In_ const DirectX::Image& region);
+
+    // ImageIOCallbacks over an in-memory file.  The callbacks have no context pointer, so only
+    // one MemoryStream can be alive at a time.
+    class MemoryStream
+    {
+    public:
+        explicit MemoryStream(std::vector<uint8_t> data) noexcept;
+        ~MemoryStream();
+
+        MemoryStream(const MemoryStream&) = delete;
+        MemoryStream& operator=(const MemoryStream&) = delete;
+
+        const DirectX::ImageIOCallbacks* GetCallbacks() const noexcept { return &m_callbacks; }
+
+        // Fails the read that reaches offset with hr
+        void FailReadsAt(size_t offset, HRESULT hr) noexcept { m_failOffset = offset; m_failHR = hr; }
+
+        bool WasCalledConcurrently() const noexcept { return m_concurrent; }
+
+        size_t GetBytesRead() const noexcept { return m_bytesRead; }
+
+    private:
+        static HRESULT __stdcall Read(void* buffer, const DWORD count);
+        static HRESULT __stdcall Write(const void* buffer, const DWORD count);
+        static HRESULT __stdcall Seek(const INT64 position, const INT32 origin);
+        static HRESULT __stdcall GetSize(INT64* size);
+
+        // Flags callbacks that overlap, the loaders promise to call them one at a time
+        struct CallScope
+        {
+            CallScope() noexcept;
+            ~CallScope();
+        };
+
+        std::vector<uint8_t>        m_data;
+        size_t                      m_position;
+        size_t                      m_failOffset;
+        HRESULT                     m_failHR;
+        size_t                      m_bytesRead;
+        std::atomic<int>            m_activeCalls;
+        bool                        m_concurrent;
+        DirectX::ImageIOCallbacks   m_callbacks;
+    };
+}
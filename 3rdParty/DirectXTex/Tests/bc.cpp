@@ -0,0 +1,678 @@
+//-------------------------------------------------------------------------------------
+// bc.cpp
+//
+// Tests for the BC1-BC7 block encoders
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+#include "BC.h"
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace TestHelpers;
+
+namespace
+{
+    constexpr size_t c_ImageSize = 256;
+
+    // Endpoint pairs and indices that tie for the integer encoder can decode a little apart
+    // through the float decoder, the BC4 checks allow for that float rounding
+    constexpr float c_RelativeTolerance = 1e-5f;
+    constexpr float c_DecodeTolerance = 5e-9f;
+
+    void LoadBlock(const Image& image, size_t bx, size_t by, XMVECTOR* pColor) noexcept
+    {
+        for (size_t y = 0; y < 4; ++y)
+        {
+            auto pixels = reinterpret_cast<const XMUBYTEN4*>(image.pixels + (by * 4 + y) * image.rowPitch) + bx * 4;
+            for (size_t x = 0; x < 4; ++x)
+            {
+                pColor[y * 4 + x] = XMLoadUByteN4(pixels + x);
+            }
+        }
+    }
+
+    float BlockError(const XMVECTOR* pOriginal, const XMVECTOR* pDecoded, bool includeAlpha) noexcept
+    {
+        float error = 0.f;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            XMVECTOR diff = XMVectorSubtract(pOriginal[i], pDecoded[i]);
+            if (!includeAlpha)
+                diff = XMVectorSelect(g_XMZero, diff, g_XMSelect1110);
+            error += XMVectorGetX(XMVector4Dot(diff, diff));
+        }
+        return error;
+    }
+
+    using EncodeFunc = void(*)(uint8_t*, const XMVECTOR*, uint32_t);
+    using EncodeBatchFunc = void(*)(uint8_t*, const XMVECTOR*, size_t, float, uint32_t);
+    using DecodeFunc = void(*)(XMVECTOR*, const uint8_t*);
+
+    void EncodeBC1(uint8_t* pBC, const XMVECTOR* pColor, uint32_t flags) noexcept
+    {
+        D3DXEncodeBC1(pBC, pColor, TEX_THRESHOLD_DEFAULT, flags);
+    }
+
+    // Encodes every block of the image with the single block and the batch encoder, and
+    // compares both against the source
+    bool CompareBatchEncoder(
+        const Image& image,
+        size_t blockSize,
+        EncodeFunc encode,
+        EncodeBatchFunc encodeBatch,
+        DecodeFunc decode,
+        uint32_t flags,
+        bool includeAlpha,
+        size_t& identicalBlocks,
+        float& singleError,
+        float& batchError)
+    {
+        const size_t blocksX = image.width / 4;
+        const size_t blocksY = image.height / 4;
+
+        std::vector<uint8_t> single(blockSize * BC_ENCODE_BATCH_SIZE);
+        std::vector<uint8_t> batch(blockSize * BC_ENCODE_BATCH_SIZE);
+
+        XMVECTOR color[BC_ENCODE_BATCH_SIZE * NUM_PIXELS_PER_BLOCK];
+        XMVECTOR decoded[NUM_PIXELS_PER_BLOCK];
+
+        for (size_t by = 0; by < blocksY; ++by)
+        {
+            for (size_t bx = 0; bx < blocksX; bx += BC_ENCODE_BATCH_SIZE)
+            {
+                const size_t count = std::min(BC_ENCODE_BATCH_SIZE, blocksX - bx);
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    LoadBlock(image, bx + i, by, color + i * NUM_PIXELS_PER_BLOCK);
+                    encode(single.data() + i * blockSize, color + i * NUM_PIXELS_PER_BLOCK, flags);
+                }
+
+                encodeBatch(batch.data(), color, count, TEX_THRESHOLD_DEFAULT, flags);
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const XMVECTOR* original = color + i * NUM_PIXELS_PER_BLOCK;
+
+                    if (memcmp(single.data() + i * blockSize, batch.data() + i * blockSize, blockSize) == 0)
+                        ++identicalBlocks;
+
+                    decode(decoded, single.data() + i * blockSize);
+                    singleError += BlockError(original, decoded, includeAlpha);
+
+                    decode(decoded, batch.data() + i * blockSize);
+                    batchError += BlockError(original, decoded, includeAlpha);
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+//-------------------------------------------------------------------------------------
+// The four block BC1-BC3 color search follows the single block arithmetic. Compilers that
+// reorder float math (/fp:fast) may still round a few blocks differently, so the test
+// checks the overall error and reports how many blocks are byte identical.
+bool Test_BCBatchMatchesSingle()
+{
+    const struct
+    {
+        const char* name;
+        size_t blockSize;
+        EncodeFunc encode;
+        EncodeBatchFunc encodeBatch;
+        DecodeFunc decode;
+        bool withAlpha;
+    } encoders[] =
+    {
+        { "BC1", 8, EncodeBC1, D3DXEncodeBC1Batch, D3DXDecodeBC1, false },
+        { "BC2", 16, D3DXEncodeBC2, D3DXEncodeBC2Batch, D3DXDecodeBC2, true },
+        { "BC3", 16, D3DXEncodeBC3, D3DXEncodeBC3Batch, D3DXDecodeBC3, true },
+    };
+
+    const uint32_t flagSets[] = { BC_FLAGS_NONE, BC_FLAGS_UNIFORM, BC_FLAGS_YCOCG_METRIC };
+
+    for (const auto& encoder : encoders)
+    {
+        for (auto flags : flagSets)
+        {
+            size_t identicalBlocks = 0;
+            size_t totalBlocks = 0;
+            float singleError = 0.f;
+            float batchError = 0.f;
+
+            for (uint32_t seed = 1; seed <= 3; ++seed)
+            {
+                ScratchImage image;
+                TEST_CHECK_HR(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, c_ImageSize, c_ImageSize, 1, 1));
+                FillTestPattern(*image.GetImage(0, 0, 0), seed, encoder.withAlpha);
+
+                TEST_CHECK(CompareBatchEncoder(*image.GetImage(0, 0, 0), encoder.blockSize,
+                    encoder.encode, encoder.encodeBatch, encoder.decode, flags, encoder.withAlpha,
+                    identicalBlocks, singleError, batchError));
+
+                totalBlocks += (c_ImageSize / 4) * (c_ImageSize / 4);
+            }
+
+            printf("    %s flags %06X: %zu of %zu blocks identical, error %f single, %f batch\n",
+                encoder.name, flags, identicalBlocks, totalBlocks, double(singleError), double(batchError));
+
+            TEST_CHECK(batchError <= singleError * 1.001f);
+            TEST_CHECK(identicalBlocks * 100 >= totalBlocks * 99);
+        }
+    }
+
+    return true;
+}
+
+namespace
+{
+    // The BC4U encoder before the endpoint candidate search: the least-squares endpoints
+    // truncated to 8 bits and the nearest decoded palette entry for each texel
+    void EncodeBC4UReference(uint8_t* pBC, const float* pTexels) noexcept
+    {
+        float fBlockMin = pTexels[0];
+        float fBlockMax = pTexels[0];
+        for (size_t i = 1; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            fBlockMin = std::min(fBlockMin, pTexels[i]);
+            fBlockMax = std::max(fBlockMax, pTexels[i]);
+        }
+
+        float fStart, fEnd;
+        if (fBlockMin == 0.f || fBlockMax == 1.f)
+        {
+            OptimizeAlpha<false>(&fStart, &fEnd, pTexels, 6);
+            pBC[0] = static_cast<uint8_t>(fStart * 255.0f);
+            pBC[1] = static_cast<uint8_t>(fEnd * 255.0f);
+        }
+        else
+        {
+            OptimizeAlpha<false>(&fStart, &fEnd, pTexels, 8);
+            pBC[0] = static_cast<uint8_t>(fEnd * 255.0f);
+            pBC[1] = static_cast<uint8_t>(fStart * 255.0f);
+        }
+
+        // Decode each palette entry by pointing every index at it
+        float palette[8];
+        for (uint64_t index = 0; index < 8; ++index)
+        {
+            uint64_t block = uint64_t(pBC[0]) | (uint64_t(pBC[1]) << 8);
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+                block |= index << (3 * i + 16);
+
+            XMVECTOR decoded[NUM_PIXELS_PER_BLOCK];
+            D3DXDecodeBC4U(decoded, reinterpret_cast<const uint8_t*>(&block));
+            palette[index] = XMVectorGetX(decoded[0]);
+        }
+
+        uint64_t block = uint64_t(pBC[0]) | (uint64_t(pBC[1]) << 8);
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            uint64_t bestIndex = 0;
+            for (uint64_t index = 1; index < 8; ++index)
+            {
+                if (fabsf(palette[index] - pTexels[i]) < fabsf(palette[bestIndex] - pTexels[i]))
+                    bestIndex = index;
+            }
+            block |= bestIndex << (3 * i + 16);
+        }
+
+        memcpy(pBC, &block, sizeof(block));
+    }
+
+    float BC4Error(const uint8_t* pBC, const float* pTexels, bool isSigned) noexcept
+    {
+        XMVECTOR decoded[NUM_PIXELS_PER_BLOCK];
+        if (isSigned)
+            D3DXDecodeBC4S(decoded, pBC);
+        else
+            D3DXDecodeBC4U(decoded, pBC);
+
+        float error = 0.f;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const float delta = XMVectorGetX(decoded[i]) - pTexels[i];
+            error += delta * delta;
+        }
+        return error;
+    }
+
+    double PSNR(double error, size_t count) noexcept
+    {
+        const double mse = error / double(count);
+        return (mse > 0.) ? 10. * log10(1. / mse) : 999.;
+    }
+
+    // Loads the red or green channel of each 4x4 block, 8-bit content as in a normal map
+    void LoadChannelBlocks(const Image& image, size_t channel, bool isSigned, std::vector<float>& texels)
+    {
+        for (size_t by = 0; by < image.height / 4; ++by)
+        {
+            for (size_t bx = 0; bx < image.width / 4; ++bx)
+            {
+                for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+                {
+                    const uint8_t value = image.pixels[(by * 4 + i / 4) * image.rowPitch + (bx * 4 + i % 4) * 4 + channel];
+                    texels.push_back(isSigned ? std::max(-1.f, (float(value) - 128.f) / 127.f) : float(value) / 255.f);
+                }
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------
+// The candidate search always includes the truncated endpoints that the encoder used to
+// return, so no block gets worse, and the exhaustive mode tries a superset of the default
+// candidates.  Prints the quality and time of each mode for reference.
+bool Test_BC4EndpointSearch()
+{
+    for (const bool isSigned : { false, true })
+    {
+        std::vector<float> texels;
+
+        for (uint32_t seed = 1; seed <= 3; ++seed)
+        {
+            ScratchImage image;
+            TEST_CHECK_HR(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, c_ImageSize, c_ImageSize, 1, 1));
+            FillTestPattern(*image.GetImage(0, 0, 0), seed, false);
+
+            LoadChannelBlocks(*image.GetImage(0, 0, 0), 0, isSigned, texels);
+            LoadChannelBlocks(*image.GetImage(0, 0, 0), 1, isSigned, texels);
+        }
+
+        const size_t blockCount = texels.size() / NUM_PIXELS_PER_BLOCK;
+
+        std::vector<uint8_t> encoded[3];
+        double seconds[3] = {};
+
+        for (size_t mode = 0; mode < 3; ++mode)
+        {
+            encoded[mode].resize(blockCount * 8);
+
+            const auto start = std::chrono::steady_clock::now();
+
+            for (size_t block = 0; block < blockCount; ++block)
+            {
+                const float* pTexels = &texels[block * NUM_PIXELS_PER_BLOCK];
+                uint8_t* pBC = &encoded[mode][block * 8];
+
+                XMVECTOR color[NUM_PIXELS_PER_BLOCK];
+                for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+                    color[i] = XMVectorReplicate(pTexels[i]);
+
+                if (mode == 0)
+                {
+                    if (isSigned)
+                        continue;
+                    EncodeBC4UReference(pBC, pTexels);
+                }
+                else
+                {
+                    const uint32_t flags = (mode == 2) ? BC_FLAGS_BC45_EXHAUSTIVE : BC_FLAGS_NONE;
+                    if (isSigned)
+                        D3DXEncodeBC4S(pBC, color, flags);
+                    else
+                        D3DXEncodeBC4U(pBC, color, flags);
+                }
+            }
+
+            seconds[mode] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        double totalError[3] = {};
+
+        for (size_t block = 0; block < blockCount; ++block)
+        {
+            const float* pTexels = &texels[block * NUM_PIXELS_PER_BLOCK];
+
+            float error[3] = {};
+            for (size_t mode = isSigned ? 1 : 0; mode < 3; ++mode)
+            {
+                error[mode] = BC4Error(&encoded[mode][block * 8], pTexels, isSigned);
+                totalError[mode] += error[mode];
+            }
+
+            if (!isSigned)
+                TEST_CHECK(error[1] <= error[0] * (1.f + c_RelativeTolerance) + c_DecodeTolerance);
+
+            TEST_CHECK(error[2] <= error[1] * (1.f + c_RelativeTolerance) + c_DecodeTolerance);
+        }
+
+        const size_t texelCount = blockCount * NUM_PIXELS_PER_BLOCK;
+        const double range = isSigned ? 4.0 : 1.0;
+
+        if (!isSigned)
+        {
+            // The reference encoder decodes its palette through D3DXDecodeBC4U, so its time is not comparable
+            printf("    BC4U previous:   %.2f dB (%zu blocks)\n", PSNR(totalError[0] / range, texelCount), blockCount);
+        }
+        printf("    BC4%c default:    %.2f dB, %.1f ms\n", isSigned ? 'S' : 'U',
+            PSNR(totalError[1] / range, texelCount), seconds[1] * 1000.);
+        printf("    BC4%c exhaustive: %.2f dB, %.1f ms\n", isSigned ? 'S' : 'U',
+            PSNR(totalError[2] / range, texelCount), seconds[2] * 1000.);
+    }
+
+    return true;
+}
+
+namespace
+{
+    // The BC3 alpha encoder before it shared the BC4 encoder: rounded least-squares
+    // endpoints and each texel projected onto the float step palette
+    void EncodeBC3AlphaFloat(uint8_t* pBC, const float* pColorAlpha) noexcept
+    {
+        // Quantized to A8 the same way as the encoder, OptimizeAlpha is sensitive to the last bit
+        float pAlpha[NUM_PIXELS_PER_BLOCK];
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            pAlpha[i] = static_cast<float>(static_cast<int32_t>(pColorAlpha[i] * 255.0f + 0.5f)) * (1.0f / 255.0f);
+
+        float fMinAlpha = pAlpha[0];
+        float fMaxAlpha = pAlpha[0];
+        for (size_t i = 1; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            fMinAlpha = std::min(fMinAlpha, pAlpha[i]);
+            fMaxAlpha = std::max(fMaxAlpha, pAlpha[i]);
+        }
+
+        memset(pBC, 0, 8);
+
+        if (1.0f == fMinAlpha)
+        {
+            pBC[0] = pBC[1] = 0xff;
+            return;
+        }
+
+        const uint32_t uSteps = ((0.0f == fMinAlpha) || (1.0f == fMaxAlpha)) ? 6u : 8u;
+
+        float fAlphaA, fAlphaB;
+        OptimizeAlpha<false>(&fAlphaA, &fAlphaB, pAlpha, uSteps);
+
+        const auto bAlphaA = static_cast<uint8_t>(static_cast<int32_t>(fAlphaA * 255.0f + 0.5f));
+        const auto bAlphaB = static_cast<uint8_t>(static_cast<int32_t>(fAlphaB * 255.0f + 0.5f));
+
+        fAlphaA = static_cast<float>(bAlphaA) * (1.0f / 255.0f);
+        fAlphaB = static_cast<float>(bAlphaB) * (1.0f / 255.0f);
+
+        if ((8 == uSteps) && (bAlphaA == bAlphaB))
+        {
+            pBC[0] = bAlphaA;
+            pBC[1] = bAlphaB;
+            return;
+        }
+
+        static const uint64_t pSteps6[] = { 0, 2, 3, 4, 5, 1 };
+        static const uint64_t pSteps8[] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+
+        const uint64_t* pSteps;
+        float fStep0, fStep1;
+
+        if (6 == uSteps)
+        {
+            pBC[0] = bAlphaA;
+            pBC[1] = bAlphaB;
+            fStep0 = fAlphaA;
+            fStep1 = fAlphaB;
+            pSteps = pSteps6;
+        }
+        else
+        {
+            pBC[0] = bAlphaB;
+            pBC[1] = bAlphaA;
+            fStep0 = fAlphaB;
+            fStep1 = fAlphaA;
+            pSteps = pSteps8;
+        }
+
+        const auto fSteps = static_cast<float>(uSteps - 1);
+        const float fScale = (fStep0 != fStep1) ? (fSteps / (fStep1 - fStep0)) : 0.0f;
+
+        uint64_t bitmap = 0;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const float fDot = (pColorAlpha[i] - fStep0) * fScale;
+
+            uint64_t iStep;
+            if (fDot <= 0.0f)
+                iStep = ((6 == uSteps) && (pColorAlpha[i] <= fStep0 * 0.5f)) ? 6u : 0u;
+            else if (fDot >= fSteps)
+                iStep = ((6 == uSteps) && (pColorAlpha[i] >= (fStep1 + 1.0f) * 0.5f)) ? 7u : 1u;
+            else
+                iStep = pSteps[uint32_t(fDot + 0.5f)];
+
+            bitmap |= iStep << (3 * i);
+        }
+
+        for (size_t i = 0; i < 6; ++i)
+            pBC[2 + i] = static_cast<uint8_t>(bitmap >> (8 * i));
+    }
+
+    // Every BC3 alpha palette entry is a multiple of 1/(255*35), whichever of the 6 and 8 step
+    // palettes is used, so the decoded values are snapped back to that grid and the squared
+    // error is exact.  Ties then compare equal instead of depending on the float rounding.
+    constexpr float c_AlphaGrid = 255.f * 35.f;
+
+    uint32_t BC3AlphaError(const uint8_t* pAlphaBlock, const float* pAlpha) noexcept
+    {
+        uint8_t block[16] = {};
+        memcpy(block, pAlphaBlock, 8);
+
+        XMVECTOR decoded[NUM_PIXELS_PER_BLOCK];
+        D3DXDecodeBC3(decoded, block);
+
+        uint32_t error = 0;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const auto value = static_cast<int32_t>(XMVectorGetW(decoded[i]) * c_AlphaGrid + 0.5f);
+            const auto target = static_cast<int32_t>(pAlpha[i] * c_AlphaGrid + 0.5f);
+            error += static_cast<uint32_t>((value - target) * (value - target));
+        }
+        return error;
+    }
+}
+
+//-------------------------------------------------------------------------------------
+// Decodes the BC3 alpha blocks of the integer palette encoder and of the float step
+// encoder it replaced, the integer encoder must be at least as close on every block
+bool Test_BC3AlphaIntegerVsFloat()
+{
+    std::vector<float> alpha;
+
+    for (uint32_t seed = 1; seed <= 3; ++seed)
+    {
+        ScratchImage image;
+        TEST_CHECK_HR(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, c_ImageSize, c_ImageSize, 1, 1));
+        FillTestPattern(*image.GetImage(0, 0, 0), seed, true);
+
+        LoadChannelBlocks(*image.GetImage(0, 0, 0), 3, false, alpha);
+    }
+
+    // Random blocks with a narrow, a wide and a full range, with and without 0 and 255
+    Random rng(42);
+    for (size_t block = 0; block < 20000; ++block)
+    {
+        const uint32_t lo = rng.Next() % 256;
+        const uint32_t span = std::min(255u - lo, (block % 3 == 0) ? 8u : (block % 3 == 1) ? 64u : 255u);
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            alpha.push_back(float(lo + rng.Next() % (span + 1)) / 255.f);
+    }
+
+    const size_t blockCount = alpha.size() / NUM_PIXELS_PER_BLOCK;
+
+    double integerError = 0.;
+    double floatError = 0.;
+    size_t betterBlocks = 0;
+
+    for (size_t block = 0; block < blockCount; ++block)
+    {
+        const float* pAlpha = &alpha[block * NUM_PIXELS_PER_BLOCK];
+
+        XMVECTOR color[NUM_PIXELS_PER_BLOCK];
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            color[i] = XMVectorSet(0.5f, 0.5f, 0.5f, pAlpha[i]);
+
+        uint8_t encoded[16];
+        D3DXEncodeBC3(encoded, color, BC_FLAGS_NONE);
+
+        uint8_t reference[8];
+        EncodeBC3AlphaFloat(reference, pAlpha);
+
+        const uint32_t errorInteger = BC3AlphaError(encoded, pAlpha);
+        const uint32_t errorFloat = BC3AlphaError(reference, pAlpha);
+
+        TEST_CHECK(errorInteger <= errorFloat);
+
+        if (errorInteger < errorFloat)
+            ++betterBlocks;
+
+        integerError += errorInteger;
+        floatError += errorFloat;
+    }
+
+    const size_t texelCount = blockCount * NUM_PIXELS_PER_BLOCK;
+    const double scale = 1. / (double(c_AlphaGrid) * double(c_AlphaGrid));
+
+    integerError *= scale;
+    floatError *= scale;
+
+    printf("    %zu blocks: integer %.2f dB, float %.2f dB, %zu blocks improved\n",
+        blockCount, PSNR(integerError, texelCount), PSNR(floatError, texelCount), betterBlocks);
+
+    return true;
+}
+
+namespace
+{
+    // The error BC_FLAGS_YCOCG_METRIC minimizes: 3 Y^2 + Co^2 + 1.5 Cg^2 scaled by the
+    // source alpha, plus A^2, in 8-bit units
+    float YCoCgBlockError(const XMVECTOR* pOriginal, const XMVECTOR* pDecoded) noexcept
+    {
+        float error = 0.f;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            XMFLOAT4 original, decoded;
+            XMStoreFloat4(&original, XMVectorRound(XMVectorScale(pOriginal[i], 255.f)));
+            XMStoreFloat4(&decoded, XMVectorRound(XMVectorScale(pDecoded[i], 255.f)));
+
+            const float r = original.x - decoded.x;
+            const float g = original.y - decoded.y;
+            const float b = original.z - decoded.z;
+            const float a = original.w - decoded.w;
+
+            const float y4 = r + 2.f * g + b;
+            const float co2 = r - b;
+            const float cg4 = 2.f * g - r - b;
+            const float alphaScale = (original.w + 1.f) / 256.f;
+
+            error += (y4 * y4 * (6.f / 32.f) + co2 * co2 * (8.f / 32.f) + cg4 * cg4 * (3.f / 32.f)) * alphaScale + a * a;
+        }
+        return error;
+    }
+}
+
+//-------------------------------------------------------------------------------------
+// BC7 with the YCoCg metric against the uniform metric, measured in the YCoCg metric.
+// The metric is evaluated in float lanes, DirectXMath has no portable integer multiply.
+bool Test_BC7YCoCgMetric()
+{
+    constexpr size_t c_Size = 64;
+
+    ScratchImage image;
+    TEST_CHECK_HR(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, c_Size, c_Size, 1, 1));
+    FillTestPattern(*image.GetImage(0, 0, 0), 1, true);
+
+    const uint32_t flagSets[2] = { BC_FLAGS_NONE, BC_FLAGS_YCOCG_METRIC };
+    float error[2] = {};
+    double seconds[2] = {};
+
+    XMVECTOR color[NUM_PIXELS_PER_BLOCK];
+    XMVECTOR decoded[NUM_PIXELS_PER_BLOCK];
+    uint8_t block[16];
+
+    for (size_t mode = 0; mode < 2; ++mode)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (size_t by = 0; by < c_Size / 4; ++by)
+        {
+            for (size_t bx = 0; bx < c_Size / 4; ++bx)
+            {
+                LoadBlock(*image.GetImage(0, 0, 0), bx, by, color);
+                D3DXEncodeBC7(block, color, flagSets[mode]);
+                D3DXDecodeBC7(decoded, block);
+                error[mode] += YCoCgBlockError(color, decoded);
+            }
+        }
+
+        seconds[mode] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const size_t texelCount = c_Size * c_Size;
+
+    printf("    BC7 uniform metric: %.2f dB, %.1f ms\n", PSNR(double(error[0]) / (255. * 255.), texelCount), seconds[0] * 1000.);
+    printf("    BC7 YCoCg metric:   %.2f dB, %.1f ms\n", PSNR(double(error[1]) / (255. * 255.), texelCount), seconds[1] * 1000.);
+
+    TEST_CHECK(error[1] <= error[0]);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// The BC1-BC3 RGBA8 decoders match the float decoders followed by a R8G8B8A8_UNORM store,
+// random blocks cover both BC1 palette modes and both BC3 alpha palettes
+bool Test_DecodeRGBA8MatchesFloat()
+{
+    const struct
+    {
+        const char* name;
+        size_t blockSize;
+        DecodeFunc decode;
+        void (*decodeRGBA8)(uint32_t*, const uint8_t*);
+    } decoders[] =
+    {
+        { "BC1", 8, D3DXDecodeBC1, D3DXDecodeBC1RGBA8 },
+        { "BC2", 16, D3DXDecodeBC2, D3DXDecodeBC2RGBA8 },
+        { "BC3", 16, D3DXDecodeBC3, D3DXDecodeBC3RGBA8 },
+    };
+
+    Random rng(7);
+
+    for (const auto& decoder : decoders)
+    {
+        for (size_t block = 0; block < 10000; ++block)
+        {
+            uint8_t bc[16];
+            for (size_t i = 0; i < decoder.blockSize; ++i)
+                bc[i] = static_cast<uint8_t>(rng.Next() >> 24);
+
+            XMVECTOR decoded[NUM_PIXELS_PER_BLOCK];
+            decoder.decode(decoded, bc);
+
+            uint32_t texels[NUM_PIXELS_PER_BLOCK];
+            decoder.decodeRGBA8(texels, bc);
+
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                uint32_t expected;
+                XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(&expected), decoded[i]);
+
+                if (texels[i] != expected)
+                {
+                    printf("    %s block %zu texel %zu: %08X, expected %08X\n", decoder.name, block, i, texels[i], expected);
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
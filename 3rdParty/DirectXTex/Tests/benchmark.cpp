@@ -0,0 +1,168 @@
+//-------------------------------------------------------------------------------------
+// benchmark.cpp
+//
+// Benchmark for the PageAllocator policies: allocates a texture array, writes it from
+// the OpenMP workers and compresses it with TEX_COMPRESS_PARALLEL under each policy.
+//
+//   directxtexbench [width] [height] [items] [repeats]
+//
+// On a NUMA system compare the default run with one under 'numactl --interleave=all',
+// the first-touch policies should only win in the default run.  On Linux the huge page
+// column is the AnonHugePages total of the process after the image was written.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fstream>
+#include <string>
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    struct Policy
+    {
+        const char* name;
+        bool pooled;
+        TEX_ALLOC_FLAGS flags;
+    };
+
+    const Policy g_Policies[] =
+    {
+        { "heap", false, TEX_ALLOC_DEFAULT },
+        { "pages", true, TEX_ALLOC_DEFAULT },
+        { "pages+thp", true, TEX_ALLOC_TRANSPARENT_HUGE_PAGES },
+        { "pages+large", true, TEX_ALLOC_LARGE_PAGES },
+        { "first-touch", true, TEX_ALLOC_FIRST_TOUCH },
+        { "first-touch+thp", true, TEX_ALLOC_FIRST_TOUCH | TEX_ALLOC_TRANSPARENT_HUGE_PAGES },
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double Milliseconds(Clock::time_point start) noexcept
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Returns the AnonHugePages total in MB, or -1 where it is not reported
+    long HugePagesMB()
+    {
+#ifdef _WIN32
+        return -1;
+#else
+        std::ifstream smaps("/proc/self/smaps_rollup");
+        std::string line;
+        while (std::getline(smaps, line))
+        {
+            long value;
+            if (sscanf(line.c_str(), "AnonHugePages: %ld kB", &value) == 1)
+                return value / 1024;
+        }
+        return -1;
+#endif
+    }
+
+    // Each row is written by the worker that writes it in the parallel loop, which places
+    // first-touch pages on that worker's node
+    void FillImages(const ScratchImage& image) noexcept
+    {
+        for (size_t i = 0; i < image.GetImageCount(); ++i)
+        {
+            const Image& img = image.GetImages()[i];
+            const auto height = static_cast<ptrdiff_t>(img.height);
+
+        #ifdef _OPENMP
+            #pragma omp parallel for
+        #endif
+            for (ptrdiff_t y = 0; y < height; ++y)
+            {
+                auto row = reinterpret_cast<uint32_t*>(img.pixels + size_t(y) * img.rowPitch);
+                for (size_t x = 0; x < img.width; ++x)
+                {
+                    uint32_t hash = static_cast<uint32_t>((x * 73856093u) ^ (size_t(y) * 19349663u) ^ (i * 83492791u));
+                    hash ^= hash >> 13;
+                    row[x] = (hash * 0x9E3779B1u) | 0xFF000000u;
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t width = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 2048;
+    const size_t height = (argc > 2) ? strtoul(argv[2], nullptr, 10) : 2048;
+    const size_t items = (argc > 3) ? strtoul(argv[3], nullptr, 10) : 8;
+    const size_t repeats = (argc > 4) ? strtoul(argv[4], nullptr, 10) : 3;
+
+    if (!width || !height || !items || !repeats || (width % 4) || (height % 4))
+    {
+        printf("usage: directxtexbench [width] [height] [items] [repeats], sizes a multiple of 4\n");
+        return 1;
+    }
+
+    printf("%zux%zu R8G8B8A8 x %zu items (%zu MB) to BC1, best of %zu\n",
+        width, height, items, (width * height * 4 * items) >> 20, repeats);
+    printf("%-16s %10s %10s %10s %10s\n", "policy", "alloc ms", "write ms", "BC1 ms", "THP MB");
+
+    for (const auto& policy : g_Policies)
+    {
+        PageAllocator allocator(policy.flags);
+        IScratchImageAllocator* pAllocator = policy.pooled ? &allocator : nullptr;
+
+        double bestAlloc = 0, bestWrite = 0, bestCompress = 0;
+        long hugePages = -1;
+
+        for (size_t r = 0; r < repeats; ++r)
+        {
+            ScratchImage image(pAllocator);
+
+            auto start = Clock::now();
+            HRESULT hr = image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, items, 1);
+            const double alloc = Milliseconds(start);
+            if (FAILED(hr))
+            {
+                printf("%-16s Initialize2D failed (%08X)\n", policy.name, static_cast<unsigned int>(hr));
+                return 1;
+            }
+
+            start = Clock::now();
+            FillImages(image);
+            const double write = Milliseconds(start);
+
+            hugePages = HugePagesMB();
+
+            ScratchImage compressed(pAllocator);
+            start = Clock::now();
+            hr = Compress(image.GetImages(), image.GetImageCount(), image.GetMetadata(), DXGI_FORMAT_BC1_UNORM,
+                TEX_COMPRESS_PARALLEL, TEX_THRESHOLD_DEFAULT, compressed);
+            const double compress = Milliseconds(start);
+            if (FAILED(hr))
+            {
+                printf("%-16s Compress failed (%08X)\n", policy.name, static_cast<unsigned int>(hr));
+                return 1;
+            }
+
+            if (!r || alloc < bestAlloc)
+                bestAlloc = alloc;
+            if (!r || write < bestWrite)
+                bestWrite = write;
+            if (!r || compress < bestCompress)
+                bestCompress = compress;
+        }
+
+        printf("%-16s %10.1f %10.1f %10.1f %10ld\n", policy.name, bestAlloc, bestWrite, bestCompress, hugePages);
+    }
+
+    return 0;
+}
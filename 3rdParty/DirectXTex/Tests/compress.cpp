@@ -0,0 +1,279 @@
+//-------------------------------------------------------------------------------------
+// compress.cpp
+//
+// Tests for the CompressEx options and DecompressRegion
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+
+#include <vector>
+
+using namespace DirectX;
+using namespace TestHelpers;
+
+namespace
+{
+    constexpr size_t c_ImageSize = 64;
+    constexpr float c_TargetError = 2e-4f;
+
+    HRESULT CompressTestPattern(
+        DXGI_FORMAT format,
+        const CompressOptions& options,
+        ScratchImage& result,
+        ScratchImage* errorMap,
+        std::function<bool __cdecl(size_t, size_t)> statusCallback = nullptr)
+    {
+        ScratchImage image;
+        HRESULT hr = image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, c_ImageSize, c_ImageSize, 1, 1);
+        if (FAILED(hr))
+            return hr;
+
+        FillTestPattern(*image.GetImage(0, 0, 0), 1, true);
+
+        return CompressEx(*image.GetImage(0, 0, 0), format, options, result, statusCallback, nullptr, errorMap);
+    }
+
+    CompressOptions DefaultOptions() noexcept
+    {
+        CompressOptions options = {};
+        options.flags = TEX_COMPRESS_DEFAULT;
+        options.threshold = TEX_THRESHOLD_DEFAULT;
+        options.alphaWeight = TEX_ALPHA_WEIGHT_DEFAULT;
+        return options;
+    }
+
+    float BlockError(const ScratchImage& errorMap, size_t block) noexcept
+    {
+        return reinterpret_cast<const XMFLOAT4*>(errorMap.GetPixels())[block].x;
+    }
+}
+
+//-------------------------------------------------------------------------------------
+// A target error stops the BC7 mode search early, so it must change the output, and a
+// block may only miss the target when the full search misses it as well
+bool Test_TargetErrorChangesOutput()
+{
+    CompressOptions options = DefaultOptions();
+
+    ScratchImage full;
+    ScratchImage fullErrors;
+    TEST_CHECK_HR(CompressTestPattern(DXGI_FORMAT_BC7_UNORM, options, full, &fullErrors));
+
+    options.targetError = c_TargetError;
+
+    ScratchImage target;
+    ScratchImage targetErrors;
+    TEST_CHECK_HR(CompressTestPattern(DXGI_FORMAT_BC7_UNORM, options, target, &targetErrors));
+
+    TEST_CHECK(full.GetPixelsSize() == target.GetPixelsSize());
+    TEST_CHECK(memcmp(full.GetPixels(), target.GetPixels(), full.GetPixelsSize()) != 0);
+
+    const size_t blockCount = (c_ImageSize / 4) * (c_ImageSize / 4);
+    size_t changedBlocks = 0;
+
+    for (size_t block = 0; block < blockCount; ++block)
+    {
+        const float error = BlockError(targetErrors, block);
+        const float fullError = BlockError(fullErrors, block);
+
+        if (error > c_TargetError)
+        {
+            TEST_CHECK(fullError > c_TargetError);
+        }
+
+        if (memcmp(full.GetPixels() + block * 16, target.GetPixels() + block * 16, 16) != 0)
+            ++changedBlocks;
+    }
+
+    printf("    %zu of %zu blocks changed\n", changedBlocks, blockCount);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// The quick first pass followed by the full search of the worst blocks: only the refined
+// blocks change, and refining every block is at least as good as the full search alone
+bool Test_RefineFraction()
+{
+    const size_t blockCount = (c_ImageSize / 4) * (c_ImageSize / 4);
+
+    CompressOptions options = DefaultOptions();
+
+    ScratchImage full;
+    ScratchImage fullErrors;
+    TEST_CHECK_HR(CompressTestPattern(DXGI_FORMAT_BC7_UNORM, options, full, &fullErrors));
+
+    options.flags = TEX_COMPRESS_BC7_QUICK;
+
+    ScratchImage quick;
+    ScratchImage quickErrors;
+    TEST_CHECK_HR(CompressTestPattern(DXGI_FORMAT_BC7_UNORM, options, quick, &quickErrors));
+
+    for (float fraction : { 0.25f, 1.0f })
+    {
+        options.flags = TEX_COMPRESS_DEFAULT;
+        options.refineFraction = fraction;
+
+        ScratchImage refined;
+        ScratchImage refinedErrors;
+        TEST_CHECK_HR(CompressTestPattern(DXGI_FORMAT_BC7_UNORM, options, refined, &refinedErrors));
+
+        size_t changedBlocks = 0;
+        double quickTotal = 0.;
+        double refinedTotal = 0.;
+
+        for (size_t block = 0; block < blockCount; ++block)
+        {
+            const float error = BlockError(refinedErrors, block);
+
+            TEST_CHECK(error <= BlockError(quickErrors, block));
+
+            if (fraction >= 1.0f)
+            {
+                TEST_CHECK(error <= BlockError(fullErrors, block));
+            }
+
+            if (memcmp(quick.GetPixels() + block * 16, refined.GetPixels() + block * 16, 16) != 0)
+                ++changedBlocks;
+
+            quickTotal += BlockError(quickErrors, block);
+            refinedTotal += error;
+        }
+
+        printf("    refineFraction %.2f: %zu of %zu blocks changed, mean error %g quick, %g refined\n",
+            double(fraction), changedBlocks, blockCount, quickTotal / double(blockCount), refinedTotal / double(blockCount));
+
+        TEST_CHECK(changedBlocks <= static_cast<size_t>(double(fraction) * double(blockCount) + 0.5));
+        TEST_CHECK(changedBlocks > 0);
+    }
+
+    // Without a fraction the image is encoded in a single pass
+    options.refineFraction = 0.f;
+
+    ScratchImage single;
+    TEST_CHECK_HR(CompressTestPattern(DXGI_FORMAT_BC7_UNORM, options, single, nullptr));
+    TEST_CHECK(memcmp(full.GetPixels(), single.GetPixels(), full.GetPixelsSize()) == 0);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// The refine pass reports the second half of the progress and stops when asked to
+bool Test_RefineProgressAndAbort()
+{
+    for (auto flags : { TEX_COMPRESS_DEFAULT, TEX_COMPRESS_PARALLEL })
+    {
+        CompressOptions options = DefaultOptions();
+        options.flags = flags;
+        options.refineFraction = 0.5f;
+
+        std::vector<double> reports;
+        auto record = [&reports](size_t done, size_t total) -> bool
+        {
+            reports.push_back(double(done) / double(total));
+            return true;
+        };
+
+        ScratchImage result;
+        TEST_CHECK_HR(CompressTestPattern(DXGI_FORMAT_BC7_UNORM, options, result, nullptr, record));
+
+        size_t refineReports = 0;
+        for (size_t i = 0; i < reports.size(); ++i)
+        {
+            TEST_CHECK(reports[i] >= 0. && reports[i] <= 1.);
+
+            // The parallel loops may report rows a little out of order
+            if (flags == TEX_COMPRESS_DEFAULT && i > 0)
+            {
+                TEST_CHECK(reports[i] >= reports[i - 1]);
+            }
+
+            if (reports[i] > 0.5 && reports[i] < 1.)
+                ++refineReports;
+        }
+
+        TEST_CHECK(refineReports > 0);
+        TEST_CHECK(reports.back() == 1.);
+
+        // Stopping in the refine pass fails the call
+        size_t calls = 0;
+        auto stop = [&calls](size_t done, size_t total) -> bool
+        {
+            ++calls;
+            return (done * 2 <= total);
+        };
+
+        HRESULT hr = CompressTestPattern(DXGI_FORMAT_BC7_UNORM, options, result, nullptr, stop);
+        TEST_CHECK(hr == E_ABORT);
+        TEST_CHECK(result.GetPixels() == nullptr);
+
+        printf("    %s: %zu progress reports, %zu from the refine pass, stopped after %zu\n",
+            (flags == TEX_COMPRESS_DEFAULT) ? "serial" : "parallel", reports.size(), refineReports, calls);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// DecompressRegion gives the same pixels as decompressing the whole image and cropping it,
+// for block aligned and unaligned rectangles and for the partial blocks at the edges of an
+// image whose size is not a multiple of 4
+bool Test_DecompressRegionMatchesDecompress()
+{
+    constexpr size_t c_Width = 70;
+    constexpr size_t c_Height = 38;
+
+    ScratchImage image;
+    TEST_CHECK_HR(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, c_Width, c_Height, 1, 1));
+    FillTestPattern(*image.GetImage(0, 0, 0), 5, true);
+
+    const Rect rects[] =
+    {
+        Rect(4, 8, 16, 12),             // Aligned
+        Rect(5, 3, 9, 7),               // Unaligned on every side
+        Rect(6, 6, 1, 1),               // Inside a single block
+        Rect(2, 0, 3, 38),              // Full height, inside one block column
+        Rect(64, 0, 6, 38),             // The partial column of blocks on the right
+        Rect(65, 33, 5, 5),             // Unaligned, ending in the partial corner block
+        Rect(68, 36, 2, 2),             // Only the partial corner block
+        Rect(0, 0, c_Width, c_Height),  // The whole image
+    };
+
+    for (auto bcFormat : { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM })
+    {
+        ScratchImage compressed;
+        TEST_CHECK_HR(Compress(*image.GetImage(0, 0, 0), bcFormat, TEX_COMPRESS_DEFAULT, TEX_THRESHOLD_DEFAULT, compressed));
+        const Image& cImage = *compressed.GetImage(0, 0, 0);
+
+        for (auto format : { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R32G32B32A32_FLOAT })
+        {
+            ScratchImage full;
+            TEST_CHECK_HR(Decompress(cImage, format, full));
+
+            for (const auto& rect : rects)
+            {
+                ScratchImage region;
+                TEST_CHECK_HR(DecompressRegion(cImage, rect, format, region));
+
+                if (!MatchesRectangle(*full.GetImage(0, 0, 0), rect, *region.GetImage(0, 0, 0)))
+                {
+                    printf("    format %d to %d, rect %zu,%zu %zux%zu differs\n",
+                        int(bcFormat), int(format), rect.x, rect.y, rect.w, rect.h);
+                    return false;
+                }
+            }
+        }
+
+        // Rectangles that are empty or reach outside the image
+        ScratchImage region;
+        TEST_CHECK(DecompressRegion(cImage, Rect(0, 0, 0, 4), DXGI_FORMAT_R8G8B8A8_UNORM, region) == E_INVALIDARG);
+        TEST_CHECK(DecompressRegion(cImage, Rect(c_Width, 0, 1, 1), DXGI_FORMAT_R8G8B8A8_UNORM, region) == E_INVALIDARG);
+        TEST_CHECK(DecompressRegion(cImage, Rect(68, 0, 3, 4), DXGI_FORMAT_R8G8B8A8_UNORM, region) == E_INVALIDARG);
+        TEST_CHECK(DecompressRegion(cImage, Rect(0, 36, 4, SIZE_MAX), DXGI_FORMAT_R8G8B8A8_UNORM, region) == E_INVALIDARG);
+    }
+
+    return true;
+}
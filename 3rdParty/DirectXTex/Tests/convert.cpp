@@ -0,0 +1,110 @@
+//-------------------------------------------------------------------------------------
+// convert.cpp
+//
+// Tests for ConvertInPlace
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+
+#include <cstdlib>
+
+using namespace DirectX;
+
+namespace
+{
+    void FillPattern(const ScratchImage& image)
+    {
+        const uint8_t* end = image.GetPixels() + image.GetPixelsSize();
+        uint32_t seed = 0x12345678;
+        for (uint8_t* ptr = image.GetPixels(); ptr < end; ++ptr)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            *ptr = static_cast<uint8_t>(seed >> 24);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------
+// Same sized formats give the same result as Convert
+bool Test_ConvertInPlaceMatchesConvert()
+{
+    const DXGI_FORMAT formats[] =
+    {
+        DXGI_FORMAT_B8G8R8A8_UNORM,
+        DXGI_FORMAT_B8G8R8X8_UNORM,
+        DXGI_FORMAT_R10G10B10A2_UNORM,
+        DXGI_FORMAT_R8G8B8A8_UINT,
+    };
+
+    for (auto format : formats)
+    {
+        ScratchImage source;
+        TEST_CHECK_HR(source.Initialize2D(format, 37, 19, 2, 1));
+        FillPattern(source);
+
+        ScratchImage expected;
+        TEST_CHECK_HR(Convert(source.GetImages(), source.GetImageCount(), source.GetMetadata(),
+            DXGI_FORMAT_R8G8B8A8_UNORM, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, expected));
+
+        TEST_CHECK_HR(ConvertInPlace(source, DXGI_FORMAT_R8G8B8A8_UNORM, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT));
+        TEST_CHECK(source.GetMetadata().format == DXGI_FORMAT_R8G8B8A8_UNORM);
+        TEST_CHECK(source.GetImageCount() == expected.GetImageCount());
+
+        for (size_t index = 0; index < source.GetImageCount(); ++index)
+        {
+            const Image& a = source.GetImages()[index];
+            const Image& b = expected.GetImages()[index];
+            for (size_t y = 0; y < a.height; ++y)
+            {
+                // Convert goes through float, so allow it to round the other way
+                const uint8_t* pA = a.pixels + y * a.rowPitch;
+                const uint8_t* pB = b.pixels + y * b.rowPitch;
+                for (size_t x = 0; x < a.width * 4; ++x)
+                {
+                    TEST_CHECK(abs(int(pA[x]) - int(pB[x])) <= 1);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// Packed and video formats share their bits per pixel with RGBA formats but not the layout
+bool Test_ConvertInPlaceRejectsPacked()
+{
+    const struct
+    {
+        DXGI_FORMAT source;
+        DXGI_FORMAT target;
+    } cases[] =
+    {
+        { DXGI_FORMAT_R8G8_B8G8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM },
+        { DXGI_FORMAT_G8R8_G8B8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM },
+        { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8_B8G8_UNORM },
+        { DXGI_FORMAT_YUY2, DXGI_FORMAT_R8G8B8A8_UNORM },
+        { DXGI_FORMAT_Y210, DXGI_FORMAT_R16G16B16A16_UNORM },
+        { DXGI_FORMAT_Y216, DXGI_FORMAT_R16G16B16A16_UNORM },
+        { DXGI_FORMAT_AYUV, DXGI_FORMAT_R8G8B8A8_UNORM },
+    };
+
+    for (const auto& test : cases)
+    {
+        ScratchImage image;
+        TEST_CHECK_HR(image.Initialize2D(test.source, 16, 16, 1, 1));
+        FillPattern(image);
+
+        const HRESULT hr = ConvertInPlace(image, test.target, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT);
+        TEST_CHECK(hr == HRESULT_E_NOT_SUPPORTED);
+
+        // The image is left alone
+        TEST_CHECK(image.GetPixels() != nullptr);
+        TEST_CHECK(image.GetMetadata().format == test.source);
+    }
+
+    return true;
+}
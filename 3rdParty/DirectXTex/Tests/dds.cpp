@@ -0,0 +1,402 @@
+//-------------------------------------------------------------------------------------
+// dds.cpp
+//
+// Tests for loading DDS files and regions of them through ImageIOCallbacks
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+#include "DDS.h"
+
+using namespace DirectX;
+using namespace TestHelpers;
+
+namespace
+{
+    // A legacy 24bpp RGB file, which is expanded while it is read
+    std::vector<uint8_t> CreateRGB24File(size_t width, size_t height)
+    {
+        DDS_HEADER header = {};
+        header.size = sizeof(DDS_HEADER);
+        header.flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_PITCH;
+        header.height = static_cast<uint32_t>(height);
+        header.width = static_cast<uint32_t>(width);
+        header.pitchOrLinearSize = static_cast<uint32_t>(width * 3);
+        header.ddspf = DDSPF_R8G8B8;
+        header.caps = DDS_SURFACE_FLAGS_TEXTURE;
+
+        std::vector<uint8_t> file(DDS_MIN_HEADER_SIZE + width * height * 3);
+        memcpy(file.data(), &DDS_MAGIC, sizeof(uint32_t));
+        memcpy(file.data() + sizeof(uint32_t), &header, sizeof(DDS_HEADER));
+
+        Random rng(11);
+        for (size_t i = DDS_MIN_HEADER_SIZE; i < file.size(); ++i)
+            file[i] = static_cast<uint8_t>(rng.Next() >> 24);
+
+        return file;
+    }
+
+    // A BC1 file whose size is not a multiple of the block size
+    HRESULT CreateBC1File(size_t width, size_t height, DDS_FLAGS flags, std::vector<uint8_t>& file)
+    {
+        ScratchImage image;
+        HRESULT hr = image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1);
+        if (FAILED(hr))
+            return hr;
+
+        FillTestPattern(*image.GetImage(0, 0, 0), 3, false);
+
+        ScratchImage compressed;
+        hr = Compress(*image.GetImage(0, 0, 0), DXGI_FORMAT_BC1_UNORM, TEX_COMPRESS_DEFAULT, TEX_THRESHOLD_DEFAULT, compressed);
+        if (FAILED(hr))
+            return hr;
+
+        Blob blob;
+        hr = SaveToDDSMemory(*compressed.GetImage(0, 0, 0), flags, blob);
+        if (FAILED(hr))
+            return hr;
+
+        file.assign(blob.GetBufferPointer(), blob.GetBufferPointer() + blob.GetBufferSize());
+        return S_OK;
+    }
+
+    // Fills every image with its own marker byte so a loaded image shows where it came from
+    uint8_t Marker(size_t item, size_t level, size_t slice) noexcept
+    {
+        return static_cast<uint8_t>(1 + item * 64 + level * 8 + slice);
+    }
+
+    HRESULT SaveMarkedFile(ScratchImage& image, DDS_FLAGS flags, std::vector<uint8_t>& file)
+    {
+        const TexMetadata& metadata = image.GetMetadata();
+
+        for (size_t item = 0; item < metadata.arraySize; ++item)
+        {
+            size_t depth = metadata.depth;
+            for (size_t level = 0; level < metadata.mipLevels; ++level)
+            {
+                for (size_t slice = 0; slice < depth; ++slice)
+                {
+                    const Image* img = image.GetImage(level, item, slice);
+                    if (!img)
+                        return E_POINTER;
+
+                    memset(img->pixels, Marker(item, level, slice), img->slicePitch);
+                }
+
+                if (depth > 1)
+                    depth >>= 1;
+            }
+        }
+
+        Blob blob;
+        HRESULT hr = SaveToDDSMemory(image.GetImages(), image.GetImageCount(), metadata, flags, blob);
+        if (FAILED(hr))
+            return hr;
+
+        file.assign(blob.GetBufferPointer(), blob.GetBufferPointer() + blob.GetBufferSize());
+        return S_OK;
+    }
+
+    // Loads a preview and checks its size, that it holds marker and that it was read with
+    // the header and nothing else
+    bool CheckPreview(
+        const std::vector<uint8_t>& file,
+        DDS_FLAGS flags,
+        size_t minWidth,
+        size_t minHeight,
+        size_t width,
+        size_t height,
+        uint8_t marker)
+    {
+        MemoryStream stream(file);
+
+        ScratchImage image;
+        TexMetadata metadata;
+        TEST_CHECK_HR(LoadPreviewFromDDSIOCallbacks(stream.GetCallbacks(), flags, minWidth, minHeight, &metadata, nullptr, image));
+
+        if (metadata.width != width || metadata.height != height)
+        {
+            printf("    preview of %zux%zu is %zux%zu, expected %zux%zu\n",
+                minWidth, minHeight, metadata.width, metadata.height, width, height);
+            return false;
+        }
+
+        TEST_CHECK(metadata.depth == 1 && metadata.arraySize == 1 && metadata.mipLevels == 1);
+        TEST_CHECK(!metadata.IsCubemap());
+        TEST_CHECK(image.GetImageCount() == 1);
+
+        const Image* img = image.GetImage(0, 0, 0);
+        for (size_t i = 0; i < img->slicePitch; ++i)
+        {
+            if (img->pixels[i] != marker)
+            {
+                printf("    preview of %zux%zu holds %u, expected %u\n",
+                    minWidth, minHeight, unsigned(img->pixels[i]), unsigned(marker));
+                return false;
+            }
+        }
+
+        TEST_CHECK(stream.GetBytesRead() == DDS_DX10_HEADER_SIZE + img->slicePitch);
+
+        return true;
+    }
+}
+
+//-------------------------------------------------------------------------------------
+// The image data of large files is read on a background thread.  A read that fails there
+// must fail the load with the error of the callback, and the callbacks are never called
+// concurrently.
+bool Test_ReadAheadFailureSurfaces()
+{
+    constexpr size_t c_Width = 2048;
+    constexpr size_t c_Height = 1024;
+
+    const std::vector<uint8_t> file = CreateRGB24File(c_Width, c_Height);
+
+    {
+        MemoryStream stream(file);
+
+        ScratchImage image;
+        TexMetadata metadata;
+        TEST_CHECK_HR(LoadFromDDSIOCallbacks(stream.GetCallbacks(), DDS_FLAGS_NONE, &metadata, nullptr, image));
+        TEST_CHECK(metadata.format == DXGI_FORMAT_R8G8B8A8_UNORM);
+        TEST_CHECK(!stream.WasCalledConcurrently());
+
+        // The file stores B, G, R
+        const Image* img = image.GetImage(0, 0, 0);
+        for (size_t y = 0; y < c_Height; y += 97)
+        {
+            const uint8_t* src = file.data() + DDS_MIN_HEADER_SIZE + y * c_Width * 3;
+            const uint8_t* dest = img->pixels + y * img->rowPitch;
+            for (size_t x = 0; x < c_Width; x += 13)
+            {
+                TEST_CHECK(dest[x * 4] == src[x * 3 + 2]);
+                TEST_CHECK(dest[x * 4 + 1] == src[x * 3 + 1]);
+                TEST_CHECK(dest[x * 4 + 2] == src[x * 3]);
+                TEST_CHECK(dest[x * 4 + 3] == 0xFF);
+            }
+        }
+    }
+
+    // The image data is read in 4 MB chunks, fail in the first chunk and in the middle and at
+    // the end of the second one
+    const HRESULT failure = E_ACCESSDENIED;
+
+    for (size_t failOffset : { DDS_MIN_HEADER_SIZE + 1000, DDS_MIN_HEADER_SIZE + 5 * 1024 * 1024, file.size() - 1 })
+    {
+        MemoryStream stream(file);
+        stream.FailReadsAt(failOffset, failure);
+
+        ScratchImage image;
+        const HRESULT hr = LoadFromDDSIOCallbacks(stream.GetCallbacks(), DDS_FLAGS_NONE, nullptr, nullptr, image);
+
+        if (hr != failure)
+        {
+            printf("    failing at %zu returned %08X\n", failOffset, static_cast<unsigned int>(hr));
+            return false;
+        }
+
+        TEST_CHECK(image.GetPixels() == nullptr);
+        TEST_CHECK(!stream.WasCalledConcurrently());
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// A region is read from the rows of blocks it covers and nothing else, with or without
+// the DX10 header, and decodes to the same pixels as the whole image
+bool Test_LoadRegionReadsOnlyCoveredRows()
+{
+    constexpr size_t c_Width = 70;
+    constexpr size_t c_Height = 38;
+    constexpr size_t c_RowPitch = ((c_Width + 3) / 4) * 8;
+
+    const Rect rects[] =
+    {
+        Rect(5, 3, 9, 7),
+        Rect(8, 12, 16, 8),
+        Rect(65, 33, 5, 5),
+        Rect(0, 36, c_Width, 2),
+        Rect(0, 0, c_Width, c_Height),
+    };
+
+    for (auto flags : { DDS_FLAGS_NONE, DDS_FLAGS_FORCE_DX10_EXT })
+    {
+        std::vector<uint8_t> file;
+        TEST_CHECK_HR(CreateBC1File(c_Width, c_Height, flags, file));
+
+        const size_t dataOffset = (flags & DDS_FLAGS_FORCE_DX10_EXT) ? DDS_DX10_HEADER_SIZE : DDS_MIN_HEADER_SIZE;
+        TEST_CHECK(file.size() == dataOffset + c_RowPitch * ((c_Height + 3) / 4));
+
+        ScratchImage full;
+        {
+            MemoryStream stream(file);
+            TEST_CHECK_HR(LoadFromDDSIOCallbacks(stream.GetCallbacks(), DDS_FLAGS_NONE, nullptr, nullptr, full));
+        }
+
+        for (const auto& rect : rects)
+        {
+            ScratchImage expected;
+            TEST_CHECK_HR(DecompressRegion(*full.GetImage(0, 0, 0), rect, DXGI_FORMAT_R8G8B8A8_UNORM, expected));
+
+            MemoryStream stream(file);
+
+            ScratchImage region;
+            TexMetadata metadata;
+            TEST_CHECK_HR(LoadRegionFromDDSIOCallbacks(stream.GetCallbacks(), DDS_FLAGS_NONE, rect,
+                DXGI_FORMAT_R8G8B8A8_UNORM, &metadata, region));
+
+            TEST_CHECK(metadata.width == c_Width && metadata.height == c_Height);
+            TEST_CHECK(metadata.format == DXGI_FORMAT_BC1_UNORM);
+            TEST_CHECK(MatchesRectangle(*expected.GetImage(0, 0, 0), Rect(0, 0, rect.w, rect.h), *region.GetImage(0, 0, 0)));
+
+            // The header is read once, then only the rows of blocks under the rectangle
+            const size_t blockRows = (rect.y + rect.h + 3) / 4 - rect.y / 4;
+            TEST_CHECK(stream.GetBytesRead() == DDS_DX10_HEADER_SIZE + blockRows * c_RowPitch);
+        }
+
+        // A failed read of the block rows is returned unchanged
+        {
+            MemoryStream stream(file);
+            stream.FailReadsAt(dataOffset + 2 * c_RowPitch, E_ACCESSDENIED);
+
+            ScratchImage region;
+            TEST_CHECK(LoadRegionFromDDSIOCallbacks(stream.GetCallbacks(), DDS_FLAGS_NONE, Rect(0, 4, 8, 8),
+                DXGI_FORMAT_R8G8B8A8_UNORM, nullptr, region) == E_ACCESSDENIED);
+            TEST_CHECK(region.GetPixels() == nullptr);
+        }
+
+        // The rows under the rectangle must be in the file
+        {
+            std::vector<uint8_t> truncated(file.begin(), file.end() - c_RowPitch);
+            MemoryStream stream(truncated);
+
+            ScratchImage region;
+            TEST_CHECK(LoadRegionFromDDSIOCallbacks(stream.GetCallbacks(), DDS_FLAGS_NONE, Rect(0, 36, 4, 2),
+                DXGI_FORMAT_R8G8B8A8_UNORM, nullptr, region) == HRESULT_E_HANDLE_EOF);
+        }
+    }
+
+    // Uncompressed files are not read by region
+    {
+        MemoryStream stream(CreateRGB24File(16, 16));
+
+        ScratchImage region;
+        TEST_CHECK(LoadRegionFromDDSIOCallbacks(stream.GetCallbacks(), DDS_FLAGS_NONE, Rect(0, 0, 4, 4),
+            DXGI_FORMAT_R8G8B8A8_UNORM, nullptr, region) == HRESULT_E_NOT_SUPPORTED);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// A preview reads the smallest stored level that is at least the requested size, and
+// only that level, also when the whole buffer is copied for the legacy DWORD layout
+bool Test_PreviewLevelChoice()
+{
+    ScratchImage image;
+    TEST_CHECK_HR(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 64, 32, 1, 0));
+    TEST_CHECK(image.GetMetadata().mipLevels == 7);
+
+    std::vector<uint8_t> file;
+    TEST_CHECK_HR(SaveMarkedFile(image, DDS_FLAGS_NONE, file));
+
+    for (auto flags : { DDS_FLAGS_NONE, DDS_FLAGS_LEGACY_DWORD })
+    {
+        TEST_CHECK(CheckPreview(file, flags, 64, 32, 64, 32, Marker(0, 0, 0)));
+        TEST_CHECK(CheckPreview(file, flags, 33, 1, 64, 32, Marker(0, 0, 0)));
+        TEST_CHECK(CheckPreview(file, flags, 32, 16, 32, 16, Marker(0, 1, 0)));
+        TEST_CHECK(CheckPreview(file, flags, 20, 10, 32, 16, Marker(0, 1, 0)));
+        TEST_CHECK(CheckPreview(file, flags, 16, 1, 16, 8, Marker(0, 2, 0)));
+        TEST_CHECK(CheckPreview(file, flags, 2, 1, 2, 1, Marker(0, 5, 0)));
+        TEST_CHECK(CheckPreview(file, flags, 0, 0, 1, 1, Marker(0, 6, 0)));
+
+        // Nothing is large enough, so the top-level image is used
+        TEST_CHECK(CheckPreview(file, flags, 128, 128, 64, 32, Marker(0, 0, 0)));
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// The levels of the first item are skipped over for arrays and cubemaps, and volume
+// levels are skipped with all of their slices
+bool Test_PreviewSkipsArraysAndVolumes()
+{
+    {
+        ScratchImage image;
+        TEST_CHECK_HR(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 32, 16, 3, 0));
+
+        std::vector<uint8_t> file;
+        TEST_CHECK_HR(SaveMarkedFile(image, DDS_FLAGS_NONE, file));
+
+        TEST_CHECK(CheckPreview(file, DDS_FLAGS_NONE, 32, 16, 32, 16, Marker(0, 0, 0)));
+        TEST_CHECK(CheckPreview(file, DDS_FLAGS_NONE, 8, 4, 8, 4, Marker(0, 2, 0)));
+        TEST_CHECK(CheckPreview(file, DDS_FLAGS_NONE, 0, 0, 1, 1, Marker(0, 5, 0)));
+    }
+
+    {
+        ScratchImage image;
+        TEST_CHECK_HR(image.InitializeCube(DXGI_FORMAT_R8G8B8A8_UNORM, 16, 16, 1, 0));
+
+        std::vector<uint8_t> file;
+        TEST_CHECK_HR(SaveMarkedFile(image, DDS_FLAGS_NONE, file));
+
+        TEST_CHECK(CheckPreview(file, DDS_FLAGS_NONE, 16, 16, 16, 16, Marker(0, 0, 0)));
+        TEST_CHECK(CheckPreview(file, DDS_FLAGS_NONE, 4, 4, 4, 4, Marker(0, 2, 0)));
+    }
+
+    {
+        // 32x16x8, 16x8x4, 8x4x2, 4x2x1, 2x1x1, 1x1x1
+        ScratchImage image;
+        TEST_CHECK_HR(image.Initialize3D(DXGI_FORMAT_R8G8B8A8_UNORM, 32, 16, 8, 0));
+        TEST_CHECK(image.GetMetadata().mipLevels == 6);
+
+        std::vector<uint8_t> file;
+        TEST_CHECK_HR(SaveMarkedFile(image, DDS_FLAGS_NONE, file));
+
+        TEST_CHECK(CheckPreview(file, DDS_FLAGS_NONE, 32, 16, 32, 16, Marker(0, 0, 0)));
+        TEST_CHECK(CheckPreview(file, DDS_FLAGS_NONE, 16, 8, 16, 8, Marker(0, 1, 0)));
+        TEST_CHECK(CheckPreview(file, DDS_FLAGS_NONE, 8, 4, 8, 4, Marker(0, 2, 0)));
+        TEST_CHECK(CheckPreview(file, DDS_FLAGS_NONE, 0, 0, 1, 1, Marker(0, 5, 0)));
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// A header that claims more levels than the file holds falls back to the top-level image
+bool Test_PreviewMipCountMismatch()
+{
+    ScratchImage image;
+    TEST_CHECK_HR(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 64, 32, 1, 0));
+
+    std::vector<uint8_t> file;
+    TEST_CHECK_HR(SaveMarkedFile(image, DDS_FLAGS_NONE, file));
+
+    const size_t level0Size = 64 * 32 * 4;
+    const size_t level1Size = 32 * 16 * 4;
+    TEST_CHECK(file.size() > DDS_MIN_HEADER_SIZE + level0Size + level1Size);
+
+    for (auto flags : { DDS_FLAGS_NONE, DDS_FLAGS_LEGACY_DWORD })
+    {
+        // Only the top-level image is stored
+        std::vector<uint8_t> truncated(file.begin(), file.begin() + DDS_MIN_HEADER_SIZE + level0Size);
+        TEST_CHECK(CheckPreview(truncated, flags, 0, 0, 64, 32, Marker(0, 0, 0)));
+        TEST_CHECK(CheckPreview(truncated, flags, 32, 16, 64, 32, Marker(0, 0, 0)));
+
+        // The selected level is cut short
+        truncated.assign(file.begin(), file.begin() + DDS_MIN_HEADER_SIZE + level0Size + level1Size - 1);
+        TEST_CHECK(CheckPreview(truncated, flags, 32, 16, 64, 32, Marker(0, 0, 0)));
+
+        // The selected level is complete, the smaller ones are missing
+        truncated.assign(file.begin(), file.begin() + DDS_MIN_HEADER_SIZE + level0Size + level1Size);
+        TEST_CHECK(CheckPreview(truncated, flags, 32, 16, 32, 16, Marker(0, 1, 0)));
+    }
+
+    return true;
+}
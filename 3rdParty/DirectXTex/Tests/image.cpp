@@ -0,0 +1,195 @@
+//-------------------------------------------------------------------------------------
+// image.cpp
+//
+// Tests for the ScratchImage allocator and the scanline cache
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include "TestHelpers.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // Tracks every block it hands out so the tests can check who frees what
+    class CountingAllocator final : public IScratchImageAllocator
+    {
+    public:
+        CountingAllocator() noexcept : allocations(0), frees(0), liveBytes(0) {}
+
+        void* __cdecl Allocate(size_t size, size_t alignment) noexcept override
+        {
+            // Scanline blocks are 16 byte aligned, which is all ScratchImage asks for
+            if (alignment > 16)
+                return nullptr;
+
+            void* ptr = ScanlineArena::Allocate(size);
+            if (!ptr)
+                return nullptr;
+
+            ++allocations;
+            liveBytes += size;
+            return ptr;
+        }
+
+        void __cdecl Free(void* ptr, size_t size) noexcept override
+        {
+            if (!ptr)
+                return;
+
+            ++frees;
+            liveBytes -= size;
+            ScanlineArena::Free(ptr);
+        }
+
+        size_t allocations;
+        size_t frees;
+        size_t liveBytes;
+    };
+}
+
+//-------------------------------------------------------------------------------------
+// Moving an image without an allocator into a pooled image must not turn pooling off
+bool Test_AllocatorKeptAcrossMove()
+{
+    CountingAllocator allocator;
+
+    {
+        ScratchImage image(&allocator);
+        TEST_CHECK_HR(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 64, 64, 1, 1));
+        TEST_CHECK(allocator.allocations == 1);
+
+        ScratchImage temp;
+        TEST_CHECK_HR(temp.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 32, 32, 1, 1));
+
+        image = std::move(temp);
+        TEST_CHECK(image.GetAllocator() == &allocator);
+        TEST_CHECK(allocator.frees == 1);
+        TEST_CHECK(image.GetMetadata().width == 32);
+
+        // The next allocation uses the pool again
+        TEST_CHECK_HR(image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 16, 16, 1, 1));
+        TEST_CHECK(allocator.allocations == 2);
+
+        // A move constructed image takes the allocator of its source
+        ScratchImage moved(std::move(image));
+        TEST_CHECK(moved.GetAllocator() == &allocator);
+    }
+
+    TEST_CHECK(allocator.allocations == allocator.frees);
+    TEST_CHECK(allocator.liveBytes == 0);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// Pooled memory moved into an image without an allocator goes back to the pool
+bool Test_MovedMemoryFreedByOwner()
+{
+    CountingAllocator allocator1;
+    CountingAllocator allocator2;
+
+    {
+        ScratchImage pooled(&allocator1);
+        TEST_CHECK_HR(pooled.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 64, 64, 1, 1));
+
+        ScratchImage plain;
+        plain = std::move(pooled);
+        TEST_CHECK(plain.GetAllocator() == &allocator1);
+        TEST_CHECK(allocator1.frees == 0);
+
+        // An image with a different allocator keeps its own and frees the moved memory with the first
+        ScratchImage other(&allocator2);
+        other = std::move(plain);
+        TEST_CHECK(other.GetAllocator() == &allocator2);
+
+        other.Release();
+        TEST_CHECK(allocator1.frees == 1);
+        TEST_CHECK(allocator2.frees == 0);
+
+        TEST_CHECK_HR(other.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 8, 8, 1, 1));
+        TEST_CHECK(allocator2.allocations == 1);
+    }
+
+    TEST_CHECK(allocator1.allocations == allocator1.frees && allocator1.liveBytes == 0);
+    TEST_CHECK(allocator2.allocations == allocator2.frees && allocator2.liveBytes == 0);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// The per-thread scanline cache stays under its byte limit and is emptied on release
+bool Test_ScanlineCacheLimit()
+{
+    ReleaseScanlineCaches();
+
+    const ScanlineArena::Cache& cache = ScanlineArena::GetCache();
+    TEST_CHECK(cache.totalSize == 0);
+
+    void* blocks[ScanlineArena::c_MaxCachedBlocks + 2] = {};
+    for (auto& block : blocks)
+    {
+        block = ScanlineArena::Allocate(ScanlineArena::c_MaxCachedBlockSize);
+        TEST_CHECK(block != nullptr);
+    }
+
+    for (auto block : blocks)
+    {
+        ScanlineArena::Free(block);
+        TEST_CHECK(cache.totalSize <= ScanlineArena::c_MaxCachedBytes);
+    }
+
+    TEST_CHECK(cache.totalSize > 0);
+
+    // A cached block is handed out again
+    void* reused = ScanlineArena::Allocate(1024);
+    TEST_CHECK(reused != nullptr);
+    ScanlineArena::Free(reused);
+
+    // Blocks over the size limit are never cached
+    const size_t before = cache.totalSize;
+    void* large = ScanlineArena::Allocate(ScanlineArena::c_MaxCachedBlockSize * 2);
+    TEST_CHECK(large != nullptr);
+    ScanlineArena::Free(large);
+    TEST_CHECK(cache.totalSize == before);
+
+    ReleaseScanlineCaches();
+    TEST_CHECK(cache.totalSize == 0);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------
+// Large images come from the OS already zeroed, small ones from the heap
+bool Test_PageAllocator()
+{
+    for (auto flags : { TEX_ALLOC_DEFAULT, TEX_ALLOC_FIRST_TOUCH, TEX_ALLOC_TRANSPARENT_HUGE_PAGES | TEX_ALLOC_FIRST_TOUCH })
+    {
+        PageAllocator allocator(flags);
+
+        TEST_CHECK(!allocator.IsZeroInitialized(64 * 64 * 4));
+        TEST_CHECK(allocator.IsZeroInitialized(1024 * 1024 * 4));
+
+        ScratchImage small(&allocator);
+        TEST_CHECK_HR(small.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 64, 64, 1, 1));
+        TEST_CHECK((reinterpret_cast<uintptr_t>(small.GetPixels()) & 15) == 0);
+
+        ScratchImage large(&allocator);
+        TEST_CHECK_HR(large.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 1024, 1024, 1, 1));
+        TEST_CHECK((reinterpret_cast<uintptr_t>(large.GetPixels()) & 15) == 0);
+
+        // Zeroed without ScratchImage clearing it
+        const uint8_t* pixels = large.GetPixels();
+        for (size_t i = 0; i < large.GetPixelsSize(); i += 4093)
+        {
+            TEST_CHECK(pixels[i] == 0);
+        }
+
+        memset(large.GetPixels(), 0xFF, large.GetPixelsSize());
+        memset(small.GetPixels(), 0xFF, small.GetPixelsSize());
+    }
+
+    return true;
+}
@@ -0,0 +1,110 @@
+//-------------------------------------------------------------------------------------
+// main.cpp
+//
+// Test runner for the DirectXTex tests, pass a group name to run only that group
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//-------------------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+
+// bc.cpp
+bool Test_BCBatchMatchesSingle();
+bool Test_BC4EndpointSearch();
+bool Test_BC3AlphaIntegerVsFloat();
+bool Test_BC7YCoCgMetric();
+bool Test_DecodeRGBA8MatchesFloat();
+
+// compress.cpp
+bool Test_TargetErrorChangesOutput();
+bool Test_RefineFraction();
+bool Test_RefineProgressAndAbort();
+bool Test_DecompressRegionMatchesDecompress();
+
+// convert.cpp
+bool Test_ConvertInPlaceMatchesConvert();
+bool Test_ConvertInPlaceRejectsPacked();
+
+// dds.cpp
+bool Test_ReadAheadFailureSurfaces();
+bool Test_LoadRegionReadsOnlyCoveredRows();
+bool Test_PreviewLevelChoice();
+bool Test_PreviewSkipsArraysAndVolumes();
+bool Test_PreviewMipCountMismatch();
+
+// image.cpp
+bool Test_AllocatorKeptAcrossMove();
+bool Test_MovedMemoryFreedByOwner();
+bool Test_ScanlineCacheLimit();
+bool Test_PageAllocator();
+
+namespace
+{
+    struct TestInfo
+    {
+        const char* group;
+        const char* name;
+        bool (*func)();
+    };
+
+    const TestInfo g_Tests[] =
+    {
+        { "bc", "BC1-BC3 batch encoder matches the single block encoder", Test_BCBatchMatchesSingle },
+        { "bc", "BC4 endpoint search is never worse than truncation", Test_BC4EndpointSearch },
+        { "bc", "BC3 alpha integer encoder is at least as close as the float encoder", Test_BC3AlphaIntegerVsFloat },
+        { "bc", "BC7 YCoCg metric lowers the YCoCg error", Test_BC7YCoCgMetric },
+        { "bc", "BC1-BC3 RGBA8 decoders match the float decoders", Test_DecodeRGBA8MatchesFloat },
+        { "compress", "A target error changes the BC7 output", Test_TargetErrorChangesOutput },
+        { "compress", "refineFraction only changes the refined blocks", Test_RefineFraction },
+        { "compress", "refineFraction progress and abort", Test_RefineProgressAndAbort },
+        { "compress", "DecompressRegion matches Decompress", Test_DecompressRegionMatchesDecompress },
+        { "convert", "ConvertInPlace matches Convert", Test_ConvertInPlaceMatchesConvert },
+        { "convert", "ConvertInPlace rejects packed and video formats", Test_ConvertInPlaceRejectsPacked },
+        { "dds", "A read failure on the read-ahead thread surfaces as the original error", Test_ReadAheadFailureSurfaces },
+        { "dds", "LoadRegionFromDDSIOCallbacks reads only the covered block rows", Test_LoadRegionReadsOnlyCoveredRows },
+        { "dds", "A preview reads only the smallest sufficient level", Test_PreviewLevelChoice },
+        { "dds", "A preview skips the other items and volume slices", Test_PreviewSkipsArraysAndVolumes },
+        { "dds", "A preview falls back to the top level when the mips are missing", Test_PreviewMipCountMismatch },
+        { "image", "ScratchImage keeps its allocator across a move", Test_AllocatorKeptAcrossMove },
+        { "image", "ScratchImage frees moved memory with its allocator", Test_MovedMemoryFreedByOwner },
+        { "image", "Scanline cache limit and release", Test_ScanlineCacheLimit },
+        { "image", "PageAllocator", Test_PageAllocator },
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    const char* group = (argc > 1) ? argv[1] : nullptr;
+
+    size_t passed = 0;
+    size_t failed = 0;
+
+    for (const auto& test : g_Tests)
+    {
+        if (group && strcmp(group, test.group) != 0)
+            continue;
+
+        printf("%s: %s\n", test.group, test.name);
+
+        if (test.func())
+        {
+            ++passed;
+        }
+        else
+        {
+            printf("  FAILED\n");
+            ++failed;
+        }
+    }
+
+    if (!passed && !failed)
+    {
+        printf("ERROR: unknown test group '%s'\n", group ? group : "");
+        return 1;
+    }
+
+    printf("%zu passed, %zu failed\n", passed, failed);
+    return failed ? 1 : 0;
+}
@@ -15,6 +15,7 @@ namespace DdsFileTypePlus
     public enum DdsErrorMetric
     {
         Perceptual,
-        Uniform
+        Uniform,
+        PerceptualYCoCg
     }
 }
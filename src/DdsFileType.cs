@@ -62,6 +62,7 @@ namespace DdsFileTypePlus
                 new BooleanProperty(PropertyNames.ErrorDiffusionDithering, true),
                 StaticListChoiceProperty.CreateForEnum(PropertyNames.BC7CompressionSpeed, BC7CompressionSpeed.Medium, false),
                 StaticListChoiceProperty.CreateForEnum(PropertyNames.ErrorMetric, DdsErrorMetric.Perceptual, false),
+                new Int32Property(PropertyNames.TargetQuality, 0, 0, 60),
                 new BooleanProperty(PropertyNames.CubeMap, false),
                 new BooleanProperty(PropertyNames.GenerateMipMaps, false),
                 CreateMipMapResamplingAlgorithm(),
@@ -95,6 +96,18 @@ namespace DdsFileTypePlus
                     PropertyNames.FileFormat,
                     new object[]
                     {
+                        DdsFileFormat.BC1,
+                        DdsFileFormat.BC1Srgb,
+                        DdsFileFormat.BC2,
+                        DdsFileFormat.BC2Srgb,
+                        DdsFileFormat.BC3,
+                        DdsFileFormat.BC3Srgb,
+                        DdsFileFormat.BC3Rxgb,
+                        DdsFileFormat.BC4Unsigned,
+                        DdsFileFormat.BC4Ati1,
+                        DdsFileFormat.BC5Unsigned,
+                        DdsFileFormat.BC5Signed,
+                        DdsFileFormat.BC5Ati2,
                         DdsFileFormat.BC6HUnsigned,
                         DdsFileFormat.BC7,
                         DdsFileFormat.BC7Srgb
@@ -112,6 +125,18 @@ namespace DdsFileTypePlus
                         DdsFileFormat.BC3,
                         DdsFileFormat.BC3Srgb,
                         DdsFileFormat.BC3Rxgb,
+                        DdsFileFormat.BC7,
+                        DdsFileFormat.BC7Srgb,
+                    },
+                    true),
+                new ReadOnlyBoundToValueRule<object, StaticListChoiceProperty>(
+                    PropertyNames.TargetQuality,
+                    PropertyNames.FileFormat,
+                    new object[]
+                    {
+                        DdsFileFormat.BC6HUnsigned,
+                        DdsFileFormat.BC7,
+                        DdsFileFormat.BC7Srgb
                     },
                     true),
                 new ReadOnlyBoundToBooleanRule(PropertyNames.MipMapResamplingAlgorithm, PropertyNames.GenerateMipMaps, true),
@@ -233,6 +258,10 @@ namespace DdsFileTypePlus
             errorMetricPCI.ControlType.Value = PropertyControlType.RadioButton;
             errorMetricPCI.SetValueDisplayName(DdsErrorMetric.Perceptual, this.strings.GetString("ErrorMetric_Perceptual"));
             errorMetricPCI.SetValueDisplayName(DdsErrorMetric.Uniform, this.strings.GetString("ErrorMetric_Uniform"));
+            errorMetricPCI.SetValueDisplayName(DdsErrorMetric.PerceptualYCoCg, this.strings.GetString("ErrorMetric_PerceptualYCoCg"));
+
+            PropertyControlInfo targetQualityPCI = configUI.FindControlForPropertyName(PropertyNames.TargetQuality);
+            targetQualityPCI.ControlProperties[ControlInfoPropertyNames.DisplayName].Value = this.strings.GetString("TargetQuality_DisplayName");
 
             PropertyControlInfo cubemapPCI = configUI.FindControlForPropertyName(PropertyNames.CubeMap);
             cubemapPCI.ControlProperties[ControlInfoPropertyNames.DisplayName].Value = string.Empty;
@@ -284,6 +313,7 @@ namespace DdsFileTypePlus
             bool errorDiffusionDithering = token.GetProperty<BooleanProperty>(PropertyNames.ErrorDiffusionDithering).Value;
             BC7CompressionSpeed compressionSpeed = (BC7CompressionSpeed)token.GetProperty(PropertyNames.BC7CompressionSpeed).Value;
             DdsErrorMetric errorMetric = (DdsErrorMetric)token.GetProperty(PropertyNames.ErrorMetric).Value;
+            int targetQuality = token.GetProperty<Int32Property>(PropertyNames.TargetQuality).Value;
             bool cubeMap = token.GetProperty<BooleanProperty>(PropertyNames.CubeMap).Value;
             bool generateMipmaps = token.GetProperty<BooleanProperty>(PropertyNames.GenerateMipMaps).Value;
             ResamplingAlgorithm mipSampling = (ResamplingAlgorithm)token.GetProperty(PropertyNames.MipMapResamplingAlgorithm).Value;
@@ -296,6 +326,7 @@ namespace DdsFileTypePlus
                            errorDiffusionDithering,
                            compressionSpeed,
                            errorMetric,
+                           targetQuality,
                            cubeMap,
                            generateMipmaps,
                            mipSampling,
@@ -316,7 +347,8 @@ namespace DdsFileTypePlus
             GitHubLink,
             ErrorDiffusionDithering,
             UseGammaCorrection,
-            PluginVersion
+            PluginVersion,
+            TargetQuality
         }
     }
 }
@@ -13,6 +13,7 @@
 #include "stdafx.h"
 #include "DdsFileTypePlusIO.h"
 #include "DirectComputeHelper.h"
+#include "ScratchImagePool.h"
 #include "DDS.h"
 #include <memory>
 
@@ -20,6 +21,19 @@ using namespace DirectX;
 
 namespace
 {
+    // The buffers of released images are kept for reuse by the next load or save,
+    // this avoids repeatedly allocating large blocks when processing many files.
+    constexpr size_t MaxPooledScratchImageBytes = 128 * 1024 * 1024;
+
+    ScratchImagePool* GetScratchImagePool()
+    {
+        // The pool is intentionally never destroyed, images owned by the host
+        // application may be released after the static destructors have run.
+        static ScratchImagePool* pool = new ScratchImagePool(MaxPooledScratchImageBytes);
+
+        return pool;
+    }
+
     SwizzledImageFormat GetSwizzledImageFormat(const TexMetadata& metadata, const DDSMetaData& ddsPixelFormat)
     {
         SwizzledImageFormat format = SwizzledImageFormat::Unknown;
@@ -56,13 +70,37 @@ namespace
         return format;
     }
 
-    HRESULT SaveImage(const ImageIOCallbacks* callbacks, const ScratchImage* const image, DdsFileOptions fileOptions)
+    bool IsAlphaAllOpaque(const ScratchImage* const image, const AlphaStatistics* alphaStats)
+    {
+        if (alphaStats == nullptr)
+        {
+            return image->IsAlphaAllOpaque();
+        }
+
+        const size_t imageCount = image->GetImageCount();
+
+        for (size_t i = 0; i < imageCount; i++)
+        {
+            if (!alphaStats[i].allOpaque)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    HRESULT SaveImage(
+        const ImageIOCallbacks* callbacks,
+        const ScratchImage* const image,
+        DdsFileOptions fileOptions,
+        const AlphaStatistics* alphaStats)
     {
         TexMetadata metadata = image->GetMetadata();
 
         if (HasAlpha(metadata.format) && metadata.format != DXGI_FORMAT_A8_UNORM)
         {
-            if (image->IsAlphaAllOpaque())
+            if (IsAlphaAllOpaque(image, alphaStats))
             {
                 metadata.SetAlphaMode(TEX_ALPHA_MODE_OPAQUE);
             }
@@ -91,6 +129,111 @@ namespace
 
         return SaveToDDSIOCallbacks(image->GetImages(), image->GetImageCount(), metadata, ddsFlags, callbacks);
     }
+
+    // Converts a loaded DDS image to the format used by Paint.NET and fills in the load info.
+    HRESULT ConvertLoadedImage(
+        std::unique_ptr<ScratchImage>& ddsImage,
+        TexMetadata info,
+        const DDSMetaData& ddsPixelFormat,
+        DDSLoadInfo* loadInfo,
+        DirectX::ScratchImage** image)
+    {
+        HRESULT hr = S_OK;
+
+        if (IsTypeless(info.format))
+        {
+            info.format = MakeTypelessUNORM(info.format);
+
+            if (IsTypeless(info.format))
+            {
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            }
+
+            ddsImage->OverrideFormat(info.format);
+        }
+
+        if (IsPlanar(info.format))
+        {
+            std::unique_ptr<ScratchImage> interleavedImage(new(std::nothrow) ScratchImage(GetScratchImagePool()));
+
+            if (interleavedImage == nullptr)
+            {
+                return E_OUTOFMEMORY;
+            }
+
+            hr = ConvertToSinglePlane(ddsImage->GetImages(), ddsImage->GetImageCount(), info, *interleavedImage);
+
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            info = interleavedImage->GetMetadata();
+            ddsImage.swap(interleavedImage);
+        }
+
+        const TexMetadata originalImageMetadata = info;
+
+        const DXGI_FORMAT targetFormat = IsSRGB(info.format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+        std::unique_ptr<ScratchImage> targetImage(new(std::nothrow) ScratchImage(GetScratchImagePool()));
+
+        if (targetImage == nullptr)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        if (info.format == targetFormat)
+        {
+            targetImage.swap(ddsImage);
+        }
+        else
+        {
+            if (IsCompressed(info.format))
+            {
+                hr = Decompress(ddsImage->GetImages(), ddsImage->GetImageCount(), ddsImage->GetMetadata(), targetFormat, *targetImage);
+            }
+            else if (BitsPerPixel(info.format) == BitsPerPixel(targetFormat)
+                && !IsPlanar(info.format)
+                && !IsPalettized(info.format)
+                && !IsTypeless(info.format)
+                && !IsPacked(info.format)
+                && !IsVideo(info.format))
+            {
+                // The pixel sizes match, so the image can be converted without allocating a second copy.
+                hr = ConvertInPlace(*ddsImage, targetFormat, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT);
+
+                if (SUCCEEDED(hr))
+                {
+                    targetImage.swap(ddsImage);
+                }
+            }
+            else
+            {
+                hr = Convert(ddsImage->GetImages(), ddsImage->GetImageCount(), ddsImage->GetMetadata(), targetFormat,
+                    TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, *targetImage);
+            }
+
+            if (FAILED(hr))
+            {
+                return hr;
+            }
+
+            info = targetImage->GetMetadata();
+        }
+
+        loadInfo->width = info.width;
+        loadInfo->height = info.height;
+        loadInfo->depth = info.depth;
+        loadInfo->arraySize = info.arraySize;
+        loadInfo->mipLevels = info.mipLevels;
+        loadInfo->swizzledImageFormat = GetSwizzledImageFormat(originalImageMetadata, ddsPixelFormat);
+        loadInfo->cubeMap = info.IsCubemap();
+        loadInfo->premultipliedAlpha = HasAlpha(info.format) && info.format != DXGI_FORMAT_A8_UNORM && info.IsPMAlpha();
+        loadInfo->volumeMap = info.IsVolumemap();
+
+        *image = targetImage.release();
+        return S_OK;
+    }
 }
 
 HRESULT __stdcall CreateScratchImage(
@@ -104,7 +247,7 @@ HRESULT __stdcall CreateScratchImage(
 {
     *image = nullptr;
 
-    std::unique_ptr<ScratchImage> scratchImage(new(std::nothrow) ScratchImage);
+    std::unique_ptr<ScratchImage> scratchImage(new(std::nothrow) ScratchImage(GetScratchImagePool()));
 
     if (scratchImage == nullptr)
     {
@@ -187,7 +330,7 @@ HRESULT __stdcall Load(
 
     TexMetadata info;
     DDSMetaData ddsPixelFormat{};
-    std::unique_ptr<ScratchImage> ddsImage(new(std::nothrow) ScratchImage);
+    std::unique_ptr<ScratchImage> ddsImage(new(std::nothrow) ScratchImage(GetScratchImagePool()));
 
     if (ddsImage == nullptr)
     {
@@ -206,87 +349,114 @@ HRESULT __stdcall Load(
         return hr;
     }
 
-    if (IsTypeless(info.format))
+    return ConvertLoadedImage(ddsImage, info, ddsPixelFormat, loadInfo, image);
+}
+
+HRESULT __stdcall LoadPreview(
+    const ImageIOCallbacks* callbacks,
+    int32_t minWidth,
+    int32_t minHeight,
+    DDSLoadInfo* loadInfo,
+    DirectX::ScratchImage** image)
+{
+    if (callbacks == nullptr || loadInfo == nullptr || image == nullptr || minWidth < 0 || minHeight < 0)
     {
-        info.format = MakeTypelessUNORM(info.format);
+        return E_INVALIDARG;
+    }
 
-        if (IsTypeless(info.format))
-        {
-            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-        }
+    *image = nullptr;
 
-        ddsImage->OverrideFormat(info.format);
-    }
+    TexMetadata info;
+    DDSMetaData ddsPixelFormat{};
+    std::unique_ptr<ScratchImage> ddsImage(new(std::nothrow) ScratchImage(GetScratchImagePool()));
 
-    if (IsPlanar(info.format))
+    if (ddsImage == nullptr)
     {
-        std::unique_ptr<ScratchImage> interleavedImage(new(std::nothrow) ScratchImage);
+        return E_OUTOFMEMORY;
+    }
 
-        if (interleavedImage == nullptr)
-        {
-            return E_OUTOFMEMORY;
-        }
+    // Only the smallest stored mip level that covers the requested size is read from the file.
+    HRESULT hr = LoadPreviewFromDDSIOCallbacks(
+        callbacks,
+        DDS_FLAGS_ALLOW_LARGE_FILES | DDS_FLAGS_PERMISSIVE,
+        static_cast<size_t>(minWidth),
+        static_cast<size_t>(minHeight),
+        &info,
+        &ddsPixelFormat,
+        *ddsImage);
 
-        hr = ConvertToSinglePlane(ddsImage->GetImages(), ddsImage->GetImageCount(), info, *interleavedImage);
+    if (FAILED(hr))
+    {
+        return hr;
+    }
 
-        if (FAILED(hr))
-        {
-            return hr;
-        }
+    return ConvertLoadedImage(ddsImage, info, ddsPixelFormat, loadInfo, image);
+}
 
-        info = interleavedImage->GetMetadata();
-        ddsImage.swap(interleavedImage);
+HRESULT __stdcall LoadRegion(
+    const ImageIOCallbacks* callbacks,
+    int32_t x,
+    int32_t y,
+    int32_t width,
+    int32_t height,
+    DirectX::ScratchImage** image)
+{
+    if (callbacks == nullptr || image == nullptr || x < 0 || y < 0 || width <= 0 || height <= 0)
+    {
+        return E_INVALIDARG;
     }
 
-    const TexMetadata originalImageMetadata = info;
+    *image = nullptr;
 
-    const DXGI_FORMAT targetFormat = IsSRGB(info.format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
-    std::unique_ptr<ScratchImage> targetImage(new(std::nothrow) ScratchImage);
+    TexMetadata info;
+    std::unique_ptr<ScratchImage> regionImage(new(std::nothrow) ScratchImage(GetScratchImagePool()));
 
-    if (targetImage == nullptr)
+    if (regionImage == nullptr)
     {
         return E_OUTOFMEMORY;
     }
 
-    if (info.format == targetFormat)
+    // Only the rows of blocks that cover the region are read from the file, they are decoded
+    // to the default format of the BC format, which keeps sRGB data in an sRGB format.
+    HRESULT hr = LoadRegionFromDDSIOCallbacks(
+        callbacks,
+        DDS_FLAGS_ALLOW_LARGE_FILES | DDS_FLAGS_PERMISSIVE,
+        Rect(static_cast<size_t>(x), static_cast<size_t>(y), static_cast<size_t>(width), static_cast<size_t>(height)),
+        DXGI_FORMAT_UNKNOWN,
+        &info,
+        *regionImage);
+
+    if (FAILED(hr))
     {
-        targetImage.swap(ddsImage);
+        return hr;
     }
-    else
+
+    const DXGI_FORMAT targetFormat = IsSRGB(info.format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    if (regionImage->GetMetadata().format != targetFormat)
     {
-        if (IsCompressed(info.format))
-        {
-            hr = Decompress(ddsImage->GetImages(), ddsImage->GetImageCount(), ddsImage->GetMetadata(), targetFormat, *targetImage);
-        }
-        else
+        // BC4, BC5 and BC6H decode to formats with fewer channels or more precision.
+        std::unique_ptr<ScratchImage> targetImage(new(std::nothrow) ScratchImage(GetScratchImagePool()));
+
+        if (targetImage == nullptr)
         {
-            hr = Convert(ddsImage->GetImages(), ddsImage->GetImageCount(), ddsImage->GetMetadata(), targetFormat,
-                TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, *targetImage);
+            return E_OUTOFMEMORY;
         }
 
+        hr = Convert(*regionImage->GetImage(0, 0, 0), targetFormat, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, *targetImage);
+
         if (FAILED(hr))
         {
             return hr;
         }
 
-        info = targetImage->GetMetadata();
+        regionImage.swap(targetImage);
     }
 
-    loadInfo->width = info.width;
-    loadInfo->height = info.height;
-    loadInfo->depth = info.depth;
-    loadInfo->arraySize = info.arraySize;
-    loadInfo->mipLevels = info.mipLevels;
-    loadInfo->swizzledImageFormat = GetSwizzledImageFormat(originalImageMetadata, ddsPixelFormat);
-    loadInfo->cubeMap = info.IsCubemap();
-    loadInfo->premultipliedAlpha = HasAlpha(info.format) && info.format != DXGI_FORMAT_A8_UNORM && info.IsPMAlpha();
-    loadInfo->volumeMap = info.IsVolumemap();
-
-    *image = targetImage.release();
+    *image = regionImage.release();
     return S_OK;
 }
 
-
 HRESULT __stdcall Save(
     const DDSSaveInfo* input,
     const DirectX::ScratchImage* const originalImage,
@@ -304,6 +474,10 @@ HRESULT __stdcall Save(
     const DXGI_FORMAT dxgiFormat = input->format;
     std::unique_ptr<ScratchImage> output;
 
+    // The alpha statistics are collected while the image is compressed or converted,
+    // this avoids having to scan the output image to determine the alpha mode.
+    std::unique_ptr<AlphaStatistics[]> alphaStats;
+
     std::function<bool __cdecl(size_t, size_t)> progressCallback = nullptr;
     if (progressFn != nullptr)
     {
@@ -318,7 +492,7 @@ HRESULT __stdcall Save(
 
     if (IsCompressed(dxgiFormat))
     {
-        std::unique_ptr<ScratchImage> compressedImage(new(std::nothrow) ScratchImage);
+        std::unique_ptr<ScratchImage> compressedImage(new(std::nothrow) ScratchImage(GetScratchImagePool()));
 
         if (compressedImage == nullptr)
         {
@@ -331,6 +505,10 @@ HRESULT __stdcall Save(
         {
             compressFlags |= TEX_COMPRESS_UNIFORM;
         }
+        else if (input->errorMetric == DdsErrorMetric::PerceptualYCoCg)
+        {
+            compressFlags |= TEX_COMPRESS_YCOCG_METRIC;
+        }
 
         std::unique_ptr<DirectComputeHelper> dcHelper = nullptr;
         bool useDirectCompute = false;
@@ -351,10 +529,18 @@ HRESULT __stdcall Save(
                 break;
             }
 
-            dcHelper.reset(new(std::nothrow) DirectComputeHelper(directComputeAdapter));
-            if (dcHelper != nullptr)
+            // The DirectCompute encoders always use the uniform metric and search every mode,
+            // the YCoCg metric and the target error are only implemented by the CPU encoders.
+            const bool cpuOnlyMetric = input->errorMetric == DdsErrorMetric::PerceptualYCoCg &&
+                (dxgiFormat == DXGI_FORMAT_BC7_UNORM || dxgiFormat == DXGI_FORMAT_BC7_UNORM_SRGB || dxgiFormat == DXGI_FORMAT_BC7_TYPELESS);
+
+            if (!cpuOnlyMetric && input->targetError <= 0.0f)
             {
-                useDirectCompute = dcHelper->ComputeDeviceAvailable();
+                dcHelper.reset(new(std::nothrow) DirectComputeHelper(directComputeAdapter));
+                if (dcHelper != nullptr)
+                {
+                    useDirectCompute = dcHelper->ComputeDeviceAvailable();
+                }
             }
         }
         else
@@ -363,22 +549,41 @@ HRESULT __stdcall Save(
             {
                 compressFlags |= TEX_COMPRESS_DITHER;
             }
+
+            if (input->compressionSpeed == BC7CompressionSpeed::Fast)
+            {
+                // BC1, BC2 and BC3 fit the color endpoints in closed form instead of iterating.
+                compressFlags |= TEX_COMPRESS_BC7_QUICK;
+            }
+            else if (input->compressionSpeed == BC7CompressionSpeed::Slow)
+            {
+                // The exhaustive endpoint search is only used by the BC4 and BC5 encoders.
+                compressFlags |= TEX_COMPRESS_BC45_EXHAUSTIVE;
+            }
+        }
+
+        alphaStats.reset(new(std::nothrow) AlphaStatistics[originalImage->GetImageCount()]);
+
+        if (alphaStats == nullptr)
+        {
+            return E_OUTOFMEMORY;
         }
 
         CompressOptions options = {};
         options.flags = compressFlags;
         options.threshold = TEX_THRESHOLD_DEFAULT;
         options.alphaWeight = TEX_ALPHA_WEIGHT_DEFAULT;
+        options.targetError = input->targetError;
 
         if (useDirectCompute)
         {
             hr = CompressEx(dcHelper->GetComputeDevice(), originalImage->GetImages(), originalImage->GetImageCount(),
-                originalImage->GetMetadata(), dxgiFormat, options, *compressedImage, progressCallback);
+                originalImage->GetMetadata(), dxgiFormat, options, *compressedImage, progressCallback, alphaStats.get());
         }
         else
         {
             hr = CompressEx(originalImage->GetImages(), originalImage->GetImageCount(), originalImage->GetMetadata(),
-                dxgiFormat, options, *compressedImage, progressCallback);
+                dxgiFormat, options, *compressedImage, progressCallback, alphaStats.get());
         }
 
         if (FAILED(hr))
@@ -390,7 +595,7 @@ HRESULT __stdcall Save(
     }
     else if (originalImage->GetMetadata().format != dxgiFormat)
     {
-        std::unique_ptr<ScratchImage> convertedImage(new(std::nothrow) ScratchImage);
+        std::unique_ptr<ScratchImage> convertedImage(new(std::nothrow) ScratchImage(GetScratchImagePool()));
 
         if (convertedImage == nullptr)
         {
@@ -404,12 +609,19 @@ HRESULT __stdcall Save(
             filter |= TEX_FILTER_DITHER_DIFFUSION;
         }
 
+        alphaStats.reset(new(std::nothrow) AlphaStatistics[originalImage->GetImageCount()]);
+
+        if (alphaStats == nullptr)
+        {
+            return E_OUTOFMEMORY;
+        }
+
         ConvertOptions options = {};
         options.filter = filter;
         options.threshold = TEX_THRESHOLD_DEFAULT;
 
         hr = ConvertEx(originalImage->GetImages(), originalImage->GetImageCount(), originalImage->GetMetadata(),
-            dxgiFormat, options, *convertedImage, progressCallback);
+            dxgiFormat, options, *convertedImage, progressCallback, alphaStats.get());
 
         if (FAILED(hr))
         {
@@ -419,5 +631,5 @@ HRESULT __stdcall Save(
         output.swap(convertedImage);
     }
 
-    return SaveImage(callbacks, output ? output.get() : originalImage, input->fileOptions);
+    return SaveImage(callbacks, output ? output.get() : originalImage, input->fileOptions, alphaStats.get());
 }
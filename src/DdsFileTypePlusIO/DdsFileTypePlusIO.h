@@ -32,7 +32,8 @@ extern "C" {
     enum class DdsErrorMetric : int32_t
     {
         Perceptual,
-        Uniform
+        Uniform,
+        PerceptualYCoCg
     };
 
     // This must be kept in sync with DdsFileOptions.cs
@@ -98,6 +99,7 @@ extern "C" {
         DdsFileOptions fileOptions;
         DdsErrorMetric errorMetric;
         BC7CompressionSpeed compressionSpeed;
+        float targetError;
         bool errorDiffusionDithering;
     };
 
@@ -139,6 +141,21 @@ extern "C" {
         DDSLoadInfo* info,
         DirectX::ScratchImage** image);
 
+    __declspec(dllexport) HRESULT __stdcall LoadPreview(
+        const DirectX::ImageIOCallbacks* callbacks,
+        int32_t minWidth,
+        int32_t minHeight,
+        DDSLoadInfo* info,
+        DirectX::ScratchImage** image);
+
+    __declspec(dllexport) HRESULT __stdcall LoadRegion(
+        const DirectX::ImageIOCallbacks* callbacks,
+        int32_t x,
+        int32_t y,
+        int32_t width,
+        int32_t height,
+        DirectX::ScratchImage** image);
+
     __declspec(dllexport) HRESULT __stdcall Save(
         const DDSSaveInfo* input,
         const DirectX::ScratchImage* const originalImage,
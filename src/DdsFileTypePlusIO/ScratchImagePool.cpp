@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-ddsfiletype-plus, a DDS FileType plugin
+// for Paint.NET that adds support for the DX10 and later formats.
+//
+// Copyright (c) 2017-2025 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include "stdafx.h"
+#include "ScratchImagePool.h"
+#include <intrin.h>
+#include <malloc.h>
+
+namespace
+{
+    constexpr size_t BlockAlignment = 64;
+
+    // Rounds the size up to one of eight steps per power of two, this limits the wasted
+    // space to 12.5% while allowing images with similar sizes to share a buffer.
+    size_t RoundAllocationSize(size_t size)
+    {
+        if (size <= 65536)
+        {
+            return (size + 4095) & ~static_cast<size_t>(4095);
+        }
+
+        unsigned long highestBit;
+        _BitScanReverse64(&highestBit, size);
+
+        const size_t granularity = static_cast<size_t>(1) << (highestBit - 3);
+
+        return (size + granularity - 1) & ~(granularity - 1);
+    }
+}
+
+ScratchImagePool::ScratchImagePool(size_t maxCachedBytes)
+    : cachedBlocks(), cachedBlockCount(0), cachedBytes(0), maxCachedBytes(maxCachedBytes)
+{
+    InitializeSRWLock(&lock);
+}
+
+ScratchImagePool::~ScratchImagePool()
+{
+    Trim();
+}
+
+void* __cdecl ScratchImagePool::Allocate(size_t size, size_t alignment) noexcept
+{
+    if (alignment > BlockAlignment)
+    {
+        return nullptr;
+    }
+
+    const size_t blockSize = RoundAllocationSize(size);
+
+    AcquireSRWLockExclusive(&lock);
+
+    void* ptr = nullptr;
+
+    // Search from the most recently freed block, it is the most likely to still be in the cache.
+    for (size_t i = cachedBlockCount; i > 0; i--)
+    {
+        if (cachedBlocks[i - 1].size == blockSize)
+        {
+            ptr = cachedBlocks[i - 1].ptr;
+            RemoveBlock(i - 1);
+            break;
+        }
+    }
+
+    ReleaseSRWLockExclusive(&lock);
+
+    if (ptr == nullptr)
+    {
+        ptr = _aligned_malloc(blockSize, BlockAlignment);
+    }
+
+    return ptr;
+}
+
+void __cdecl ScratchImagePool::Free(void* ptr, size_t size) noexcept
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+
+    const size_t blockSize = RoundAllocationSize(size);
+
+    if (blockSize > maxCachedBytes)
+    {
+        _aligned_free(ptr);
+        return;
+    }
+
+    AcquireSRWLockExclusive(&lock);
+
+    // Evict the oldest blocks until the new block fits.
+    while (cachedBlockCount > 0 && (cachedBlockCount == MaxCachedBlocks || cachedBytes + blockSize > maxCachedBytes))
+    {
+        _aligned_free(cachedBlocks[0].ptr);
+        RemoveBlock(0);
+    }
+
+    cachedBlocks[cachedBlockCount].ptr = ptr;
+    cachedBlocks[cachedBlockCount].size = blockSize;
+    cachedBlockCount++;
+    cachedBytes += blockSize;
+
+    ReleaseSRWLockExclusive(&lock);
+}
+
+void ScratchImagePool::Trim() noexcept
+{
+    AcquireSRWLockExclusive(&lock);
+
+    for (size_t i = 0; i < cachedBlockCount; i++)
+    {
+        _aligned_free(cachedBlocks[i].ptr);
+    }
+
+    cachedBlockCount = 0;
+    cachedBytes = 0;
+
+    ReleaseSRWLockExclusive(&lock);
+}
+
+void ScratchImagePool::RemoveBlock(size_t index) noexcept
+{
+    cachedBytes -= cachedBlocks[index].size;
+
+    for (size_t i = index + 1; i < cachedBlockCount; i++)
+    {
+        cachedBlocks[i - 1] = cachedBlocks[i];
+    }
+
+    cachedBlockCount--;
+}
@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////
+//
+// This file is part of pdn-ddsfiletype-plus, a DDS FileType plugin
+// for Paint.NET that adds support for the DX10 and later formats.
+//
+// Copyright (c) 2017-2025 Nicholas Hayes
+//
+// This file is licensed under the MIT License.
+// See LICENSE.txt for complete licensing and attribution information.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "DirectXTex.h"
+
+// Keeps recently freed ScratchImage buffers so that the next image with a
+// similar size can reuse them instead of allocating new memory.
+class ScratchImagePool final : public DirectX::IScratchImageAllocator
+{
+public:
+    explicit ScratchImagePool(size_t maxCachedBytes);
+    ~ScratchImagePool();
+
+    ScratchImagePool(const ScratchImagePool&) = delete;
+    ScratchImagePool& operator=(const ScratchImagePool&) = delete;
+
+    void* __cdecl Allocate(size_t size, size_t alignment) noexcept override;
+    void __cdecl Free(void* ptr, size_t size) noexcept override;
+
+    void Trim() noexcept;
+
+private:
+    static constexpr size_t MaxCachedBlocks = 16;
+
+    struct Block
+    {
+        void* ptr;
+        size_t size;
+    };
+
+    void RemoveBlock(size_t index) noexcept;
+
+    SRWLOCK lock;
+    Block cachedBlocks[MaxCachedBlocks];
+    size_t cachedBlockCount;
+    size_t cachedBytes;
+    const size_t maxCachedBytes;
+};
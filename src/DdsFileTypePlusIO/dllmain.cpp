@@ -26,6 +26,9 @@ BOOL APIENTRY DllMain( HMODULE hModule,
     case DLL_THREAD_ATTACH:
     case DLL_THREAD_DETACH:
     case DLL_PROCESS_DETACH:
+        // The DirectXTex scanline caches are kept across loads and saves. They are thread_local,
+        // so the CRT frees each one when its thread exits or the DLL is unloaded.
+        // ReleaseScanlineCaches must not be called here, it starts an OpenMP parallel region.
         break;
     }
     return TRUE;
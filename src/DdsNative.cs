@@ -42,40 +42,59 @@ namespace DdsFileTypePlus
 
             GC.KeepAlive(streamIO);
 
-            if (HResult.Failed(hr))
+            return CreateLoadedImage(hr, streamIO, scratchImageHandle);
+        }
+
+        public static unsafe DirectXTexScratchImage LoadPreview(Stream stream, int minWidth, int minHeight, out DDSLoadInfo info)
+        {
+            StreamIOCallbacks streamIO = new(stream);
+            IOCallbacks callbacks = streamIO.GetIOCallbacks();
+
+            int hr;
+            SafeDirectXTexScratchImage scratchImageHandle;
+
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
             {
-                if (streamIO.CallbackExceptionInfo != null)
-                {
-                    streamIO.CallbackExceptionInfo.Throw();
-                }
-                else
-                {
-                    switch (hr)
-                    {
-                        case HResult.InvalidDdsFileSignature:
-                        case HResult.InvalidData:
-                            throw new FormatException("The DDS file is invalid.") { HResult = hr };
-                        case HResult.NotSupported:
-                            throw new FormatException("The file is not a supported DDS format.") { HResult = hr };
-                        default:
-                            Marshal.ThrowExceptionForHR(hr);
-                            break;
-                    }
-                }
+                hr = DdsIO_x64.LoadPreview(ref callbacks, minWidth, minHeight, out info, out scratchImageHandle);
+            }
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
+            {
+                hr = DdsIO_ARM64.LoadPreview(ref callbacks, minWidth, minHeight, out info, out scratchImageHandle);
+            }
+            else
+            {
+                throw new PlatformNotSupportedException();
             }
 
-            DirectXTexScratchImage scratchImage;
-            try
+            GC.KeepAlive(streamIO);
+
+            return CreateLoadedImage(hr, streamIO, scratchImageHandle);
+        }
+
+        public static unsafe DirectXTexScratchImage LoadRegion(Stream stream, int x, int y, int width, int height)
+        {
+            StreamIOCallbacks streamIO = new(stream);
+            IOCallbacks callbacks = streamIO.GetIOCallbacks();
+
+            int hr;
+            SafeDirectXTexScratchImage scratchImageHandle;
+
+            if (RuntimeInformation.ProcessArchitecture == Architecture.X64)
             {
-                scratchImage = new DirectXTexScratchImage(scratchImageHandle);
-                scratchImageHandle = null;
+                hr = DdsIO_x64.LoadRegion(ref callbacks, x, y, width, height, out scratchImageHandle);
             }
-            finally
+            else if (RuntimeInformation.ProcessArchitecture == Architecture.Arm64)
             {
-                scratchImageHandle?.Dispose();
+                hr = DdsIO_ARM64.LoadRegion(ref callbacks, x, y, width, height, out scratchImageHandle);
+            }
+            else
+            {
+                throw new PlatformNotSupportedException();
             }
 
-            return scratchImage;
+            GC.KeepAlive(streamIO);
+
+            return CreateLoadedImage(hr, streamIO, scratchImageHandle);
         }
 
         public static unsafe void Save(
@@ -134,5 +153,45 @@ namespace DdsFileTypePlus
                 }
             }
         }
+
+        private static DirectXTexScratchImage CreateLoadedImage(int hr,
+                                                                StreamIOCallbacks streamIO,
+                                                                SafeDirectXTexScratchImage scratchImageHandle)
+        {
+            if (HResult.Failed(hr))
+            {
+                if (streamIO.CallbackExceptionInfo != null)
+                {
+                    streamIO.CallbackExceptionInfo.Throw();
+                }
+                else
+                {
+                    switch (hr)
+                    {
+                        case HResult.InvalidDdsFileSignature:
+                        case HResult.InvalidData:
+                            throw new FormatException("The DDS file is invalid.") { HResult = hr };
+                        case HResult.NotSupported:
+                            throw new FormatException("The file is not a supported DDS format.") { HResult = hr };
+                        default:
+                            Marshal.ThrowExceptionForHR(hr);
+                            break;
+                    }
+                }
+            }
+
+            DirectXTexScratchImage scratchImage;
+            try
+            {
+                scratchImage = new DirectXTexScratchImage(scratchImageHandle);
+                scratchImageHandle = null;
+            }
+            finally
+            {
+                scratchImageHandle?.Dispose();
+            }
+
+            return scratchImage;
+        }
     }
 }
@@ -33,6 +33,7 @@ namespace DdsFileTypePlus
             bool errorDiffusionDithering,
             BC7CompressionSpeed compressionSpeed,
             DdsErrorMetric errorMetric,
+            int targetQuality,
             bool cubeMapFromCrossedImage,
             bool generateMipmaps,
             ResamplingAlgorithm sampling,
@@ -109,6 +110,7 @@ namespace DdsFileTypePlus
                         FileOptions = fileOptions,
                         ErrorMetric = errorMetric,
                         CompressionSpeed = compressionSpeed,
+                        TargetError = GetTargetError(targetQuality),
                         ErrorDiffusionDithering = errorDiffusionDithering
                     };
 
@@ -281,6 +283,13 @@ namespace DdsFileTypePlus
             return (dxgiFormat, options);
         }
 
+        private static float GetTargetError(int targetQuality)
+        {
+            // The target quality is a PSNR in dB, the encoder expects the matching mean squared
+            // error per channel on a [0, 1] scale.
+            return targetQuality > 0 ? (float)Math.Pow(10.0, -targetQuality / 10.0) : 0.0f;
+        }
+
         private static int GetMipCount(int width, int height)
         {
             int mipCount = 1;
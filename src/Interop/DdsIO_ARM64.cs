@@ -47,6 +47,23 @@ namespace DdsFileTypePlus.Interop
                                          out DDSLoadInfo info,
                                          out SafeDirectXTexScratchImage image);
 
+        [LibraryImport(DllName)]
+        [UnmanagedCallConv(CallConvs = new Type[] { typeof(System.Runtime.CompilerServices.CallConvStdcall) })]
+        internal static partial int LoadPreview(ref IOCallbacks callbacks,
+                                                int minWidth,
+                                                int minHeight,
+                                                out DDSLoadInfo info,
+                                                out SafeDirectXTexScratchImage image);
+
+        [LibraryImport(DllName)]
+        [UnmanagedCallConv(CallConvs = new Type[] { typeof(System.Runtime.CompilerServices.CallConvStdcall) })]
+        internal static partial int LoadRegion(ref IOCallbacks callbacks,
+                                               int x,
+                                               int y,
+                                               int width,
+                                               int height,
+                                               out SafeDirectXTexScratchImage image);
+
         [LibraryImport(DllName)]
         [UnmanagedCallConv(CallConvs = new Type[] { typeof(System.Runtime.CompilerServices.CallConvStdcall) })]
         internal static unsafe partial int Save(ref NativeDdsSaveInfo input,
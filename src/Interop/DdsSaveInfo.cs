@@ -24,6 +24,8 @@ namespace DdsFileTypePlus.Interop
 
         public BC7CompressionSpeed CompressionSpeed { get; init; }
 
+        public float TargetError { get; init; }
+
         public bool ErrorDiffusionDithering { get; init; }
 
         public NativeDdsSaveInfo ToNative() => new()
@@ -32,6 +34,7 @@ namespace DdsFileTypePlus.Interop
             fileOptions = this.FileOptions,
             errorMetric = this.ErrorMetric,
             compressionSpeed = this.CompressionSpeed,
+            targetError = this.TargetError,
             errorDiffusionDithering = (byte)(this.ErrorDiffusionDithering ? 1 : 0)
         };
     }
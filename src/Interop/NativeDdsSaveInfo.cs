@@ -23,6 +23,7 @@ namespace DdsFileTypePlus.Interop
         public DdsFileOptions fileOptions;
         public DdsErrorMetric errorMetric;
         public BC7CompressionSpeed compressionSpeed;
+        public float targetError;
         public byte errorDiffusionDithering;
     }
 }
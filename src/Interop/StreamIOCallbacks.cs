@@ -15,9 +15,15 @@ using System.Buffers;
 using System.IO;
 using System.Runtime.ExceptionServices;
 using System.Runtime.InteropServices;
+using System.Threading;
 
 namespace DdsFileTypePlus.Interop
 {
+    // The native code may call Read on a background thread while it reads the image data
+    // ahead of decoding it. The callbacks are never called concurrently, and every call has
+    // returned before the native function that was given the callbacks returns.
+    // The first exception thrown by a callback is kept, as later failures are usually a
+    // consequence of it.
     internal sealed class StreamIOCallbacks
     {
         private readonly Stream stream;
@@ -25,6 +31,7 @@ namespace DdsFileTypePlus.Interop
         private readonly WriteDelegate write;
         private readonly SeekDelegate seek;
         private readonly GetSizeDelegate getSize;
+        private ExceptionDispatchInfo callbackExceptionInfo;
 
         // 81920 is the largest multiple of 4096 that is below the large object heap threshold.
         private const int MaxBufferSize = 81920;
@@ -36,14 +43,10 @@ namespace DdsFileTypePlus.Interop
             this.write = Write;
             this.seek = Seek;
             this.getSize = GetSize;
-            this.CallbackExceptionInfo = null;
+            this.callbackExceptionInfo = null;
         }
 
-        public ExceptionDispatchInfo CallbackExceptionInfo
-        {
-            get;
-            private set;
-        }
+        public ExceptionDispatchInfo CallbackExceptionInfo => Volatile.Read(ref this.callbackExceptionInfo);
 
         public IOCallbacks GetIOCallbacks()
         {
@@ -96,7 +99,7 @@ namespace DdsFileTypePlus.Interop
             }
             catch (Exception ex)
             {
-                this.CallbackExceptionInfo = ExceptionDispatchInfo.Capture(ex);
+                SetCallbackException(ex);
                 return ex.HResult;
             }
         }
@@ -138,7 +141,7 @@ namespace DdsFileTypePlus.Interop
             }
             catch (Exception ex)
             {
-                this.CallbackExceptionInfo = ExceptionDispatchInfo.Capture(ex);
+                SetCallbackException(ex);
                 return ex.HResult;
             }
         }
@@ -158,13 +161,18 @@ namespace DdsFileTypePlus.Interop
             }
             catch (Exception ex)
             {
-                this.CallbackExceptionInfo = ExceptionDispatchInfo.Capture(ex);
+                SetCallbackException(ex);
                 hr = ex.HResult;
             }
 
             return hr;
         }
 
+        private void SetCallbackException(Exception ex)
+        {
+            Interlocked.CompareExchange(ref this.callbackExceptionInfo, ExceptionDispatchInfo.Capture(ex), null);
+        }
+
         private unsafe int GetSize(long* size)
         {
             if (size != null)
@@ -184,7 +192,7 @@ namespace DdsFileTypePlus.Interop
             }
             catch (Exception ex)
             {
-                this.CallbackExceptionInfo = ExceptionDispatchInfo.Capture(ex);
+                SetCallbackException(ex);
                 hr = ex.HResult;
             }
 
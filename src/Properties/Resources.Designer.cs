@@ -402,6 +402,15 @@ namespace DdsFileTypePlus.Properties {
             }
         }
         
+        /// <summary>
+        ///   Looks up a localized string similar to Perceptual (YCoCg).
+        /// </summary>
+        internal static string ErrorMetric_PerceptualYCoCg {
+            get {
+                return ResourceManager.GetString("ErrorMetric_PerceptualYCoCg", resourceCulture);
+            }
+        }
+        
         /// <summary>
         ///   Looks up a localized string similar to Uniform.
         /// </summary>
@@ -519,6 +528,15 @@ namespace DdsFileTypePlus.Properties {
             }
         }
         
+        /// <summary>
+        ///   Looks up a localized string similar to Target quality (PSNR in dB, 0 searches every mode).
+        /// </summary>
+        internal static string TargetQuality_DisplayName {
+            get {
+                return ResourceManager.GetString("TargetQuality_DisplayName", resourceCulture);
+            }
+        }
+        
         /// <summary>
         ///   Looks up a localized string similar to Use gamma correction.
         /// </summary>